@@ -0,0 +1,37 @@
+#pragma once
+
+#include <EngineCore.h>
+#include <Resources/CompressedContainer.h>
+
+#include <chrono>
+
+namespace Tempest
+{
+using BenchmarkClock = std::chrono::high_resolution_clock;
+
+inline float GetMillisecondsSince(BenchmarkClock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+// Every benchmark generates its data with a fixed seed, runs on the engine job system and logs the results.
+// They are friends of the measured classes, so they can time the internal steps in isolation
+
+struct SceneBvhBenchmark
+{
+	// Builds, refits and culls random items
+	static void Run(Job::JobSystem& jobSystem, uint32_t itemCount);
+};
+
+struct ClusteredLightCullingBenchmark
+{
+	// Bins random lights over a battlefield
+	static void Run(Job::JobSystem& jobSystem, uint32_t lightCount);
+};
+
+struct CompressedContainerBenchmark
+{
+	// Compresses and decompresses generated mesh like data. Returns false if the round trip does not match the source
+	static bool Run(Job::JobSystem& jobSystem, CompressionCodec codec, uint32_t sizeInBytes);
+};
+}
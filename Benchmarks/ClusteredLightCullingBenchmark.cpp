@@ -0,0 +1,54 @@
+#include "Benchmarks.h"
+
+#include <Graphics/ClusteredLightCulling.h>
+#include <Utils/SeededRandom.h>
+
+namespace Tempest
+{
+void ClusteredLightCullingBenchmark::Run(Job::JobSystem& jobSystem, uint32_t lightCount)
+{
+	OPTICK_EVENT();
+
+	// Torches and spot lights spread over the battlefield in front of the camera
+	Utils::SeededRandom random;
+	eastl::vector<FrameData::LocalLight> lights(lightCount);
+	for (FrameData::LocalLight& light : lights)
+	{
+		light.Position = glm::vec3((random.NextFloat() - 0.5f) * 200.0f, 0.5f + random.NextFloat() * 5.0f, (random.NextFloat() - 0.5f) * 200.0f);
+		light.Radius = 2.0f + random.NextFloat() * 10.0f;
+		light.Color = glm::vec3(random.NextFloat(), random.NextFloat(), random.NextFloat());
+		light.Direction = sForwardDirection;
+		light.SpotScale = 0.0f;
+		light.SpotOffset = 1.0f;
+		if (random.NextFloat() < 0.25f)
+		{
+			const float cosOuter = glm::cos(0.3f + random.NextFloat());
+			light.Direction = glm::normalize(glm::vec3(random.NextFloat() - 0.5f, -1.0f, random.NextFloat() - 0.5f));
+			light.SpotScale = 1.0f / 0.1f;
+			light.SpotOffset = -cosOuter * light.SpotScale;
+		}
+	}
+
+	const glm::mat4x4 view = glm::lookAt(glm::vec3(0.0f, 30.0f, -120.0f), glm::vec3(0.0f), sUpDirection);
+	const glm::mat4x4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	ClusteredLightCulling culling;
+	culling.SetupClusters(projection, 0.1f, 1000.0f);
+	const eastl::span<const FrameData::LocalLight> lightsSpan(lights.data(), lights.size());
+	// First run grows all the vectors
+	culling.Bin(jobSystem, lightsSpan, view);
+
+	const uint32_t runs = 16;
+	const auto start = BenchmarkClock::now();
+	for (uint32_t run = 0; run < runs; ++run)
+	{
+		culling.Bin(jobSystem, lightsSpan, view);
+	}
+	const float binningMilliseconds = GetMillisecondsSince(start) / float(runs);
+
+	const ClusteredLightCullingStatistics& statistics = culling.m_Statistics;
+	const float averageClusterLights = statistics.UsedClusters > 0 ? float(statistics.LightIndices) / float(statistics.UsedClusters) : 0.0f;
+	FORMAT_LOG(Info, Benchmarks, "Clustered light binning of %u lights in %u clusters: %.3f ms, %u light indices, %.1f lights per used cluster, max %u",
+		lightCount, ClusteredLightCulling::sClusterCount, binningMilliseconds, statistics.LightIndices, averageClusterLights, statistics.MaxClusterLights);
+}
+}
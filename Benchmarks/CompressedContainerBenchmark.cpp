@@ -0,0 +1,90 @@
+#include "Benchmarks.h"
+
+#include <Utils/SeededRandom.h>
+
+namespace Tempest
+{
+bool CompressedContainerBenchmark::Run(Job::JobSystem& jobSystem, CompressionCodec codec, uint32_t sizeInBytes)
+{
+	OPTICK_EVENT();
+
+	// Vertices of a wavy terrain with normals and UVs, followed by the indices of its quads
+	const uint32_t gridSize = 256;
+	const uint32_t vertexFloats = 8;
+	eastl::vector<uint8_t> source;
+	source.reserve(sizeInBytes);
+	Utils::SeededRandom random;
+	auto append = [&source](const void* value, size_t valueSize) {
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(value);
+		source.insert(source.end(), bytes, bytes + valueSize);
+	};
+	for (uint32_t vertex = 0; source.size() + vertexFloats * sizeof(float) <= sizeInBytes / 2; ++vertex)
+	{
+		const float x = float(vertex % gridSize);
+		const float z = float(vertex / gridSize);
+		const float height = glm::sin(x * 0.1f) * glm::cos(z * 0.1f) * 4.0f + random.NextFloat() * 0.05f;
+		const glm::vec3 normal = glm::normalize(glm::vec3(-glm::cos(x * 0.1f) * 0.4f, 1.0f, glm::sin(z * 0.1f) * 0.4f));
+		const float values[vertexFloats] = { x, height, z, normal.x, normal.y, normal.z, x / float(gridSize), z / float(gridSize) };
+		append(values, sizeof(values));
+	}
+	for (uint32_t quad = 0; source.size() + 6 * sizeof(uint32_t) <= sizeInBytes; ++quad)
+	{
+		const uint32_t corner = (quad / (gridSize - 1)) * gridSize + quad % (gridSize - 1);
+		const uint32_t indices[6] = { corner, corner + gridSize, corner + 1, corner + 1, corner + gridSize, corner + gridSize + 1 };
+		append(indices, sizeof(indices));
+	}
+
+	eastl::vector<uint8_t> compressed;
+	float compressMilliseconds = 0.0f;
+	{
+		const auto start = BenchmarkClock::now();
+		compressed = CompressedContainer::Compress(jobSystem, source.data(), source.size(), codec);
+		compressMilliseconds = GetMillisecondsSince(start);
+	}
+
+	eastl::vector<uint8_t> decompressed;
+	decompressed.resize(source.size());
+	bool matches = true;
+	float serialDecompressMilliseconds = 0.0f;
+	{
+		CompressedContainer::DecompressTask task;
+		task.Data = compressed.data();
+		task.Header = CompressedContainer::Validate(compressed.data(), compressed.size());
+		task.Offsets = reinterpret_cast<const uint64_t*>(task.Header + 1);
+		task.Destination = decompressed.data();
+
+		const auto start = BenchmarkClock::now();
+		for (uint32_t block = 0; block < task.Header->BlockCount; ++block)
+		{
+			matches &= CompressedContainer::DecompressBlock(task, block);
+		}
+		serialDecompressMilliseconds = GetMillisecondsSince(start);
+	}
+	matches &= memcmp(decompressed.data(), source.data(), source.size()) == 0;
+
+	memset(decompressed.data(), 0, decompressed.size());
+	float parallelDecompressMilliseconds = 0.0f;
+	{
+		const auto start = BenchmarkClock::now();
+		matches &= CompressedContainer::Decompress(jobSystem, compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+		parallelDecompressMilliseconds = GetMillisecondsSince(start);
+	}
+	matches &= memcmp(decompressed.data(), source.data(), source.size()) == 0;
+
+	// Megabytes of uncompressed data per second
+	const float megabytes = float(source.size()) / (1024.0f * 1024.0f);
+	const float compressThroughput = megabytes / eastl::max(compressMilliseconds / 1000.0f, 1e-6f);
+	const float serialDecompressThroughput = megabytes / eastl::max(serialDecompressMilliseconds / 1000.0f, 1e-6f);
+	const float parallelDecompressThroughput = megabytes / eastl::max(parallelDecompressMilliseconds / 1000.0f, 1e-6f);
+	if (!matches)
+	{
+		FORMAT_LOG(Error, Benchmarks, "%s container round trip does not match the source data", CompressedContainer::GetCodecName(codec));
+	}
+	FORMAT_LOG(Info, Benchmarks, "%s container of %.2f MB: ratio %.2f, compress %.2f ms (%.1f MB/s), decompress 1 thread %.2f ms (%.1f MB/s), jobs %.2f ms (%.1f MB/s)",
+		CompressedContainer::GetCodecName(codec), megabytes, float(source.size()) / float(eastl::max(compressed.size(), size_t(1))),
+		compressMilliseconds, compressThroughput,
+		serialDecompressMilliseconds, serialDecompressThroughput,
+		parallelDecompressMilliseconds, parallelDecompressThroughput);
+	return matches;
+}
+}
@@ -0,0 +1,38 @@
+#include "Benchmarks.h"
+
+#include <filesystem>
+
+// Returns nonzero if any of the benchmarks produced wrong results
+int main()
+{
+	char exePath[MAX_PATH];
+	::GetModuleFileNameA(NULL, exePath, MAX_PATH);
+	std::filesystem::current_path(std::filesystem::path(exePath).parent_path());
+
+	Tempest::EngineCoreOptions options;
+	options.NumWorkerThreads = std::thread::hardware_concurrency();
+	options.ResourceFolder = "../../Tempest/Shaders/";
+	options.UseAssetPack = false;
+
+	bool passed = true;
+	{
+		Tempest::EngineCore engine(options);
+
+		Tempest::Job::JobDecl job{ [](uint32_t, void* passedData) {
+			bool& passed = *(bool*)passedData;
+			Tempest::Job::JobSystem& jobSystem = Tempest::gEngineCore->GetJobSystem();
+
+			Tempest::SceneBvhBenchmark::Run(jobSystem, 100000);
+			Tempest::ClusteredLightCullingBenchmark::Run(jobSystem, 1000);
+			passed &= Tempest::CompressedContainerBenchmark::Run(jobSystem, Tempest::CompressionCodec::LZ4, 64 * 1024 * 1024);
+			passed &= Tempest::CompressedContainerBenchmark::Run(jobSystem, Tempest::CompressionCodec::Zstd, 64 * 1024 * 1024);
+
+			jobSystem.Quit();
+		}, &passed };
+
+		engine.GetJobSystem().RunJobs("Run Benchmarks", &job, 1, nullptr, Tempest::Job::ThreadTag::Worker);
+		engine.GetJobSystem().WaitForCompletion();
+	}
+
+	return passed ? 0 : 1;
+}
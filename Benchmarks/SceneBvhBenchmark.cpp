@@ -0,0 +1,71 @@
+#include "Benchmarks.h"
+
+#include <Graphics/SceneBvh.h>
+#include <Utils/SeededRandom.h>
+
+namespace Tempest
+{
+void SceneBvhBenchmark::Run(Job::JobSystem& jobSystem, uint32_t itemCount)
+{
+	OPTICK_EVENT();
+
+	// Soldier sized boxes over a battlefield
+	SceneBvh bvh;
+	bvh.m_StaticTree.State = SceneBvh::ItemState::Static;
+	bvh.m_DynamicTree.State = SceneBvh::ItemState::Dynamic;
+	Utils::SeededRandom random;
+	const float fieldSize = 1000.0f;
+	for (uint32_t i = 0; i < itemCount; ++i)
+	{
+		const glm::vec3 center((random.NextFloat() - 0.5f) * fieldSize, random.NextFloat() * 5.0f, (random.NextFloat() - 0.5f) * fieldSize);
+		const glm::vec3 halfSize(0.5f + random.NextFloat(), 1.0f + random.NextFloat(), 0.5f + random.NextFloat());
+		const BoundingBox bounds{ center - halfSize, center + halfSize };
+		bvh.Insert(i, &bounds);
+	}
+
+	// Everything in one tree, so the numbers are for the full item count
+	bvh.m_StaticTree.References.swap(bvh.m_PendingItems);
+	float buildMilliseconds = 0.0f;
+	{
+		const auto start = BenchmarkClock::now();
+		bvh.BuildTree(bvh.m_StaticTree, jobSystem);
+		buildMilliseconds = GetMillisecondsSince(start);
+	}
+
+	bvh.m_DynamicTree.References = bvh.m_StaticTree.References;
+	bvh.BuildTree(bvh.m_DynamicTree, jobSystem);
+	const uint32_t refitRuns = 8;
+	float refitMilliseconds = 0.0f;
+	for (uint32_t run = 0; run < refitRuns; ++run)
+	{
+		for (SceneBvh::Item& item : bvh.m_Items)
+		{
+			const glm::vec3 offset((random.NextFloat() - 0.5f) * 0.2f, 0.0f, (random.NextFloat() - 0.5f) * 0.2f);
+			item.Bounds.Min += offset;
+			item.Bounds.Max += offset;
+		}
+		const auto start = BenchmarkClock::now();
+		bvh.RefitTree(bvh.m_DynamicTree);
+		refitMilliseconds += GetMillisecondsSince(start);
+	}
+	refitMilliseconds /= float(refitRuns);
+
+	// Main and shadow view together
+	float cullMilliseconds = 0.0f;
+	{
+		const glm::mat4x4 views[] = {
+			glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 600.0f) * glm::lookAt(glm::vec3(0.0f, 50.0f, -500.0f), glm::vec3(0.0f), sUpDirection),
+			glm::ortho(-300.0f, 300.0f, -300.0f, 300.0f, 1.0f, 1000.0f) * glm::lookAt(glm::vec3(300.0f, 500.0f, 0.0f), glm::vec3(0.0f), sUpDirection),
+		};
+		const auto start = BenchmarkClock::now();
+		bvh.Cull(jobSystem, views);
+		cullMilliseconds = GetMillisecondsSince(start);
+	}
+
+	// Millions of items per second
+	const float buildThroughput = float(itemCount) / eastl::max(buildMilliseconds * 1000.0f, 1e-6f);
+	const float refitThroughput = float(itemCount) / eastl::max(refitMilliseconds * 1000.0f, 1e-6f);
+	FORMAT_LOG(Info, Benchmarks, "Scene BVH with %u items: build %.2f ms (%.1f M items/s), refit %.2f ms (%.1f M items/s), cull 2 views %.2f ms",
+		itemCount, buildMilliseconds, buildThroughput, refitMilliseconds, refitThroughput, cullMilliseconds);
+}
+}
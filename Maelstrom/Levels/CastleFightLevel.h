@@ -39,6 +39,15 @@ public:
                 .set(Tempest::Components::Transform{ glm::identity<glm::quat>(), originPoint, glm::vec3(1.0f, 1.0f, 1.0f) });
         }
 
+        // Torch in front of the castle, colored as the faction
+        {
+            const glm::vec3 torchColor = faction == Tempest::CastleFight::Faction::Red ? glm::vec3(1.0f, 0.3f, 0.2f) : glm::vec3(0.2f, 0.4f, 1.0f);
+            m_ECS.m_EntityWorld.entity(("Torch" + suffix).c_str())
+                .set(Tempest::Components::Transform{ glm::identity<glm::quat>(), originPoint + 3.0f * factionOriginToWorldOrigin + glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f) })
+                .set(Tempest::Components::LightColorInfo{ torchColor, 4.0f })
+                .set(Tempest::Components::PointLight{ 8.0f });
+        }
+
         // Soldiers
         {
             const uint32_t meshIndex = AddMeshRequest("Soldier", "Warrior" + suffix);
@@ -3,6 +3,7 @@
 #include <filesystem>
 
 #include "Resources/Level.h"
+#include "Resources/AssetPack.h"
 #include "Levels/CastleFightLevel.h"
 
 #define COMPILE_SCRIPTED_LEVEL_NAME CastleFightLevel
@@ -17,6 +18,8 @@ int main()
 	options.NumWorkerThreads = std::thread::hardware_concurrency();
 	// Make real resource folder
 	options.ResourceFolder = "../../Tempest/Shaders/";
+	// The pack in the output folder is rewritten at the end of the cook, so it must not be kept open
+	options.UseAssetPack = false;
 
 	{
 		Tempest::EngineCore engine(options);
@@ -29,10 +32,15 @@ int main()
 
 			CompilerOptions options{
 				.InputFolder = "../../",
-				.OutputFolder = "../../Tempest/Shaders/"
+				.OutputFolder = "../../Tempest/Shaders/",
+				.CacheFolder = "../../CookCache/"
 			};
 
 			gCompilerOptions = &options;
+			CookCache cookCache(options.CacheFolder.c_str());
+			gCookCache = &cookCache;
+			CookProfiler cookProfiler(Tempest::gEngineCore->GetOptions().NumWorkerThreads);
+			gCookProfiler = &cookProfiler;
 
 			level.Compile();
 			eastl::vector<uint8_t> compiledData = level.GetCompiledData();
@@ -42,6 +50,13 @@ int main()
 			outputPath.replace_extension(Tempest::Definition::LevelExtension());
 			std::ofstream outputFile(outputPath, std::ios::binary);
 			outputFile.write(reinterpret_cast<char*>(compiledData.data()), compiledData.size());
+			outputFile.close();
+
+			WriteAssetPack();
+			cookCache.LogStatistics();
+			cookProfiler.LogReport();
+			gCookCache = nullptr;
+			gCookProfiler = nullptr;
 
 			Tempest::gEngineCore->GetJobSystem().Quit();
 		}, &levelName };
@@ -53,10 +68,15 @@ int main()
 
             CompilerOptions options{
                 .InputFolder = "../../",
-                .OutputFolder = "../../Tempest/Shaders/"
+                .OutputFolder = "../../Tempest/Shaders/",
+                .CacheFolder = "../../CookCache/"
             };
 
             gCompilerOptions = &options;
+            CookCache cookCache(options.CacheFolder.c_str());
+            gCookCache = &cookCache;
+            CookProfiler cookProfiler(Tempest::gEngineCore->GetOptions().NumWorkerThreads);
+            gCookProfiler = &cookProfiler;
 
             level.Compile();
             eastl::vector<uint8_t> compiledData = level.GetCompiledData();
@@ -66,6 +86,13 @@ int main()
             outputPath.replace_extension(Tempest::Definition::LevelExtension());
             std::ofstream outputFile(outputPath, std::ios::binary);
             outputFile.write(reinterpret_cast<char*>(compiledData.data()), compiledData.size());
+            outputFile.close();
+
+            WriteAssetPack();
+            cookCache.LogStatistics();
+            cookProfiler.LogReport();
+            gCookCache = nullptr;
+            gCookProfiler = nullptr;
 
             Tempest::gEngineCore->GetJobSystem().Quit();
         }, nullptr };
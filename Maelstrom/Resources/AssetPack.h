@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Resource.h"
+
+#include <Resources/AssetPack.h>
+
+#include <EASTL/sort.h>
+
+#include <DataDefinitions/Level_generated.h>
+#include <DataDefinitions/Sector_generated.h>
+#include <DataDefinitions/GeometryDatabase_generated.h>
+#include <DataDefinitions/TextureDatabase_generated.h>
+#include <DataDefinitions/AudioDatabase_generated.h>
+
+// Packs every cooked level and database in the output folder, so levels cooked in earlier runs stay in the pack.
+// The shader library is built by another tool, so it is left as a loose file and never goes stale inside of the pack
+struct AssetPackResource : Resource<eastl::vector<uint8_t>>
+{
+public:
+	AssetPackResource()
+	{}
+
+	void Compile() override
+	{
+		const char* extensions[] = {
+			Tempest::Definition::LevelExtension(),
+			Tempest::Definition::SectorExtension(),
+			Tempest::Definition::GeometryDatabaseExtension(),
+			Tempest::Definition::TextureDatabaseExtension(),
+			Tempest::Definition::AudioDatabaseExtension(),
+		};
+
+		eastl::vector<Tempest::AssetPackInput> assets;
+		for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(gCompilerOptions->OutputFolder.c_str()))
+		{
+			if (!file.is_regular_file())
+			{
+				continue;
+			}
+
+			// Extensions of the definitions don't have the dot
+			const std::string extension = file.path().extension().string();
+			bool isCooked = false;
+			for (const char* cookedExtension : extensions)
+			{
+				isCooked |= extension.size() > 1 && extension.compare(1, std::string::npos, cookedExtension) == 0;
+			}
+			if (!isCooked)
+			{
+				continue;
+			}
+
+			Tempest::AssetPackInput& asset = assets.push_back();
+			asset.Name = file.path().filename().string().c_str();
+			asset.Data.resize(file.file_size());
+			std::ifstream stream(file.path(), std::ios::binary);
+			stream.read(reinterpret_cast<char*>(asset.Data.data()), asset.Data.size());
+		}
+
+		// Directory order is not guaranteed, sorting keeps the pack the same for the same assets
+		eastl::sort(assets.begin(), assets.end(), [](const Tempest::AssetPackInput& left, const Tempest::AssetPackInput& right) {
+			return left.Name < right.Name;
+		});
+
+		m_CompiledData = Tempest::AssetPack::Build(eastl::span<const Tempest::AssetPackInput>(assets.data(), assets.size()));
+		FORMAT_LOG(Info, Maelstrom, "Packed %u assets in %.2f MB", uint32_t(assets.size()), float(m_CompiledData.size()) / (1024.0f * 1024.0f));
+	}
+};
+
+// Rebuilds the pack after everything is written, or removes it when disabled so a stale pack never hides the loose files
+inline void WriteAssetPack()
+{
+	std::filesystem::path packPath(gCompilerOptions->OutputFolder.c_str());
+	packPath /= Tempest::AssetPack::sFileName;
+	if (!gCompilerOptions->BuildAssetPack)
+	{
+		std::error_code error;
+		std::filesystem::remove(packPath, error);
+		return;
+	}
+
+	AssetPackResource pack;
+	pack.Compile();
+	WriteCompiledFile(packPath, pack.GetCompiledData(), false);
+}
@@ -0,0 +1,335 @@
+#pragma once
+#include <EngineCore.h>
+
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <type_traits>
+
+// Hash of everything a compiled output depends on, it is the name of the output in the cache
+class CookHasher
+{
+public:
+	// The version of the compiler is the start of every key, so bumping it leaves all of its old outputs unused
+	explicit CookHasher(uint32_t compilerVersion)
+	{
+		Add(compilerVersion);
+	}
+
+	void AddBytes(const void* data, size_t size)
+	{
+		// FNV-1a, the same as the names in the asset pack
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			m_Hash ^= bytes[i];
+			m_Hash *= 1099511628211ull;
+		}
+	}
+
+	template<typename T>
+	void Add(const T& value)
+		requires std::is_trivially_copyable_v<T>
+	{
+		AddBytes(&value, sizeof(T));
+	}
+
+	template<typename T>
+	void Add(const eastl::vector<T>& values)
+		requires std::is_trivially_copyable_v<T>
+	{
+		// The size goes in as well, so the same bytes split differently between vectors give another key
+		Add(uint64_t(values.size()));
+		AddBytes(values.data(), values.size() * sizeof(T));
+	}
+
+	uint64_t GetHash() const
+	{
+		return m_Hash;
+	}
+private:
+	uint64_t m_Hash = 14695981039346656037ull;
+};
+
+// Archives for SerializeCookData, which every cached output implements once for both directions.
+// Plain data and vectors of it are copied at once, everything else goes through its SerializeCookData
+class CookDataWriter
+{
+public:
+	template<typename T>
+	void operator()(const T& value)
+		requires std::is_trivially_copyable_v<T>
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_Data.insert(m_Data.end(), bytes, bytes + sizeof(T));
+	}
+
+	template<typename T>
+	void operator()(const T& value)
+		requires (!std::is_trivially_copyable_v<T>)
+	{
+		// The writer only reads the data
+		SerializeCookData(*this, const_cast<T&>(value));
+	}
+
+	template<typename T>
+	void operator()(const eastl::vector<T>& values)
+	{
+		(*this)(uint64_t(values.size()));
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+			m_Data.insert(m_Data.end(), bytes, bytes + values.size() * sizeof(T));
+		}
+		else
+		{
+			for (const T& value : values)
+			{
+				(*this)(value);
+			}
+		}
+	}
+
+	eastl::vector<uint8_t>& GetData()
+	{
+		return m_Data;
+	}
+private:
+	eastl::vector<uint8_t> m_Data;
+};
+
+class CookDataReader
+{
+public:
+	CookDataReader(const uint8_t* data, size_t size)
+		: m_Data(data)
+		, m_Size(size)
+	{}
+
+	template<typename T>
+	void operator()(T& value)
+		requires std::is_trivially_copyable_v<T>
+	{
+		ReadBytes(&value, sizeof(T));
+	}
+
+	template<typename T>
+	void operator()(T& value)
+		requires (!std::is_trivially_copyable_v<T>)
+	{
+		SerializeCookData(*this, value);
+	}
+
+	template<typename T>
+	void operator()(eastl::vector<T>& values)
+	{
+		uint64_t count = 0;
+		(*this)(count);
+		// A broken file must not make us allocate everything
+		if (m_Failed || count > m_Size - m_Position)
+		{
+			m_Failed = true;
+			return;
+		}
+
+		values.resize(size_t(count));
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			ReadBytes(values.data(), values.size() * sizeof(T));
+		}
+		else
+		{
+			for (T& value : values)
+			{
+				(*this)(value);
+			}
+		}
+	}
+
+	// Everything was read and nothing more is left
+	bool IsValid() const
+	{
+		return !m_Failed && m_Position == m_Size;
+	}
+private:
+	void ReadBytes(void* destination, size_t size)
+	{
+		if (m_Failed || size > m_Size - m_Position)
+		{
+			m_Failed = true;
+			return;
+		}
+		memcpy(destination, m_Data + m_Position, size);
+		m_Position += size;
+	}
+
+	const uint8_t* m_Data;
+	size_t m_Size;
+	size_t m_Position = 0;
+	bool m_Failed = false;
+};
+
+struct CookCacheStatistics
+{
+	uint32_t Hits = 0;
+	uint32_t Misses = 0;
+	uint64_t ReadBytes = 0;
+	uint64_t WrittenBytes = 0;
+};
+
+// Content addressed cache of the compiled resources in a local folder. Every output is a file named by its key, so
+// resources which didn't change are read back instead of compiled again, no matter which level or scene they come from.
+// Outputs are written to a temporary file which is renamed when complete, so a cook which stops midway never leaves
+// broken outputs, and files which are not valid anyway are treated as misses. Safe to use from many jobs at once
+class CookCache : Tempest::Utils::NonCopyable
+{
+public:
+	static const uint32_t sMagic = 0x4B434B54; // TKCK
+	static const uint32_t sVersion = 1;
+
+	// Empty folder disables the cache
+	explicit CookCache(const char* folder)
+		: m_Folder(folder)
+	{
+		if (!m_Folder.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(m_Folder, error);
+		}
+	}
+
+	bool IsEnabled() const
+	{
+		return !m_Folder.empty();
+	}
+
+	// Fills the data from the cache, false if it must be compiled
+	template<typename T>
+	bool Load(uint64_t key, const char* kind, T& outData)
+	{
+		if (!IsEnabled())
+		{
+			return false;
+		}
+
+		std::ifstream stream(GetPath(key, kind), std::ios::binary | std::ios::ate);
+		eastl::vector<uint8_t> file;
+		if (stream)
+		{
+			file.resize(size_t(stream.tellg()));
+			stream.seekg(0);
+			stream.read(reinterpret_cast<char*>(file.data()), file.size());
+		}
+
+		Header header;
+		if (!stream || file.size() < sizeof(Header))
+		{
+			++m_Misses;
+			return false;
+		}
+		memcpy(&header, file.data(), sizeof(Header));
+		if (header.Magic != sMagic || header.Version != sVersion || header.Key != key || header.PayloadSize != file.size() - sizeof(Header))
+		{
+			FORMAT_LOG(Warning, Maelstrom, "Cached %s (%016llx) is not valid, compiling it again", kind, key);
+			++m_Misses;
+			return false;
+		}
+
+		CookDataReader reader(file.data() + sizeof(Header), size_t(header.PayloadSize));
+		T data;
+		reader(data);
+		if (!reader.IsValid())
+		{
+			FORMAT_LOG(Warning, Maelstrom, "Cached %s (%016llx) is not valid, compiling it again", kind, key);
+			++m_Misses;
+			return false;
+		}
+
+		outData = eastl::move(data);
+		++m_Hits;
+		m_ReadBytes += file.size();
+		return true;
+	}
+
+	template<typename T>
+	void Store(uint64_t key, const char* kind, const T& data)
+	{
+		if (!IsEnabled())
+		{
+			return;
+		}
+
+		CookDataWriter writer;
+		writer(Header{ sMagic, sVersion, key, 0 });
+		writer(data);
+		eastl::vector<uint8_t>& file = writer.GetData();
+		reinterpret_cast<Header*>(file.data())->PayloadSize = file.size() - sizeof(Header);
+
+		// Every job writes its own temporary file, even if two of them compile the same resource
+		const std::filesystem::path path = GetPath(key, kind);
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ("." + std::to_string(m_TemporaryFiles.fetch_add(1)) + ".tmp");
+		{
+			std::ofstream stream(temporaryPath, std::ios::binary);
+			stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+			if (!stream)
+			{
+				FORMAT_LOG(Warning, Maelstrom, "Failed to write %s (%016llx) in the cook cache", kind, key);
+				return;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return;
+		}
+		m_WrittenBytes += file.size();
+	}
+
+	CookCacheStatistics GetStatistics() const
+	{
+		return CookCacheStatistics{ m_Hits.load(), m_Misses.load(), m_ReadBytes.load(), m_WrittenBytes.load() };
+	}
+
+	void LogStatistics() const
+	{
+		if (!IsEnabled())
+		{
+			return;
+		}
+
+		const CookCacheStatistics statistics = GetStatistics();
+		FORMAT_LOG(Info, Maelstrom, "Cook cache: %u hits, %u misses, read %.2f MB, wrote %.2f MB",
+			statistics.Hits,
+			statistics.Misses,
+			float(statistics.ReadBytes) / (1024.0f * 1024.0f),
+			float(statistics.WrittenBytes) / (1024.0f * 1024.0f));
+	}
+private:
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint64_t PayloadSize;
+	};
+
+	std::filesystem::path GetPath(uint64_t key, const char* kind) const
+	{
+		char fileName[64];
+		snprintf(fileName, sizeof(fileName), "%016llx.%s", (unsigned long long)key, kind);
+		return std::filesystem::path(m_Folder.c_str()) / fileName;
+	}
+
+	eastl::string m_Folder;
+	std::atomic<uint32_t> m_Hits = 0;
+	std::atomic<uint32_t> m_Misses = 0;
+	std::atomic<uint64_t> m_ReadBytes = 0;
+	std::atomic<uint64_t> m_WrittenBytes = 0;
+	std::atomic<uint32_t> m_TemporaryFiles = 0;
+};
+
+CookCache* gCookCache = nullptr;
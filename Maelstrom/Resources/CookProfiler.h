@@ -0,0 +1,149 @@
+#pragma once
+#include <EngineCore.h>
+
+#include <EASTL/sort.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+struct CookProfileEntry
+{
+	const char* Kind;
+	eastl::string Name;
+	// From the start of the compilation to its end, including the time it waited for its own jobs
+	float WallMilliseconds;
+};
+
+// Times every compiled resource and the work done in the jobs of the cook, so the report shows which resources
+// are on the critical path and how busy the workers were. Only the timed work is counted as busy time, so waiting
+// in jobs is not counted twice, and work outside of the compiled resources, like writing the files, is not counted at all
+class CookProfiler : Tempest::Utils::NonCopyable
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+
+	explicit CookProfiler(uint32_t workerCount)
+		: m_WorkerCount(workerCount)
+		, m_StartTime(Clock::now())
+	{}
+
+	void AddResource(const char* kind, eastl::string name, float wallMilliseconds)
+	{
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		m_Entries.push_back(CookProfileEntry{ kind, eastl::move(name), wallMilliseconds });
+	}
+
+	void AddWork(Clock::duration duration)
+	{
+		m_WorkNanoseconds += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	}
+
+	void LogReport(uint32_t slowestResourcesToLog = 16)
+	{
+		const float cookMilliseconds = std::chrono::duration<float, std::milli>(Clock::now() - m_StartTime).count();
+		const float workMilliseconds = float(m_WorkNanoseconds.load()) / 1000000.0f;
+		const float utilization = cookMilliseconds > 0.0f ? workMilliseconds / (cookMilliseconds * float(m_WorkerCount)) : 0.0f;
+
+		std::lock_guard<std::mutex> lock(m_EntriesMutex);
+		FORMAT_LOG(Info, Maelstrom, "Cook took %.1f ms, %.1f ms of work on %u workers, %.1f%% utilization",
+			cookMilliseconds,
+			workMilliseconds,
+			m_WorkerCount,
+			utilization * 100.0f);
+
+		// Totals per kind in the order they were first compiled
+		eastl::vector<const char*> kinds;
+		for (const CookProfileEntry& entry : m_Entries)
+		{
+			if (eastl::find_if(kinds.begin(), kinds.end(), [&entry](const char* kind) { return strcmp(kind, entry.Kind) == 0; }) == kinds.end())
+			{
+				kinds.push_back(entry.Kind);
+			}
+		}
+		for (const char* kind : kinds)
+		{
+			uint32_t count = 0;
+			float totalMilliseconds = 0.0f;
+			float maxMilliseconds = 0.0f;
+			for (const CookProfileEntry& entry : m_Entries)
+			{
+				if (strcmp(entry.Kind, kind) == 0)
+				{
+					++count;
+					totalMilliseconds += entry.WallMilliseconds;
+					maxMilliseconds = glm::max(maxMilliseconds, entry.WallMilliseconds);
+				}
+			}
+			FORMAT_LOG(Info, Maelstrom, "    %-20s %5u compiled, %10.1f ms total, %10.1f ms slowest", kind, count, totalMilliseconds, maxMilliseconds);
+		}
+
+		eastl::sort(m_Entries.begin(), m_Entries.end(), [](const CookProfileEntry& left, const CookProfileEntry& right) {
+			return left.WallMilliseconds > right.WallMilliseconds;
+		});
+		FORMAT_LOG(Info, Maelstrom, "Slowest resources:");
+		for (uint32_t index = 0; index < m_Entries.size() && index < slowestResourcesToLog; ++index)
+		{
+			FORMAT_LOG(Info, Maelstrom, "    %10.1f ms %s %s", m_Entries[index].WallMilliseconds, m_Entries[index].Kind, m_Entries[index].Name.c_str());
+		}
+	}
+private:
+	uint32_t m_WorkerCount;
+	Clock::time_point m_StartTime;
+	std::atomic<uint64_t> m_WorkNanoseconds = 0;
+
+	std::mutex m_EntriesMutex;
+	eastl::vector<CookProfileEntry> m_Entries;
+};
+
+CookProfiler* gCookProfiler = nullptr;
+
+// Counts the scope as busy time of the workers. Must not wait for other jobs
+struct CookWorkTimer
+{
+	CookWorkTimer()
+		: m_StartTime(CookProfiler::Clock::now())
+	{}
+
+	~CookWorkTimer()
+	{
+		if (gCookProfiler)
+		{
+			gCookProfiler->AddWork(CookProfiler::Clock::now() - m_StartTime);
+		}
+	}
+private:
+	CookProfiler::Clock::time_point m_StartTime;
+};
+
+// Times the compilation of a resource. Resources which wait for their own jobs are not counted as work,
+// they time the parts which don't wait themselves
+struct CookResourceTimer
+{
+	CookResourceTimer(const char* kind, eastl::string name, bool countAsWork = true)
+		: m_Kind(kind)
+		, m_Name(eastl::move(name))
+		, m_CountAsWork(countAsWork)
+		, m_StartTime(CookProfiler::Clock::now())
+	{}
+
+	~CookResourceTimer()
+	{
+		if (!gCookProfiler)
+		{
+			return;
+		}
+
+		const CookProfiler::Clock::duration duration = CookProfiler::Clock::now() - m_StartTime;
+		gCookProfiler->AddResource(m_Kind, eastl::move(m_Name), std::chrono::duration<float, std::milli>(duration).count());
+		if (m_CountAsWork)
+		{
+			gCookProfiler->AddWork(duration);
+		}
+	}
+private:
+	const char* m_Kind;
+	eastl::string m_Name;
+	bool m_CountAsWork;
+	CookProfiler::Clock::time_point m_StartTime;
+};
@@ -22,6 +22,7 @@ public:
 
 	void Compile() override
 	{
+		CookResourceTimer resourceTimer("Entities database", "");
 		Tempest::WorldStorage ecs;
 
 		// NB: template argument is not used but needed to compile
@@ -49,6 +50,29 @@ public:
 							node->light->intensity })
 						.add<Tempest::Tags::DirectionalLight>();
 				}
+				else if (node->light->type == cgltf_light_type_point || node->light->type == cgltf_light_type_spot)
+				{
+					// Same as the directional lights, spot lights shine upon -Z in GLTF
+					auto changedShineDirectionWorldTransfrom = transform * glm::scale(glm::vec3(1.0f, 1.0f, -1.0f));
+					TRS trs(changedShineDirectionWorldTransfrom);
+
+					// GLTF allows infinite range, so cut it where the light is too dim to matter
+					const float radius = node->light->range > 0.0f ? node->light->range : glm::sqrt(node->light->intensity / sMinLightIlluminance);
+
+					auto entity = ecs.m_EntityWorld.entity(node->name)
+						.set(Tempest::Components::Transform{ trs.Rotation, trs.Translation, trs.Scale })
+						.set(Tempest::Components::LightColorInfo{
+							glm::vec3(node->light->color[0], node->light->color[1], node->light->color[2]),
+							node->light->intensity });
+					if (node->light->type == cgltf_light_type_point)
+					{
+						entity.set(Tempest::Components::PointLight{ radius });
+					}
+					else
+					{
+						entity.set(Tempest::Components::SpotLight{ radius, node->light->spot_inner_cone_angle, node->light->spot_outer_cone_angle });
+					}
+				}
 			}
 
 			return eastl::nullopt;
@@ -60,5 +84,8 @@ public:
 	}
 
 private:
+	// Illuminance at which lights without range are cut
+	static constexpr float sMinLightIlluminance = 0.01f;
+
 	const Scene& m_Scene;
 };
@@ -18,11 +18,18 @@ public:
 
 	void Compile() override
 	{
+		CookResourceTimer resourceTimer("Geometry database", "");
 		eastl::vector<VertexLayout> vertexBuffer;
 		eastl::vector<uint8_t> meshletIndicesBuffer;
 		eastl::vector<Tempest::Definition::Meshlet> meshlets;
 		eastl::vector<Tempest::Definition::PrimitiveMeshData> primitiveMeshes;
 		eastl::vector<Tempest::Definition::MeshMapping> mappings;
+		eastl::vector<Tempest::Definition::OccluderData> occluders;
+		eastl::vector<Common::Tempest::Vec3> occluderVertices;
+		eastl::vector<uint32_t> occluderIndices;
+		eastl::vector<Tempest::Definition::PrimitiveMeshLods> primitiveLods;
+		eastl::vector<Tempest::Definition::MeshLod> lods;
+		eastl::vector<float> uvDensities;
 
 		uint32_t currentVertexBufferOffset = 0;
 		uint32_t currentIndicesBufferOffset = 0;
@@ -67,12 +74,43 @@ public:
 				MaterialRequest findRequest{ m_Meshes[index].m_SceneIndex, primitiveMesh.MaterialIndex };
 				const uint32_t remmapedMaterialIndex = uint32_t(eastl::distance(m_MaterialRequests.begin(), eastl::find(m_MaterialRequests.begin(), m_MaterialRequests.end(), findRequest)));
 
+				// The default meshlets are only the full mesh, the rest are reachable through the lods
 				primitiveMeshes.emplace_back(
-					currentMeshletBufferOffset,
-					uint32_t(primitiveMesh.Meshlets.size()),
+					currentMeshletBufferOffset + primitiveMesh.Lods[0].MeshletOffset,
+					primitiveMesh.Lods[0].MeshletCount,
 					remmapedMaterialIndex
 				);
 
+				primitiveLods.emplace_back(uint32_t(lods.size()), uint32_t(primitiveMesh.Lods.size()));
+				for (const MeshLodData& lod : primitiveMesh.Lods)
+				{
+					lods.emplace_back(
+						currentMeshletBufferOffset + lod.MeshletOffset,
+						lod.MeshletCount,
+						lod.TriangleCount,
+						lod.Error
+					);
+				}
+
+				uvDensities.push_back(primitiveMesh.UVDensity);
+
+				// Occluders are already compacted and moved inside of the mesh, the occlusion culling needs only positions
+				const uint32_t occluderVertexOffset = uint32_t(occluderVertices.size());
+				const uint32_t occluderIndexOffset = uint32_t(occluderIndices.size());
+				for (const glm::vec3& position : primitiveMesh.OccluderPositions)
+				{
+					occluderVertices.emplace_back(position.x, position.y, position.z);
+				}
+				occluderIndices.insert(occluderIndices.end(), primitiveMesh.OccluderIndices.begin(), primitiveMesh.OccluderIndices.end());
+
+				occluders.emplace_back(
+					occluderVertexOffset,
+					occluderIndexOffset,
+					uint32_t(primitiveMesh.OccluderIndices.size()),
+					Common::Tempest::Vec3(primitiveMesh.BoundsMin.x, primitiveMesh.BoundsMin.y, primitiveMesh.BoundsMin.z),
+					Common::Tempest::Vec3(primitiveMesh.BoundsMax.x, primitiveMesh.BoundsMax.y, primitiveMesh.BoundsMax.z)
+				);
+
 				currentMeshletBufferOffset += uint32_t(primitiveMesh.Meshlets.size());
 				currentVertexBufferOffset += uint32_t(primitiveMesh.Vertices.size());
 				currentIndicesBufferOffset += uint32_t(primitiveMesh.MeshletIndices.size());
@@ -86,6 +124,12 @@ public:
 		auto primitiveMeshesOffset = builder.CreateVectorOfStructs<Tempest::Definition::PrimitiveMeshData>(primitiveMeshes.data(), primitiveMeshes.size());
 		auto materialsOffset = builder.CreateVectorOfStructs<Tempest::Definition::Material>(m_Materials.data(), m_Materials.size());
 		auto mappingsOffset = builder.CreateVectorOfSortedStructs<Tempest::Definition::MeshMapping>(mappings.data(), mappings.size());
+		auto occludersOffset = builder.CreateVectorOfStructs<Tempest::Definition::OccluderData>(occluders.data(), occluders.size());
+		auto occluderVerticesOffset = builder.CreateVectorOfStructs<Common::Tempest::Vec3>(occluderVertices.data(), occluderVertices.size());
+		auto occluderIndicesOffset = builder.CreateVector<uint32_t>(occluderIndices.data(), occluderIndices.size());
+		auto primitiveLodsOffset = builder.CreateVectorOfStructs<Tempest::Definition::PrimitiveMeshLods>(primitiveLods.data(), primitiveLods.size());
+		auto lodsOffset = builder.CreateVectorOfStructs<Tempest::Definition::MeshLod>(lods.data(), lods.size());
+		auto uvDensitiesOffset = builder.CreateVector<float>(uvDensities.data(), uvDensities.size());
 
 		auto root = Tempest::Definition::CreateGeometryDatabase(
 			builder,
@@ -94,7 +138,13 @@ public:
 			meshletBufferOffset,
 			primitiveMeshesOffset,
 			materialsOffset,
-			mappingsOffset
+			mappingsOffset,
+			occludersOffset,
+			occluderVerticesOffset,
+			occluderIndicesOffset,
+			primitiveLodsOffset,
+			lodsOffset,
+			uvDensitiesOffset
 		);
 
 		Tempest::Definition::FinishGeometryDatabaseBuffer(builder, root);
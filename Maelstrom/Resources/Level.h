@@ -7,6 +7,7 @@
 #include "TextureDatabase.h"
 #include "EntitiesDatabase.h"
 #include "AudioDatabase.h"
+#include "LevelSectors.h"
 
 #include "../GLTFScene.h"
 
@@ -21,14 +22,13 @@ public:
 
     }
 
-    eastl::string WriteFile(const char* extension, const eastl::vector<uint8_t>& data)
+    eastl::string WriteFile(const char* extension, const eastl::vector<uint8_t>& data, bool compress = false)
     {
         std::filesystem::path filename(gCompilerOptions->OutputFolder.c_str());
         filename /= m_Name.c_str();
         filename.replace_extension(extension);
 
-        std::ofstream stream(filename, std::ios::binary);
-        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+        WriteCompiledFile(filename, data, compress);
 
         return eastl::string(filename.filename().string().c_str());
     }
@@ -68,13 +68,18 @@ public:
 
         Tempest::gEngineCore->GetJobSystem().WaitForCounter(&databaseCounter, 0);
 
-        auto geometryDatabaseName = WriteFile(Tempest::Definition::GeometryDatabaseExtension(), geometryDatabaseResource.GetCompiledData());
+        LevelSectorsResource levelSectorsResource(entitiesDatabaseResource.GetCompiledData().EcsState, gCompilerOptions->SectorSize);
+        levelSectorsResource.Compile();
+        const LevelSectorsData& levelSectors = levelSectorsResource.GetCompiledData();
+
+        auto geometryDatabaseName = WriteFile(Tempest::Definition::GeometryDatabaseExtension(), geometryDatabaseResource.GetCompiledData(), true);
         auto audioDatabaseName = WriteFile(Tempest::Definition::AudioDatabaseExtension(), audioDatabaseResource.GetCompiledData());
-        auto textureDatabaseName = WriteFile(Tempest::Definition::TextureDatabaseExtension(), textureDatabaseResource.GetCompiledData());
+        auto textureDatabaseName = WriteFile(Tempest::Definition::TextureDatabaseExtension(), textureDatabaseResource.GetCompiledData(), true);
 
         flatbuffers::FlatBufferBuilder builder(1024 * 1024);
         auto nameOffset = builder.CreateString(m_Name.c_str());
-        auto entitiesOffset = builder.CreateVector<uint8_t>(entitiesDatabaseResource.GetCompiledData().EcsState.data(), entitiesDatabaseResource.GetCompiledData().EcsState.size());
+        auto entitiesOffset = builder.CreateVector<uint8_t>(levelSectors.GlobalEcsState.data(), levelSectors.GlobalEcsState.size());
+        auto sectorsOffset = WriteLevelSectors(builder, m_Name.c_str(), levelSectors);
         auto physicsWorldOffset = 0;
         auto geometryDatabaseFileOffset = builder.CreateString(geometryDatabaseName.c_str());
         auto textureDatabaseFileOffset = builder.CreateString(textureDatabaseName.c_str());
@@ -87,7 +92,8 @@ public:
             geometryDatabaseFileOffset,
             textureDatabaseFileOffset,
             audioDatabaseFileOffset,
-            &scene.m_Camera
+            &scene.m_Camera,
+            sectorsOffset
         );
 
         Tempest::Definition::FinishLevelBuffer(builder, root);
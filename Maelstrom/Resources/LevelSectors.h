@@ -0,0 +1,213 @@
+#pragma once
+
+#include "Resource.h"
+
+#include <World/World.h>
+#include <World/Components/Components.h>
+
+#include <EASTL/map.h>
+#include <EASTL/unordered_set.h>
+
+#include <DataDefinitions/Level_generated.h>
+#include <DataDefinitions/Sector_generated.h>
+
+struct LevelSectorData
+{
+	int32_t CellX;
+	int32_t CellZ;
+	glm::vec3 BoundsMin;
+	glm::vec3 BoundsMax;
+	eastl::vector<uint8_t> EcsState;
+	eastl::vector<eastl::string> EntityNames;
+};
+
+struct LevelSectorsData
+{
+	// Entities which are not in any sector, they are always in the world
+	eastl::vector<uint8_t> GlobalEcsState;
+	eastl::vector<LevelSectorData> Sectors;
+};
+
+// Splits the entities of the level on a grid on the ground, so the runtime can stream them around the camera.
+// Entities go in the cell of their position. Directional lights light everything and entities without names
+// can't be found again after loading, so they stay in the level. Every sector is the whole level without the
+// entities of the other cells, so the components and the relations between the entities are serialized as they were.
+// Everything else the level created is taken out of the sectors, including the entities which stay in the level and
+// the ones without a transform, so streaming a sector in doesn't reset them. Only the parents of the entities in the cell
+// are kept with them, as destructing a parent destructs its children too.
+// Levels which fit in a single cell are left as they are
+struct LevelSectorsResource : Resource<LevelSectorsData>
+{
+public:
+	LevelSectorsResource(const eastl::vector<uint8_t>& ecsState, float sectorSize)
+		: m_EcsState(ecsState)
+		, m_SectorSize(sectorSize)
+	{}
+
+	void Compile() override
+	{
+		CookResourceTimer resourceTimer("Level sectors", "");
+		m_CompiledData.GlobalEcsState = m_EcsState;
+		if (m_SectorSize <= 0.0f)
+		{
+			return;
+		}
+
+		// flecs parses null terminated strings
+		const eastl::string json(reinterpret_cast<const char*>(m_EcsState.data()), m_EcsState.size());
+		Tempest::WorldStorage level;
+		level.m_EntityWorld.from_json(json.c_str());
+
+		eastl::map<eastl::pair<int32_t, int32_t>, Cell> cells;
+		level.m_EntityWorld.query<const Tempest::Components::Transform>().each([&](flecs::entity entity, const Tempest::Components::Transform& transform) {
+			const char* name = entity.name().c_str();
+			if (entity.has<Tempest::Tags::DirectionalLight>() || !name || !name[0])
+			{
+				return;
+			}
+
+			const eastl::pair<int32_t, int32_t> key(int32_t(glm::floor(transform.Position.x / m_SectorSize)), int32_t(glm::floor(transform.Position.z / m_SectorSize)));
+			Cell& cell = cells[key];
+			cell.MinHeight = glm::min(cell.MinHeight, transform.Position.y);
+			cell.MaxHeight = glm::max(cell.MaxHeight, transform.Position.y);
+			cell.EntityPaths.push_back(entity.path().c_str());
+		});
+
+		if (cells.size() <= 1)
+		{
+			return;
+		}
+
+		for (const auto& [key, cell] : cells)
+		{
+			Tempest::WorldStorage sector;
+			const eastl::unordered_set<flecs::entity_t> builtinEntities = GetAllEntities(sector);
+			sector.m_EntityWorld.from_json(json.c_str());
+			KeepOnlyEntities(sector, builtinEntities, cell.EntityPaths);
+
+			LevelSectorData& sectorData = m_CompiledData.Sectors.push_back();
+			sectorData.CellX = key.first;
+			sectorData.CellZ = key.second;
+			sectorData.BoundsMin = glm::vec3(float(key.first) * m_SectorSize, cell.MinHeight, float(key.second) * m_SectorSize);
+			sectorData.BoundsMax = glm::vec3(float(key.first + 1) * m_SectorSize, cell.MaxHeight, float(key.second + 1) * m_SectorSize);
+			sectorData.EcsState = Serialize(sector);
+			sectorData.EntityNames = cell.EntityPaths;
+		}
+
+		// The level keeps only what is left after every sector is taken out
+		for (const auto& [key, cell] : cells)
+		{
+			DestructEntities(level, cell.EntityPaths);
+		}
+		m_CompiledData.GlobalEcsState = Serialize(level);
+
+		FORMAT_LOG(Info, Maelstrom, "Split the level in %u sectors of %.1f units", uint32_t(m_CompiledData.Sectors.size()), m_SectorSize);
+	}
+
+private:
+	struct Cell
+	{
+		float MinHeight = FLT_MAX;
+		float MaxHeight = -FLT_MAX;
+		eastl::vector<eastl::string> EntityPaths;
+	};
+
+	static void DestructEntities(Tempest::WorldStorage& world, const eastl::vector<eastl::string>& paths)
+	{
+		for (const eastl::string& path : paths)
+		{
+			const flecs::entity entity = world.m_EntityWorld.lookup(path.c_str());
+			if (entity)
+			{
+				entity.destruct();
+			}
+		}
+	}
+
+	static eastl::unordered_set<flecs::entity_t> GetAllEntities(Tempest::WorldStorage& world)
+	{
+		eastl::unordered_set<flecs::entity_t> entities;
+		world.m_EntityWorld.filter_builder<>().term(flecs::Any).build().each([&entities](flecs::entity entity) {
+			entities.insert(entity.id());
+		});
+		return entities;
+	}
+
+	// Every entity which the world didn't have before the level was loaded is destructed, unless it is in the paths
+	// or is a parent of one of them
+	static void KeepOnlyEntities(Tempest::WorldStorage& world, const eastl::unordered_set<flecs::entity_t>& builtinEntities, const eastl::vector<eastl::string>& paths)
+	{
+		eastl::unordered_set<flecs::entity_t> entitiesToKeep = builtinEntities;
+		for (const eastl::string& path : paths)
+		{
+			for (flecs::entity entity = world.m_EntityWorld.lookup(path.c_str()); entity; entity = entity.parent())
+			{
+				entitiesToKeep.insert(entity.id());
+			}
+		}
+
+		// Collected first, as destructing changes the tables which are iterated
+		eastl::vector<flecs::entity> entitiesToDestruct;
+		world.m_EntityWorld.filter_builder<>().term(flecs::Any).build().each([&](flecs::entity entity) {
+			if (entitiesToKeep.find(entity.id()) == entitiesToKeep.end())
+			{
+				entitiesToDestruct.push_back(entity);
+			}
+		});
+
+		for (const flecs::entity& entity : entitiesToDestruct)
+		{
+			// Could already be gone with its parent
+			if (entity.is_alive())
+			{
+				entity.destruct();
+			}
+		}
+	}
+
+	static eastl::vector<uint8_t> Serialize(Tempest::WorldStorage& world)
+	{
+		auto jsonString = world.m_EntityWorld.to_json();
+		eastl::vector<uint8_t> result;
+		result.resize(jsonString.size());
+		memcpy(result.data(), jsonString.c_str(), jsonString.size());
+		return result;
+	}
+
+	const eastl::vector<uint8_t>& m_EcsState;
+	float m_SectorSize;
+};
+
+// Writes every sector in a file of its own next to the level and returns them for the level. Must be called from a job
+inline flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Tempest::Definition::LevelSector>>> WriteLevelSectors(flatbuffers::FlatBufferBuilder& levelBuilder, const char* levelName, const LevelSectorsData& data)
+{
+	if (data.Sectors.empty())
+	{
+		return 0;
+	}
+
+	eastl::vector<flatbuffers::Offset<Tempest::Definition::LevelSector>> sectorOffsets;
+	for (const LevelSectorData& sector : data.Sectors)
+	{
+		flatbuffers::FlatBufferBuilder builder(64 * 1024);
+		auto entitiesOffset = builder.CreateVector<uint8_t>(sector.EcsState.data(), sector.EcsState.size());
+		eastl::vector<flatbuffers::Offset<flatbuffers::String>> nameOffsets;
+		for (const eastl::string& name : sector.EntityNames)
+		{
+			nameOffsets.push_back(builder.CreateString(name.c_str()));
+		}
+		auto namesOffset = builder.CreateVector(nameOffsets.data(), nameOffsets.size());
+		Tempest::Definition::FinishSectorBuffer(builder, Tempest::Definition::CreateSector(builder, entitiesOffset, namesOffset));
+
+		eastl::string fileName;
+		fileName.sprintf("%s_Sector_%d_%d.%s", levelName, sector.CellX, sector.CellZ, Tempest::Definition::SectorExtension());
+		std::filesystem::path filePath(gCompilerOptions->OutputFolder.c_str());
+		filePath /= fileName.c_str();
+		WriteCompiledFile(filePath, eastl::vector<uint8_t>(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize()), false);
+
+		const Common::Tempest::Vec3 boundsMin(sector.BoundsMin.x, sector.BoundsMin.y, sector.BoundsMin.z);
+		const Common::Tempest::Vec3 boundsMax(sector.BoundsMax.x, sector.BoundsMax.y, sector.BoundsMax.z);
+		sectorOffsets.push_back(Tempest::Definition::CreateLevelSector(levelBuilder, &boundsMin, &boundsMax, levelBuilder.CreateString(fileName.c_str())));
+	}
+	return levelBuilder.CreateVector(sectorOffsets.data(), sectorOffsets.size());
+}
@@ -42,6 +42,7 @@ public:
 
 	void Compile() override
 	{
+		CookResourceTimer resourceTimer("Material database", "");
 		eastl::vector<Tempest::Definition::Material> materials;
 		eastl::vector<TextureRequest> requests;
 
@@ -13,18 +13,105 @@ struct VertexLayout
 	glm::vec2 UV;
 };
 
+struct MeshLodData
+{
+	uint32_t MeshletOffset;
+	uint32_t MeshletCount;
+	uint32_t TriangleCount;
+	// Simplification error compared to the full mesh, in mesh space units
+	float Error;
+};
+
 struct PrimitiveMeshData
 {
 	eastl::vector<meshopt_Meshlet> Meshlets;
 	eastl::vector<VertexLayout> Vertices;
 	eastl::vector<uint8_t> MeshletIndices;
-	eastl::vector<uint32_t> WholeMeshIndices;
-	eastl::vector<uint32_t> SimplyfiedMeshIndices;
+	glm::vec3 BoundsMin;
+	glm::vec3 BoundsMax;
 	uint32_t MaterialIndex;
+	// UV units per mesh space unit, averaged by area over all triangles
+	float UVDensity;
+	// Level 0 is the full mesh. Meshlets, vertices and meshlet indices of all levels are stored one after another
+	eastl::vector<MeshLodData> Lods;
+	// Only for the full mesh
+	eastl::vector<uint32_t> WholeMeshIndices;
+	// Simplified mesh for the occlusion culling, which is inside of the full one. Indices point in the positions. Empty if
+	// the mesh cannot be simplified enough while staying close to its surface
+	eastl::vector<glm::vec3> OccluderPositions;
+	eastl::vector<uint32_t> OccluderIndices;
 };
 
+template<typename Archive>
+void SerializeCookData(Archive& archive, PrimitiveMeshData& primitiveMesh)
+{
+	archive(primitiveMesh.Meshlets);
+	archive(primitiveMesh.Vertices);
+	archive(primitiveMesh.MeshletIndices);
+	archive(primitiveMesh.BoundsMin);
+	archive(primitiveMesh.BoundsMax);
+	archive(primitiveMesh.MaterialIndex);
+	archive(primitiveMesh.UVDensity);
+	archive(primitiveMesh.Lods);
+	archive(primitiveMesh.WholeMeshIndices);
+	archive(primitiveMesh.OccluderPositions);
+	archive(primitiveMesh.OccluderIndices);
+}
+
+// Builds meshlets for the indices and appends them to the primitive. The vertices used by every meshlet are copied,
+// so each meshlet references a continuous range of the vertex buffer.
+inline MeshLodData AppendMeshlets(PrimitiveMeshData& primitiveMesh, const eastl::vector<uint32_t>& indices, const eastl::vector<VertexLayout>& vertices)
+{
+	const uint32_t maxTriangles = 128;
+	const uint32_t maxVertices = 128;
+	const size_t meshletCount = meshopt_buildMeshletsBound(indices.size(), maxVertices, maxTriangles);
+	eastl::vector<meshopt_Meshlet> meshlets(meshletCount);
+	eastl::vector<uint32_t> meshletVertices(meshletCount * maxVertices);
+	eastl::vector<uint8_t> meshletIndices(meshletCount * maxTriangles * 3);
+	const size_t actualMeshletCount = meshopt_buildMeshlets(
+		meshlets.data(),
+		meshletVertices.data(),
+		meshletIndices.data(),
+		indices.data(), indices.size(),
+		reinterpret_cast<const float*>(vertices.data()), vertices.size(), sizeof(VertexLayout),
+		maxVertices,
+		maxTriangles,
+		0.0f
+	);
+	meshlets.resize(actualMeshletCount);
+	meshletVertices.resize(meshlets.back().vertex_offset + meshlets.back().vertex_count);
+	meshletIndices.resize(meshlets.back().triangle_offset + (meshlets.back().triangle_count * 3));
+
+	const MeshLodData lod{
+		.MeshletOffset = uint32_t(primitiveMesh.Meshlets.size()),
+		.MeshletCount = uint32_t(meshlets.size()),
+		.TriangleCount = uint32_t(indices.size() / 3),
+		.Error = 0.0f
+	};
+
+	const uint32_t vertexOffset = uint32_t(primitiveMesh.Vertices.size());
+	const uint32_t triangleOffset = uint32_t(primitiveMesh.MeshletIndices.size());
+	for (meshopt_Meshlet meshlet : meshlets)
+	{
+		meshlet.vertex_offset += vertexOffset;
+		meshlet.triangle_offset += triangleOffset;
+		primitiveMesh.Meshlets.push_back(meshlet);
+	}
+
+	primitiveMesh.Vertices.reserve(primitiveMesh.Vertices.size() + meshletVertices.size());
+	for (uint32_t vertexIndex : meshletVertices)
+	{
+		primitiveMesh.Vertices.push_back(vertices[vertexIndex]);
+	}
+	primitiveMesh.MeshletIndices.insert(primitiveMesh.MeshletIndices.end(), meshletIndices.begin(), meshletIndices.end());
+	return lod;
+}
+
 struct MeshResource : Resource<eastl::vector<PrimitiveMeshData>>
 {
+	// Bump when the compiled output changes, so the cached outputs of the old version are not used
+	static const uint32_t sCookVersion = 2;
+
 	MeshResource(const Scene& scene, uint32_t sceneIndex, uint32_t meshIndex)
 		: m_Scene(scene)
 		, m_SceneIndex(sceneIndex)
@@ -33,119 +120,256 @@ struct MeshResource : Resource<eastl::vector<PrimitiveMeshData>>
 
 	void Compile() override
 	{
+		const char* meshName = m_Scene.m_Meshes[m_MeshIndex]->name;
+		CookResourceTimer resourceTimer("Mesh", meshName ? meshName : "Unnamed", false);
 		auto perPrimitivePositionCounts = m_Scene.MeshPositionCountPerPrimitive(m_MeshIndex);
 		auto primitiveCount = m_Scene.MeshPrimitiveCount(m_MeshIndex);
 
-		eastl::vector<PrimitiveMeshData> primitiveMeshes(primitiveCount);
-		for (int prim = 0; prim < int(primitiveCount); ++prim)
+		// Reading the primitives out of the scene is cheap compared to the compilation, and they are the key for the cache
+		eastl::vector<PrimitiveInput> inputs(primitiveCount);
+		uint64_t cacheKey = 0;
 		{
-			eastl::vector<VertexLayout> vertices;
-			eastl::vector<uint32_t> indices;
-			auto gltfIndicesData = m_Scene.MeshIndices(m_MeshIndex, prim);
-			if (gltfIndicesData.has_value())
+			CookWorkTimer workTimer;
+			CookHasher hasher(sCookVersion);
+			for (int prim = 0; prim < int(primitiveCount); ++prim)
 			{
-				indices = eastl::move(gltfIndicesData.value());
+				eastl::vector<VertexLayout>& vertices = inputs[prim].Vertices;
+				eastl::vector<uint32_t>& indices = inputs[prim].Indices;
+				auto gltfIndicesData = m_Scene.MeshIndices(m_MeshIndex, prim);
+				if (gltfIndicesData.has_value())
+				{
+					indices = eastl::move(gltfIndicesData.value());
+				}
+				else
+				{
+					indices.resize(perPrimitivePositionCounts[prim]);
+					eastl::iota(indices.begin(), indices.end(), 0);
+				}
+
+				assert(indices.size() % 3 == 0);
+				for (int i = 0; i < indices.size() / 3; ++i)
+				{
+					eastl::swap(indices[i * 3 + 1], indices[i * 3 + 2]);
+				}
+
+				auto positions = m_Scene.MeshPositions(m_MeshIndex, prim);
+				auto normals = m_Scene.MeshNormals(m_MeshIndex, prim);
+				auto uvs = m_Scene.MeshUVs(m_MeshIndex, prim);
+				assert(positions.size() == normals.size() && normals.size() == uvs.size());
+
+				vertices.resize(positions.size());
+				for (int i = 0; i < positions.size(); ++i)
+				{
+					vertices[i] = VertexLayout{
+						.Position = glm::vec3(positions[i].x, positions[i].y, -positions[i].z),
+						.Normal = glm::vec3(normals[i].x, normals[i].y, -normals[i].z),
+						.UV = uvs[i]
+					};
+				}
+				inputs[prim].MaterialIndex = m_Scene.MeshMaterialIndex(m_MeshIndex, prim);
+
+				hasher.Add(vertices);
+				hasher.Add(indices);
+				hasher.Add(inputs[prim].MaterialIndex);
 			}
-			else
+
+			cacheKey = hasher.GetHash();
+			if (gCookCache && gCookCache->Load(cacheKey, "mesh", m_CompiledData))
 			{
-				indices.resize(perPrimitivePositionCounts[prim]);
-				eastl::iota(indices.begin(), indices.end(), 0);
+				return;
 			}
+		}
+
+		// Primitives don't depend on each other, so big meshes with many of them don't keep a single worker busy
+		eastl::vector<PrimitiveMeshData> primitiveMeshes(primitiveCount);
+		PrimitiveTask task{ inputs.data(), primitiveMeshes.data() };
+		eastl::vector<Tempest::Job::JobDecl> jobs(primitiveCount, Tempest::Job::JobDecl{ CompilePrimitiveJob, &task });
+		Tempest::Job::Counter primitivesCounter;
+		Tempest::gEngineCore->GetJobSystem().RunJobs("Compile Mesh Primitive", jobs.data(), uint32_t(jobs.size()), &primitivesCounter);
+		Tempest::gEngineCore->GetJobSystem().WaitForCounter(&primitivesCounter, 0);
+
+		m_CompiledData.swap(primitiveMeshes);
+		if (gCookCache)
+		{
+			gCookCache->Store(cacheKey, "mesh", m_CompiledData);
+		}
+	}
+
+	struct PrimitiveInput
+	{
+		eastl::vector<VertexLayout> Vertices;
+		eastl::vector<uint32_t> Indices;
+		uint32_t MaterialIndex;
+	};
+
+	struct PrimitiveTask
+	{
+		PrimitiveInput* Inputs;
+		PrimitiveMeshData* Outputs;
+	};
+
+	static void CompilePrimitiveJob(uint32_t primitiveIndex, void* data)
+	{
+		CookWorkTimer workTimer;
+		PrimitiveTask* task = reinterpret_cast<PrimitiveTask*>(data);
+		CompilePrimitive(task->Inputs[primitiveIndex], task->Outputs[primitiveIndex]);
+	}
+
+	// Remaps and optimizes the primitive, then builds the meshlets and the levels of detail. The input is changed in place
+	static void CompilePrimitive(PrimitiveInput& input, PrimitiveMeshData& primitiveMesh)
+	{
+		eastl::vector<VertexLayout>& vertices = input.Vertices;
+		eastl::vector<uint32_t>& indices = input.Indices;
+
+		eastl::vector<uint32_t> remapTable(vertices.size());
+		meshopt_generateVertexRemap(remapTable.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(VertexLayout));
+
+		meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remapTable.data());
+
+		meshopt_remapVertexBuffer(vertices.data(), vertices.data(), vertices.size(), sizeof(VertexLayout), remapTable.data());
+
+		meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
+		meshopt_optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(VertexLayout));
+
+		primitiveMesh.Lods.push_back(AppendMeshlets(primitiveMesh, indices, vertices));
 
-			assert(indices.size() % 3 == 0);
-			for (int i = 0; i < indices.size() / 3; ++i)
+		// From here on everything works on the vertices ordered by the meshlets of the full mesh
+		const eastl::vector<VertexLayout> fullMeshVertices = primitiveMesh.Vertices;
+		eastl::vector<uint32_t> wholeMeshIndices;
+		wholeMeshIndices.reserve(primitiveMesh.MeshletIndices.size());
+		for (const auto& meshlet : primitiveMesh.Meshlets)
+		{
+			for (uint32_t index = meshlet.triangle_offset; index < (meshlet.triangle_offset + meshlet.triangle_count * 3); ++index)
 			{
-				eastl::swap(indices[i * 3 + 1], indices[i * 3 + 2]);
+				wholeMeshIndices.push_back(meshlet.vertex_offset + primitiveMesh.MeshletIndices[index]);
 			}
+		}
 
-			auto positions = m_Scene.MeshPositions(m_MeshIndex, prim);
-			auto normals = m_Scene.MeshNormals(m_MeshIndex, prim);
-			auto uvs = m_Scene.MeshUVs(m_MeshIndex, prim);
-			assert(positions.size() == normals.size() && normals.size() == uvs.size());
-
-			vertices.resize(positions.size());
-			for (int i = 0; i < positions.size(); ++i)
+		// Every level is simplified from the full mesh, so the reported error is not accumulated between levels
+		const uint32_t maxLodCount = 6;
+		const uint32_t minLodTriangles = 64;
+		const float maxLodError = 0.05f;
+		const float meshScale = meshopt_simplifyScale(reinterpret_cast<const float*>(fullMeshVertices.data()), fullMeshVertices.size(), sizeof(VertexLayout));
+		for (uint32_t level = 1; level < maxLodCount; ++level)
+		{
+			const size_t targetIndexCount = ((wholeMeshIndices.size() / 3) >> level) * 3;
+			if (targetIndexCount < minLodTriangles * 3)
 			{
-				vertices[i] = VertexLayout{
-					.Position = glm::vec3(positions[i].x, positions[i].y, -positions[i].z),
-					.Normal = glm::vec3(normals[i].x, normals[i].y, -normals[i].z),
-					.UV = uvs[i]
-				};
+				break;
 			}
 
-			eastl::vector<uint32_t> remapTable(vertices.size());
-			meshopt_generateVertexRemap(remapTable.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(VertexLayout));
-
-			meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remapTable.data());
-
-			meshopt_remapVertexBuffer(vertices.data(), vertices.data(), vertices.size(), sizeof(VertexLayout), remapTable.data());
-
-			meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
-			meshopt_optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(VertexLayout));
-
-			const uint32_t maxTriangles = 128;
-			const uint32_t maxVertices = 128;
-			const size_t meshletCount = meshopt_buildMeshletsBound(indices.size(), maxVertices, maxTriangles);
-			eastl::vector<meshopt_Meshlet> meshlets(meshletCount);
-			eastl::vector<uint32_t> meshletVertices(meshletCount * maxTriangles);
-			eastl::vector<uint8_t> meshletIndices(meshletCount * maxTriangles * 3);
-			const size_t actualMeshletCount = meshopt_buildMeshlets(
-				meshlets.data(),
-				meshletVertices.data(),
-				meshletIndices.data(),
-				indices.data(), indices.size(),
-				reinterpret_cast<const float*>(vertices.data()), vertices.size(), sizeof(VertexLayout),
-				maxVertices,
-				maxTriangles,
-				0.0f
-			);
-			meshlets.resize(actualMeshletCount);
-			meshletVertices.resize(meshlets.back().vertex_offset + meshlets.back().vertex_count);
-			meshletIndices.resize(meshlets.back().triangle_offset + (meshlets.back().triangle_count * 3));
+			eastl::vector<uint32_t> lodIndices(wholeMeshIndices.size());
+			float lodError = 0.0f;
+			lodIndices.resize(meshopt_simplify(
+				lodIndices.data(),
+				wholeMeshIndices.data(),
+				wholeMeshIndices.size(),
+				reinterpret_cast<const float*>(fullMeshVertices.data()),
+				fullMeshVertices.size(),
+				sizeof(VertexLayout),
+				targetIndexCount,
+				maxLodError,
+				0,
+				&lodError
+			));
 
+			// Simplification is stuck on the error limit, next levels will not be any better
+			if (lodIndices.empty() || lodIndices.size() > size_t(primitiveMesh.Lods.back().TriangleCount) * 3 * 85 / 100)
 			{
-				eastl::vector<VertexLayout> orderedVertices;
-				orderedVertices.reserve(vertices.size());
-				for (uint32_t vertexIndex : meshletVertices)
-				{
-					orderedVertices.push_back(vertices[vertexIndex]);
-				}
-				vertices.swap(orderedVertices);
+				break;
 			}
 
-			eastl::vector<uint32_t> wholeMeshIndices;
-			wholeMeshIndices.reserve(meshletIndices.size());
-			for (const auto& meshlet : meshlets)
+			meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), lodIndices.size(), fullMeshVertices.size());
+			MeshLodData lod = AppendMeshlets(primitiveMesh, lodIndices, fullMeshVertices);
+			lod.Error = lodError * meshScale;
+			primitiveMesh.Lods.push_back(lod);
+		}
+
+		glm::vec3 boundsMin(FLT_MAX);
+		glm::vec3 boundsMax(-FLT_MAX);
+		for (const VertexLayout& vertex : fullMeshVertices)
+		{
+			boundsMin = glm::min(boundsMin, vertex.Position);
+			boundsMax = glm::max(boundsMax, vertex.Position);
+		}
+
+		BuildOccluder(primitiveMesh, wholeMeshIndices, fullMeshVertices, meshScale, boundsMin, boundsMax);
+
+		// Ratio of the areas instead of the edges, so stretched triangles don't skew the result
+		double worldArea = 0.0;
+		double uvArea = 0.0;
+		for (size_t i = 0; i < wholeMeshIndices.size(); i += 3)
+		{
+			const VertexLayout& v0 = fullMeshVertices[wholeMeshIndices[i + 0]];
+			const VertexLayout& v1 = fullMeshVertices[wholeMeshIndices[i + 1]];
+			const VertexLayout& v2 = fullMeshVertices[wholeMeshIndices[i + 2]];
+			worldArea += glm::length(glm::cross(v1.Position - v0.Position, v2.Position - v0.Position)) * 0.5;
+			const glm::vec2 uvEdge0 = v1.UV - v0.UV;
+			const glm::vec2 uvEdge1 = v2.UV - v0.UV;
+			uvArea += glm::abs(uvEdge0.x * uvEdge1.y - uvEdge0.y * uvEdge1.x) * 0.5;
+		}
+
+		primitiveMesh.UVDensity = worldArea > 0.0 ? float(glm::sqrt(uvArea / worldArea)) : 0.0f;
+		primitiveMesh.WholeMeshIndices.swap(wholeMeshIndices);
+		primitiveMesh.BoundsMin = boundsMin;
+		primitiveMesh.BoundsMax = boundsMax;
+		primitiveMesh.MaterialIndex = input.MaterialIndex;
+	}
+
+	// An occluder which covers anything the mesh doesn't would hide visible objects, so it must stay inside of the mesh.
+	// The simplification is bounded by an error instead of going to a fixed triangle count at any cost, like the sloppy one
+	// does. Every vertex is then moved against its normal by the reported error, the distance of the simplified surface from
+	// the full one, which puts the surface behind the full one and shrinks its silhouette. Vertices are split on hard edges,
+	// so each face on a corner is offset along its own normal. The positions are clamped in the bounds of the mesh as well.
+	// Meshes which cannot get under the triangle limit within the error have no occluder, they are rarely good ones anyway
+	static void BuildOccluder(PrimitiveMeshData& primitiveMesh, const eastl::vector<uint32_t>& wholeMeshIndices, const eastl::vector<VertexLayout>& fullMeshVertices, float meshScale, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		const size_t targetIndexCount = 256 * 3;
+		const size_t maxIndexCount = 1024 * 3;
+		const float maxOccluderError = 0.02f;
+
+		eastl::vector<uint32_t> indices(wholeMeshIndices.size());
+		float error = 0.0f;
+		indices.resize(meshopt_simplify(
+			indices.data(),
+			wholeMeshIndices.data(),
+			wholeMeshIndices.size(),
+			reinterpret_cast<const float*>(fullMeshVertices.data()),
+			fullMeshVertices.size(),
+			sizeof(VertexLayout),
+			eastl::min(targetIndexCount, wholeMeshIndices.size()),
+			maxOccluderError,
+			0,
+			&error
+		));
+		if (indices.empty() || indices.size() > maxIndexCount)
+		{
+			return;
+		}
+
+		const float offset = error * meshScale;
+		eastl::unordered_map<uint32_t, uint32_t> vertexRemap;
+		eastl::vector<glm::vec3> positions;
+		for (uint32_t& index : indices)
+		{
+			auto[remapItr, inserted] = vertexRemap.insert(eastl::make_pair(index, uint32_t(positions.size())));
+			if (inserted)
 			{
-				for (uint32_t index = meshlet.triangle_offset; index < (meshlet.triangle_offset + meshlet.triangle_count * 3); ++index)
+				const VertexLayout& vertex = fullMeshVertices[index];
+				const float normalLength = glm::length(vertex.Normal);
+				// Without a normal there is no inside to move to
+				if (offset > 0.0f && normalLength < 1e-6f)
 				{
-					wholeMeshIndices.push_back(meshlet.vertex_offset + meshletIndices[index]);
+					return;
 				}
+				const glm::vec3 inward = normalLength > 0.0f ? -vertex.Normal / normalLength : glm::vec3(0.0f);
+				positions.push_back(glm::clamp(vertex.Position + inward * offset, boundsMin, boundsMax));
 			}
-
-			eastl::vector<uint32_t> simplifiedIndices(wholeMeshIndices.size());
-			const auto simplifiedIndicesCount = meshopt_simplifySloppy(
-				simplifiedIndices.data(),
-				wholeMeshIndices.data(),
-				wholeMeshIndices.size(),
-				reinterpret_cast<const float*>(vertices.data()),
-				vertices.size(),
-				sizeof(VertexLayout),
-				std::min(size_t(256), wholeMeshIndices.size()),
-				1.0,
-				nullptr
-			);
-			simplifiedIndices.resize(simplifiedIndicesCount);
-
-			primitiveMeshes[prim].Meshlets.swap(meshlets);
-            primitiveMeshes[prim].Vertices.swap(vertices);
-            primitiveMeshes[prim].MeshletIndices.swap(meshletIndices);
-            primitiveMeshes[prim].WholeMeshIndices.swap(wholeMeshIndices);
-            primitiveMeshes[prim].SimplyfiedMeshIndices.swap(simplifiedIndices);
-			primitiveMeshes[prim].MaterialIndex = m_Scene.MeshMaterialIndex(m_MeshIndex, prim);
+			index = remapItr->second;
 		}
 
-		m_CompiledData.swap(primitiveMeshes);
+		primitiveMesh.OccluderPositions.swap(positions);
+		primitiveMesh.OccluderIndices.swap(indices);
 	}
 
 	const Scene& m_Scene;
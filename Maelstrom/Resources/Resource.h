@@ -1,14 +1,53 @@
 #pragma once
 #include <EngineCore.h>
+#include <Resources/CompressedContainer.h>
+
+#include "CookCache.h"
+#include "CookProfiler.h"
+
+#include <fstream>
+#include <filesystem>
 
 struct CompilerOptions
 {
 	eastl::string InputFolder;
 	eastl::string OutputFolder;
+	// Compiled meshes and textures are kept here between the runs, empty disables the cache
+	eastl::string CacheFolder;
+	// Geometry and texture databases are written in compressed containers, which the runtime decompresses when loading them
+	bool CompressDatabases = true;
+	Tempest::CompressionCodec DatabaseCodec = Tempest::CompressionCodec::LZ4;
+	// All cooked assets in the output folder are packed together after the level is written
+	bool BuildAssetPack = true;
+	// Large textures are split in tiles which are encoded in parallel jobs, the output is the same as encoding them whole
+	bool TiledTextureEncoding = true;
+	// Encodes every texture whole as well and logs an error if the tiles differ from it
+	bool VerifyTiledTextureEncoding = false;
+	// Size of the grid cells the entities of the level are split in for streaming, zero keeps all of them in the level
+	float SectorSize = 64.0f;
 };
 
 CompilerOptions* gCompilerOptions = nullptr;
 
+// Writes the data in the output folder, compressed if asked and enabled in the options. Must be called from a job
+inline void WriteCompiledFile(const std::filesystem::path& filename, const eastl::vector<uint8_t>& data, bool compress)
+{
+	std::ofstream stream(filename, std::ios::binary);
+	if (!compress || !gCompilerOptions->CompressDatabases)
+	{
+		stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+		return;
+	}
+
+	eastl::vector<uint8_t> compressed = Tempest::CompressedContainer::Compress(Tempest::gEngineCore->GetJobSystem(), data.data(), data.size(), gCompilerOptions->DatabaseCodec);
+	stream.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+	FORMAT_LOG(Info, Maelstrom, "Compressed %s with %s from %.2f MB to %.2f MB",
+		filename.filename().string().c_str(),
+		Tempest::CompressedContainer::GetCodecName(gCompilerOptions->DatabaseCodec),
+		float(data.size()) / (1024.0f * 1024.0f),
+		float(compressed.size()) / (1024.0f * 1024.0f));
+}
+
 // This is needed to be able to cast to this and call Compile from a Job
 struct ResourceBase
 {
@@ -7,6 +7,7 @@
 #include "TextureDatabase.h"
 #include "EntitiesDatabase.h"
 #include "AudioDatabase.h"
+#include "LevelSectors.h"
 
 #include "../GLTFScene.h"
 
@@ -19,14 +20,13 @@ public:
     {
     }
 
-    eastl::string WriteFile(const char* extension, const eastl::vector<uint8_t>& data)
+    eastl::string WriteFile(const char* extension, const eastl::vector<uint8_t>& data, bool compress = false)
     {
         std::filesystem::path filename(gCompilerOptions->OutputFolder.c_str());
         filename /= GetName();
         filename.replace_extension(extension);
 
-        std::ofstream stream(filename, std::ios::binary);
-        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+        WriteCompiledFile(filename, data, compress);
 
         return eastl::string(filename.filename().string().c_str());
     }
@@ -95,18 +95,22 @@ public:
         auto jsonString = m_ECS.m_EntityWorld.to_json();
         ecsState.resize(jsonString.size());
         memcpy(ecsState.data(), jsonString.c_str(), jsonString.size());
+        LevelSectorsResource levelSectorsResource(ecsState, gCompilerOptions->SectorSize);
+        levelSectorsResource.Compile();
+        const LevelSectorsData& levelSectors = levelSectorsResource.GetCompiledData();
 
         // Now wait for the databases to finish
         Tempest::gEngineCore->GetJobSystem().WaitForCounter(&databaseCounter, 0);
 
         // We are ready with all dependenacies so we just write the data
-        auto geometryDatabaseName = WriteFile(Tempest::Definition::GeometryDatabaseExtension(), geometryDatabaseResource.GetCompiledData());
+        auto geometryDatabaseName = WriteFile(Tempest::Definition::GeometryDatabaseExtension(), geometryDatabaseResource.GetCompiledData(), true);
         auto audioDatabaseName = WriteFile(Tempest::Definition::AudioDatabaseExtension(), audioDatabaseResource.GetCompiledData());
-        auto textureDatabaseName = WriteFile(Tempest::Definition::TextureDatabaseExtension(), textureDatabaseResource.GetCompiledData());
+        auto textureDatabaseName = WriteFile(Tempest::Definition::TextureDatabaseExtension(), textureDatabaseResource.GetCompiledData(), true);
 
         flatbuffers::FlatBufferBuilder builder(1024 * 1024);
         auto nameOffset = builder.CreateString(/*m_Name.c_str()*/"");
-        auto entitiesOffset = builder.CreateVector<uint8_t>(ecsState.data(), ecsState.size());
+        auto entitiesOffset = builder.CreateVector<uint8_t>(levelSectors.GlobalEcsState.data(), levelSectors.GlobalEcsState.size());
+        auto sectorsOffset = WriteLevelSectors(builder, GetName(), levelSectors);
         auto physicsWorldOffset = 0;
         auto geometryDatabaseFileOffset = builder.CreateString(geometryDatabaseName.c_str());
         auto textureDatabaseFileOffset = builder.CreateString(textureDatabaseName.c_str());
@@ -119,7 +123,8 @@ public:
             geometryDatabaseFileOffset,
             textureDatabaseFileOffset,
             audioDatabaseFileOffset,
-            &m_Camera
+            &m_Camera,
+            sectorsOffset
         );
 
         Tempest::Definition::FinishLevelBuffer(builder, root);
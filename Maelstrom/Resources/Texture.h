@@ -11,6 +11,10 @@
 
 #include <DataDefinitions/TextureDatabase_generated.h>
 
+#include <EASTL/algorithm.h>
+
+#include <emmintrin.h>
+
 struct TextureRequest
 {
 	uint32_t SceneIndex;
@@ -19,15 +23,154 @@ struct TextureRequest
 	Tempest::Definition::TextureFormat TextureFormat;
 };
 
+struct TextureMipData
+{
+	uint32_t Offset;
+	uint32_t Size;
+};
+
 struct TextureCompiledData
 {
+	// All mips one after another, starting with the most detailed
 	eastl::vector<uint8_t> Data;
+	eastl::vector<TextureMipData> Mips;
 	Tempest::Definition::TextureData TextureInfo;
 };
 
+template<typename Archive>
+void SerializeCookData(Archive& archive, TextureCompiledData& texture)
+{
+	archive(texture.Data);
+	archive(texture.Mips);
+	archive(texture.TextureInfo);
+}
+
+// Swaps the red and blue channels of 8 bit pixels in place, so it converts RGBA to BGRA and back
+inline void SwizzleRedAndBlue(uint8_t* pixels, size_t pixelCount)
+{
+	// Green and alpha stay, red and blue swap places by rotating every pixel by 16 bits
+	const __m128i greenAlphaMask = _mm_set1_epi32(int(0xFF00FF00));
+	const __m128i redBlueMask = _mm_set1_epi32(0x00FF00FF);
+	size_t pixel = 0;
+	for (; pixel + 4 <= pixelCount; pixel += 4)
+	{
+		__m128i* address = reinterpret_cast<__m128i*>(pixels + pixel * 4);
+		const __m128i value = _mm_loadu_si128(address);
+		const __m128i rotated = _mm_or_si128(_mm_slli_epi32(value, 16), _mm_srli_epi32(value, 16));
+		_mm_storeu_si128(address, _mm_or_si128(_mm_and_si128(value, greenAlphaMask), _mm_and_si128(rotated, redBlueMask)));
+	}
+	for (; pixel < pixelCount; ++pixel)
+	{
+		eastl::swap(pixels[pixel * 4 + 0], pixels[pixel * 4 + 2]);
+	}
+}
+
+// 8 bit gamma values to 16 bit linear ones, and the nearest gamma value for a linear one
+struct GammaTables
+{
+	uint16_t ToLinear[256];
+
+	GammaTables()
+	{
+		for (uint32_t value = 0; value < 256; ++value)
+		{
+			ToLinear[value] = uint16_t(glm::round(glm::pow(float(value) / 255.0f, 2.2f) * 65535.0f));
+		}
+	}
+
+	uint8_t ToGamma(uint32_t linear) const
+	{
+		const uint16_t* upper = eastl::lower_bound(ToLinear, ToLinear + 256, linear);
+		if (upper == ToLinear + 256)
+		{
+			return 255;
+		}
+		if (upper == ToLinear || *upper - linear <= linear - *(upper - 1))
+		{
+			return uint8_t(upper - ToLinear);
+		}
+		return uint8_t(upper - ToLinear - 1);
+	}
+
+	static const GammaTables& Get()
+	{
+		static const GammaTables sTables;
+		return sTables;
+	}
+};
+
+// Box filters the 8 bit pixels to the next mip, half the size rounded down. Odd rows and columns are clamped at the edges.
+// Everything is integer math, so the mips are exactly the same no matter how they are computed. Color channels of sRGB
+// textures are filtered in linear space, alpha is always linear
+inline void DownsampleMip(const uint8_t* source, uint32_t sourceWidth, uint32_t sourceHeight, uint8_t* destination, bool isSRGB)
+{
+	const uint32_t width = glm::max(sourceWidth / 2, 1u);
+	const uint32_t height = glm::max(sourceHeight / 2, 1u);
+	const GammaTables& gamma = GammaTables::Get();
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		const uint8_t* row0 = source + size_t(glm::min(y * 2, sourceHeight - 1)) * sourceWidth * 4;
+		const uint8_t* row1 = source + size_t(glm::min(y * 2 + 1, sourceHeight - 1)) * sourceWidth * 4;
+		uint8_t* destinationRow = destination + size_t(y) * width * 4;
+
+		uint32_t x = 0;
+		if (!isSRGB)
+		{
+			// Four pixels at a time while all of their source pixels are in the row
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i rounding = _mm_set1_epi16(2);
+			for (; (x + 4) * 2 <= sourceWidth; x += 4)
+			{
+				const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+				const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+				const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+				const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+				// Every register has two source pixels in 16 bit channels, the columns of the same destination pixel
+				const __m128i columns0 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+				const __m128i columns1 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+				const __m128i columns2 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+				const __m128i columns3 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+				const __m128i sum0 = _mm_add_epi16(columns0, _mm_srli_si128(columns0, 8));
+				const __m128i sum1 = _mm_add_epi16(columns1, _mm_srli_si128(columns1, 8));
+				const __m128i sum2 = _mm_add_epi16(columns2, _mm_srli_si128(columns2, 8));
+				const __m128i sum3 = _mm_add_epi16(columns3, _mm_srli_si128(columns3, 8));
+
+				const __m128i average01 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sum0, sum1), rounding), 2);
+				const __m128i average23 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(sum2, sum3), rounding), 2);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destinationRow + x * 4), _mm_packus_epi16(average01, average23));
+			}
+		}
+
+		for (; x < width; ++x)
+		{
+			const uint32_t x0 = glm::min(x * 2, sourceWidth - 1) * 4;
+			const uint32_t x1 = glm::min(x * 2 + 1, sourceWidth - 1) * 4;
+			for (uint32_t channel = 0; channel < 4; ++channel)
+			{
+				if (isSRGB && channel != 3)
+				{
+					const uint32_t sum = gamma.ToLinear[row0[x0 + channel]] + gamma.ToLinear[row0[x1 + channel]] + gamma.ToLinear[row1[x0 + channel]] + gamma.ToLinear[row1[x1 + channel]];
+					destinationRow[x * 4 + channel] = gamma.ToGamma((sum + 2) >> 2);
+				}
+				else
+				{
+					const uint32_t sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel];
+					destinationRow[x * 4 + channel] = uint8_t((sum + 2) >> 2);
+				}
+			}
+		}
+	}
+}
+
 struct TextureResource : Resource<TextureCompiledData>
 {
 public:
+	// Bump when the compiled output changes, so the cached outputs of the old version are not used
+	static const uint32_t sCookVersion = 2;
+	// In pixels, a multiple of the block size of every format
+	static const uint32_t sTileSize = 256;
+
     TextureResource(const Scene& scene, const TextureRequest& textureRequest)
 		: m_Scene(scene)
 		, m_TextureRequest(textureRequest)
@@ -38,54 +181,210 @@ public:
 	void Compile() override
 	{
 		const cgltf_texture& texture = m_Scene.m_Data->textures[m_TextureRequest.TextureIndex];
+		const char* textureName = texture.name ? texture.name : texture.image->name;
+		// The tiles time themselves
+		CookResourceTimer resourceTimer("Texture", textureName ? textureName : "Unnamed", false);
 		const uint8_t* data = cgltf_buffer_view_data(texture.image->buffer_view);
 
-        int width, height, components;
-        uint8_t* decompressedImage = stbi_load_from_memory(data, int(texture.image->buffer_view->size), &width, &height, &components, 4);
+		// The same image is the same texture, no matter which scene it comes from
+		CookHasher hasher(sCookVersion);
+		hasher.AddBytes(data, texture.image->buffer_view->size);
+		hasher.Add(m_TextureRequest.ColorSpace);
+		hasher.Add(m_TextureRequest.TextureFormat);
+		const uint64_t cacheKey = hasher.GetHash();
+		if (gCookCache && gCookCache->Load(cacheKey, "texture", m_CompiledData))
+		{
+			return;
+		}
+
+		int width, height, components;
+		uint8_t* decompressedImage = stbi_load_from_memory(data, int(texture.image->buffer_view->size), &width, &height, &components, 4);
 
-		// Convert RGBA -> BGRA
-		for (size_t pixel = 0; pixel < (width * height); pixel++)
+		// Full chain down to 1x1, so the runtime can stream only the mips it needs. They are built before the encoding, so every mip
+		// can be split in tiles. nvtt takes BGRA, so the channels are swapped once here and every mip is built from that
+		eastl::vector<eastl::vector<uint8_t>> mipPixels;
+		eastl::vector<glm::uvec2> mipSizes;
 		{
-			eastl::swap(decompressedImage[pixel * 4 + 0], decompressedImage[pixel * 4 + 2]);
+			CookWorkTimer workTimer;
+			mipSizes.push_back(glm::uvec2(width, height));
+			mipPixels.emplace_back(decompressedImage, decompressedImage + size_t(width) * height * 4);
+			stbi_image_free(decompressedImage);
+			SwizzleRedAndBlue(mipPixels.back().data(), size_t(width) * height);
+
+			const bool isSRGB = m_TextureRequest.ColorSpace == Tempest::Definition::ColorSpace_sRGB;
+			while (mipSizes.back().x > 1 || mipSizes.back().y > 1)
+			{
+				const glm::uvec2 sourceSize = mipSizes.back();
+				const glm::uvec2 size = glm::max(sourceSize / 2u, glm::uvec2(1));
+				eastl::vector<uint8_t> pixels(size_t(size.x) * size.y * 4);
+				DownsampleMip(mipPixels.back().data(), sourceSize.x, sourceSize.y, pixels.data(), isSRGB);
+				mipSizes.push_back(size);
+				mipPixels.push_back(eastl::move(pixels));
+			}
 		}
 
-		nvtt::InputOptions inputOptions;
-		inputOptions.setTextureLayout(nvtt::TextureType_2D, width, height);
-		inputOptions.setMipmapData(decompressedImage, width, height);
-		inputOptions.setAlphaMode(nvtt::AlphaMode_None);
-		inputOptions.setMipmapGeneration(false);
+		// Blocks are encoded on their own, so tiles aligned to the blocks give exactly the same blocks as the whole mip.
+		// All tiles of all mips go in a single batch of jobs, so a big texture is spread over all workers
+		const uint32_t tileSize = gCompilerOptions->TiledTextureEncoding ? sTileSize : UINT32_MAX;
+		eastl::vector<TextureTile> tiles;
+		for (uint32_t mip = 0; mip < mipSizes.size(); ++mip)
+		{
+			for (uint32_t y = 0; y < mipSizes[mip].y; y += tileSize)
+			{
+				for (uint32_t x = 0; x < mipSizes[mip].x; x += tileSize)
+				{
+					TextureTile& tile = tiles.push_back();
+					tile.Pixels = mipPixels[mip].data();
+					tile.MipWidth = mipSizes[mip].x;
+					tile.Mip = mip;
+					tile.X = x;
+					tile.Y = y;
+					tile.Width = glm::min(tileSize, mipSizes[mip].x - x);
+					tile.Height = glm::min(tileSize, mipSizes[mip].y - y);
+					tile.Format = m_TextureRequest.TextureFormat;
+				}
+			}
+		}
+
+		eastl::vector<Tempest::Job::JobDecl> jobs(tiles.size());
+		for (uint32_t index = 0; index < tiles.size(); ++index)
+		{
+			jobs[index] = Tempest::Job::JobDecl{ EncodeTileJob, &tiles[index] };
+		}
+		Tempest::Job::Counter tilesCounter;
+		Tempest::gEngineCore->GetJobSystem().RunJobs("Encode Texture Tile", jobs.data(), uint32_t(jobs.size()), &tilesCounter);
+		Tempest::gEngineCore->GetJobSystem().WaitForCounter(&tilesCounter, 0);
+
+		// Tiles are copied in their place in the rows of blocks of their mips
+		{
+			CookWorkTimer workTimer;
+			const BlockLayout layout = GetBlockLayout(m_TextureRequest.TextureFormat);
+			for (uint32_t mip = 0; mip < mipSizes.size(); ++mip)
+			{
+				const uint32_t blocksX = (mipSizes[mip].x + layout.Dimension - 1) / layout.Dimension;
+				const uint32_t blocksY = (mipSizes[mip].y + layout.Dimension - 1) / layout.Dimension;
+				m_CompiledData.Mips.push_back(TextureMipData{ uint32_t(m_CompiledData.Data.size()), blocksX * blocksY * layout.Bytes });
+				m_CompiledData.Data.resize(m_CompiledData.Data.size() + size_t(blocksX) * blocksY * layout.Bytes);
+			}
+
+			for (const TextureTile& tile : tiles)
+			{
+				const uint32_t mipBlocksX = (mipSizes[tile.Mip].x + layout.Dimension - 1) / layout.Dimension;
+				const uint32_t tileBlocksX = (tile.Width + layout.Dimension - 1) / layout.Dimension;
+				const uint32_t tileBlocksY = (tile.Height + layout.Dimension - 1) / layout.Dimension;
+				assert(tile.Encoded.size() == size_t(tileBlocksX) * tileBlocksY * layout.Bytes);
+				uint8_t* mipData = m_CompiledData.Data.data() + m_CompiledData.Mips[tile.Mip].Offset;
+				for (uint32_t row = 0; row < tileBlocksY; ++row)
+				{
+					const size_t blockIndex = size_t(tile.Y / layout.Dimension + row) * mipBlocksX + tile.X / layout.Dimension;
+					memcpy(mipData + blockIndex * layout.Bytes, tile.Encoded.data() + size_t(row) * tileBlocksX * layout.Bytes, tileBlocksX * layout.Bytes);
+				}
+			}
+		}
+
+		if (gCompilerOptions->VerifyTiledTextureEncoding && gCompilerOptions->TiledTextureEncoding)
+		{
+			VerifyTiles(textureName ? textureName : "Unnamed", mipPixels, mipSizes);
+		}
 
-		stbi_image_free(decompressedImage);
+		m_CompiledData.TextureInfo = Tempest::Definition::TextureData(
+			width,
+			height,
+			m_TextureRequest.TextureFormat,
+			m_TextureRequest.ColorSpace
+		);
 
-		switch (m_TextureRequest.ColorSpace)
+		if (gCookCache)
 		{
-		case Tempest::Definition::ColorSpace_Linear:
-			inputOptions.setGamma(1.0f, 1.0f);
-			break;
-		case Tempest::Definition::ColorSpace_sRGB:
-			inputOptions.setGamma(2.2f, 2.2f);
-			break;
+			gCookCache->Store(cacheKey, "texture", m_CompiledData);
+		}
+	}
+
+private:
+	struct BlockLayout
+	{
+		// Pixels on each side of a block
+		uint32_t Dimension;
+		uint32_t Bytes;
+	};
+
+	// Part of a mip which is encoded by a job of its own
+	struct TextureTile
+	{
+		// BGRA pixels of the whole mip
+		const uint8_t* Pixels;
+		uint32_t MipWidth;
+		uint32_t Mip;
+		uint32_t X;
+		uint32_t Y;
+		uint32_t Width;
+		uint32_t Height;
+		Tempest::Definition::TextureFormat Format;
+		// Blocks of the tile row after row
+		eastl::vector<uint8_t> Encoded;
+	};
+
+	static BlockLayout GetBlockLayout(Tempest::Definition::TextureFormat format)
+	{
+		switch (format)
+		{
+		case Tempest::Definition::TextureFormat_BC1_RGB:
+			return BlockLayout{ 4, 8 };
+		case Tempest::Definition::TextureFormat_BC7_RGBA:
+			return BlockLayout{ 4, 16 };
 		default:
-			assert(false);
-			break;
+			// Uncompressed pixels are blocks of a single pixel
+			return BlockLayout{ 1, 4 };
 		}
+	}
+
+	static void EncodeTileJob(uint32_t, void* data)
+	{
+		CookWorkTimer workTimer;
+		EncodeTile(*reinterpret_cast<TextureTile*>(data));
+	}
+
+	static void EncodeTile(TextureTile& tile)
+	{
+		eastl::vector<uint8_t> pixels(size_t(tile.Width) * tile.Height * 4);
+		for (uint32_t row = 0; row < tile.Height; ++row)
+		{
+			memcpy(pixels.data() + size_t(row) * tile.Width * 4, tile.Pixels + (size_t(tile.Y + row) * tile.MipWidth + tile.X) * 4, size_t(tile.Width) * 4);
+		}
+
+		if (tile.Format == Tempest::Definition::TextureFormat_RGBA8)
+		{
+			SwizzleRedAndBlue(pixels.data(), size_t(tile.Width) * tile.Height);
+			tile.Encoded.swap(pixels);
+			return;
+		}
+
+		// The pixels are final, so there is no gamma conversion and no mips
+		nvtt::InputOptions inputOptions;
+		inputOptions.setTextureLayout(nvtt::TextureType_2D, tile.Width, tile.Height);
+		inputOptions.setMipmapData(pixels.data(), tile.Width, tile.Height);
+		inputOptions.setMipmapGeneration(false);
+		inputOptions.setGamma(1.0f, 1.0f);
+		inputOptions.setAlphaMode(tile.Format == Tempest::Definition::TextureFormat_BC7_RGBA ? nvtt::AlphaMode_Transparency : nvtt::AlphaMode_None);
 
 		struct OutputHandler : public nvtt::OutputHandler
 		{
-			TextureResource& m_Texture;
+			eastl::vector<uint8_t>& m_Encoded;
 
-			OutputHandler(TextureResource& texture)
-				: m_Texture(texture)
+			OutputHandler(eastl::vector<uint8_t>& encoded)
+				: m_Encoded(encoded)
 			{}
 
 			void beginImage(int size, int width, int height, int depth, int face, int miplevel)
 			{
-				m_Texture.m_CompiledData.Data.resize(size);
+				m_Encoded.reserve(size);
 			}
 
 			bool writeData(const void* data, int size) override
 			{
-				memcpy(m_Texture.m_CompiledData.Data.data(), data, size);
+				// Data for a single image could come in multiple calls
+				const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+				m_Encoded.insert(m_Encoded.end(), bytes, bytes + size);
 
 				return true;
 			}
@@ -93,27 +392,35 @@ public:
 			void endImage() override
 			{
 			}
-		} handler(*this);
+		} handler(tile.Encoded);
 
 		nvtt::OutputOptions outOptions;
 		outOptions.setOutputHandler(&handler);
 		outOptions.setOutputHeader(false);
 
 		nvtt::CompressionOptions compressionOptions;
-		compressionOptions.setFormat(nvtt::Format_BC1); // TODO: Support other
+		compressionOptions.setFormat(tile.Format == Tempest::Definition::TextureFormat_BC7_RGBA ? nvtt::Format_BC7 : nvtt::Format_BC1);
 
 		nvtt::Compressor compressor;
 		compressor.process(inputOptions, compressionOptions, outOptions);
+	}
 
-		m_CompiledData.TextureInfo = Tempest::Definition::TextureData(
-			width,
-			height,
-			m_TextureRequest.TextureFormat,
-			m_TextureRequest.ColorSpace
-		);
+	// Encodes every mip whole in this job and compares it with the tiles
+	void VerifyTiles(const char* textureName, const eastl::vector<eastl::vector<uint8_t>>& mipPixels, const eastl::vector<glm::uvec2>& mipSizes) const
+	{
+		for (uint32_t mip = 0; mip < mipSizes.size(); ++mip)
+		{
+			TextureTile wholeMip{ mipPixels[mip].data(), mipSizes[mip].x, mip, 0, 0, mipSizes[mip].x, mipSizes[mip].y, m_TextureRequest.TextureFormat };
+			EncodeTile(wholeMip);
+
+			const TextureMipData& tiledMip = m_CompiledData.Mips[mip];
+			if (wholeMip.Encoded.size() != tiledMip.Size || memcmp(wholeMip.Encoded.data(), m_CompiledData.Data.data() + tiledMip.Offset, tiledMip.Size) != 0)
+			{
+				FORMAT_LOG(Error, Maelstrom, "Tiled encoding of texture %s differs from the whole mip %u", textureName, mip);
+			}
+		}
 	}
 
-private:
     const Scene& m_Scene;
     const TextureRequest& m_TextureRequest;
 };
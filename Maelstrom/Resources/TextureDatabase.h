@@ -17,6 +17,8 @@ public:
 
 	void Compile() override
 	{
+		// Only the assembly after the textures are compiled is work of its own
+		CookResourceTimer resourceTimer("Texture database", "", false);
 		eastl::vector<TextureResource> textures;
 		textures.reserve(m_TextureRequests.size());
 		for (const TextureRequest& request : m_TextureRequests)
@@ -31,9 +33,12 @@ public:
 		CompileResourceArray(eastl::span(textures), texturesCounter);
 
 		Tempest::gEngineCore->GetJobSystem().WaitForCounter(&texturesCounter, 0);
+		CookWorkTimer workTimer;
 
 		eastl::vector<uint8_t> textureDataBuffer;
 		eastl::vector<Tempest::Definition::TextureMapping> mappings;
+		eastl::vector<Tempest::Definition::TextureMipRange> mipRanges;
+		eastl::vector<Tempest::Definition::TextureMip> mips;
 		size_t sizeToReserve = 0;
 		for (const auto& texture : textures)
 		{
@@ -42,6 +47,7 @@ public:
 
 		textureDataBuffer.reserve(sizeToReserve);
 		mappings.reserve(textures.size());
+		mipRanges.reserve(textures.size());
 
 		for (uint32_t index = 0; index < textures.size(); ++index)
 		{
@@ -53,13 +59,21 @@ public:
 				textureData.TextureInfo
 			);
 
+			mipRanges.emplace_back(uint32_t(mips.size()), uint32_t(textureData.Mips.size()));
+			for (const TextureMipData& mip : textureData.Mips)
+			{
+				mips.emplace_back(uint32_t(textureDataBuffer.size()) + mip.Offset, mip.Size);
+			}
+
 			textureDataBuffer.insert(textureDataBuffer.end(), textureData.Data.begin(), textureData.Data.end());
 		}
 
 		flatbuffers::FlatBufferBuilder builder(1024 * 1024);
 		auto dataOffset = builder.CreateVector<uint8_t>(textureDataBuffer.data(), textureDataBuffer.size());
 		auto mappingOffset = builder.CreateVectorOfSortedStructs<Tempest::Definition::TextureMapping>(mappings.data(), mappings.size());
-		auto root = Tempest::Definition::CreateTextureDatabase(builder, dataOffset, mappingOffset);
+		auto mipRangesOffset = builder.CreateVectorOfStructs<Tempest::Definition::TextureMipRange>(mipRanges.data(), mipRanges.size());
+		auto mipsOffset = builder.CreateVectorOfStructs<Tempest::Definition::TextureMip>(mips.data(), mips.size());
+		auto root = Tempest::Definition::CreateTextureDatabase(builder, dataOffset, mappingOffset, mipRangesOffset, mipsOffset);
 		Tempest::Definition::FinishTextureDatabaseBuffer(builder, root);
 
 		m_CompiledData.resize(builder.GetSize());
@@ -16,6 +16,11 @@ int main()
 	options.Height = 720;
 	// Make real resource folder
 	options.ResourceFolder = "../../Tempest/Shaders/";
+	//options.MemoryMapResources = false;
+	//options.UseOverlappedIO = false;
+	//options.UseAssetPack = false;
+	//options.ResourceMemoryBudget = 512ull * 1024 * 1024;
+	//options.ReleaseAssetsAfterUpload = false;
 
 	Tempest::GameOptions gameOptions;
 	//gameOptions.LevelToLoad = "Level_village.tlb";
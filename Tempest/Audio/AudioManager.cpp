@@ -159,14 +159,14 @@ void AudioManager::Update()
 
 void AudioManager::LoadDatabase(const char* databaseName)
 {
-	const Definition::AudioDatabase* audioDatabase = gEngine->GetResourceLoader().LoadResource<Definition::AudioDatabase>(databaseName);
+	AssetHandle<Definition::AudioDatabase> audioDatabase = gEngine->GetResourceLoader().LoadResource<Definition::AudioDatabase>(databaseName);
 	if (!audioDatabase)
 	{
 		LOG(Warning, Renderer, "Audio Database is Invalid!");
 		return;
 	}
 
-	m_Database = audioDatabase;
+	m_Database = eastl::move(audioDatabase);
 
 	// TODO: Add temp memory or some kind of managed memory
 	int vorbisError = 0;
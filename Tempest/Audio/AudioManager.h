@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
 
+#include <Resources/ResourceLoader.h>
+
 struct IAudioClient;
 struct IAudioRenderClient;
 struct stb_vorbis;
@@ -27,7 +29,8 @@ private:
 
 	//uint32_t m_SampleCount;
 
-	const Definition::AudioDatabase* m_Database;
+	// Music is decoded from it while it plays
+	AssetHandle<Definition::AudioDatabase> m_Database;
 	// Background music
 	stb_vorbis* m_VorbisDecoder;
 };
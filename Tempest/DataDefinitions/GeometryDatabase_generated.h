@@ -21,6 +21,12 @@ struct Meshlet;
 
 struct Material;
 
+struct MeshLod;
+
+struct PrimitiveMeshLods;
+
+struct OccluderData;
+
 struct GeometryDatabase;
 struct GeometryDatabaseBuilder;
 
@@ -181,6 +187,105 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Material FLATBUFFERS_FINAL_CLASS {
 };
 FLATBUFFERS_STRUCT_END(Material, 32);
 
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) MeshLod FLATBUFFERS_FINAL_CLASS {
+ private:
+  uint32_t meshlets_offset_;
+  uint32_t meshlets_count_;
+  uint32_t triangle_count_;
+  float error_;
+
+ public:
+  MeshLod()
+      : meshlets_offset_(0),
+        meshlets_count_(0),
+        triangle_count_(0),
+        error_(0) {
+  }
+  MeshLod(uint32_t _meshlets_offset, uint32_t _meshlets_count, uint32_t _triangle_count, float _error)
+      : meshlets_offset_(flatbuffers::EndianScalar(_meshlets_offset)),
+        meshlets_count_(flatbuffers::EndianScalar(_meshlets_count)),
+        triangle_count_(flatbuffers::EndianScalar(_triangle_count)),
+        error_(flatbuffers::EndianScalar(_error)) {
+  }
+  uint32_t meshlets_offset() const {
+    return flatbuffers::EndianScalar(meshlets_offset_);
+  }
+  uint32_t meshlets_count() const {
+    return flatbuffers::EndianScalar(meshlets_count_);
+  }
+  uint32_t triangle_count() const {
+    return flatbuffers::EndianScalar(triangle_count_);
+  }
+  float error() const {
+    return flatbuffers::EndianScalar(error_);
+  }
+};
+FLATBUFFERS_STRUCT_END(MeshLod, 16);
+
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) PrimitiveMeshLods FLATBUFFERS_FINAL_CLASS {
+ private:
+  uint32_t lod_offset_;
+  uint32_t lod_count_;
+
+ public:
+  PrimitiveMeshLods()
+      : lod_offset_(0),
+        lod_count_(0) {
+  }
+  PrimitiveMeshLods(uint32_t _lod_offset, uint32_t _lod_count)
+      : lod_offset_(flatbuffers::EndianScalar(_lod_offset)),
+        lod_count_(flatbuffers::EndianScalar(_lod_count)) {
+  }
+  uint32_t lod_offset() const {
+    return flatbuffers::EndianScalar(lod_offset_);
+  }
+  uint32_t lod_count() const {
+    return flatbuffers::EndianScalar(lod_count_);
+  }
+};
+FLATBUFFERS_STRUCT_END(PrimitiveMeshLods, 8);
+
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) OccluderData FLATBUFFERS_FINAL_CLASS {
+ private:
+  uint32_t vertex_offset_;
+  uint32_t index_offset_;
+  uint32_t index_count_;
+  Common::Tempest::Vec3 bounds_min_;
+  Common::Tempest::Vec3 bounds_max_;
+
+ public:
+  OccluderData()
+      : vertex_offset_(0),
+        index_offset_(0),
+        index_count_(0),
+        bounds_min_(),
+        bounds_max_() {
+  }
+  OccluderData(uint32_t _vertex_offset, uint32_t _index_offset, uint32_t _index_count, const Common::Tempest::Vec3 &_bounds_min, const Common::Tempest::Vec3 &_bounds_max)
+      : vertex_offset_(flatbuffers::EndianScalar(_vertex_offset)),
+        index_offset_(flatbuffers::EndianScalar(_index_offset)),
+        index_count_(flatbuffers::EndianScalar(_index_count)),
+        bounds_min_(_bounds_min),
+        bounds_max_(_bounds_max) {
+  }
+  uint32_t vertex_offset() const {
+    return flatbuffers::EndianScalar(vertex_offset_);
+  }
+  uint32_t index_offset() const {
+    return flatbuffers::EndianScalar(index_offset_);
+  }
+  uint32_t index_count() const {
+    return flatbuffers::EndianScalar(index_count_);
+  }
+  const Common::Tempest::Vec3 &bounds_min() const {
+    return bounds_min_;
+  }
+  const Common::Tempest::Vec3 &bounds_max() const {
+    return bounds_max_;
+  }
+};
+FLATBUFFERS_STRUCT_END(OccluderData, 36);
+
 struct GeometryDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef GeometryDatabaseBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
@@ -189,7 +294,13 @@ struct GeometryDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_MESHLET_BUFFER = 8,
     VT_PRIMITIVE_MESHES = 10,
     VT_MATERIALS = 12,
-    VT_MAPPINGS = 14
+    VT_MAPPINGS = 14,
+    VT_OCCLUDERS = 16,
+    VT_OCCLUDER_VERTICES = 18,
+    VT_OCCLUDER_INDICES = 20,
+    VT_PRIMITIVE_LODS = 22,
+    VT_LODS = 24,
+    VT_PRIMITIVE_UV_DENSITIES = 26
   };
   const flatbuffers::Vector<uint8_t> *vertex_buffer() const {
     return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_VERTEX_BUFFER);
@@ -209,6 +320,24 @@ struct GeometryDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::Vector<const Tempest::Definition::MeshMapping *> *mappings() const {
     return GetPointer<const flatbuffers::Vector<const Tempest::Definition::MeshMapping *> *>(VT_MAPPINGS);
   }
+  const flatbuffers::Vector<const Tempest::Definition::OccluderData *> *occluders() const {
+    return GetPointer<const flatbuffers::Vector<const Tempest::Definition::OccluderData *> *>(VT_OCCLUDERS);
+  }
+  const flatbuffers::Vector<const Common::Tempest::Vec3 *> *occluder_vertices() const {
+    return GetPointer<const flatbuffers::Vector<const Common::Tempest::Vec3 *> *>(VT_OCCLUDER_VERTICES);
+  }
+  const flatbuffers::Vector<uint32_t> *occluder_indices() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_OCCLUDER_INDICES);
+  }
+  const flatbuffers::Vector<const Tempest::Definition::PrimitiveMeshLods *> *primitive_lods() const {
+    return GetPointer<const flatbuffers::Vector<const Tempest::Definition::PrimitiveMeshLods *> *>(VT_PRIMITIVE_LODS);
+  }
+  const flatbuffers::Vector<const Tempest::Definition::MeshLod *> *lods() const {
+    return GetPointer<const flatbuffers::Vector<const Tempest::Definition::MeshLod *> *>(VT_LODS);
+  }
+  const flatbuffers::Vector<float> *primitive_uv_densities() const {
+    return GetPointer<const flatbuffers::Vector<float> *>(VT_PRIMITIVE_UV_DENSITIES);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_VERTEX_BUFFER) &&
@@ -223,6 +352,18 @@ struct GeometryDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            verifier.VerifyVector(materials()) &&
            VerifyOffset(verifier, VT_MAPPINGS) &&
            verifier.VerifyVector(mappings()) &&
+           VerifyOffset(verifier, VT_OCCLUDERS) &&
+           verifier.VerifyVector(occluders()) &&
+           VerifyOffset(verifier, VT_OCCLUDER_VERTICES) &&
+           verifier.VerifyVector(occluder_vertices()) &&
+           VerifyOffset(verifier, VT_OCCLUDER_INDICES) &&
+           verifier.VerifyVector(occluder_indices()) &&
+           VerifyOffset(verifier, VT_PRIMITIVE_LODS) &&
+           verifier.VerifyVector(primitive_lods()) &&
+           VerifyOffset(verifier, VT_LODS) &&
+           verifier.VerifyVector(lods()) &&
+           VerifyOffset(verifier, VT_PRIMITIVE_UV_DENSITIES) &&
+           verifier.VerifyVector(primitive_uv_densities()) &&
            verifier.EndTable();
   }
 };
@@ -249,6 +390,24 @@ struct GeometryDatabaseBuilder {
   void add_mappings(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::MeshMapping *>> mappings) {
     fbb_.AddOffset(GeometryDatabase::VT_MAPPINGS, mappings);
   }
+  void add_occluders(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::OccluderData *>> occluders) {
+    fbb_.AddOffset(GeometryDatabase::VT_OCCLUDERS, occluders);
+  }
+  void add_occluder_vertices(flatbuffers::Offset<flatbuffers::Vector<const Common::Tempest::Vec3 *>> occluder_vertices) {
+    fbb_.AddOffset(GeometryDatabase::VT_OCCLUDER_VERTICES, occluder_vertices);
+  }
+  void add_occluder_indices(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> occluder_indices) {
+    fbb_.AddOffset(GeometryDatabase::VT_OCCLUDER_INDICES, occluder_indices);
+  }
+  void add_primitive_lods(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::PrimitiveMeshLods *>> primitive_lods) {
+    fbb_.AddOffset(GeometryDatabase::VT_PRIMITIVE_LODS, primitive_lods);
+  }
+  void add_lods(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::MeshLod *>> lods) {
+    fbb_.AddOffset(GeometryDatabase::VT_LODS, lods);
+  }
+  void add_primitive_uv_densities(flatbuffers::Offset<flatbuffers::Vector<float>> primitive_uv_densities) {
+    fbb_.AddOffset(GeometryDatabase::VT_PRIMITIVE_UV_DENSITIES, primitive_uv_densities);
+  }
   explicit GeometryDatabaseBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -267,8 +426,20 @@ inline flatbuffers::Offset<GeometryDatabase> CreateGeometryDatabase(
     flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::Meshlet *>> meshlet_buffer = 0,
     flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::PrimitiveMeshData *>> primitive_meshes = 0,
     flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::Material *>> materials = 0,
-    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::MeshMapping *>> mappings = 0) {
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::MeshMapping *>> mappings = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::OccluderData *>> occluders = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Common::Tempest::Vec3 *>> occluder_vertices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> occluder_indices = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::PrimitiveMeshLods *>> primitive_lods = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::MeshLod *>> lods = 0,
+    flatbuffers::Offset<flatbuffers::Vector<float>> primitive_uv_densities = 0) {
   GeometryDatabaseBuilder builder_(_fbb);
+  builder_.add_primitive_uv_densities(primitive_uv_densities);
+  builder_.add_lods(lods);
+  builder_.add_primitive_lods(primitive_lods);
+  builder_.add_occluder_indices(occluder_indices);
+  builder_.add_occluder_vertices(occluder_vertices);
+  builder_.add_occluders(occluders);
   builder_.add_mappings(mappings);
   builder_.add_materials(materials);
   builder_.add_primitive_meshes(primitive_meshes);
@@ -285,13 +456,25 @@ inline flatbuffers::Offset<GeometryDatabase> CreateGeometryDatabaseDirect(
     const std::vector<Tempest::Definition::Meshlet> *meshlet_buffer = nullptr,
     const std::vector<Tempest::Definition::PrimitiveMeshData> *primitive_meshes = nullptr,
     const std::vector<Tempest::Definition::Material> *materials = nullptr,
-    std::vector<Tempest::Definition::MeshMapping> *mappings = nullptr) {
+    std::vector<Tempest::Definition::MeshMapping> *mappings = nullptr,
+    const std::vector<Tempest::Definition::OccluderData> *occluders = nullptr,
+    const std::vector<Common::Tempest::Vec3> *occluder_vertices = nullptr,
+    const std::vector<uint32_t> *occluder_indices = nullptr,
+    const std::vector<Tempest::Definition::PrimitiveMeshLods> *primitive_lods = nullptr,
+    const std::vector<Tempest::Definition::MeshLod> *lods = nullptr,
+    const std::vector<float> *primitive_uv_densities = nullptr) {
   auto vertex_buffer__ = vertex_buffer ? _fbb.CreateVector<uint8_t>(*vertex_buffer) : 0;
   auto meshlet_indices_buffer__ = meshlet_indices_buffer ? _fbb.CreateVector<uint8_t>(*meshlet_indices_buffer) : 0;
   auto meshlet_buffer__ = meshlet_buffer ? _fbb.CreateVectorOfStructs<Tempest::Definition::Meshlet>(*meshlet_buffer) : 0;
   auto primitive_meshes__ = primitive_meshes ? _fbb.CreateVectorOfStructs<Tempest::Definition::PrimitiveMeshData>(*primitive_meshes) : 0;
   auto materials__ = materials ? _fbb.CreateVectorOfStructs<Tempest::Definition::Material>(*materials) : 0;
   auto mappings__ = mappings ? _fbb.CreateVectorOfSortedStructs<Tempest::Definition::MeshMapping>(mappings) : 0;
+  auto occluders__ = occluders ? _fbb.CreateVectorOfStructs<Tempest::Definition::OccluderData>(*occluders) : 0;
+  auto occluder_vertices__ = occluder_vertices ? _fbb.CreateVectorOfStructs<Common::Tempest::Vec3>(*occluder_vertices) : 0;
+  auto occluder_indices__ = occluder_indices ? _fbb.CreateVector<uint32_t>(*occluder_indices) : 0;
+  auto primitive_lods__ = primitive_lods ? _fbb.CreateVectorOfStructs<Tempest::Definition::PrimitiveMeshLods>(*primitive_lods) : 0;
+  auto lods__ = lods ? _fbb.CreateVectorOfStructs<Tempest::Definition::MeshLod>(*lods) : 0;
+  auto primitive_uv_densities__ = primitive_uv_densities ? _fbb.CreateVector<float>(*primitive_uv_densities) : 0;
   return Tempest::Definition::CreateGeometryDatabase(
       _fbb,
       vertex_buffer__,
@@ -299,7 +482,13 @@ inline flatbuffers::Offset<GeometryDatabase> CreateGeometryDatabaseDirect(
       meshlet_buffer__,
       primitive_meshes__,
       materials__,
-      mappings__);
+      mappings__,
+      occluders__,
+      occluder_vertices__,
+      occluder_indices__,
+      primitive_lods__,
+      lods__,
+      primitive_uv_densities__);
 }
 
 inline const Tempest::Definition::GeometryDatabase *GetGeometryDatabase(const void *buf) {
@@ -13,6 +13,9 @@ namespace Definition {
 
 struct Camera;
 
+struct LevelSector;
+struct LevelSectorBuilder;
+
 struct Level;
 struct LevelBuilder;
 
@@ -69,6 +72,81 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) Camera FLATBUFFERS_FINAL_CLASS {
 };
 FLATBUFFERS_STRUCT_END(Camera, 52);
 
+struct LevelSector FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef LevelSectorBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_BOUNDS_MIN = 4,
+    VT_BOUNDS_MAX = 6,
+    VT_FILE = 8
+  };
+  const Common::Tempest::Vec3 *bounds_min() const {
+    return GetStruct<const Common::Tempest::Vec3 *>(VT_BOUNDS_MIN);
+  }
+  const Common::Tempest::Vec3 *bounds_max() const {
+    return GetStruct<const Common::Tempest::Vec3 *>(VT_BOUNDS_MAX);
+  }
+  const flatbuffers::String *file() const {
+    return GetPointer<const flatbuffers::String *>(VT_FILE);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<Common::Tempest::Vec3>(verifier, VT_BOUNDS_MIN, 4) &&
+           VerifyField<Common::Tempest::Vec3>(verifier, VT_BOUNDS_MAX, 4) &&
+           VerifyOffset(verifier, VT_FILE) &&
+           verifier.VerifyString(file()) &&
+           verifier.EndTable();
+  }
+};
+
+struct LevelSectorBuilder {
+  typedef LevelSector Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_bounds_min(const Common::Tempest::Vec3 *bounds_min) {
+    fbb_.AddStruct(LevelSector::VT_BOUNDS_MIN, bounds_min);
+  }
+  void add_bounds_max(const Common::Tempest::Vec3 *bounds_max) {
+    fbb_.AddStruct(LevelSector::VT_BOUNDS_MAX, bounds_max);
+  }
+  void add_file(flatbuffers::Offset<flatbuffers::String> file) {
+    fbb_.AddOffset(LevelSector::VT_FILE, file);
+  }
+  explicit LevelSectorBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  flatbuffers::Offset<LevelSector> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<LevelSector>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<LevelSector> CreateLevelSector(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const Common::Tempest::Vec3 *bounds_min = 0,
+    const Common::Tempest::Vec3 *bounds_max = 0,
+    flatbuffers::Offset<flatbuffers::String> file = 0) {
+  LevelSectorBuilder builder_(_fbb);
+  builder_.add_file(file);
+  builder_.add_bounds_max(bounds_max);
+  builder_.add_bounds_min(bounds_min);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<LevelSector> CreateLevelSectorDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const Common::Tempest::Vec3 *bounds_min = 0,
+    const Common::Tempest::Vec3 *bounds_max = 0,
+    const char *file = nullptr) {
+  auto file__ = file ? _fbb.CreateString(file) : 0;
+  return Tempest::Definition::CreateLevelSector(
+      _fbb,
+      bounds_min,
+      bounds_max,
+      file__);
+}
+
 struct Level FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef LevelBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
@@ -78,7 +156,8 @@ struct Level FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_GEOMETRY_DATABASE_FILE = 10,
     VT_TEXTURE_DATABASE_FILE = 12,
     VT_AUDIO_DATABASE_FILE = 14,
-    VT_CAMERA = 16
+    VT_CAMERA = 16,
+    VT_SECTORS = 18
   };
   const flatbuffers::String *name() const {
     return GetPointer<const flatbuffers::String *>(VT_NAME);
@@ -101,6 +180,9 @@ struct Level FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const Tempest::Definition::Camera *camera() const {
     return GetStruct<const Tempest::Definition::Camera *>(VT_CAMERA);
   }
+  const flatbuffers::Vector<flatbuffers::Offset<Tempest::Definition::LevelSector>> *sectors() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Tempest::Definition::LevelSector>> *>(VT_SECTORS);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_NAME) &&
@@ -116,6 +198,9 @@ struct Level FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_AUDIO_DATABASE_FILE) &&
            verifier.VerifyString(audio_database_file()) &&
            VerifyField<Tempest::Definition::Camera>(verifier, VT_CAMERA, 4) &&
+           VerifyOffset(verifier, VT_SECTORS) &&
+           verifier.VerifyVector(sectors()) &&
+           verifier.VerifyVectorOfTables(sectors()) &&
            verifier.EndTable();
   }
 };
@@ -145,6 +230,9 @@ struct LevelBuilder {
   void add_camera(const Tempest::Definition::Camera *camera) {
     fbb_.AddStruct(Level::VT_CAMERA, camera);
   }
+  void add_sectors(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Tempest::Definition::LevelSector>>> sectors) {
+    fbb_.AddOffset(Level::VT_SECTORS, sectors);
+  }
   explicit LevelBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -164,8 +252,10 @@ inline flatbuffers::Offset<Level> CreateLevel(
     flatbuffers::Offset<flatbuffers::String> geometry_database_file = 0,
     flatbuffers::Offset<flatbuffers::String> texture_database_file = 0,
     flatbuffers::Offset<flatbuffers::String> audio_database_file = 0,
-    const Tempest::Definition::Camera *camera = 0) {
+    const Tempest::Definition::Camera *camera = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Tempest::Definition::LevelSector>>> sectors = 0) {
   LevelBuilder builder_(_fbb);
+  builder_.add_sectors(sectors);
   builder_.add_camera(camera);
   builder_.add_audio_database_file(audio_database_file);
   builder_.add_texture_database_file(texture_database_file);
@@ -184,13 +274,15 @@ inline flatbuffers::Offset<Level> CreateLevelDirect(
     const char *geometry_database_file = nullptr,
     const char *texture_database_file = nullptr,
     const char *audio_database_file = nullptr,
-    const Tempest::Definition::Camera *camera = 0) {
+    const Tempest::Definition::Camera *camera = 0,
+    const std::vector<flatbuffers::Offset<Tempest::Definition::LevelSector>> *sectors = nullptr) {
   auto name__ = name ? _fbb.CreateString(name) : 0;
   auto entities__ = entities ? _fbb.CreateVector<uint8_t>(*entities) : 0;
   auto physics_world__ = physics_world ? _fbb.CreateVector<uint8_t>(*physics_world) : 0;
   auto geometry_database_file__ = geometry_database_file ? _fbb.CreateString(geometry_database_file) : 0;
   auto texture_database_file__ = texture_database_file ? _fbb.CreateString(texture_database_file) : 0;
   auto audio_database_file__ = audio_database_file ? _fbb.CreateString(audio_database_file) : 0;
+  auto sectors__ = sectors ? _fbb.CreateVector<flatbuffers::Offset<Tempest::Definition::LevelSector>>(*sectors) : 0;
   return Tempest::Definition::CreateLevel(
       _fbb,
       name__,
@@ -199,7 +291,8 @@ inline flatbuffers::Offset<Level> CreateLevelDirect(
       geometry_database_file__,
       texture_database_file__,
       audio_database_file__,
-      camera);
+      camera,
+      sectors__);
 }
 
 inline const Tempest::Definition::Level *GetLevel(const void *buf) {
@@ -0,0 +1,127 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+
+#ifndef FLATBUFFERS_GENERATED_SECTOR_TEMPEST_DEFINITION_H_
+#define FLATBUFFERS_GENERATED_SECTOR_TEMPEST_DEFINITION_H_
+
+#include "flatbuffers/flatbuffers.h"
+
+namespace Tempest {
+namespace Definition {
+
+struct Sector;
+struct SectorBuilder;
+
+struct Sector FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef SectorBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_ENTITIES = 4,
+    VT_ENTITY_NAMES = 6
+  };
+  const flatbuffers::Vector<uint8_t> *entities() const {
+    return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_ENTITIES);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *entity_names() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(VT_ENTITY_NAMES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_ENTITIES) &&
+           verifier.VerifyVector(entities()) &&
+           VerifyOffset(verifier, VT_ENTITY_NAMES) &&
+           verifier.VerifyVector(entity_names()) &&
+           verifier.VerifyVectorOfStrings(entity_names()) &&
+           verifier.EndTable();
+  }
+};
+
+struct SectorBuilder {
+  typedef Sector Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_entities(flatbuffers::Offset<flatbuffers::Vector<uint8_t>> entities) {
+    fbb_.AddOffset(Sector::VT_ENTITIES, entities);
+  }
+  void add_entity_names(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> entity_names) {
+    fbb_.AddOffset(Sector::VT_ENTITY_NAMES, entity_names);
+  }
+  explicit SectorBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  flatbuffers::Offset<Sector> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Sector>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Sector> CreateSector(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<uint8_t>> entities = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> entity_names = 0) {
+  SectorBuilder builder_(_fbb);
+  builder_.add_entity_names(entity_names);
+  builder_.add_entities(entities);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Sector> CreateSectorDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<uint8_t> *entities = nullptr,
+    const std::vector<flatbuffers::Offset<flatbuffers::String>> *entity_names = nullptr) {
+  auto entities__ = entities ? _fbb.CreateVector<uint8_t>(*entities) : 0;
+  auto entity_names__ = entity_names ? _fbb.CreateVector<flatbuffers::Offset<flatbuffers::String>>(*entity_names) : 0;
+  return Tempest::Definition::CreateSector(
+      _fbb,
+      entities__,
+      entity_names__);
+}
+
+inline const Tempest::Definition::Sector *GetSector(const void *buf) {
+  return flatbuffers::GetRoot<Tempest::Definition::Sector>(buf);
+}
+
+inline const Tempest::Definition::Sector *GetSizePrefixedSector(const void *buf) {
+  return flatbuffers::GetSizePrefixedRoot<Tempest::Definition::Sector>(buf);
+}
+
+inline const char *SectorIdentifier() {
+  return "TSEC";
+}
+
+inline bool SectorBufferHasIdentifier(const void *buf) {
+  return flatbuffers::BufferHasIdentifier(
+      buf, SectorIdentifier());
+}
+
+inline bool VerifySectorBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifyBuffer<Tempest::Definition::Sector>(SectorIdentifier());
+}
+
+inline bool VerifySizePrefixedSectorBuffer(
+    flatbuffers::Verifier &verifier) {
+  return verifier.VerifySizePrefixedBuffer<Tempest::Definition::Sector>(SectorIdentifier());
+}
+
+inline const char *SectorExtension() {
+  return "tsc";
+}
+
+inline void FinishSectorBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<Tempest::Definition::Sector> root) {
+  fbb.Finish(root, SectorIdentifier());
+}
+
+inline void FinishSizePrefixedSectorBuffer(
+    flatbuffers::FlatBufferBuilder &fbb,
+    flatbuffers::Offset<Tempest::Definition::Sector> root) {
+  fbb.FinishSizePrefixed(root, SectorIdentifier());
+}
+
+}  // namespace Definition
+}  // namespace Tempest
+
+#endif  // FLATBUFFERS_GENERATED_SECTOR_TEMPEST_DEFINITION_H_
@@ -11,6 +11,10 @@ namespace Definition {
 
 struct TextureData;
 
+struct TextureMip;
+
+struct TextureMipRange;
+
 struct TextureMapping;
 
 struct TextureDatabase;
@@ -118,6 +122,52 @@ FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) TextureData FLATBUFFERS_FINAL_CLASS {
 };
 FLATBUFFERS_STRUCT_END(TextureData, 12);
 
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) TextureMip FLATBUFFERS_FINAL_CLASS {
+ private:
+  uint32_t offset_;
+  uint32_t byte_count_;
+
+ public:
+  TextureMip()
+      : offset_(0),
+        byte_count_(0) {
+  }
+  TextureMip(uint32_t _offset, uint32_t _byte_count)
+      : offset_(flatbuffers::EndianScalar(_offset)),
+        byte_count_(flatbuffers::EndianScalar(_byte_count)) {
+  }
+  uint32_t offset() const {
+    return flatbuffers::EndianScalar(offset_);
+  }
+  uint32_t byte_count() const {
+    return flatbuffers::EndianScalar(byte_count_);
+  }
+};
+FLATBUFFERS_STRUCT_END(TextureMip, 8);
+
+FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) TextureMipRange FLATBUFFERS_FINAL_CLASS {
+ private:
+  uint32_t mip_offset_;
+  uint32_t mip_count_;
+
+ public:
+  TextureMipRange()
+      : mip_offset_(0),
+        mip_count_(0) {
+  }
+  TextureMipRange(uint32_t _mip_offset, uint32_t _mip_count)
+      : mip_offset_(flatbuffers::EndianScalar(_mip_offset)),
+        mip_count_(flatbuffers::EndianScalar(_mip_count)) {
+  }
+  uint32_t mip_offset() const {
+    return flatbuffers::EndianScalar(mip_offset_);
+  }
+  uint32_t mip_count() const {
+    return flatbuffers::EndianScalar(mip_count_);
+  }
+};
+FLATBUFFERS_STRUCT_END(TextureMipRange, 8);
+
 FLATBUFFERS_MANUALLY_ALIGNED_STRUCT(4) TextureMapping FLATBUFFERS_FINAL_CLASS {
  private:
   uint32_t index_;
@@ -163,7 +213,9 @@ struct TextureDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef TextureDatabaseBuilder Builder;
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_TEXTURE_DATA_BUFFER = 4,
-    VT_MAPPINGS = 6
+    VT_MAPPINGS = 6,
+    VT_MIP_RANGES = 8,
+    VT_MIPS = 10
   };
   const flatbuffers::Vector<uint8_t> *texture_data_buffer() const {
     return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_TEXTURE_DATA_BUFFER);
@@ -171,12 +223,22 @@ struct TextureDatabase FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::Vector<const Tempest::Definition::TextureMapping *> *mappings() const {
     return GetPointer<const flatbuffers::Vector<const Tempest::Definition::TextureMapping *> *>(VT_MAPPINGS);
   }
+  const flatbuffers::Vector<const Tempest::Definition::TextureMipRange *> *mip_ranges() const {
+    return GetPointer<const flatbuffers::Vector<const Tempest::Definition::TextureMipRange *> *>(VT_MIP_RANGES);
+  }
+  const flatbuffers::Vector<const Tempest::Definition::TextureMip *> *mips() const {
+    return GetPointer<const flatbuffers::Vector<const Tempest::Definition::TextureMip *> *>(VT_MIPS);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_TEXTURE_DATA_BUFFER) &&
            verifier.VerifyVector(texture_data_buffer()) &&
            VerifyOffset(verifier, VT_MAPPINGS) &&
            verifier.VerifyVector(mappings()) &&
+           VerifyOffset(verifier, VT_MIP_RANGES) &&
+           verifier.VerifyVector(mip_ranges()) &&
+           VerifyOffset(verifier, VT_MIPS) &&
+           verifier.VerifyVector(mips()) &&
            verifier.EndTable();
   }
 };
@@ -191,6 +253,12 @@ struct TextureDatabaseBuilder {
   void add_mappings(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMapping *>> mappings) {
     fbb_.AddOffset(TextureDatabase::VT_MAPPINGS, mappings);
   }
+  void add_mip_ranges(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMipRange *>> mip_ranges) {
+    fbb_.AddOffset(TextureDatabase::VT_MIP_RANGES, mip_ranges);
+  }
+  void add_mips(flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMip *>> mips) {
+    fbb_.AddOffset(TextureDatabase::VT_MIPS, mips);
+  }
   explicit TextureDatabaseBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -205,8 +273,12 @@ struct TextureDatabaseBuilder {
 inline flatbuffers::Offset<TextureDatabase> CreateTextureDatabase(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<flatbuffers::Vector<uint8_t>> texture_data_buffer = 0,
-    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMapping *>> mappings = 0) {
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMapping *>> mappings = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMipRange *>> mip_ranges = 0,
+    flatbuffers::Offset<flatbuffers::Vector<const Tempest::Definition::TextureMip *>> mips = 0) {
   TextureDatabaseBuilder builder_(_fbb);
+  builder_.add_mips(mips);
+  builder_.add_mip_ranges(mip_ranges);
   builder_.add_mappings(mappings);
   builder_.add_texture_data_buffer(texture_data_buffer);
   return builder_.Finish();
@@ -215,13 +287,19 @@ inline flatbuffers::Offset<TextureDatabase> CreateTextureDatabase(
 inline flatbuffers::Offset<TextureDatabase> CreateTextureDatabaseDirect(
     flatbuffers::FlatBufferBuilder &_fbb,
     const std::vector<uint8_t> *texture_data_buffer = nullptr,
-    std::vector<Tempest::Definition::TextureMapping> *mappings = nullptr) {
+    std::vector<Tempest::Definition::TextureMapping> *mappings = nullptr,
+    const std::vector<Tempest::Definition::TextureMipRange> *mip_ranges = nullptr,
+    const std::vector<Tempest::Definition::TextureMip> *mips = nullptr) {
   auto texture_data_buffer__ = texture_data_buffer ? _fbb.CreateVector<uint8_t>(*texture_data_buffer) : 0;
   auto mappings__ = mappings ? _fbb.CreateVectorOfSortedStructs<Tempest::Definition::TextureMapping>(mappings) : 0;
+  auto mip_ranges__ = mip_ranges ? _fbb.CreateVectorOfStructs<Tempest::Definition::TextureMipRange>(*mip_ranges) : 0;
+  auto mips__ = mips ? _fbb.CreateVectorOfStructs<Tempest::Definition::TextureMip>(*mips) : 0;
   return Tempest::Definition::CreateTextureDatabase(
       _fbb,
       texture_data_buffer__,
-      mappings__);
+      mappings__,
+      mip_ranges__,
+      mips__);
 }
 
 inline const Tempest::Definition::TextureDatabase *GetTextureDatabase(const void *buf) {
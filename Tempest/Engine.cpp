@@ -27,6 +27,7 @@ Engine::~Engine()
 void Engine::StartEngineLoop()
 {
 	LOG(Info, Engine, "Starting Engine Loop");
+	m_StartTime = std::chrono::high_resolution_clock::now();
 	OPTICK_APP("Tempo Engine");
 	// This is needed for proper visualization of profile library
 	OPTICK_FRAME("Engine Execution");
@@ -104,6 +105,10 @@ void Engine::DoFrame()
 	//ImGui::End();
 
 
+	// Sectors are added and removed before the systems run, the camera controller moves the main view
+	const Camera* mainView = m_Renderer.GetMainView();
+	m_LevelStreaming.Update(m_World, mainView ? mainView->Position : m_Camera.Position);
+
 	// TODO: add real delta time
 	m_World.Update(1.0f / 60.0f, m_JobSystem);
 
@@ -111,7 +116,14 @@ void Engine::DoFrame()
 	m_Audio.Update();
 
 	// TODO: This should be on seperate job and be pipelined with the DoFrame job
-	FrameData frameData = m_Renderer.GatherWorldData(m_World);
+	const FrameData& frameData = m_Renderer.GatherWorldData(m_World);
 	m_Renderer.RenderFrame(frameData);
+
+	if (!m_HasRenderedFrame)
+	{
+		m_HasRenderedFrame = true;
+		FORMAT_LOG(Info, Engine, "First frame rendered %.2f ms after start", std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - m_StartTime).count());
+		m_ResourceLoader.LogStatistics("First frame");
+	}
 }
 }
\ No newline at end of file
@@ -5,9 +5,12 @@
 #include <Graphics/Renderer.h>
 #include <World/World.h>
 #include <World/Camera.h>
+#include <World/LevelStreaming.h>
 #include <Audio/AudioManager.h>
 #include <Physics/PhysicsManager.h>
 
+#include <chrono>
+
 namespace Tempest
 {
 struct EngineOptions : public EngineCoreOptions
@@ -62,6 +65,11 @@ public:
 		return m_Camera;
 	}
 
+	LevelStreaming& GetLevelStreaming()
+	{
+		return m_LevelStreaming;
+	}
+
 private:
 	// Data members
 	EngineOptions m_Options;
@@ -70,6 +78,7 @@ private:
 	WindowsPlatform m_Platform;
 
 	World m_World;
+	LevelStreaming m_LevelStreaming;
 	Renderer m_Renderer;
 	Camera m_Camera;
 	AudioManager m_Audio;
@@ -81,6 +90,10 @@ private:
 
 	static void DoFrameJob(uint32_t, void*);
 	void DoFrame();
+
+	// Time to the first frame is logged to compare loading paths
+	std::chrono::high_resolution_clock::time_point m_StartTime;
+	bool m_HasRenderedFrame = false;
 };
 
 extern Engine* gEngine;
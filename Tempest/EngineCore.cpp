@@ -12,7 +12,7 @@ EngineCore::EngineCore(const EngineCoreOptions& options)
 	: m_CoreOptions(options)
 	, m_Logger()
 	, m_JobSystem(options.NumWorkerThreads, 64, 2 * 1024 * 1024)
-	, m_ResourceLoader(options.ResourceFolder)
+	, m_ResourceLoader(options.ResourceFolder, options.MemoryMapResources, m_JobSystem, options.UseOverlappedIO, options.UseAssetPack, options.ResourceMemoryBudget)
 {
 	gEngineCore = this;
 }
@@ -12,6 +12,16 @@ struct EngineCoreOptions
 {
 	uint32_t NumWorkerThreads;
 	const char* ResourceFolder;
+	// Assets are used straight from file mappings. Otherwise they are read in memory, which is kept for comparison
+	bool MemoryMapResources = true;
+	// Asynchronous reads go through overlapped I/O. Otherwise they are blocking reads on the IO thread
+	bool UseOverlappedIO = true;
+	// Assets are loaded from the asset pack in the resource folder if there is one. Otherwise every asset is a loose file
+	bool UseAssetPack = true;
+	// Resident memory of the loaded assets in bytes, loads which don't fit in it fail. Zero for no budget
+	uint64_t ResourceMemoryBudget = 0;
+	// Assets which are fully copied to the GPU are released right after the upload. Otherwise they stay loaded with the level
+	bool ReleaseAssetsAfterUpload = true;
 };
 
 class TEMPEST_API EngineCore
@@ -11,7 +11,7 @@ Game* gGame = nullptr;
 
 Game::Game(const GameOptions& options, const EngineOptions& engineOptions)
 	: m_GameOptions(options)
-	, m_Engine(PrepareEngineOptions(options, engineOptions))
+	, m_Engine(PrepareEngineOptions(m_GameOptions, engineOptions))
 {
 	gGame = this;
 }
@@ -28,7 +28,8 @@ void Game::Start()
 EngineOptions Game::PrepareEngineOptions(const GameOptions& gameOptions, const EngineOptions& inOptions)
 {
 	EngineOptions outOptions = inOptions;
-	outOptions.InitializeDataJob.Data = (void*)gameOptions.LevelToLoad;
+	// Game options are a member initialized before the engine, so they live long enough
+	outOptions.InitializeDataJob.Data = (void*)&gameOptions;
 	outOptions.InitializeDataJob.EntryPoint = Game::LoadLevel;
 
 	return outOptions;
@@ -36,14 +37,23 @@ EngineOptions Game::PrepareEngineOptions(const GameOptions& gameOptions, const E
 
 void Game::LoadLevel(uint32_t, void* data)
 {
-	const char* levelToLoad = (const char*)data;
-	const Definition::Level* level = gEngine->GetResourceLoader().LoadResource<Definition::Level>(levelToLoad);
+	const GameOptions* gameOptions = (const GameOptions*)data;
+	const char* levelToLoad = gameOptions->LevelToLoad;
+	// Everything the game needs from the level is copied out of it by the end of the loading, so it is released then
+	AssetHandle<Definition::Level> level = gEngine->GetResourceLoader().LoadResource<Definition::Level>(levelToLoad);
 	const char* levelName = level->name()->c_str();
 	const char* geometryDatabase = level->geometry_database_file()->c_str();
 	const char* textureDatabase = level->texture_database_file()->c_str();
 	const char* audioDatabase = level->audio_database_file()->c_str();
 	FORMAT_LOG(Info, Game, "Loading Level \"%s\".", levelName);
 
+	// Start reading all databases at once, the jobs below wait only for the one they need.
+	// The references keep them loaded until the systems using them take their own
+	Job::Counter databaseReadsCounter;
+	const char* databaseFiles[] = { geometryDatabase, textureDatabase, audioDatabase };
+	AssetReference databaseReferences[sizeof(databaseFiles) / sizeof(databaseFiles[0])];
+	gEngine->GetResourceLoader().RequestResources(databaseFiles, uint32_t(sizeof(databaseFiles) / sizeof(databaseFiles[0])), databaseReferences, &databaseReadsCounter);
+
 	// Async Load the rendering databases
 	Job::Counter renderingDatabasesCounter;
 	struct RenderingDatabases
@@ -72,12 +82,13 @@ void Game::LoadLevel(uint32_t, void* data)
 	}
 
 	// Runs async to loading the world
-	// This needs to be on Windows thread so it is a new job
+	// This needs to be on Windows thread so it is a new job. The name is in the level, so it is waited for before releasing it
+	Job::Counter changeWindowNameCounter;
 	{
 		Job::JobDecl changeWindowName{ [](uint32_t, void* levelName) {
 			gEngine->GetPlatform().SetTitleName(reinterpret_cast<const char*>(levelName));
 		}, (void*)levelName };
-		gEngine->GetJobSystem().RunJobs("Change Window Name", &changeWindowName, 1, nullptr, Job::ThreadTag::Windows);
+		gEngine->GetJobSystem().RunJobs("Change Window Name", &changeWindowName, 1, &changeWindowNameCounter, Job::ThreadTag::Windows);
 	}
 
 	// Async Load the physics world
@@ -93,6 +104,7 @@ void Game::LoadLevel(uint32_t, void* data)
 
 	const flatbuffers::Vector<uint8_t>* entitiesData = level->entities();
 	const eastl::vector<flecs::entity_t>& newlyCreatedEntities = gEngine->GetWorld().LoadFromLevel(reinterpret_cast<const char*>(entitiesData->Data()), entitiesData->size());
+	gEngine->GetLevelStreaming().Initialize(*level.Get());
 
 	auto camera = level->camera();
 
@@ -101,6 +113,9 @@ void Game::LoadLevel(uint32_t, void* data)
 	gEngine->GetCamera().Up = glm::vec3(camera->up().x(), camera->up().y(), camera->up().z());
 	gEngine->GetCamera().SetPerspectiveProjection(camera->aspect_ratio(), camera->yfov(), camera->znear(), camera->zfar());
 
+	// The sectors around the camera are part of the level, the rest are streamed while playing
+	gEngine->GetLevelStreaming().LoadAround(gEngine->GetWorld(), gEngine->GetCamera().Position);
+
 	auto cameraController = gEngine->GetWorld().m_EntityWorld.entity("MainCameraController")
 		.set<Components::CameraController>({ gEngine->GetCamera(), 0})
 		.set<Components::VehicleController>({ 1 });
@@ -115,10 +130,20 @@ void Game::LoadLevel(uint32_t, void* data)
 	//gEngine->GetPhysics().PatchWorldComponents(gEngine->GetWorld(), newlyCreatedEntities);
 
 	// Wait for the loading of the rendering databases before initializing it
+	gEngine->GetJobSystem().WaitForCounter(&databaseReadsCounter, 0);
 	gEngine->GetJobSystem().WaitForCounter(&renderingDatabasesCounter, 0);
 	gEngine->GetRenderer().InitializeAfterLevelLoad(gEngine->GetWorld());
 
 	// Wait for audio as well
 	gEngine->GetJobSystem().WaitForCounter(&audioDatabaseCounter, 0);
+	gEngine->GetJobSystem().WaitForCounter(&changeWindowNameCounter, 0);
+
+	// Only the assets which the systems kept are still resident after this
+	for (AssetReference& reference : databaseReferences)
+	{
+		reference.Release();
+	}
+	level.Release();
+	gEngine->GetResourceLoader().LogStatistics("Level loaded");
 }
 }
\ No newline at end of file
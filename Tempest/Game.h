@@ -25,7 +25,7 @@ private:
 	Engine m_Engine;
 
 	static EngineOptions PrepareEngineOptions(const GameOptions& gameOptions, const EngineOptions& inOptions);
-	static void LoadLevel(uint32_t, void* levelToLoad);
+	static void LoadLevel(uint32_t, void* gameOptions);
 };
 
 extern Game* gGame;
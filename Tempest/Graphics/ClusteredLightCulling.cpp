@@ -0,0 +1,371 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/ClusteredLightCulling.h>
+#include <Graphics/Dx12/Dx12Backend.h>
+#include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
+#include <Job/JobSystem.h>
+
+#include <emmintrin.h>
+#include <chrono>
+
+namespace Tempest
+{
+// Clusters in a slice are packed in the top bits of the pairs, the light in the rest
+static const uint32_t sPairLightBits = 24;
+static const uint32_t sPairLightMask = (1u << sPairLightBits) - 1;
+static_assert(ClusteredLightCulling::sClustersPerSlice <= (1u << (32 - sPairLightBits)), "Clusters of a slice don't fit in the pairs");
+static_assert(ClusteredLightCulling::sTilesX % 4 == 0, "Rows of tiles are tested 4 at a time");
+
+void ClusteredLightCulling::Initialize(Dx12::Backend& backend)
+{
+	m_Backend = &backend;
+}
+
+void ClusteredLightCulling::Execute(Job::JobSystem& jobSystem, const FrameData& frameData)
+{
+	OPTICK_EVENT();
+	const auto binningStart = std::chrono::high_resolution_clock::now();
+
+	SetupClusters(frameData.Projection, frameData.NearPlane, frameData.FarPlane);
+	Bin(jobSystem, eastl::span<const FrameData::LocalLight>(frameData.LocalLights.begin(), frameData.LocalLights.size()), frameData.View);
+
+	m_Statistics.BinningMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - binningStart).count();
+	OPTICK_TAG("Lights", m_Statistics.Lights);
+	OPTICK_TAG("Light Indices", m_Statistics.LightIndices);
+	OPTICK_TAG("Max Cluster Lights", m_Statistics.MaxClusterLights);
+	OPTICK_TAG("Light Binning ms", m_Statistics.BinningMilliseconds);
+}
+
+void ClusteredLightCulling::SetupClusters(const glm::mat4x4& projection, float nearPlane, float farPlane)
+{
+	const glm::vec4 key(projection[0][0], projection[1][1], nearPlane, farPlane);
+	if (!m_SliceBounds.empty() && key == m_ClusterKey)
+	{
+		return;
+	}
+
+	OPTICK_EVENT();
+	m_ClusterKey = key;
+	m_ClusterNear = nearPlane;
+	m_ClusterFar = eastl::max(eastl::min(farPlane, sMaxClusterDistance), nearPlane * 2.0f);
+	m_SliceBounds.resize(sSlices);
+
+	// Corners of the tiles at some depth are the corners in NDC scaled by the depth and the inverse projection
+	const float depthRatio = m_ClusterFar / m_ClusterNear;
+	for (uint32_t slice = 0; slice < sSlices; ++slice)
+	{
+		const float sliceNear = m_ClusterNear * glm::pow(depthRatio, float(slice) / float(sSlices));
+		const float sliceFar = m_ClusterNear * glm::pow(depthRatio, float(slice + 1) / float(sSlices));
+		SliceBounds& bounds = m_SliceBounds[slice];
+		for (uint32_t tileY = 0; tileY < sTilesY; ++tileY)
+		{
+			// First row of tiles is at the top of the screen
+			const float ndcBottom = 1.0f - 2.0f * float(tileY + 1) / float(sTilesY);
+			const float ndcTop = 1.0f - 2.0f * float(tileY) / float(sTilesY);
+			for (uint32_t tileX = 0; tileX < sTilesX; ++tileX)
+			{
+				const float ndcLeft = -1.0f + 2.0f * float(tileX) / float(sTilesX);
+				const float ndcRight = -1.0f + 2.0f * float(tileX + 1) / float(sTilesX);
+				const uint32_t cluster = tileY * sTilesX + tileX;
+				bounds.MinX[cluster] = eastl::min(ndcLeft * sliceNear, ndcLeft * sliceFar) / projection[0][0];
+				bounds.MaxX[cluster] = eastl::max(ndcRight * sliceNear, ndcRight * sliceFar) / projection[0][0];
+				bounds.MinY[cluster] = eastl::min(ndcBottom * sliceNear, ndcBottom * sliceFar) / projection[1][1];
+				bounds.MaxY[cluster] = eastl::max(ndcTop * sliceNear, ndcTop * sliceFar) / projection[1][1];
+				bounds.MinZ[cluster] = sliceNear;
+				bounds.MaxZ[cluster] = sliceFar;
+			}
+		}
+	}
+
+	m_SliceScale = float(sSlices) / glm::log(depthRatio);
+	m_SliceBias = -glm::log(m_ClusterNear) * m_SliceScale;
+	m_ProjectionScale = glm::vec2(projection[0][0], projection[1][1]);
+}
+
+void ClusteredLightCulling::ComputeLightBounds(eastl::span<const FrameData::LocalLight> lights, const glm::mat4x4& view)
+{
+	OPTICK_EVENT();
+	m_LightBounds.resize(lights.size());
+	for (uint32_t lightIndex = 0; lightIndex < lights.size(); ++lightIndex)
+	{
+		const FrameData::LocalLight& light = lights[lightIndex];
+		LightBounds& bounds = m_LightBounds[lightIndex];
+
+		glm::vec3 center = light.Position;
+		float radius = light.Radius;
+		if (light.SpotScale > 0.0f)
+		{
+			// Smallest sphere around the cone, narrow cones are inside of the sphere through the apex and the cap
+			const float cosOuter = -light.SpotOffset / light.SpotScale;
+			if (cosOuter >= 0.70710678f)
+			{
+				radius = light.Radius / (2.0f * cosOuter);
+				center = light.Position + light.Direction * radius;
+			}
+			else if (cosOuter > 0.0f)
+			{
+				center = light.Position + light.Direction * (light.Radius * cosOuter);
+				radius = light.Radius * glm::sqrt(1.0f - cosOuter * cosOuter);
+			}
+		}
+
+		bounds.Center = glm::vec3(view * glm::vec4(center, 1.0f));
+		bounds.Radius = radius;
+
+		// Empty range, so the light is skipped by all slices
+		bounds.MinSlice = 1;
+		bounds.MaxSlice = 0;
+
+		const float minZ = bounds.Center.z - radius;
+		const float maxZ = bounds.Center.z + radius;
+		if (maxZ < m_ClusterNear || minZ > m_ClusterFar)
+		{
+			continue;
+		}
+
+		uint32_t minTileX = 0;
+		uint32_t maxTileX = sTilesX - 1;
+		uint32_t minTileY = 0;
+		uint32_t maxTileY = sTilesY - 1;
+		// Crossing the near plane covers the whole screen, otherwise the extremes are at the front or the back of the sphere
+		if (minZ > m_ClusterNear)
+		{
+			const float ndcMinX = m_ProjectionScale.x * eastl::min((bounds.Center.x - radius) / minZ, (bounds.Center.x - radius) / maxZ);
+			const float ndcMaxX = m_ProjectionScale.x * eastl::max((bounds.Center.x + radius) / minZ, (bounds.Center.x + radius) / maxZ);
+			const float ndcMinY = m_ProjectionScale.y * eastl::min((bounds.Center.y - radius) / minZ, (bounds.Center.y - radius) / maxZ);
+			const float ndcMaxY = m_ProjectionScale.y * eastl::max((bounds.Center.y + radius) / minZ, (bounds.Center.y + radius) / maxZ);
+			if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+			{
+				continue;
+			}
+
+			auto toTile = [](float value, uint32_t tileCount) {
+				return uint32_t(glm::clamp(value * float(tileCount), 0.0f, float(tileCount - 1)));
+			};
+			minTileX = toTile((ndcMinX + 1.0f) * 0.5f, sTilesX);
+			maxTileX = toTile((ndcMaxX + 1.0f) * 0.5f, sTilesX);
+			minTileY = toTile((1.0f - ndcMaxY) * 0.5f, sTilesY);
+			maxTileY = toTile((1.0f - ndcMinY) * 0.5f, sTilesY);
+		}
+
+		auto toSlice = [this](float depth) {
+			return uint32_t(glm::clamp(glm::log(eastl::max(depth, m_ClusterNear)) * m_SliceScale + m_SliceBias, 0.0f, float(sSlices - 1)));
+		};
+		bounds.MinSlice = toSlice(minZ);
+		bounds.MaxSlice = toSlice(maxZ);
+		bounds.MinTileX = minTileX;
+		bounds.MaxTileX = maxTileX;
+		bounds.MinTileY = minTileY;
+		bounds.MaxTileY = maxTileY;
+	}
+}
+
+void ClusteredLightCulling::BinSlice(uint32_t slice)
+{
+	OPTICK_EVENT();
+	const SliceBounds& clusters = m_SliceBounds[slice];
+	eastl::vector<uint32_t>& pairs = m_SliceLightPairs[slice];
+	pairs.clear();
+
+	const __m128 zero = _mm_setzero_ps();
+	for (uint32_t lightIndex = 0; lightIndex < m_LightBounds.size(); ++lightIndex)
+	{
+		const LightBounds& light = m_LightBounds[lightIndex];
+		if (slice < light.MinSlice || slice > light.MaxSlice)
+		{
+			continue;
+		}
+
+		const __m128 centerX = _mm_set1_ps(light.Center.x);
+		const __m128 centerY = _mm_set1_ps(light.Center.y);
+		const __m128 centerZ = _mm_set1_ps(light.Center.z);
+		const __m128 radiusSquared = _mm_set1_ps(light.Radius * light.Radius);
+		for (uint32_t tileY = light.MinTileY; tileY <= light.MaxTileY; ++tileY)
+		{
+			for (uint32_t tileX = light.MinTileX & ~3u; tileX <= light.MaxTileX; tileX += 4)
+			{
+				// Distance from the center to the closest point of 4 boxes at a time
+				const uint32_t cluster = tileY * sTilesX + tileX;
+				const __m128 distanceX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(clusters.MinX + cluster), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(clusters.MaxX + cluster))), zero);
+				const __m128 distanceY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(clusters.MinY + cluster), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(clusters.MaxY + cluster))), zero);
+				const __m128 distanceZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(clusters.MinZ + cluster), centerZ), _mm_sub_ps(centerZ, _mm_loadu_ps(clusters.MaxZ + cluster))), zero);
+				const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(distanceX, distanceX), _mm_mul_ps(distanceY, distanceY)), _mm_mul_ps(distanceZ, distanceZ));
+				const uint32_t mask = uint32_t(_mm_movemask_ps(_mm_cmple_ps(distanceSquared, radiusSquared)));
+				if (mask == 0)
+				{
+					continue;
+				}
+
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					// Tiles of the group outside of the screen bounds of the light are dropped
+					const bool isInBounds = tileX + lane >= light.MinTileX && tileX + lane <= light.MaxTileX;
+					if ((mask & (1u << lane)) && isInBounds)
+					{
+						pairs.push_back(((cluster + lane) << sPairLightBits) | lightIndex);
+					}
+				}
+			}
+		}
+	}
+
+	// Counting sort by cluster. Lights were visited in order, so every cluster has its lights sorted
+	eastl::array<uint32_t, sClustersPerSlice> counts;
+	counts.fill(0);
+	for (uint32_t pair : pairs)
+	{
+		++counts[pair >> sPairLightBits];
+	}
+
+	ClusterRange* ranges = m_ClusterRanges.data() + slice * sClustersPerSlice;
+	uint32_t offset = 0;
+	for (uint32_t cluster = 0; cluster < sClustersPerSlice; ++cluster)
+	{
+		ranges[cluster] = ClusterRange{ offset, counts[cluster] };
+		counts[cluster] = offset;
+		offset += ranges[cluster].Count;
+	}
+
+	eastl::vector<uint32_t>& indices = m_SliceLightIndices[slice];
+	indices.resize(pairs.size());
+	for (uint32_t pair : pairs)
+	{
+		indices[counts[pair >> sPairLightBits]++] = pair & sPairLightMask;
+	}
+}
+
+void ClusteredLightCulling::BinSliceJob(uint32_t slice, void* data)
+{
+	reinterpret_cast<ClusteredLightCulling*>(data)->BinSlice(slice);
+}
+
+void ClusteredLightCulling::Bin(Job::JobSystem& jobSystem, eastl::span<const FrameData::LocalLight> lights, const glm::mat4x4& view)
+{
+	assert(lights.size() <= sPairLightMask && "Too many lights for the binning");
+	m_Statistics.Lights = uint32_t(lights.size());
+	m_ClusterRanges.resize(sClusterCount);
+	m_LightIndices.clear();
+	if (lights.empty())
+	{
+		eastl::fill(m_ClusterRanges.begin(), m_ClusterRanges.end(), ClusterRange{ 0, 0 });
+		m_Statistics.UsedClusters = 0;
+		m_Statistics.LightIndices = 0;
+		m_Statistics.MaxClusterLights = 0;
+		return;
+	}
+
+	ComputeLightBounds(lights, view);
+
+	{
+		eastl::array<Job::JobDecl, sSlices> jobs;
+		for (Job::JobDecl& job : jobs)
+		{
+			job = Job::JobDecl{ BinSliceJob, this };
+		}
+		Job::Counter counter;
+		jobSystem.RunJobs("Light Binning Slice", jobs.data(), uint32_t(jobs.size()), &counter);
+		jobSystem.WaitForCounter(&counter, 0);
+	}
+
+	// Slices are placed one after the other in the compact list
+	uint32_t totalIndices = 0;
+	for (const eastl::vector<uint32_t>& sliceIndices : m_SliceLightIndices)
+	{
+		totalIndices += uint32_t(sliceIndices.size());
+	}
+	m_LightIndices.resize(totalIndices);
+
+	uint32_t usedClusters = 0;
+	uint32_t maxClusterLights = 0;
+	uint32_t sliceOffset = 0;
+	for (uint32_t slice = 0; slice < sSlices; ++slice)
+	{
+		const eastl::vector<uint32_t>& sliceIndices = m_SliceLightIndices[slice];
+		if (!sliceIndices.empty())
+		{
+			memcpy(m_LightIndices.data() + sliceOffset, sliceIndices.data(), sliceIndices.size() * sizeof(uint32_t));
+		}
+
+		ClusterRange* ranges = m_ClusterRanges.data() + slice * sClustersPerSlice;
+		for (uint32_t cluster = 0; cluster < sClustersPerSlice; ++cluster)
+		{
+			ranges[cluster].Offset += sliceOffset;
+			usedClusters += ranges[cluster].Count > 0 ? 1 : 0;
+			maxClusterLights = eastl::max(maxClusterLights, ranges[cluster].Count);
+		}
+		sliceOffset += uint32_t(sliceIndices.size());
+	}
+
+	m_Statistics.UsedClusters = usedClusters;
+	m_Statistics.LightIndices = totalIndices;
+	m_Statistics.MaxClusterLights = maxClusterLights;
+}
+
+void ClusteredLightCulling::PrepareBuffers(const FrameData& frameData)
+{
+	// Everything the shaders read is copied again every frame, so the new buffers need no initial data
+	Dx12::BufferManager& buffers = m_Backend->Managers.Buffer;
+	buffers.GrowBuffer(m_LightBuffer, Dx12::Dx12Device::ShaderResourceSlot::LocalLights, uint32_t(frameData.LocalLights.size()), sMinLightCapacity, sizeof(FrameData::LocalLight), nullptr, 0);
+	buffers.GrowBuffer(m_ClusterBuffer, Dx12::Dx12Device::ShaderResourceSlot::LightClusters, sClusterCount, sClusterCount, sizeof(ClusterRange), nullptr, 0);
+	buffers.GrowBuffer(m_IndexBuffer, Dx12::Dx12Device::ShaderResourceSlot::LightIndices, uint32_t(m_LightIndices.size()), sMinIndexCapacity, sizeof(uint32_t), nullptr, 0);
+}
+
+void ClusteredLightCulling::RecordUploads(const FrameData& frameData, RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager)
+{
+	OPTICK_EVENT();
+	assert(m_ClusterBuffer.Capacity != 0 && "PrepareBuffers must be called before recording");
+
+	m_Statistics.UploadedBytes = 0;
+	AddUpload(m_LightBuffer, frameData.LocalLights.begin(), uint32_t(frameData.LocalLights.size() * sizeof(FrameData::LocalLight)), commandList, constantManager);
+	AddUpload(m_ClusterBuffer, m_ClusterRanges.data(), uint32_t(m_ClusterRanges.size() * sizeof(ClusterRange)), commandList, constantManager);
+	AddUpload(m_IndexBuffer, m_LightIndices.data(), uint32_t(m_LightIndices.size() * sizeof(uint32_t)), commandList, constantManager);
+
+	OPTICK_TAG("Light Upload Bytes", m_Statistics.UploadedBytes);
+	m_LastFrameStatistics = m_Statistics;
+	m_Statistics = ClusteredLightCullingStatistics{};
+}
+
+void ClusteredLightCulling::AddUpload(GrowableBuffer& buffer, const void* data, uint32_t size, RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	eastl::array<RendererBufferUpdateRegion, 16> regions;
+	uint32_t regionCount = 0;
+	auto flushRegions = [&]() {
+		RendererCommandUpdateBuffer command;
+		command.Buffer = buffer.Handle;
+		command.RegionCount = regionCount;
+		commandList.AddCommand(command, eastl::span<const RendererBufferUpdateRegion>(regions.data(), regionCount));
+		regionCount = 0;
+	};
+
+	for (uint32_t offset = 0; offset < size; offset += sMaxUploadBytes)
+	{
+		// Very big uploads go in multiple commands
+		if (regionCount == regions.size())
+		{
+			flushRegions();
+		}
+
+		const uint32_t chunkSize = eastl::min(sMaxUploadBytes, size - offset);
+		RendererBufferUpdateRegion& region = regions[regionCount++];
+		region.DestinationOffset = offset;
+		region.ConstantDataOffset = constantManager.AddRawData(reinterpret_cast<const uint8_t*>(data) + offset, chunkSize);
+		region.Size = chunkSize;
+	}
+	flushRegions();
+	m_Statistics.UploadedBytes += size;
+}
+
+ClusterShaderParameters ClusteredLightCulling::GetShaderParameters(const FrameData& frameData, const glm::uvec2& viewportSize) const
+{
+	return ClusterShaderParameters{
+		glm::uvec4(sTilesX, sTilesY, sSlices, uint32_t(frameData.LocalLights.size())),
+		glm::vec4(float(sTilesX) / float(viewportSize.x), float(sTilesY) / float(viewportSize.y), m_SliceScale, m_SliceBias),
+		glm::uvec4(m_LightBuffer.DescriptorIndex, m_ClusterBuffer.DescriptorIndex, m_IndexBuffer.DescriptorIndex, 0)
+	};
+}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+#include <Graphics/RendererCommandList.h>
+#include <Graphics/FrameData.h>
+
+namespace Tempest
+{
+namespace Job { class JobSystem; }
+namespace Dx12 { class Backend; struct ConstantBufferDataManager; }
+
+struct ClusteredLightCullingStatistics
+{
+	uint32_t Lights = 0;
+	// Clusters with at least one light
+	uint32_t UsedClusters = 0;
+	uint32_t LightIndices = 0;
+	uint32_t MaxClusterLights = 0;
+	uint32_t UploadedBytes = 0;
+	float BinningMilliseconds = 0.0f;
+};
+
+// What the shaders need to find the cluster of a pixel
+struct ClusterShaderParameters
+{
+	// Tiles in X and Y, depth slices and number of lights
+	glm::uvec4 Grid;
+	// Tiles per pixel in X and Y, then scale and bias converting the log of the view depth to a slice
+	glm::vec4 Parameters;
+	// Heap indices of the views of the lights, the clusters and the light indices, which change when the buffers grow
+	glm::uvec4 Buffers;
+};
+
+// Assigns the point and spot lights to a grid of froxels over the main view, so pixels only go through the lights which can reach them.
+// The screen is split in tiles and the view depth in exponential slices. Slices are binned in parallel jobs and
+// every light is tested against the bounds of 4 clusters at a time with SSE. Spot lights use the bounding sphere of their cone.
+// Every cluster gets an offset and a count in a compact list of light indices. The lights, the clusters and the list are
+// copied every frame through the constant buffer ring in GPU buffers, which are read by the shaders from static descriptors.
+class ClusteredLightCulling : Utils::NonCopyable
+{
+public:
+	static const uint32_t sTilesX = 16;
+	static const uint32_t sTilesY = 9;
+	static const uint32_t sSlices = 24;
+	static const uint32_t sClustersPerSlice = sTilesX * sTilesY;
+	static const uint32_t sClusterCount = sClustersPerSlice * sSlices;
+
+	void Initialize(Dx12::Backend& backend);
+
+	// Bins the local lights of the frame in the clusters of the main view. Must be called from a job
+	void Execute(Job::JobSystem& jobSystem, const FrameData& frameData);
+
+	// Grows the GPU buffers if the data does not fit. Must be called before the frame is recorded
+	void PrepareBuffers(const FrameData& frameData);
+	// Copies the lights and the clusters in the GPU buffers. Must be recorded before any draw using them
+	void RecordUploads(const FrameData& frameData, RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager);
+
+	ClusterShaderParameters GetShaderParameters(const FrameData& frameData, const glm::uvec2& viewportSize) const;
+
+	const ClusteredLightCullingStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	friend struct ClusteredLightCullingBenchmark;
+
+	struct ClusterRange
+	{
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	// Bounding sphere of a light in view space, with the clusters it could touch
+	struct LightBounds
+	{
+		glm::vec3 Center;
+		float Radius;
+		uint32_t MinSlice;
+		uint32_t MaxSlice;
+		uint32_t MinTileX;
+		uint32_t MaxTileX;
+		uint32_t MinTileY;
+		uint32_t MaxTileY;
+	};
+
+	// View space boxes of the clusters of a slice, in rows of tiles which are multiple of 4 for SSE
+	struct SliceBounds
+	{
+		float MinX[sClustersPerSlice];
+		float MinY[sClustersPerSlice];
+		float MinZ[sClustersPerSlice];
+		float MaxX[sClustersPerSlice];
+		float MaxY[sClustersPerSlice];
+		float MaxZ[sClustersPerSlice];
+	};
+
+	void SetupClusters(const glm::mat4x4& projection, float nearPlane, float farPlane);
+	void ComputeLightBounds(eastl::span<const FrameData::LocalLight> lights, const glm::mat4x4& view);
+	void BinSlice(uint32_t slice);
+	static void BinSliceJob(uint32_t slice, void* data);
+	void Bin(Job::JobSystem& jobSystem, eastl::span<const FrameData::LocalLight> lights, const glm::mat4x4& view);
+
+	void AddUpload(GrowableBuffer& buffer, const void* data, uint32_t size, RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager);
+
+	static const uint32_t sMinLightCapacity = 256;
+	static const uint32_t sMinIndexCapacity = 16 * 1024;
+	// Bigger uploads are split, so a single allocation does not take too much of the constant buffer ring
+	static const uint32_t sMaxUploadBytes = 256 * 1024;
+	// Lights farther than this from the camera are not binned, even if the far plane is farther
+	static constexpr float sMaxClusterDistance = 500.0f;
+
+	Dx12::Backend* m_Backend = nullptr;
+
+	// The clusters only change with the projection
+	glm::vec4 m_ClusterKey = glm::vec4(0.0f);
+	float m_ClusterNear = 0.0f;
+	float m_ClusterFar = 0.0f;
+	// Slice of a view depth is log(depth) * scale + bias
+	float m_SliceScale = 0.0f;
+	float m_SliceBias = 0.0f;
+	glm::vec2 m_ProjectionScale = glm::vec2(1.0f);
+	eastl::vector<SliceBounds> m_SliceBounds;
+
+	eastl::vector<LightBounds> m_LightBounds;
+	// Every slice bins its lights separately, packed as the cluster in the slice and the light
+	eastl::array<eastl::vector<uint32_t>, sSlices> m_SliceLightPairs;
+	eastl::array<eastl::vector<uint32_t>, sSlices> m_SliceLightIndices;
+	eastl::vector<ClusterRange> m_ClusterRanges;
+	eastl::vector<uint32_t> m_LightIndices;
+
+	GrowableBuffer m_LightBuffer;
+	GrowableBuffer m_ClusterBuffer;
+	GrowableBuffer m_IndexBuffer;
+
+	ClusteredLightCullingStatistics m_Statistics;
+	ClusteredLightCullingStatistics m_LastFrameStatistics;
+};
+}
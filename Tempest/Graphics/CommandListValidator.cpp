@@ -0,0 +1,488 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/CommandListValidator.h>
+#include <fstream>
+
+namespace Tempest
+{
+static const char* ResourceStateName(ResourceState state)
+{
+	switch (state)
+	{
+	case ResourceState::Common: return "Common";
+	case ResourceState::RenderTarget: return "RenderTarget";
+	case ResourceState::PixelShaderRead: return "PixelShaderRead";
+	case ResourceState::DepthWrite: return "DepthWrite";
+	case ResourceState::DepthRead: return "DepthRead";
+	default: return "Unknown";
+	}
+}
+
+static const char* BarrierKindName(BarrierKind kind)
+{
+	switch (kind)
+	{
+	case BarrierKind::Transition: return "Transition";
+	case BarrierKind::TransitionBegin: return "TransitionBegin";
+	case BarrierKind::TransitionEnd: return "TransitionEnd";
+	case BarrierKind::Aliasing: return "Aliasing";
+	default: return "Unknown";
+	}
+}
+
+static const char* LoadActionName(TextureTargetLoadAction action)
+{
+	switch (action)
+	{
+	case TextureTargetLoadAction::DoNotCare: return "DoNotCare";
+	case TextureTargetLoadAction::Clear: return "Clear";
+	case TextureTargetLoadAction::Load: return "Load";
+	default: return "Unknown";
+	}
+}
+
+static const char* StoreActionName(TextureTargetStoreAction action)
+{
+	switch (action)
+	{
+	case TextureTargetStoreAction::DoNotCare: return "DoNotCare";
+	case TextureTargetStoreAction::Store: return "Store";
+	default: return "Unknown";
+	}
+}
+
+void CommandListValidator::RegisterPipelineState(PipelineStateHandle handle)
+{
+	if (eastl::find(m_Pipelines.begin(), m_Pipelines.end(), handle) == m_Pipelines.end())
+	{
+		m_Pipelines.push_back(handle);
+	}
+}
+
+void CommandListValidator::SetConstantBufferSize(uint64_t size)
+{
+	m_ConstantBufferSize = size;
+}
+
+void CommandListValidator::ReportError(uint32_t commandOffset, const char* message)
+{
+	eastl::string error;
+	error.sprintf("Command at offset %u: %s", commandOffset, message);
+	LOG(Error, Renderer, error.c_str());
+	m_LastFrameErrors.push_back(eastl::move(error));
+	++m_LastFrameStatistics.Errors;
+}
+
+void CommandListValidator::ValidateShaderParameters(uint32_t commandOffset, PipelineStateHandle pipeline, const ShaderParameterView parameters[size_t(ShaderParameterType::Count)])
+{
+	if (eastl::find(m_Pipelines.begin(), m_Pipelines.end(), pipeline) == m_Pipelines.end())
+	{
+		eastl::string message;
+		message.sprintf("Draw uses unknown pipeline %u", pipeline);
+		ReportError(commandOffset, message.c_str());
+	}
+
+	for (int i = 0; i < int(ShaderParameterType::Count); ++i)
+	{
+		const uint32_t offset = parameters[i].ConstantDataOffset;
+		// Constant buffer views must be placed on 256 bytes
+		if (offset % 256 != 0)
+		{
+			eastl::string message;
+			message.sprintf("Constant data offset %u for parameter %d is not aligned", offset, i);
+			ReportError(commandOffset, message.c_str());
+		}
+		if (m_ConstantBufferSize != 0 && offset >= m_ConstantBufferSize)
+		{
+			eastl::string message;
+			message.sprintf("Constant data offset %u for parameter %d is outside of the constant buffer", offset, i);
+			ReportError(commandOffset, message.c_str());
+		}
+	}
+}
+
+void CommandListValidator::ValidateBarrier(uint32_t commandOffset, const RendererCommandBarrier& barrier)
+{
+	eastl::string message;
+	switch (barrier.Kind)
+	{
+	case BarrierKind::Aliasing:
+		++m_LastFrameStatistics.AliasingBarriers;
+		return;
+	case BarrierKind::Transition:
+	case BarrierKind::TransitionBegin:
+	{
+		++m_LastFrameStatistics.Transitions;
+		if (m_PendingSplitTransitions.find(barrier.TextureHandle) != m_PendingSplitTransitions.end())
+		{
+			message.sprintf("Texture %u is transitioned while a split transition on it is not finished", barrier.TextureHandle);
+			ReportError(commandOffset, message.c_str());
+		}
+
+		auto stateItr = m_TextureStates.find(barrier.TextureHandle);
+		if (stateItr != m_TextureStates.end() && stateItr->second != barrier.BeforeState)
+		{
+			message.sprintf("Texture %u is in state %s, but the barrier expects %s", barrier.TextureHandle, ResourceStateName(stateItr->second), ResourceStateName(barrier.BeforeState));
+			ReportError(commandOffset, message.c_str());
+		}
+		if (barrier.BeforeState == barrier.AfterState)
+		{
+			message.sprintf("Texture %u is transitioned to the state it is already in (%s)", barrier.TextureHandle, ResourceStateName(barrier.AfterState));
+			ReportError(commandOffset, message.c_str());
+		}
+
+		if (barrier.Kind == BarrierKind::TransitionBegin)
+		{
+			++m_LastFrameStatistics.SplitTransitions;
+			m_PendingSplitTransitions[barrier.TextureHandle] = barrier;
+		}
+		else
+		{
+			m_TextureStates[barrier.TextureHandle] = barrier.AfterState;
+		}
+		return;
+	}
+	case BarrierKind::TransitionEnd:
+	{
+		auto pendingItr = m_PendingSplitTransitions.find(barrier.TextureHandle);
+		if (pendingItr == m_PendingSplitTransitions.end())
+		{
+			message.sprintf("Texture %u has end of split transition without a begin", barrier.TextureHandle);
+			ReportError(commandOffset, message.c_str());
+			return;
+		}
+		if (pendingItr->second.BeforeState != barrier.BeforeState || pendingItr->second.AfterState != barrier.AfterState)
+		{
+			message.sprintf("Texture %u has split transition with different states in the begin and the end", barrier.TextureHandle);
+			ReportError(commandOffset, message.c_str());
+		}
+		m_TextureStates[barrier.TextureHandle] = barrier.AfterState;
+		m_PendingSplitTransitions.erase(pendingItr);
+		return;
+	}
+	default:
+		message.sprintf("Texture %u has barrier of unknown kind", barrier.TextureHandle);
+		ReportError(commandOffset, message.c_str());
+		return;
+	}
+}
+
+bool CommandListValidator::Validate(const RendererCommandList& commandList)
+{
+	OPTICK_EVENT();
+	m_LastFrameStatistics = CommandListStatistics{};
+	m_LastFrameErrors.clear();
+	m_LastFrameStatistics.CommandBytes = uint32_t(commandList.m_DataBuffer.size());
+
+	bool renderPassStarted = false;
+	PipelineStateHandle currentPipeline = sInvalidHandle;
+
+	const uint8_t* commandListStart = commandList.m_DataBuffer.begin();
+	const uint8_t* commandListEnd = commandList.m_DataBuffer.end();
+	const uint8_t* commandListIterator = commandListStart;
+	auto hasRoomFor = [&](size_t size) {
+		return size_t(commandListEnd - commandListIterator) >= size;
+	};
+
+	while (commandListIterator && commandListIterator < commandListEnd)
+	{
+		const uint32_t commandOffset = uint32_t(commandListIterator - commandListStart);
+		++m_LastFrameStatistics.Commands;
+
+		RendererCommandType type = reinterpret_cast<const RendererCommand<RendererCommandType::Count>*>(commandListIterator)->Type;
+		switch (type)
+		{
+		case RendererCommandType::BeginRenderPass:
+		{
+			if (!hasRoomFor(sizeof(RendererCommandBeginRenderPass)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			const RendererCommandBeginRenderPass* command = reinterpret_cast<const RendererCommandBeginRenderPass*>(commandListIterator);
+			if (renderPassStarted)
+			{
+				ReportError(commandOffset, "Render pass started inside of another render pass");
+			}
+			if (command->ColorTarget.Texture == sInvalidHandle && command->DepthStencilTarget.Texture == sInvalidHandle)
+			{
+				ReportError(commandOffset, "Render pass without any targets");
+			}
+			renderPassStarted = true;
+			++m_LastFrameStatistics.RenderPasses;
+
+			commandListIterator += sizeof(RendererCommandBeginRenderPass);
+			break;
+		}
+		case RendererCommandType::EndRenderPass:
+		{
+			if (!renderPassStarted)
+			{
+				ReportError(commandOffset, "Render pass ended without being started");
+			}
+			renderPassStarted = false;
+
+			commandListIterator += sizeof(RendererCommandEndRenderPass);
+			break;
+		}
+		case RendererCommandType::Barrier:
+		{
+			if (!hasRoomFor(sizeof(RendererCommandBarrier)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			++m_LastFrameStatistics.BarrierBatches;
+			ValidateBarrier(commandOffset, *reinterpret_cast<const RendererCommandBarrier*>(commandListIterator));
+
+			commandListIterator += sizeof(RendererCommandBarrier);
+			break;
+		}
+		case RendererCommandType::BarrierBatch:
+		{
+			const RendererCommandBarrierBatch* command = reinterpret_cast<const RendererCommandBarrierBatch*>(commandListIterator);
+			if (!hasRoomFor(sizeof(RendererCommandBarrierBatch)) || !hasRoomFor(sizeof(RendererCommandBarrierBatch) + sizeof(RendererCommandBarrier) * size_t(command->BarrierCount)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			if (command->BarrierCount == 0)
+			{
+				ReportError(commandOffset, "Empty barrier batch");
+			}
+			++m_LastFrameStatistics.BarrierBatches;
+
+			commandListIterator += sizeof(RendererCommandBarrierBatch);
+			const RendererCommandBarrier* barriers = reinterpret_cast<const RendererCommandBarrier*>(commandListIterator);
+			for (uint32_t i = 0; i < command->BarrierCount; ++i)
+			{
+				ValidateBarrier(commandOffset, barriers[i]);
+			}
+
+			commandListIterator += sizeof(RendererCommandBarrier) * command->BarrierCount;
+			break;
+		}
+		case RendererCommandType::UpdateBuffer:
+		{
+			const RendererCommandUpdateBuffer* command = reinterpret_cast<const RendererCommandUpdateBuffer*>(commandListIterator);
+			if (!hasRoomFor(sizeof(RendererCommandUpdateBuffer)) || !hasRoomFor(sizeof(RendererCommandUpdateBuffer) + sizeof(RendererBufferUpdateRegion) * size_t(command->RegionCount)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			if (renderPassStarted)
+			{
+				ReportError(commandOffset, "Buffer update inside of a render pass");
+			}
+			if (command->RegionCount == 0)
+			{
+				ReportError(commandOffset, "Empty buffer update");
+			}
+			++m_LastFrameStatistics.BufferUpdates;
+
+			commandListIterator += sizeof(RendererCommandUpdateBuffer);
+			const RendererBufferUpdateRegion* regions = reinterpret_cast<const RendererBufferUpdateRegion*>(commandListIterator);
+			for (uint32_t i = 0; i < command->RegionCount; ++i)
+			{
+				if (m_ConstantBufferSize != 0 && uint64_t(regions[i].ConstantDataOffset) + regions[i].Size > m_ConstantBufferSize)
+				{
+					eastl::string message;
+					message.sprintf("Buffer update region %u reads outside of the constant buffer", i);
+					ReportError(commandOffset, message.c_str());
+				}
+				++m_LastFrameStatistics.BufferUpdateRegions;
+				m_LastFrameStatistics.BufferUpdateBytes += regions[i].Size;
+			}
+
+			commandListIterator += sizeof(RendererBufferUpdateRegion) * command->RegionCount;
+			break;
+		}
+		case RendererCommandType::DrawInstanced:
+		{
+			if (!hasRoomFor(sizeof(RendererCommandDrawInstanced)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			const RendererCommandDrawInstanced* command = reinterpret_cast<const RendererCommandDrawInstanced*>(commandListIterator);
+			if (!renderPassStarted)
+			{
+				ReportError(commandOffset, "Draw outside of a render pass");
+			}
+			ValidateShaderParameters(commandOffset, command->Pipeline, command->ParameterViews);
+			if (currentPipeline != command->Pipeline)
+			{
+				currentPipeline = command->Pipeline;
+				++m_LastFrameStatistics.PipelineChanges;
+			}
+			++m_LastFrameStatistics.DrawInstanced;
+			m_LastFrameStatistics.Vertices += command->VertexCountPerInstance * command->InstanceCount;
+			m_LastFrameStatistics.Instances += command->InstanceCount;
+
+			commandListIterator += sizeof(RendererCommandDrawInstanced);
+			break;
+		}
+		case RendererCommandType::DrawMeshlet:
+		{
+			if (!hasRoomFor(sizeof(RendererCommandDrawMeshlet)))
+			{
+				ReportError(commandOffset, "Truncated command");
+				commandListIterator = commandListEnd;
+				break;
+			}
+			const RendererCommandDrawMeshlet* command = reinterpret_cast<const RendererCommandDrawMeshlet*>(commandListIterator);
+			if (!renderPassStarted)
+			{
+				ReportError(commandOffset, "Draw outside of a render pass");
+			}
+			ValidateShaderParameters(commandOffset, command->Pipeline, command->ParameterViews);
+			if (currentPipeline != command->Pipeline)
+			{
+				currentPipeline = command->Pipeline;
+				++m_LastFrameStatistics.PipelineChanges;
+			}
+			++m_LastFrameStatistics.DrawMeshlet;
+			m_LastFrameStatistics.Meshlets += command->MeshletCount;
+
+			commandListIterator += sizeof(RendererCommandDrawMeshlet);
+			break;
+		}
+		default:
+			// We cannot know the size of the command, so there is no way to continue
+			ReportError(commandOffset, "Unknown command type");
+			commandListIterator = commandListEnd;
+			break;
+		}
+	}
+
+	const uint32_t endOffset = uint32_t(commandList.m_DataBuffer.size());
+	if (renderPassStarted)
+	{
+		ReportError(endOffset, "Render pass is not ended at the end of the frame");
+	}
+	for (const auto& pending : m_PendingSplitTransitions)
+	{
+		eastl::string message;
+		message.sprintf("Split transition of texture %u is not finished at the end of the frame", pending.first);
+		ReportError(endOffset, message.c_str());
+	}
+	m_PendingSplitTransitions.clear();
+
+	OPTICK_TAG("Commands", m_LastFrameStatistics.Commands);
+	OPTICK_TAG("Validation Errors", m_LastFrameStatistics.Errors);
+	return m_LastFrameStatistics.Errors == 0;
+}
+
+eastl::string CommandListValidator::SerializeCommandList(const RendererCommandList& commandList)
+{
+	eastl::string result;
+	auto appendParameters = [&result](const ShaderParameterView parameters[size_t(ShaderParameterType::Count)]) {
+		result.append_sprintf(" Scene=%u Geometry=%u",
+			parameters[size_t(ShaderParameterType::Scene)].ConstantDataOffset,
+			parameters[size_t(ShaderParameterType::Geometry)].ConstantDataOffset
+		);
+	};
+	auto appendBarrier = [&result](const RendererCommandBarrier& barrier) {
+		result.append_sprintf("%s Texture=%u %s -> %s\n", BarrierKindName(barrier.Kind), barrier.TextureHandle, ResourceStateName(barrier.BeforeState), ResourceStateName(barrier.AfterState));
+	};
+
+	const uint8_t* commandListIterator = commandList.m_DataBuffer.begin();
+	while (commandListIterator && commandListIterator < commandList.m_DataBuffer.end())
+	{
+		RendererCommandType type = reinterpret_cast<const RendererCommand<RendererCommandType::Count>*>(commandListIterator)->Type;
+		switch (type)
+		{
+		case RendererCommandType::BeginRenderPass:
+		{
+			const RendererCommandBeginRenderPass* command = reinterpret_cast<const RendererCommandBeginRenderPass*>(commandListIterator);
+			result.append_sprintf("BeginRenderPass Color=%u %s/%s DepthStencil=%u %s/%s\n",
+				command->ColorTarget.Texture, LoadActionName(command->ColorTarget.LoadAction), StoreActionName(command->ColorTarget.StoreAction),
+				command->DepthStencilTarget.Texture, LoadActionName(command->DepthStencilTarget.LoadAction), StoreActionName(command->DepthStencilTarget.StoreAction)
+			);
+			commandListIterator += sizeof(RendererCommandBeginRenderPass);
+			break;
+		}
+		case RendererCommandType::EndRenderPass:
+			result += "EndRenderPass\n";
+			commandListIterator += sizeof(RendererCommandEndRenderPass);
+			break;
+		case RendererCommandType::Barrier:
+			appendBarrier(*reinterpret_cast<const RendererCommandBarrier*>(commandListIterator));
+			commandListIterator += sizeof(RendererCommandBarrier);
+			break;
+		case RendererCommandType::BarrierBatch:
+		{
+			const RendererCommandBarrierBatch* command = reinterpret_cast<const RendererCommandBarrierBatch*>(commandListIterator);
+			result.append_sprintf("BarrierBatch Count=%u\n", command->BarrierCount);
+			commandListIterator += sizeof(RendererCommandBarrierBatch);
+
+			const RendererCommandBarrier* barriers = reinterpret_cast<const RendererCommandBarrier*>(commandListIterator);
+			for (uint32_t i = 0; i < command->BarrierCount; ++i)
+			{
+				result += "\t";
+				appendBarrier(barriers[i]);
+			}
+			commandListIterator += sizeof(RendererCommandBarrier) * command->BarrierCount;
+			break;
+		}
+		case RendererCommandType::UpdateBuffer:
+		{
+			const RendererCommandUpdateBuffer* command = reinterpret_cast<const RendererCommandUpdateBuffer*>(commandListIterator);
+			result.append_sprintf("UpdateBuffer Buffer=%u Count=%u\n", command->Buffer, command->RegionCount);
+			commandListIterator += sizeof(RendererCommandUpdateBuffer);
+
+			const RendererBufferUpdateRegion* regions = reinterpret_cast<const RendererBufferUpdateRegion*>(commandListIterator);
+			for (uint32_t i = 0; i < command->RegionCount; ++i)
+			{
+				result.append_sprintf("\tRegion Destination=%u Source=%u Size=%u\n", regions[i].DestinationOffset, regions[i].ConstantDataOffset, regions[i].Size);
+			}
+			commandListIterator += sizeof(RendererBufferUpdateRegion) * command->RegionCount;
+			break;
+		}
+		case RendererCommandType::DrawInstanced:
+		{
+			const RendererCommandDrawInstanced* command = reinterpret_cast<const RendererCommandDrawInstanced*>(commandListIterator);
+			result.append_sprintf("DrawInstanced Pipeline=%u", command->Pipeline);
+			appendParameters(command->ParameterViews);
+			result.append_sprintf(" Vertices=%u Instances=%u\n", command->VertexCountPerInstance, command->InstanceCount);
+			commandListIterator += sizeof(RendererCommandDrawInstanced);
+			break;
+		}
+		case RendererCommandType::DrawMeshlet:
+		{
+			const RendererCommandDrawMeshlet* command = reinterpret_cast<const RendererCommandDrawMeshlet*>(commandListIterator);
+			result.append_sprintf("DrawMeshlet Pipeline=%u", command->Pipeline);
+			appendParameters(command->ParameterViews);
+			result.append_sprintf(" Meshlets=%u\n", command->MeshletCount);
+			commandListIterator += sizeof(RendererCommandDrawMeshlet);
+			break;
+		}
+		default:
+			result.append_sprintf("Unknown command type %u, stopping\n", uint32_t(type));
+			commandListIterator = commandList.m_DataBuffer.end();
+			break;
+		}
+	}
+	return result;
+}
+
+bool CommandListValidator::SerializeToFile(const RendererCommandList& commandList, const char* filePath)
+{
+	OPTICK_EVENT();
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream.good())
+	{
+		FORMAT_LOG(Error, Renderer, "Cannot open %s for writing the command list", filePath);
+		return false;
+	}
+
+	eastl::string data = SerializeCommandList(commandList);
+	stream.write(data.data(), data.size());
+	return stream.good();
+}
+}
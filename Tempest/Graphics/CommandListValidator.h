@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+#include <Graphics/RendererCommandList.h>
+
+namespace Tempest
+{
+struct CommandListStatistics
+{
+	uint32_t Commands = 0;
+	uint32_t CommandBytes = 0;
+	uint32_t RenderPasses = 0;
+	uint32_t DrawInstanced = 0;
+	uint32_t DrawMeshlet = 0;
+	uint32_t Vertices = 0;
+	uint32_t Instances = 0;
+	uint32_t Meshlets = 0;
+	uint32_t PipelineChanges = 0;
+	uint32_t BarrierBatches = 0;
+	uint32_t Transitions = 0;
+	uint32_t SplitTransitions = 0;
+	uint32_t AliasingBarriers = 0;
+	uint32_t BufferUpdates = 0;
+	uint32_t BufferUpdateRegions = 0;
+	uint32_t BufferUpdateBytes = 0;
+	uint32_t Errors = 0;
+};
+
+// Walks the command stream the same way the Dx12 backend does, but without a device. It validates the stream and gathers
+// statistics, and can write it in a text form, which is easy to diff between two runs.
+// It only checks the commands. The Renderer still records them through the Dx12 managers, so it runs next to the Dx12 backend
+// and does not replace it.
+class CommandListValidator : Utils::NonCopyable
+{
+public:
+	// Only registered pipelines are considered valid in the draw commands
+	void RegisterPipelineState(PipelineStateHandle handle);
+	// Constant data offsets must fall inside the constant buffer. 0 disables the check
+	void SetConstantBufferSize(uint64_t size);
+
+	// Returns false if any validation error was found. Every error is logged and stored
+	bool Validate(const RendererCommandList& commandList);
+
+	const CommandListStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+
+	const eastl::vector<eastl::string>& GetLastFrameErrors() const
+	{
+		return m_LastFrameErrors;
+	}
+
+	// One command per line. Handles and offsets are written as they are, so two streams diff cleanly only
+	// if they were recorded from the same initial state
+	static eastl::string SerializeCommandList(const RendererCommandList& commandList);
+	static bool SerializeToFile(const RendererCommandList& commandList, const char* filePath);
+private:
+	void ReportError(uint32_t commandOffset, const char* message);
+	void ValidateShaderParameters(uint32_t commandOffset, PipelineStateHandle pipeline, const ShaderParameterView parameters[size_t(ShaderParameterType::Count)]);
+	void ValidateBarrier(uint32_t commandOffset, const RendererCommandBarrier& barrier);
+
+	eastl::vector<PipelineStateHandle> m_Pipelines;
+	uint64_t m_ConstantBufferSize = 0;
+
+	// Last known state of every texture, which persists between frames like the resources themselves
+	eastl::unordered_map<TextureHandle, ResourceState> m_TextureStates;
+	eastl::unordered_map<TextureHandle, RendererCommandBarrier> m_PendingSplitTransitions;
+
+	CommandListStatistics m_LastFrameStatistics;
+	eastl::vector<eastl::string> m_LastFrameErrors;
+};
+}
@@ -12,6 +12,7 @@
 #endif
 
 #include <eastl/optional.h>
+#include <cstdlib>
 
 namespace Tempest
 {
@@ -39,7 +40,7 @@ Backend::~Backend()
 
 void Backend::Initialize(WindowHandle handle)
 {
-	m_Device->Initialize(handle);
+	m_Device->Initialize(handle, gEngineCore->GetJobSystem());
 }
 
 void Backend::RenderFrame(const RendererCommandList& commandList)
@@ -71,6 +72,38 @@ void Backend::RenderFrame(const RendererCommandList& commandList)
 		}
 	};
 
+	eastl::vector<D3D12_RESOURCE_BARRIER> barriers;
+	auto recordBarriers = [&](const RendererCommandBarrier* commands, uint32_t count) {
+		barriers.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const RendererCommandBarrier& command = commands[i];
+			D3D12_RESOURCE_BARRIER& barrier = barriers.push_back();
+			if (command.Kind == BarrierKind::Aliasing)
+			{
+				// We don't track which resource was using the memory before, so use null resource which means any placed resource could be the previous one
+				barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+				barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+				barrier.Aliasing.pResourceBefore = nullptr;
+				barrier.Aliasing.pResourceAfter = Managers.Texture.GetTexture(command.TextureHandle);
+				continue;
+			}
+
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			switch (command.Kind)
+			{
+			case BarrierKind::TransitionBegin: barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY; break;
+			case BarrierKind::TransitionEnd: barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY; break;
+			default: barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE; break;
+			}
+			barrier.Transition.pResource = Managers.Texture.GetTexture(command.TextureHandle); // TODO: It could be a buffer ?
+			barrier.Transition.StateBefore = Dx12StateFromState(command.BeforeState);
+			barrier.Transition.StateAfter = Dx12StateFromState(command.AfterState);
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		}
+		frame.CommandList->ResourceBarrier(UINT(barriers.size()), barriers.data());
+	};
+
 	const uint8_t* commandListIterator = commandList.m_DataBuffer.begin();
 	while (commandListIterator && commandListIterator < commandList.m_DataBuffer.end())
 	{
@@ -102,13 +135,25 @@ void Backend::RenderFrame(const RendererCommandList& commandList)
 			}
 			else if (command->DepthStencilTarget.Texture != sInvalidHandle)
 			{
-				uint32_t slot = GetDevice()->m_DSVDescriptorHeap.AllocateDynamicResource();
-
-				D3D12_CPU_DESCRIPTOR_HANDLE heapStart = GetDevice()->m_DSVDescriptorHeap.Heap->GetCPUDescriptorHandleForHeapStart();
-				UINT heapIncrement = GetDevice()->GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
-				heapStart.ptr += heapIncrement * slot;
-				GetDevice()->GetDevice()->CreateDepthStencilView(Managers.Texture.GetTexture(command->DepthStencilTarget.Texture), nullptr, heapStart);
-				dsv = heapStart;
+				auto [slot, needsView] = GetDevice()->m_DSVDescriptorCache.GetOrAllocate(DescriptorViewKey{ command->DepthStencilTarget.Texture, DescriptorViewType::DepthStencil, DXGI_FORMAT_UNKNOWN });
+				if (slot == DescriptorCache::sInvalidSlot)
+				{
+					// Every cached view could still be used by the GPU, so this one lives only for the frame
+					slot = GetDevice()->m_DSVDescriptorHeap.AllocateDynamicResource();
+					needsView = true;
+				}
+
+				if (slot == TwoPartRingBufferDescriptorHeapManager::sInvalidSlot)
+				{
+					// The pass would be rendered without its depth target, same as the shader resources in the render graph
+					LOG(Fatal, Dx12, "No depth stencil descriptor left!");
+					std::abort();
+				}
+				dsv = GetDevice()->m_DSVDescriptorHeap.GetCPUHandle(slot);
+				if (needsView)
+				{
+					GetDevice()->GetDevice()->CreateDepthStencilView(Managers.Texture.GetTexture(command->DepthStencilTarget.Texture), nullptr, *dsv);
+				}
 
 				auto dimensions = Managers.Texture.GetTextureDimensions(command->DepthStencilTarget.Texture);
 				width = dimensions.x;
@@ -153,20 +198,49 @@ void Backend::RenderFrame(const RendererCommandList& commandList)
 		}
 		case RendererCommandType::Barrier:
 		{
-			// TODO: This needs to be batching. For now we are going to have a resource per command
-			// So we need to batch all consecutive barrier commands together and issue them at the same time
 			const RendererCommandBarrier* command = reinterpret_cast<const RendererCommandBarrier*>(commandListIterator);
+			recordBarriers(command, 1);
+
+			commandListIterator += sizeof(RendererCommandBarrier);
+			break;
+		}
+		case RendererCommandType::BarrierBatch:
+		{
+			const RendererCommandBarrierBatch* command = reinterpret_cast<const RendererCommandBarrierBatch*>(commandListIterator);
+			commandListIterator += sizeof(RendererCommandBarrierBatch);
+			recordBarriers(reinterpret_cast<const RendererCommandBarrier*>(commandListIterator), command->BarrierCount);
+
+			commandListIterator += sizeof(RendererCommandBarrier) * command->BarrierCount;
+			break;
+		}
+		case RendererCommandType::UpdateBuffer:
+		{
+			const RendererCommandUpdateBuffer* command = reinterpret_cast<const RendererCommandUpdateBuffer*>(commandListIterator);
+			commandListIterator += sizeof(RendererCommandUpdateBuffer);
+			const RendererBufferUpdateRegion* regions = reinterpret_cast<const RendererBufferUpdateRegion*>(commandListIterator);
+
+			ID3D12Resource* buffer = Managers.Buffer.GetBuffer(command->Buffer);
+			ID3D12Resource* constantBuffer = m_Device->GetConstantDataManager().GetBuffer();
 
 			D3D12_RESOURCE_BARRIER barrier;
 			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
 			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-			barrier.Transition.pResource = Managers.Texture.GetTexture(command->TextureHandle); // TODO: It could be a buffer ?
-			barrier.Transition.StateBefore = Dx12StateFromState(command->BeforeState);
-			barrier.Transition.StateAfter = Dx12StateFromState(command->AfterState);
+			barrier.Transition.pResource = buffer;
+			// Buffers in default heaps are kept in the common state and promoted implicitly by the reads
+			barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+			barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
 			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 			frame.CommandList->ResourceBarrier(1, &barrier);
 
-			commandListIterator += sizeof(RendererCommandBarrier);
+			for (uint32_t i = 0; i < command->RegionCount; ++i)
+			{
+				frame.CommandList->CopyBufferRegion(buffer, regions[i].DestinationOffset, constantBuffer, regions[i].ConstantDataOffset, regions[i].Size);
+			}
+
+			eastl::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+			frame.CommandList->ResourceBarrier(1, &barrier);
+
+			commandListIterator += sizeof(RendererBufferUpdateRegion) * command->RegionCount;
 			break;
 		}
 		case RendererCommandType::DrawInstanced:
@@ -197,63 +271,44 @@ void Backend::RenderFrame(const RendererCommandList& commandList)
 	m_Device->SubmitFrame(frame);
 
 	m_Device->Present();
+
+	Managers.TemporaryTexture.EndFrame();
+	Managers.Buffer.EndFrame();
 }
 
 UploadData Backend::PrepareUpload(uint32_t size)
 {
-	UploadData result;
-
-	D3D12_HEAP_PROPERTIES props;
-	::ZeroMemory(&props, sizeof(D3D12_HEAP_PROPERTIES));
-	props.Type = D3D12_HEAP_TYPE_UPLOAD;
-
-	D3D12_RESOURCE_DESC desc;
-	::ZeroMemory(&desc, sizeof(D3D12_RESOURCE_DESC));
-	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	desc.Width = size;
-	desc.Height = 1;
-	desc.DepthOrArraySize = 1;
-	desc.MipLevels = 1;
-	desc.Format = DXGI_FORMAT_UNKNOWN;
-	desc.SampleDesc.Count = 1;
-	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-	CHECK_SUCCESS(m_Device->GetDevice()->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&result.UploadHeap)));
-	
-	D3D12_RANGE range;
-	::ZeroMemory(&range, sizeof(D3D12_RANGE)); // This will tell that we won't read the data from CPU
-	CHECK_SUCCESS(result.UploadHeap->Map(0, &range, &result.MappedData));
-	result.CurrentOffset = 0;
-
-	// TODO: this could be copy only, but we cannot make any resource barriers on copy lists.
-	CHECK_SUCCESS(m_Device->GetDevice()->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&result.Allocator)));
-	result.Allocator->SetName(L"Copy Command Allocator");
-
-	CHECK_SUCCESS(m_Device->GetDevice()->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, result.Allocator.Get(), nullptr, IID_PPV_ARGS(&result.CommandList)));
-	result.CommandList->SetName(L"Copy Command List");
-
-	return result;
+	return m_Device->GetUploadManager().Allocate(size);
 }
 
-void Backend::ExecuteUpload(UploadData& uploadData)
+UploadTicket Backend::SubmitUpload(UploadData& uploadData)
 {
-	// For good measure
-	uploadData.UploadHeap->Unmap(0, nullptr);
-
-	uploadData.CommandList->Close();
-	ID3D12CommandList* cmdList = uploadData.CommandList.Get();
-	m_Device->m_GraphicsQueue->ExecuteCommandLists(1, &cmdList);
-	
-	const UINT64 fence = m_Device->m_FenceValue;
-	m_Device->m_GraphicsQueue->Signal(m_Device->m_Fence.Get(), fence);
-	m_Device->m_FenceValue++;
-
-	if(m_Device->m_Fence->GetCompletedValue() < m_Device->m_FenceValue - 1)
-	{
-		m_Device->m_Fence->SetEventOnCompletion(m_Device->m_FenceValue - 1, m_Device->m_FenceEvent);
-		WaitForSingleObject(m_Device->m_FenceEvent, INFINITE);
-	}
+	return m_Device->GetUploadManager().Submit(uploadData);
+}
+
+void Backend::WaitForUpload(UploadTicket ticket)
+{
+	m_Device->GetUploadManager().Wait(ticket);
+}
+
+bool Backend::IsUploadCompleted(UploadTicket ticket) const
+{
+	return m_Device->GetUploadManager().IsCompleted(ticket);
+}
+
+void Backend::MakeFrameWaitForUpload(UploadTicket ticket)
+{
+	m_Device->GetUploadManager().AddFrameDependency(ticket);
+}
+
+uint64_t Backend::GetSubmittedFrameFence() const
+{
+	return m_Device->m_FenceValue - 1;
+}
+
+bool Backend::IsFrameFenceCompleted(uint64_t fence) const
+{
+	return m_Device->m_Fence->GetCompletedValue() >= fence;
 }
 }
 }
\ No newline at end of file
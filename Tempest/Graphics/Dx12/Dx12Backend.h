@@ -42,15 +42,6 @@ struct BackendManagers
 	TemporaryTextureManager TemporaryTexture;
 };
 
-struct UploadData
-{
-	ComPtr<ID3D12CommandAllocator> Allocator;
-	ComPtr<ID3D12GraphicsCommandList6> CommandList;
-	ComPtr<ID3D12Resource> UploadHeap;
-	void* MappedData;
-	uint64_t CurrentOffset;
-};
-
 class Backend : Utils::NonCopyable
 {
 public:
@@ -62,8 +53,18 @@ public:
 	void RenderFrame(const RendererCommandList& commandList);
 
 	Dx12Device* GetDevice() const { return m_Device.get(); }
+	// Safe to be called from multiple jobs at the same time
 	UploadData PrepareUpload(uint32_t size);
-	void ExecuteUpload(UploadData& uploadData);
+	// Queues the copies for the copy queue. The uploaded resources can be used once the upload is completed,
+	// or by the next frame if it is made to wait for it
+	UploadTicket SubmitUpload(UploadData& uploadData);
+	void WaitForUpload(UploadTicket ticket);
+	bool IsUploadCompleted(UploadTicket ticket) const;
+	// The next frame waits on the GPU for the upload, without blocking the CPU
+	void MakeFrameWaitForUpload(UploadTicket ticket);
+	// Fence value signaled after the last submitted frame. Resources used by the frames until now can be destroyed when it is completed
+	uint64_t GetSubmittedFrameFence() const;
+	bool IsFrameFenceCompleted(uint64_t fence) const;
 private:
 	eastl::unique_ptr<Dx12Device> m_Device;
 public:
@@ -81,6 +81,7 @@ Dx12Device::Dx12Device()
 
 Dx12Device::~Dx12Device()
 {
+	m_UploadManager.Destroy();
 	m_DSVDescriptorHeap.Destroy();
 	m_RTVDescriptorHeap.Destroy();
 	m_MainDescriptorHeap.Destroy();
@@ -90,7 +91,7 @@ Dx12Device::~Dx12Device()
 	ImGui_ImplDX12_Shutdown();
 }
 
-void Dx12Device::Initialize(WindowHandle handle)
+void Dx12Device::Initialize(WindowHandle handle, Job::JobSystem& jobSystem)
 {
 	DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
 	swapChainDesc.BufferCount = 2;
@@ -123,13 +124,23 @@ void Dx12Device::Initialize(WindowHandle handle)
 
 	FORMAT_LOG(Info, Dx12, "Initialized Swap Chain with size %d %d", m_SwapChainSize.x, m_SwapChainSize.y);
 
+	// Create synchronization objects. The descriptor heaps need the fence for their rings
+	{
+		m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence));
+		m_FenceValue = 1;
+
+		// Create an event handle to use for frame synchronization.
+		m_FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	}
+
 	UINT rtvDescriptorSize = m_Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	// Create descriptor heaps.
-	m_RTVDescriptorHeap.Initialize(m_Device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 1000);
+	m_RTVDescriptorHeap.Initialize(m_Device.Get(), m_Fence.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 64);
 	m_RTVDescriptorHeap.AllocateStaticResources(2); // 2 Backbuffer rtvs
 
-	m_DSVDescriptorHeap.Initialize(m_Device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 1000);
+	m_DSVDescriptorHeap.Initialize(m_Device.Get(), m_Fence.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 256);
 	m_DSVDescriptorHeap.AllocateStaticResources(1); // 1 Backbuffer depth stencil
+	m_DSVDescriptorCache.Initialize(m_DSVDescriptorHeap, 128);
 
 	// Create frame resources.
 	{
@@ -191,15 +202,6 @@ void Dx12Device::Initialize(WindowHandle handle)
 		}
 	}
 
-	// Create synchronization objects.
-	{
-		m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence));
-		m_FenceValue = 1;
-
-		// Create an event handle to use for frame synchronization.
-		m_FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-	}
-
 	// Create Command Lists for number of back buffers
 	for (int i = 0; i < m_SwapChainImages.size(); ++i)
 	{
@@ -216,7 +218,8 @@ void Dx12Device::Initialize(WindowHandle handle)
 		m_MainCommandLists.push_back({ allocator, list });
 	}
 
-	m_ConstantBufferData.Initialize(m_Device.Get());
+	m_ConstantBufferData.Initialize(m_Device.Get(), m_Fence.Get());
+	m_UploadManager.Initialize(m_Device.Get(), jobSystem);
 
 	// Initialize UI
 	{
@@ -310,6 +313,11 @@ void Dx12Device::SubmitFrame(const Dx12FrameData& frame)
 
 	frame.CommandList->Close();
 
+	// Uploads are copied on their own queue, so the frame must not start before the ones it reads are done.
+	// The rest keep copying while the frame renders
+	m_UploadManager.EndFrame();
+	m_UploadManager.QueueWaitForFrameDependencies(m_GraphicsQueue.Get());
+
 	ID3D12CommandList* cmdList = frame.CommandList;
 	m_GraphicsQueue->ExecuteCommandLists(1, &cmdList);
 }
@@ -322,6 +330,15 @@ void Dx12Device::Present()
 	m_GraphicsQueue->Signal(m_Fence.Get(), fence);
 	m_FenceValue++;
 
+	// All constant data written for this frame is released when this fence is reached
+	m_ConstantBufferData.EndFrame(fence);
+	// Same for the descriptors allocated in this frame
+	m_MainDescriptorHeap.EndFrame(fence);
+	m_RTVDescriptorHeap.EndFrame(fence);
+	m_DSVDescriptorHeap.EndFrame(fence);
+	m_MainDescriptorCache.EndFrame();
+	m_DSVDescriptorCache.EndFrame();
+
 	// Wait until the previous frame is finished.
 	if (m_Fence->GetCompletedValue() < m_FenceValue - 2)
 	{
@@ -332,8 +349,14 @@ void Dx12Device::Present()
 
 void Dx12Device::AllocateMainDescriptorHeap(const int numTextures)
 {
-	m_MainDescriptorHeap.Initialize(m_Device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1000000 /* Hardware Tier 1 limit*/);
-	m_MainDescriptorHeap.AllocateStaticResources(static_cast<int>(ShaderResourceSlot::NonTextureCount) + numTextures);
+	// The ring is fenced per frame, so it needs to hold only the descriptors of the frames in flight
+	const uint32_t cachedDescriptors = 1024;
+	const uint32_t dynamicDescriptors = 16 * 1024;
+	// Streamed textures alternate between two slots, so a new mip range never rewrites the descriptor of a frame in flight
+	const uint32_t staticDescriptors = static_cast<uint32_t>(ShaderResourceSlot::NonTextureCount) + 2 * numTextures;
+	m_MainDescriptorHeap.Initialize(m_Device.Get(), m_Fence.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, staticDescriptors + cachedDescriptors + dynamicDescriptors);
+	m_MainDescriptorHeap.AllocateStaticResources(staticDescriptors);
+	m_MainDescriptorCache.Initialize(m_MainDescriptorHeap, cachedDescriptors);
 }
 
 void Dx12Device::AddStaticTextureDescriptor(ID3D12Resource* resource, DXGI_FORMAT format, uint32_t mipLevels, uint32_t slot)
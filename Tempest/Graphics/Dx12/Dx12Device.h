@@ -2,7 +2,9 @@
 
 #include <Graphics/Dx12/Dx12Common.h>
 #include <Graphics/Dx12/Managers/TwoPartRingBufferDescriptorHeapManager.h>
+#include <Graphics/Dx12/Managers/DescriptorCache.h>
 #include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
+#include <Graphics/Dx12/Managers/UploadManager.h>
 #include <Graphics/Dx12/Managers/TextureManager.h>
 #include <Platform/WindowsPlatform.h>
 
@@ -24,7 +26,7 @@ class Dx12Device : Utils::NonCopyable
 public:
 	Dx12Device();
 	~Dx12Device();
-	void Initialize(WindowHandle handle);
+	void Initialize(WindowHandle handle, Job::JobSystem& jobSystem);
 	Dx12FrameData StartNewFrame();
 	void SubmitFrame(const Dx12FrameData& frame);
 	void Present();
@@ -43,6 +45,11 @@ public:
 		return m_ConstantBufferData;
 	}
 
+	UploadManager& GetUploadManager()
+	{
+		return m_UploadManager;
+	}
+
 	void AllocateMainDescriptorHeap(const int numTextures);
 
 	// TODO: This should be refactored
@@ -53,9 +60,22 @@ public:
 		MeshletIndices,
 		MeshletVertices,
 		Materials,
-		TextureStart,
+		// Heap index of the current descriptor of every streamed texture
+		TextureSlots,
+		// Growable buffers alternate between their slot and a second one after all of them
+		Instances,
+		LocalLights,
+		LightClusters,
+		LightIndices,
+		GrowableEnd,
+		TextureStart = GrowableEnd + (GrowableEnd - Instances),
 		NonTextureCount = TextureStart
 	};
+	static uint32_t GetSecondGrowableSlot(ShaderResourceSlot slot)
+	{
+		assert(slot >= ShaderResourceSlot::Instances && slot < ShaderResourceSlot::GrowableEnd);
+		return uint32_t(slot) + uint32_t(ShaderResourceSlot::GrowableEnd) - uint32_t(ShaderResourceSlot::Instances);
+	}
 	void AddStaticBufferDescriptor(ID3D12Resource* resource, uint32_t numElements, uint32_t stride, ShaderResourceSlot slot) const;
 	void AddStaticTextureDescriptor(ID3D12Resource* resource, DXGI_FORMAT format, uint32_t mipLevels, uint32_t slot);
 	// TODO: Remove this abstraction and just use device code inside the backend
@@ -88,7 +108,10 @@ public:
 	TwoPartRingBufferDescriptorHeapManager m_MainDescriptorHeap;
 	TwoPartRingBufferDescriptorHeapManager m_RTVDescriptorHeap;
 	TwoPartRingBufferDescriptorHeapManager m_DSVDescriptorHeap;
+	DescriptorCache m_MainDescriptorCache;
+	DescriptorCache m_DSVDescriptorCache;
 	ConstantBufferDataManager m_ConstantBufferData;
+	UploadManager m_UploadManager;
 
 	// UI Stuff
 	// TODO: Merge this with main descriptor heap
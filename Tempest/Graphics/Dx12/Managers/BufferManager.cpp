@@ -46,26 +46,18 @@ BufferHandle BufferManager::CreateBuffer(const BufferDescription& description, U
 
 	PipelineStateHandle resultHandle = m_NextHandle++;
 	ComPtr<ID3D12Resource>& buffer = m_Buffers[resultHandle];
-	D3D12_RESOURCE_STATES state = description.Data ? D3D12_RESOURCE_STATE_COPY_DEST : D3D12_RESOURCE_STATE_GENERIC_READ;
+	// Buffers in default heaps stay in the common state, as the copy queue leaves them there and reads promote them implicitly
+	D3D12_RESOURCE_STATES state = props.Type == D3D12_HEAP_TYPE_UPLOAD ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON;
 	CHECK_SUCCESS(m_Device.GetDevice()->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, state, NULL, IID_PPV_ARGS(&buffer)));
 
 	if(description.Data && upload)
 	{
+		assert(props.Type == D3D12_HEAP_TYPE_DEFAULT);
+		assert(upload->CurrentOffset + description.Size <= upload->EndOffset);
 		memcpy(reinterpret_cast<uint8_t*>(upload->MappedData) + upload->CurrentOffset, description.Data, description.Size);
 
 		upload->CommandList->CopyBufferRegion(buffer.Get(), 0, upload->UploadHeap.Get(), upload->CurrentOffset, description.Size);
 		upload->CurrentOffset += description.Size;
-
-		D3D12_RESOURCE_BARRIER barrier;
-		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-		barrier.Transition.pResource = buffer.Get();
-		barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-		barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ;
-		barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-
-		// TODO: Batch those
-		upload->CommandList->ResourceBarrier(1, &barrier);
 	}
 
 	return resultHandle;
@@ -101,6 +93,66 @@ D3D12_GPU_VIRTUAL_ADDRESS BufferManager::GetGPUAddress(BufferHandle handle)
 	return m_Buffers[handle]->GetGPUVirtualAddress();
 }
 
+void BufferManager::GrowBuffer(GrowableBuffer& buffer, Dx12Device::ShaderResourceSlot slot, uint32_t requiredCount, uint32_t minCapacity, uint32_t stride, const void* data, uint32_t dataSize)
+{
+	if (buffer.Capacity != 0 && requiredCount <= buffer.Capacity)
+	{
+		return;
+	}
+
+	OPTICK_EVENT();
+	uint32_t newCapacity = eastl::max(buffer.Capacity, minCapacity);
+	while (newCapacity < requiredCount)
+	{
+		newCapacity *= 2;
+	}
+
+	const uint32_t bufferSize = newCapacity * stride;
+	assert(dataSize <= bufferSize);
+	const BufferHandle newBuffer = CreateBuffer(BufferDescription{ BufferType::Vertex, bufferSize, nullptr }, nullptr);
+	if (data && dataSize > 0)
+	{
+		UploadManager& uploadManager = m_Device.GetUploadManager();
+		UploadData upload = uploadManager.Allocate(dataSize);
+		memcpy(reinterpret_cast<uint8_t*>(upload.MappedData) + upload.CurrentOffset, data, dataSize);
+		upload.CommandList->CopyBufferRegion(GetBuffer(newBuffer), 0, upload.UploadHeap.Get(), upload.CurrentOffset, dataSize);
+		upload.CurrentOffset += dataSize;
+		uploadManager.AddFrameDependency(uploadManager.Submit(upload));
+	}
+
+	uint32_t descriptorIndex = uint32_t(slot);
+	if (buffer.Capacity != 0)
+	{
+		descriptorIndex = buffer.DescriptorIndex == uint32_t(slot) ? Dx12Device::GetSecondGrowableSlot(slot) : uint32_t(slot);
+		// Present keeps a single frame in flight, so this waits only if the buffer grows twice before the next frame
+		if (m_Device.m_Fence->GetCompletedValue() < buffer.PreviousViewFence)
+		{
+			OPTICK_EVENT("Wait For Previous Buffer View");
+			CHECK_SUCCESS(m_Device.m_Fence->SetEventOnCompletion(buffer.PreviousViewFence, m_Device.m_FenceEvent));
+			::WaitForSingleObject(m_Device.m_FenceEvent, INFINITE);
+		}
+
+		const uint64_t submittedFrameFence = m_Device.m_FenceValue - 1;
+		m_RetiredBuffers.push_back(RetiredBuffer{ buffer.Handle, submittedFrameFence });
+		buffer.PreviousViewFence = submittedFrameFence;
+	}
+	m_Device.AddStaticBufferDescriptor(GetBuffer(newBuffer), newCapacity, stride, Dx12Device::ShaderResourceSlot(descriptorIndex));
+
+	buffer.Handle = newBuffer;
+	buffer.Capacity = newCapacity;
+	buffer.DescriptorIndex = descriptorIndex;
+}
+
+void BufferManager::EndFrame()
+{
+	const uint64_t completedFence = m_Device.m_Fence->GetCompletedValue();
+	while (!m_RetiredBuffers.empty() && m_RetiredBuffers.front().FrameFence <= completedFence)
+	{
+		DestroyBuffer(m_RetiredBuffers.front().Handle);
+		m_RetiredBuffers.pop_front();
+	}
+}
+
 //ComPtr<ID3D12Resource> BufferManager::CreateStagingBuffer(size_t size)
 //{
 //	D3D12_HEAP_PROPERTIES props;
@@ -4,6 +4,8 @@
 #include <Graphics/Dx12/Dx12Device.h>
 #include <Graphics/RendererTypes.h>
 
+#include <EASTL/deque.h>
+
 namespace Tempest
 {
 namespace Dx12
@@ -36,11 +38,26 @@ public:
 	void DestroyBuffer(BufferHandle handle);
 
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUAddress(BufferHandle handle);
+
+	// Grows the buffer by doubling until the count fits, the data is uploaded at the start of the new buffer.
+	// The next frame waits on the GPU for the upload. The view of the new buffer goes in the other slot of the two,
+	// so the views read by the frames in flight are never rewritten, and the old buffer is destroyed after those frames.
+	// Must be called before the frame is recorded, the frame reads the buffer through its DescriptorIndex
+	void GrowBuffer(GrowableBuffer& buffer, Dx12Device::ShaderResourceSlot slot, uint32_t requiredCount, uint32_t minCapacity, uint32_t stride, const void* data, uint32_t dataSize);
+	// Destroys the replaced buffers which the GPU is done with
+	void EndFrame();
 private:
+	struct RetiredBuffer
+	{
+		BufferHandle Handle;
+		uint64_t FrameFence;
+	};
+
 	//ComPtr<ID3D12Resource> CreateStagingBuffer(size_t size);
 	//void InitializeBufferData(ID3D12Resource* dst, size_t size, const void* data);
 
 	eastl::unordered_map<BufferHandle, ComPtr<ID3D12Resource>> m_Buffers;
+	eastl::deque<RetiredBuffer> m_RetiredBuffers;
 	BufferHandle m_NextHandle = 0;
 	Dx12Device& m_Device;
 };
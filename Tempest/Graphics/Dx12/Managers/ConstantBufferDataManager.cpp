@@ -2,14 +2,62 @@
 
 #include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
 
+#include <cstdlib>
+
 namespace Tempest
 {
 namespace Dx12
 {
-void ConstantBufferDataManager::Initialize(ID3D12Device3* device)
+// Block of the ring owned by the current worker thread. Only valid for the frame it was taken in.
+struct WorkerConstantBlock
+{
+	const ConstantBufferDataManager* Owner = nullptr;
+	uint64_t Frame = 0;
+	uint64_t Current = 0;
+	uint64_t End = 0;
+};
+
+static thread_local WorkerConstantBlock tlsWorkerBlock;
+
+void ConstantBufferDataManager::Initialize(ID3D12Device3* device, ID3D12Fence* fence)
 {
+	m_Device = device;
+	m_Fence = fence;
+	m_FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
 	// Somewhat random
-	m_Capacity = 100000;
+	const uint32_t capacity = 100000;
+	CreateBuffer(((capacity + sSlotsPerWorkerBlock - 1) / sSlotsPerWorkerBlock) * sSlotsPerWorkerBlock);
+}
+
+void ConstantBufferDataManager::Destroy()
+{
+	m_Capacity = 0;
+	m_NextVirtualSlot = 0;
+	m_VirtualLimit = 0;
+	m_InFlightRegions.clear();
+
+	m_Buffer->Unmap(0, nullptr);
+	m_Buffer.Reset();
+
+	CloseHandle(m_FenceEvent);
+	m_FenceEvent = nullptr;
+}
+
+void ConstantBufferDataManager::CreateBuffer(uint32_t capacity)
+{
+	if (m_Buffer)
+	{
+		m_Buffer->Unmap(0, nullptr);
+		m_Buffer.Reset();
+	}
+
+	m_Capacity = capacity;
+	m_NextVirtualSlot = 0;
+	m_VirtualLimit = m_Capacity;
+	m_ReleasedVirtualEnd = 0;
+	m_CurrentFrameStart = 0;
+	m_InFlightRegions.clear();
 
 	D3D12_HEAP_PROPERTIES props;
 	::ZeroMemory(&props, sizeof(D3D12_HEAP_PROPERTIES));
@@ -18,7 +66,7 @@ void ConstantBufferDataManager::Initialize(ID3D12Device3* device)
 	D3D12_RESOURCE_DESC desc;
 	::ZeroMemory(&desc, sizeof(D3D12_RESOURCE_DESC));
 	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	desc.Width = m_Capacity * sAlignment;
+	desc.Width = uint64_t(m_Capacity) * sAlignment;
 	desc.Height = 1;
 	desc.DepthOrArraySize = 1;
 	desc.MipLevels = 1;
@@ -27,43 +75,154 @@ void ConstantBufferDataManager::Initialize(ID3D12Device3* device)
 	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-	CHECK_SUCCESS(device->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&m_Buffer)));
+	CHECK_SUCCESS(m_Device->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&m_Buffer)));
+	m_Buffer->SetName(L"Constant Buffer Ring");
 
 	D3D12_RANGE range;
 	::ZeroMemory(&range, sizeof(D3D12_RANGE)); // This will tell that we won't read the data from CPU
 	CHECK_SUCCESS(m_Buffer->Map(0, &range, reinterpret_cast<void**>(&m_PersistentMappedMemoryPointer)));
 }
 
-void ConstantBufferDataManager::Destroy()
+uint32_t ConstantBufferDataManager::AddDataInternal(const void* data, uint32_t size)
 {
-	m_Capacity = 0;
-	m_CurrentSlot = 0;
+	const uint32_t numSlotsRequired = (size + (sAlignment - 1)) / sAlignment;
+	const uint64_t allocatedVirtualSlot = ReserveSlots(numSlotsRequired);
+	const uint32_t allocatedSlot = uint32_t(allocatedVirtualSlot % m_Capacity);
 
-	m_Buffer->Unmap(0, nullptr);
-	m_Buffer.Reset();
+	m_BytesRequested.fetch_add(size, std::memory_order_relaxed);
+	m_Allocations.fetch_add(1, std::memory_order_relaxed);
+
+	memcpy(m_PersistentMappedMemoryPointer + (uint64_t(allocatedSlot) * sAlignment), data, size);
+
+	return allocatedSlot * sAlignment;
 }
 
-uint32_t ConstantBufferDataManager::AddDataInternal(const void* data, uint32_t size)
+uint64_t ConstantBufferDataManager::ReserveSlots(uint32_t numSlots)
 {
-	// TODO: Add checks for to track how many slots are used per frame
-	const uint32_t numSlotsRequired = (size + (sAlignment - 1)) / sAlignment;
-	if(m_CurrentSlot + numSlotsRequired > m_Capacity)
+	// Fast path, suballocate from the block of the current worker
+	if (numSlots <= sSlotsPerWorkerBlock)
 	{
-		m_CurrentSlot = 0; // wrap around directly
+		WorkerConstantBlock& block = tlsWorkerBlock;
+		const uint64_t frame = m_FrameCounter.load(std::memory_order_relaxed);
+		if (block.Owner != this || block.Frame != frame || block.Current + numSlots > block.End)
+		{
+			const uint64_t blockStart = m_NextVirtualSlot.fetch_add(sSlotsPerWorkerBlock);
+			WaitForSlots(blockStart + sSlotsPerWorkerBlock);
+
+			block.Owner = this;
+			block.Frame = frame;
+			block.Current = blockStart;
+			block.End = blockStart + sSlotsPerWorkerBlock;
+		}
+
+		const uint64_t result = block.Current;
+		block.Current += numSlots;
+		return result;
 	}
 
-	const uint32_t allocatedSlot = m_CurrentSlot;
+	// Big allocations take whole blocks directly from the ring.
+	// If they end up wrapping around the ring, just waste them and try again
+	const uint32_t numBlockSlots = ((numSlots + sSlotsPerWorkerBlock - 1) / sSlotsPerWorkerBlock) * sSlotsPerWorkerBlock;
+	assert(numBlockSlots <= m_Capacity);
+	uint64_t start = m_NextVirtualSlot.fetch_add(numBlockSlots);
+	while ((start % m_Capacity) + numBlockSlots > m_Capacity)
+	{
+		start = m_NextVirtualSlot.fetch_add(numBlockSlots);
+	}
+	WaitForSlots(start + numBlockSlots);
+	return start;
+}
 
-	m_CurrentSlot += numSlotsRequired;
-	// Wrap around as a ring buffer
-	if (m_CurrentSlot == m_Capacity)
+void ConstantBufferDataManager::WaitForSlots(uint64_t virtualEnd)
+{
+	if (virtualEnd <= m_VirtualLimit.load(std::memory_order_acquire))
 	{
-		m_CurrentSlot = 0;
+		return;
 	}
 
-	memcpy(m_PersistentMappedMemoryPointer + (allocatedSlot * sAlignment), data, size);
+	OPTICK_EVENT("Constant Buffer Stall");
+	for (;;)
+	{
+		uint64_t oldestFenceValue = 0;
+		{
+			std::lock_guard<std::mutex> lock(m_RegionsMutex);
+			// Another thread could have waited for the GPU already
+			ReleaseCompletedRegionsLocked();
+			if (virtualEnd <= m_VirtualLimit.load(std::memory_order_relaxed))
+			{
+				return;
+			}
 
-	return allocatedSlot * sAlignment;
+			if (m_InFlightRegions.empty())
+			{
+				// The current frame alone does not fit into the ring. There is nothing to wait for and the slots
+				// handed out after this would overwrite data of the same frame, so there is no way to continue.
+				FORMAT_LOG(Fatal, Dx12, "Constant buffer ring overflow! Single frame requires more than %u slots", m_Capacity);
+				std::abort();
+			}
+			oldestFenceValue = m_InFlightRegions.front().FenceValue;
+		}
+
+		// Waiting without the lock, so threads which have room in the ring are not blocked.
+		// Null event blocks until the fence is reached, so any number of threads can wait at the same time
+		CHECK_SUCCESS(m_Fence->SetEventOnCompletion(oldestFenceValue, nullptr));
+		m_Stalls.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void ConstantBufferDataManager::ReleaseCompletedRegionsLocked()
+{
+	const uint64_t completedValue = m_Fence->GetCompletedValue();
+	while (!m_InFlightRegions.empty() && m_InFlightRegions.front().FenceValue <= completedValue)
+	{
+		m_ReleasedVirtualEnd = m_InFlightRegions.front().VirtualEnd;
+		m_InFlightRegions.pop_front();
+	}
+	m_VirtualLimit.store(m_ReleasedVirtualEnd + m_Capacity, std::memory_order_release);
+}
+
+void ConstantBufferDataManager::EndFrame(uint64_t fenceValue)
+{
+	const uint64_t frameEnd = m_NextVirtualSlot.load();
+
+	m_LastFrameStatistics.FrameIndex = m_FrameCounter.load();
+	m_LastFrameStatistics.SlotsUsed = uint32_t(frameEnd - m_CurrentFrameStart);
+	m_LastFrameStatistics.BytesRequested = m_BytesRequested.exchange(0);
+	m_LastFrameStatistics.Allocations = m_Allocations.exchange(0);
+	m_LastFrameStatistics.Stalls = m_Stalls.exchange(0);
+	m_LastFrameStatistics.Capacity = m_Capacity;
+
+	OPTICK_TAG("Constant Buffer Slots Used", m_LastFrameStatistics.SlotsUsed);
+	OPTICK_TAG("Constant Buffer Allocations", m_LastFrameStatistics.Allocations);
+	OPTICK_TAG("Constant Buffer Stalls", m_LastFrameStatistics.Stalls);
+
+	{
+		std::lock_guard<std::mutex> lock(m_RegionsMutex);
+		m_InFlightRegions.push_back(InFlightRegion{ frameEnd, fenceValue });
+
+		// Release everything the GPU has already finished with
+		ReleaseCompletedRegionsLocked();
+	}
+
+	m_CurrentFrameStart = frameEnd;
+	// This invalidates all the worker blocks
+	m_FrameCounter.fetch_add(1);
+
+	if (m_LastFrameStatistics.SlotsUsed > m_Capacity / sFramesInRing)
+	{
+		// We cannot change the buffer while the GPU is using it, so wait for everything in flight.
+		// This should happen only a couple of times until we find the real requirements of the game.
+		OPTICK_EVENT("Constant Buffer Grow");
+		if (m_Fence->GetCompletedValue() < fenceValue)
+		{
+			m_Fence->SetEventOnCompletion(fenceValue, m_FenceEvent);
+			WaitForSingleObject(m_FenceEvent, INFINITE);
+		}
+
+		const uint32_t newCapacity = m_Capacity * 2;
+		FORMAT_LOG(Warning, Dx12, "Constant buffer ring used %u out of %u slots in a single frame. Growing to %u slots.", m_LastFrameStatistics.SlotsUsed, m_Capacity, newCapacity);
+		CreateBuffer(newCapacity);
+	}
 }
 }
 }
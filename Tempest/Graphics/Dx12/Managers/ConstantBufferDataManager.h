@@ -2,14 +2,36 @@
 
 #include <Graphics/Dx12/Dx12Common.h>
 
+#include <atomic>
+#include <mutex>
+#include <EASTL/deque.h>
+
 namespace Tempest
 {
 namespace Dx12
 {
+struct ConstantBufferFrameStatistics
+{
+	uint64_t FrameIndex = 0;
+	// Slots consumed in the ring, including the unused tails of worker blocks
+	uint32_t SlotsUsed = 0;
+	uint32_t BytesRequested = 0;
+	uint32_t Allocations = 0;
+	// How many times an allocation had to wait for the GPU to release ring memory
+	uint32_t Stalls = 0;
+	uint32_t Capacity = 0;
+};
 
+// Ring buffer of constant data in upload memory, safe to be used from multiple jobs at the same time.
+// Allocations are done with an atomic bump pointer over a monotonically increasing virtual offset, which is
+// wrapped around the ring. Every thread grabs a block of slots and suballocates from it without atomics.
+// Every frame owns a region of the ring which is fenced by the value signaled in Present, so we never
+// write over data the GPU may still be reading. When there is no room we stall on the oldest frame still in flight
+// and if a single frame is using too much of the ring, the buffer is grown on the next frame boundary.
+// All offsets of a frame point in the same buffer, so a frame which doesn't fit in the whole ring is a fatal error.
 struct ConstantBufferDataManager : Utils::NonCopyable
 {
-	void Initialize(ID3D12Device3* device);
+	void Initialize(ID3D12Device3* device, ID3D12Fence* fence);
 	void Destroy();
 
 	template<typename T>
@@ -18,19 +40,78 @@ struct ConstantBufferDataManager : Utils::NonCopyable
 		return AddDataInternal(&data, static_cast<uint32_t>(sizeof(T)));
 	}
 
+	// For data which is not read as constants, but copied in other buffers
+	uint32_t AddRawData(const void* data, uint32_t size)
+	{
+		return AddDataInternal(data, size);
+	}
+
 	D3D12_GPU_VIRTUAL_ADDRESS GetGPUAddress()
 	{
 		return m_Buffer->GetGPUVirtualAddress();
 	}
+
+	ID3D12Resource* GetBuffer()
+	{
+		return m_Buffer.Get();
+	}
+
+	uint64_t GetSizeInBytes() const
+	{
+		return uint64_t(m_Capacity) * sAlignment;
+	}
+
+	// Closes the region of the current frame, which will be released when the fence reaches fenceValue
+	// NB: Must not be called while other jobs are adding data
+	void EndFrame(uint64_t fenceValue);
+
+	const ConstantBufferFrameStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
 private:
 	uint32_t AddDataInternal(const void* data, uint32_t size);
+	uint64_t ReserveSlots(uint32_t numSlots);
+	void WaitForSlots(uint64_t virtualEnd);
+	void ReleaseCompletedRegionsLocked();
+	void CreateBuffer(uint32_t capacity);
 
 	ComPtr<ID3D12Resource> m_Buffer;
+	ID3D12Device3* m_Device = nullptr;
+	ID3D12Fence* m_Fence = nullptr;
+	HANDLE m_FenceEvent = nullptr;
 	uint8_t* m_PersistentMappedMemoryPointer = nullptr;
 
 	uint32_t m_Capacity = 0;
-	uint32_t m_CurrentSlot = 0;
+	// Virtual offsets in slots. They only increase, the physical slot is the offset modulo the capacity
+	std::atomic<uint64_t> m_NextVirtualSlot = 0;
+	// Everything before this virtual offset is safe to be written to
+	std::atomic<uint64_t> m_VirtualLimit = 0;
+	uint64_t m_ReleasedVirtualEnd = 0;
+	uint64_t m_CurrentFrameStart = 0;
+	// Incremented on every frame boundary so the workers know their blocks are stale
+	std::atomic<uint64_t> m_FrameCounter = 1;
+
+	struct InFlightRegion
+	{
+		uint64_t VirtualEnd;
+		uint64_t FenceValue;
+	};
+	std::mutex m_RegionsMutex;
+	eastl::deque<InFlightRegion> m_InFlightRegions;
+
+	std::atomic<uint32_t> m_BytesRequested = 0;
+	std::atomic<uint32_t> m_Allocations = 0;
+	std::atomic<uint32_t> m_Stalls = 0;
+	ConstantBufferFrameStatistics m_LastFrameStatistics;
+
 	static const uint32_t sAlignment = 256;
+	// Size of the block every worker takes from the ring. The capacity is always a multiple of this,
+	// so a block never straddles the end of the ring
+	static const uint32_t sSlotsPerWorkerBlock = 64;
+	// With 2 back buffers we can have up to 3 frames writing/reading from the ring.
+	// If a single frame is using more than that part of the ring we are going to grow it
+	static const uint32_t sFramesInRing = 3;
 };
 
 }
@@ -0,0 +1,79 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/Dx12/Managers/DescriptorCache.h>
+#include <Graphics/Dx12/Managers/TwoPartRingBufferDescriptorHeapManager.h>
+
+namespace Tempest
+{
+namespace Dx12
+{
+size_t DescriptorCache::DescriptorViewKeyHash::operator()(const DescriptorViewKey& key) const
+{
+	size_t hash = eastl::hash<uint32_t>()(key.Texture);
+	hash ^= eastl::hash<uint32_t>()(uint32_t(key.Type)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= eastl::hash<uint32_t>()(uint32_t(key.Format)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+void DescriptorCache::Initialize(TwoPartRingBufferDescriptorHeapManager& heap, uint32_t capacity)
+{
+	const uint32_t firstSlot = heap.ReservePersistentResources(capacity);
+	m_Views.clear();
+	m_FreeSlots.clear();
+	m_FreeSlots.reserve(capacity);
+	// Reversed, so the first allocations get the lowest slots
+	for (uint32_t i = capacity; i > 0; --i)
+	{
+		m_FreeSlots.push_back(firstSlot + i - 1);
+	}
+}
+
+eastl::pair<uint32_t, bool> DescriptorCache::GetOrAllocate(const DescriptorViewKey& key)
+{
+	auto findItr = m_Views.find(key);
+	if (findItr != m_Views.end())
+	{
+		findItr->second.LastUsedFrame = m_FrameIndex;
+		++m_Hits;
+		return eastl::make_pair(findItr->second.Slot, false);
+	}
+
+	++m_Misses;
+	if (m_FreeSlots.empty())
+	{
+		// Views which could be evicted safely are already evicted at the end of the frame, the rest could still be used by the GPU
+		++m_Overflows;
+		return eastl::make_pair(sInvalidSlot, false);
+	}
+
+	const uint32_t slot = m_FreeSlots.back();
+	m_FreeSlots.pop_back();
+	m_Views[key] = CachedView{ slot, m_FrameIndex };
+	return eastl::make_pair(slot, true);
+}
+
+void DescriptorCache::EndFrame()
+{
+	OPTICK_TAG("Descriptor Cache Hits", m_Hits);
+	OPTICK_TAG("Descriptor Cache Misses", m_Misses);
+	OPTICK_TAG("Descriptor Cache Overflows", m_Overflows);
+	m_Hits = 0;
+	m_Misses = 0;
+	m_Overflows = 0;
+
+	for (auto itr = m_Views.begin(); itr != m_Views.end();)
+	{
+		if (itr->second.LastUsedFrame + sEvictAfterFrames <= m_FrameIndex)
+		{
+			m_FreeSlots.push_back(itr->second.Slot);
+			itr = m_Views.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+	++m_FrameIndex;
+}
+}
+}
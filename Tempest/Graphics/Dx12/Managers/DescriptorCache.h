@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Graphics/Dx12/Dx12Common.h>
+#include <Graphics/RendererTypes.h>
+
+namespace Tempest
+{
+namespace Dx12
+{
+struct TwoPartRingBufferDescriptorHeapManager;
+
+enum class DescriptorViewType : uint8_t
+{
+	ShaderResource,
+	DepthStencil,
+};
+
+// Texture handles are never reused, so they identify the resource better than the ID3D12Resource pointer
+struct DescriptorViewKey
+{
+	TextureHandle Texture;
+	DescriptorViewType Type;
+	DXGI_FORMAT Format;
+
+	bool operator==(const DescriptorViewKey& other) const
+	{
+		return Texture == other.Texture && Type == other.Type && Format == other.Format;
+	}
+};
+
+// Keeps views of textures alive between frames, so stable views (shadow maps, transient textures from the pool)
+// are created only once instead of every frame. The slots live in a reserved range of the heap outside of the ring.
+// Views not used for some frames are evicted and their slots are reused. Views still used by the GPU are never evicted,
+// so when all slots are taken the cache fails and the caller has to use a descriptor which lives only for the frame.
+class DescriptorCache : Utils::NonCopyable
+{
+public:
+	static const uint32_t sInvalidSlot = uint32_t(-1);
+
+	void Initialize(TwoPartRingBufferDescriptorHeapManager& heap, uint32_t capacity);
+
+	// Returns the slot of the view and true if it was just allocated, so the caller has to create the view in it.
+	// Returns sInvalidSlot if the cache is full
+	eastl::pair<uint32_t, bool> GetOrAllocate(const DescriptorViewKey& key);
+	void EndFrame();
+private:
+	struct DescriptorViewKeyHash
+	{
+		size_t operator()(const DescriptorViewKey& key) const;
+	};
+
+	struct CachedView
+	{
+		uint32_t Slot;
+		uint64_t LastUsedFrame;
+	};
+	eastl::unordered_map<DescriptorViewKey, CachedView, DescriptorViewKeyHash> m_Views;
+	eastl::vector<uint32_t> m_FreeSlots;
+	uint64_t m_FrameIndex = 1;
+
+	uint32_t m_Hits = 0;
+	uint32_t m_Misses = 0;
+	uint32_t m_Overflows = 0;
+
+	// Must be more than the frames in flight, so the GPU is done with the evicted descriptors
+	static const uint64_t sEvictAfterFrames = 60;
+};
+}
+}
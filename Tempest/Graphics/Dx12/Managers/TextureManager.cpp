@@ -13,13 +13,20 @@ TextureManager::TextureManager(Dx12Device& device)
 {
 }
 
-TextureHandle TextureManager::CreateTexture(const TextureDescription& description, D3D12_RESOURCE_STATES initialState, UploadData* upload)
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
 {
-	const bool isDepth = description.Format == DXGI_FORMAT_D32_FLOAT;
+	return ((value + alignment - 1) / alignment) * alignment;
+}
 
-	D3D12_HEAP_PROPERTIES props;
-	::ZeroMemory(&props, sizeof(D3D12_HEAP_PROPERTIES));
-	props.Type = D3D12_HEAP_TYPE_DEFAULT;
+static bool IsDepthFormat(DXGI_FORMAT format)
+{
+	// TODO: more types of depth
+	return format == DXGI_FORMAT_D32_FLOAT;
+}
+
+static D3D12_RESOURCE_DESC ResourceDescFromTextureDescription(const TextureDescription& description, bool isRenderTarget)
+{
+	const bool isDepth = IsDepthFormat(description.Format);
 
 	D3D12_RESOURCE_DESC desc;
 	::ZeroMemory(&desc, sizeof(D3D12_RESOURCE_DESC));
@@ -27,61 +34,139 @@ TextureHandle TextureManager::CreateTexture(const TextureDescription& descriptio
 	desc.Width = description.Width;
 	desc.Height = description.Height;
 	desc.DepthOrArraySize = 1;
-	desc.MipLevels = 1;
+	desc.MipLevels = UINT16(description.MipLevels);
 	desc.Format = description.Format;
 	desc.SampleDesc.Count = 1;
 	desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-	desc.Flags = !isDepth ? D3D12_RESOURCE_FLAG_NONE : D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL; // TODO: more types of depth
-
-	PipelineStateHandle resultHandle = m_NextHandle++;
-	eastl::pair<TextureDescription, ComPtr<ID3D12Resource>>& texture = m_Textures[resultHandle];
-	texture.first = description;
-	D3D12_RESOURCE_STATES state = (description.Data && upload) ? D3D12_RESOURCE_STATE_COPY_DEST : initialState;
+	desc.Flags = isDepth ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : (isRenderTarget ? D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET : D3D12_RESOURCE_FLAG_NONE);
+	return desc;
+}
 
+static D3D12_CLEAR_VALUE ClearValueFromTextureDescription(const TextureDescription& description)
+{
 	D3D12_CLEAR_VALUE clearValue;
 	::ZeroMemory(&clearValue, sizeof(D3D12_CLEAR_VALUE));
 	clearValue.Format = description.Format;
-	if(isDepth)
+	if (IsDepthFormat(description.Format))
 	{
 		clearValue.DepthStencil.Depth = 1.0f;
 		clearValue.DepthStencil.Stencil = 0;
 	}
+	return clearValue;
+}
+
+TextureHandle TextureManager::CreateTexture(const TextureDescription& description, D3D12_RESOURCE_STATES initialState, UploadData* upload)
+{
+	const bool isDepth = IsDepthFormat(description.Format);
+
+	D3D12_HEAP_PROPERTIES props;
+	::ZeroMemory(&props, sizeof(D3D12_HEAP_PROPERTIES));
+	props.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+	D3D12_RESOURCE_DESC desc = ResourceDescFromTextureDescription(description, false);
+
+	PipelineStateHandle resultHandle = m_NextHandle++;
+	eastl::pair<TextureDescription, ComPtr<ID3D12Resource>>& texture = m_Textures[resultHandle];
+	texture.first = description;
+	// The copy queue leaves uploaded textures in the common state. Shader reads promote them implicitly, so only those states can be asked for
+	assert(!(description.Data && upload) || initialState == D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE || initialState == D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+	D3D12_RESOURCE_STATES state = (description.Data && upload) ? D3D12_RESOURCE_STATE_COMMON : initialState;
+
+	D3D12_CLEAR_VALUE clearValue = ClearValueFromTextureDescription(description);
 	CHECK_SUCCESS(m_Device.GetDevice()->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, state, isDepth ? &clearValue : nullptr, IID_PPV_ARGS(&texture.second)));
 
 	if (description.Data && upload)
 	{
-		memcpy(reinterpret_cast<uint8_t*>(upload->MappedData) + upload->CurrentOffset, description.Data, description.Size);
+		// D3D12 texture mips are 16 at most
+		eastl::array<D3D12_PLACED_SUBRESOURCE_FOOTPRINT, D3D12_REQ_MIP_LEVELS> footprints;
+		eastl::array<UINT, D3D12_REQ_MIP_LEVELS> rowCounts;
+		eastl::array<UINT64, D3D12_REQ_MIP_LEVELS> rowSizes;
+		UINT64 totalBytes = 0;
+		upload->CurrentOffset = AlignUp(upload->CurrentOffset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+		m_Device.GetDevice()->GetCopyableFootprints(&desc, 0, description.MipLevels, upload->CurrentOffset, footprints.data(), rowCounts.data(), rowSizes.data(), &totalBytes);
 
-		D3D12_TEXTURE_COPY_LOCATION dstCopyLocation;
-		::ZeroMemory(&dstCopyLocation, sizeof(D3D12_TEXTURE_COPY_LOCATION));
-		dstCopyLocation.pResource = texture.second.Get();
-		dstCopyLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-		dstCopyLocation.SubresourceIndex = 0;
+		// Source rows are tightly packed, but the upload heap needs them with aligned pitch
+		const uint8_t* source = reinterpret_cast<const uint8_t*>(description.Data);
+		for (uint32_t mip = 0; mip < description.MipLevels; ++mip)
+		{
+			uint8_t* destination = reinterpret_cast<uint8_t*>(upload->MappedData) + footprints[mip].Offset;
+			for (UINT row = 0; row < rowCounts[mip]; ++row)
+			{
+				memcpy(destination + row * footprints[mip].Footprint.RowPitch, source, rowSizes[mip]);
+				source += rowSizes[mip];
+			}
 
-		D3D12_TEXTURE_COPY_LOCATION srcCopyLocation;
-		srcCopyLocation.pResource = upload->UploadHeap.Get();
-		srcCopyLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-		m_Device.GetDevice()->GetCopyableFootprints(&desc, 0, 1, upload->CurrentOffset, &srcCopyLocation.PlacedFootprint, nullptr, nullptr, nullptr);
+			D3D12_TEXTURE_COPY_LOCATION dstCopyLocation;
+			::ZeroMemory(&dstCopyLocation, sizeof(D3D12_TEXTURE_COPY_LOCATION));
+			dstCopyLocation.pResource = texture.second.Get();
+			dstCopyLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+			dstCopyLocation.SubresourceIndex = mip;
 
-		upload->CommandList->CopyTextureRegion(&dstCopyLocation, 0, 0, 0, &srcCopyLocation, nullptr);
+			D3D12_TEXTURE_COPY_LOCATION srcCopyLocation;
+			srcCopyLocation.pResource = upload->UploadHeap.Get();
+			srcCopyLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+			srcCopyLocation.PlacedFootprint = footprints[mip];
 
-		upload->CurrentOffset += description.Size;
+			upload->CommandList->CopyTextureRegion(&dstCopyLocation, 0, 0, 0, &srcCopyLocation, nullptr);
+		}
+		assert(source <= reinterpret_cast<const uint8_t*>(description.Data) + description.Size);
 
-		D3D12_RESOURCE_BARRIER barrier;
-		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-		barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-		barrier.Transition.pResource = texture.second.Get();
-		barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-		barrier.Transition.StateAfter = initialState;
-		barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-
-		// TODO: Batch those
-		upload->CommandList->ResourceBarrier(1, &barrier);
+		upload->CurrentOffset += totalBytes;
+		assert(upload->CurrentOffset <= upload->EndOffset);
 	}
 
 	return resultHandle;
 }
 
+TextureHandle TextureManager::CreatePlacedTexture(const TextureDescription& description, ID3D12Heap* heap, uint64_t heapOffset, D3D12_RESOURCE_STATES initialState)
+{
+	D3D12_RESOURCE_DESC desc = ResourceDescFromTextureDescription(description, true);
+	D3D12_CLEAR_VALUE clearValue = ClearValueFromTextureDescription(description);
+
+	TextureHandle resultHandle = m_NextHandle++;
+	eastl::pair<TextureDescription, ComPtr<ID3D12Resource>>& texture = m_Textures[resultHandle];
+	texture.first = description;
+	CHECK_SUCCESS(m_Device.GetDevice()->CreatePlacedResource(heap, heapOffset, &desc, initialState, &clearValue, IID_PPV_ARGS(&texture.second)));
+
+	return resultHandle;
+}
+
+void TextureManager::DestroyTexture(TextureHandle textureHandle)
+{
+	m_Textures.erase(textureHandle);
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO TextureManager::GetPlacedTextureAllocationInfo(const TextureDescription& description)
+{
+	D3D12_RESOURCE_DESC desc = ResourceDescFromTextureDescription(description, true);
+	return m_Device.GetDevice()->GetResourceAllocationInfo(0, 1, &desc);
+}
+
+uint64_t TextureManager::GetUploadSize(const TextureDescription& description)
+{
+	D3D12_RESOURCE_DESC desc = ResourceDescFromTextureDescription(description, false);
+	UINT64 totalBytes = 0;
+	m_Device.GetDevice()->GetCopyableFootprints(&desc, 0, description.MipLevels, 0, nullptr, nullptr, nullptr, &totalBytes);
+	// Every texture starts aligned in the upload heap
+	return totalBytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+}
+
+ComPtr<ID3D12Heap> TextureManager::CreateRenderTargetHeap(uint64_t size)
+{
+	D3D12_HEAP_DESC desc;
+	::ZeroMemory(&desc, sizeof(D3D12_HEAP_DESC));
+	desc.SizeInBytes = size;
+	desc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	// Resource Heap Tier 1 does not allow mixing of render targets with other textures and buffers
+	desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+	ComPtr<ID3D12Heap> heap;
+	CHECK_SUCCESS(m_Device.GetDevice()->CreateHeap(&desc, IID_PPV_ARGS(&heap)));
+	heap->SetName(L"Transient Render Target Heap");
+	return heap;
+}
+
 ID3D12Resource* TextureManager::GetTexture(uint32_t textureHandle)
 {
 	return m_Textures[textureHandle].second.Get();
@@ -92,6 +177,11 @@ glm::ivec2 TextureManager::GetTextureDimensions(TextureHandle textureHandle)
 	return glm::ivec2(m_Textures[textureHandle].first.Width, m_Textures[textureHandle].first.Height);
 }
 
+const TextureDescription& TextureManager::GetTextureDescription(TextureHandle textureHandle)
+{
+	return m_Textures[textureHandle].first;
+}
+
 DXGI_FORMAT DxFormatForStorageFromTextureFormat(const Definition::TextureData& data)
 {
 	switch (data.format())
@@ -126,40 +216,157 @@ DXGI_FORMAT DxFormatForViewFromTextureFormat(const Definition::TextureData& data
 	}
 }
 
+DXGI_FORMAT DxFormatForShaderResourceView(DXGI_FORMAT storageFormat)
+{
+	switch (storageFormat)
+	{
+	case DXGI_FORMAT_D32_FLOAT:
+		return DXGI_FORMAT_R32_FLOAT;
+	default:
+		return storageFormat;
+	}
+}
+
 TemporaryTextureManager::TemporaryTextureManager(TextureManager& manager)
 	: m_TextureManager(manager)
 {
 }
 
-eastl::pair<TextureHandle, D3D12_RESOURCE_STATES> TemporaryTextureManager::RequestTexture(const TextureDescription& desc)
+eastl::pair<uint64_t, uint64_t> TemporaryTextureManager::GetAllocationInfo(const TextureDescription& desc)
+{
+	D3D12_RESOURCE_ALLOCATION_INFO info = m_TextureManager.GetPlacedTextureAllocationInfo(desc);
+	return eastl::make_pair(uint64_t(info.SizeInBytes), uint64_t(info.Alignment));
+}
+
+size_t TemporaryTextureManager::TextureKeyHash::operator()(const TextureKey& key) const
 {
-	auto findItr = eastl::find_if(m_Textures.begin(), m_Textures.end(), [&desc](const TextureResource& resource) {
-		return resource.Description.Type == desc.Type &&
-			resource.Description.Format == desc.Format &&
-			resource.Description.Width == desc.Width &&
-			resource.Description.Height == desc.Height &&
-			resource.Description.Size == desc.Size &&
-			resource.Description.Data == desc.Data;
-	});
+	size_t hash = 0;
+	auto combine = [&hash](size_t value) {
+		hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	};
+	combine(eastl::hash<uint32_t>()(uint32_t(key.Type)));
+	combine(eastl::hash<uint32_t>()(uint32_t(key.Format)));
+	combine(eastl::hash<uint32_t>()(key.Width));
+	combine(eastl::hash<uint32_t>()(key.Height));
+	combine(eastl::hash<uint64_t>()(key.HeapOffset));
+	return hash;
+}
 
-	if (findItr != m_Textures.end())
+void TemporaryTextureManager::ReserveHeap(uint64_t heapSize)
+{
+	if (heapSize <= m_HeapSize)
 	{
-		return eastl::make_pair(findItr->Handle, findItr->CurrentState);
+		return;
 	}
 
-	TextureHandle handle = m_TextureManager.CreateTexture(desc, D3D12_RESOURCE_STATE_COMMON, nullptr);
-	m_Textures.push_back({ handle, desc, D3D12_RESOURCE_STATE_COMMON });
+	// Textures from the old heap could still be used by frames in flight
+	if (m_Heap)
+	{
+		assert(m_AcquiredTextures.empty());
+		RetiredHeap retired{ m_Heap, m_HeapSize, {}, m_FrameIndex };
+		retired.Textures.reserve(m_Textures.size());
+		for (const auto& texture : m_Textures)
+		{
+			retired.Textures.push_back(texture.first);
+		}
+		m_RetiredHeaps.push_back(eastl::move(retired));
+		m_Textures.clear();
+		m_FreeTextures.clear();
+	}
+
+	const uint64_t heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	m_HeapSize = ((heapSize + heapAlignment - 1) / heapAlignment) * heapAlignment;
+	m_Heap = m_TextureManager.CreateRenderTargetHeap(m_HeapSize);
+	FORMAT_LOG(Info, Dx12, "Transient texture heap resized to %llu bytes", m_HeapSize);
+}
+
+eastl::pair<TextureHandle, D3D12_RESOURCE_STATES> TemporaryTextureManager::RequestTexture(const TextureDescription& desc, uint64_t heapOffset)
+{
+	assert(m_Heap);
+	const TextureKey key{ desc.Type, desc.Format, desc.Width, desc.Height, heapOffset };
+	auto findItr = m_FreeTextures.find(key);
+	if (findItr != m_FreeTextures.end())
+	{
+		const TextureHandle handle = findItr->second;
+		m_FreeTextures.erase(findItr);
+		m_AcquiredTextures.push_back(handle);
+
+		TextureResource& resource = m_Textures[handle];
+		resource.LastUsedFrame = m_FrameIndex;
+		return eastl::make_pair(handle, resource.CurrentState);
+	}
+
+	TextureHandle handle = m_TextureManager.CreatePlacedTexture(desc, m_Heap.Get(), heapOffset, D3D12_RESOURCE_STATE_COMMON);
+	m_Textures[handle] = TextureResource{ key, D3D12_RESOURCE_STATE_COMMON, m_FrameIndex };
+	m_AcquiredTextures.push_back(handle);
+	++m_Statistics.CreatedTextures;
 	return eastl::make_pair(handle, D3D12_RESOURCE_STATE_COMMON);
 }
 
 void TemporaryTextureManager::UpdateCurrentState(TextureHandle handle, D3D12_RESOURCE_STATES state)
 {
-	auto findItr = eastl::find_if(m_Textures.begin(), m_Textures.end(), [&handle](const TextureResource& resource) {
-		return resource.Handle == handle;
-	});
-
+	auto findItr = m_Textures.find(handle);
 	assert(findItr != m_Textures.end());
-	findItr->CurrentState = state;
+	findItr->second.CurrentState = state;
+}
+
+void TemporaryTextureManager::EndFrame()
+{
+	OPTICK_EVENT();
+	m_Statistics.AcquiredTextures = uint32_t(m_AcquiredTextures.size());
+	for (TextureHandle handle : m_AcquiredTextures)
+	{
+		m_FreeTextures.insert(eastl::make_pair(m_Textures[handle].Key, handle));
+	}
+	m_AcquiredTextures.clear();
+
+	// Evicted textures were not used for more frames than there are in flight, so the GPU is done with them
+	for (auto itr = m_FreeTextures.begin(); itr != m_FreeTextures.end();)
+	{
+		auto textureItr = m_Textures.find(itr->second);
+		if (textureItr->second.LastUsedFrame + sEvictAfterFrames <= m_FrameIndex)
+		{
+			m_TextureManager.DestroyTexture(itr->second);
+			m_Textures.erase(textureItr);
+			itr = m_FreeTextures.erase(itr);
+			++m_Statistics.EvictedTextures;
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	++m_FrameIndex;
+	m_RetiredHeaps.erase(eastl::remove_if(m_RetiredHeaps.begin(), m_RetiredHeaps.end(), [this](const RetiredHeap& retired) {
+		if (retired.RetiredFrame + sFramesInFlight > m_FrameIndex)
+		{
+			return false;
+		}
+
+		for (TextureHandle handle : retired.Textures)
+		{
+			m_TextureManager.DestroyTexture(handle);
+		}
+		return true;
+	}), m_RetiredHeaps.end());
+
+	m_Statistics.PooledTextures = uint32_t(m_Textures.size());
+	m_Statistics.CurrentMemory = m_HeapSize;
+	for (const RetiredHeap& retired : m_RetiredHeaps)
+	{
+		m_Statistics.CurrentMemory += retired.Size;
+	}
+	m_Statistics.PeakMemory = eastl::max(m_LastFrameStatistics.PeakMemory, m_Statistics.CurrentMemory);
+
+	m_LastFrameStatistics = m_Statistics;
+	m_Statistics = TemporaryTextureStatistics{};
+
+	OPTICK_TAG("Pooled Transient Textures", m_LastFrameStatistics.PooledTextures);
+	OPTICK_TAG("Created Transient Textures", m_LastFrameStatistics.CreatedTextures);
+	OPTICK_TAG("Evicted Transient Textures", m_LastFrameStatistics.EvictedTextures);
+	OPTICK_TAG("Transient Memory Current", m_LastFrameStatistics.CurrentMemory);
+	OPTICK_TAG("Transient Memory Peak", m_LastFrameStatistics.PeakMemory);
 }
 }
 }
\ No newline at end of file
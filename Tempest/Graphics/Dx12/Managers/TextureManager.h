@@ -26,42 +26,126 @@ struct TextureDescription
 	uint32_t Width;
 	uint32_t Height;
 	size_t Size;
+	// All mips one after another, starting with the most detailed. Rows are tightly packed
 	const void* Data;
+	uint32_t MipLevels = 1;
 };
 
 DXGI_FORMAT DxFormatForStorageFromTextureFormat(const Definition::TextureData& data);
 DXGI_FORMAT DxFormatForViewFromTextureFormat(const Definition::TextureData& data);
+// Format of the view which reads the texture in shaders. Depth is read as its color equivalent
+DXGI_FORMAT DxFormatForShaderResourceView(DXGI_FORMAT storageFormat);
 
 class TextureManager : Utils::NonCopyable
 {
 public:
 	TextureManager(Dx12Device& device);
 	TextureHandle CreateTexture(const TextureDescription& description, D3D12_RESOURCE_STATES initialState, UploadData* upload);
+	// Placed textures are always render target or depth stencil, as they live in a heap only for those
+	TextureHandle CreatePlacedTexture(const TextureDescription& description, ID3D12Heap* heap, uint64_t heapOffset, D3D12_RESOURCE_STATES initialState);
+	void DestroyTexture(TextureHandle textureHandle);
+	D3D12_RESOURCE_ALLOCATION_INFO GetPlacedTextureAllocationInfo(const TextureDescription& description);
+	// Space needed in the upload heap for the data of all mips, including the alignment padding
+	uint64_t GetUploadSize(const TextureDescription& description);
+	ComPtr<ID3D12Heap> CreateRenderTargetHeap(uint64_t size);
 	ID3D12Resource* GetTexture(TextureHandle textureHandle);
 	glm::ivec2 GetTextureDimensions(TextureHandle textureHandle);
+	const TextureDescription& GetTextureDescription(TextureHandle textureHandle);
 private:
 	eastl::unordered_map<TextureHandle, eastl::pair<TextureDescription, ComPtr<ID3D12Resource>>> m_Textures;
 	TextureHandle m_NextHandle = 1; // TODO: for now invalid handle is 0
 	Dx12Device& m_Device;
 };
 
+struct TemporaryTextureStatistics
+{
+	uint32_t PooledTextures = 0;
+	uint32_t AcquiredTextures = 0;
+	uint32_t CreatedTextures = 0;
+	uint32_t EvictedTextures = 0;
+	// Heap memory, including the old heaps kept alive for the frames in flight
+	uint64_t CurrentMemory = 0;
+	uint64_t PeakMemory = 0;
+};
+
 // TODO: Move to seperate file
 class TemporaryTextureManager : Utils::NonCopyable
 {
 public:
 	TemporaryTextureManager(TextureManager& manager);
 
-	eastl::pair<TextureHandle, D3D12_RESOURCE_STATES> RequestTexture(const TextureDescription& desc);
+	// Size and alignment of the texture when placed inside the transient heap
+	eastl::pair<uint64_t, uint64_t> GetAllocationInfo(const TextureDescription& desc);
+	// Makes sure the transient heap can hold at least heapSize bytes.
+	// If the heap is recreated all textures from the old one are kept alive until the GPU is done with them.
+	void ReserveHeap(uint64_t heapSize);
+	// Acquires a texture from the pool for the current frame. All acquired textures are released back to the pool in EndFrame
+	eastl::pair<TextureHandle, D3D12_RESOURCE_STATES> RequestTexture(const TextureDescription& desc, uint64_t heapOffset);
 	void UpdateCurrentState(TextureHandle, D3D12_RESOURCE_STATES state);
+	void EndFrame();
+
+	uint64_t GetHeapSize() const
+	{
+		return m_HeapSize;
+	}
+
+	const TemporaryTextureStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
 private:
 	TextureManager& m_TextureManager;
+
+	// Transient textures never have initial data, so only the properties of the placed resource matter
+	struct TextureKey
+	{
+		TextureType Type;
+		DXGI_FORMAT Format;
+		uint32_t Width;
+		uint32_t Height;
+		uint64_t HeapOffset;
+
+		bool operator==(const TextureKey& other) const
+		{
+			return Type == other.Type && Format == other.Format && Width == other.Width && Height == other.Height && HeapOffset == other.HeapOffset;
+		}
+	};
+
+	struct TextureKeyHash
+	{
+		size_t operator()(const TextureKey& key) const;
+	};
+
 	struct TextureResource
 	{
-		TextureHandle Handle;
-		TextureDescription Description;
+		TextureKey Key;
 		D3D12_RESOURCE_STATES CurrentState;
+		uint64_t LastUsedFrame;
 	};
-	eastl::vector<TextureResource> m_Textures;
+	eastl::unordered_map<TextureHandle, TextureResource> m_Textures;
+	// Textures which are not acquired in the current frame
+	eastl::unordered_multimap<TextureKey, TextureHandle, TextureKeyHash> m_FreeTextures;
+	eastl::vector<TextureHandle> m_AcquiredTextures;
+
+	ComPtr<ID3D12Heap> m_Heap;
+	uint64_t m_HeapSize = 0;
+
+	struct RetiredHeap
+	{
+		ComPtr<ID3D12Heap> Heap;
+		uint64_t Size;
+		eastl::vector<TextureHandle> Textures;
+		uint64_t RetiredFrame;
+	};
+	eastl::vector<RetiredHeap> m_RetiredHeaps;
+	uint64_t m_FrameIndex = 1;
+	// 2 back buffers + the frame currently being recorded
+	static const uint64_t sFramesInFlight = 3;
+	// Free textures are destroyed after not being used for that many frames. Must be bigger than the frames in flight
+	static const uint64_t sEvictAfterFrames = 60;
+
+	TemporaryTextureStatistics m_Statistics;
+	TemporaryTextureStatistics m_LastFrameStatistics;
 };
 }
 }
\ No newline at end of file
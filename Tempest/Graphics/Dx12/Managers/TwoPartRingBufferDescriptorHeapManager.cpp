@@ -6,9 +6,12 @@ namespace Tempest
 {
 namespace Dx12
 {
-void TwoPartRingBufferDescriptorHeapManager::Initialize(ID3D12Device3* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity)
+void TwoPartRingBufferDescriptorHeapManager::Initialize(ID3D12Device3* device, ID3D12Fence* fence, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity)
 {
 	m_Capacity = capacity;
+	m_Fence = fence;
+	m_FenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	m_DescriptorSize = device->GetDescriptorHandleIncrementSize(type);
 
 	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
 	srvHeapDesc.NumDescriptors = m_Capacity;
@@ -21,27 +24,100 @@ void TwoPartRingBufferDescriptorHeapManager::Destroy()
 {
 	m_Capacity = 0;
 	m_NumStaticResources = 0;
-	m_CurrentSlot = 0;
+	m_DynamicStart = 0;
+	m_NextVirtualSlot = 0;
+	m_VirtualLimit = 0;
+	m_CurrentFrameStart = 0;
+	m_InFlightRegions.clear();
 	Heap.Reset();
+
+	if (m_FenceEvent)
+	{
+		CloseHandle(m_FenceEvent);
+		m_FenceEvent = nullptr;
+	}
 }
 
 void TwoPartRingBufferDescriptorHeapManager::AllocateStaticResources(int numResources)
 {
 	m_NumStaticResources = numResources;
-	m_CurrentSlot = numResources;
+	m_DynamicStart = numResources;
+	m_VirtualLimit = m_Capacity - m_DynamicStart;
 }
 
-uint32_t TwoPartRingBufferDescriptorHeapManager::AllocateDynamicResource()
+uint32_t TwoPartRingBufferDescriptorHeapManager::ReservePersistentResources(uint32_t numResources)
 {
-	uint32_t allocatedSlot = m_CurrentSlot;
+	assert(m_NextVirtualSlot == 0);
+	assert(m_DynamicStart + numResources < m_Capacity);
+	const uint32_t firstSlot = m_DynamicStart;
+	m_DynamicStart += numResources;
+	m_VirtualLimit = m_Capacity - m_DynamicStart;
+	return firstSlot;
+}
 
-	++m_CurrentSlot;
-	// Wrap around as a ring buffer
-	if(m_CurrentSlot == m_Capacity)
+uint32_t TwoPartRingBufferDescriptorHeapManager::AllocateDynamicResource()
+{
+	if (m_NextVirtualSlot + 1 > m_VirtualLimit && !WaitForOldestFrame())
 	{
-		m_CurrentSlot = m_NumStaticResources;
+		return sInvalidSlot;
 	}
+
+	const uint32_t allocatedSlot = m_DynamicStart + uint32_t(m_NextVirtualSlot % (m_Capacity - m_DynamicStart));
+	++m_NextVirtualSlot;
 	return allocatedSlot;
 }
+
+D3D12_CPU_DESCRIPTOR_HANDLE TwoPartRingBufferDescriptorHeapManager::GetCPUHandle(uint32_t slot) const
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = Heap->GetCPUDescriptorHandleForHeapStart();
+	handle.ptr += uint64_t(slot) * m_DescriptorSize;
+	return handle;
+}
+
+bool TwoPartRingBufferDescriptorHeapManager::WaitForOldestFrame()
+{
+	OPTICK_EVENT("Descriptor Ring Stall");
+	if (m_InFlightRegions.empty())
+	{
+		// The current frame alone does not fit into the ring, there is nothing to wait for
+		FORMAT_LOG(Error, Dx12, "Descriptor ring overflow! Single frame requires more than %u descriptors", m_Capacity - m_DynamicStart);
+		return false;
+	}
+
+	const InFlightRegion& oldestRegion = m_InFlightRegions.front();
+	if (m_Fence->GetCompletedValue() < oldestRegion.FenceValue)
+	{
+		m_Fence->SetEventOnCompletion(oldestRegion.FenceValue, m_FenceEvent);
+		WaitForSingleObject(m_FenceEvent, INFINITE);
+		++m_Stalls;
+	}
+
+	m_VirtualLimit = oldestRegion.VirtualEnd + (m_Capacity - m_DynamicStart);
+	m_InFlightRegions.pop_front();
+	return true;
+}
+
+void TwoPartRingBufferDescriptorHeapManager::EndFrame(uint64_t fenceValue)
+{
+	if (!Heap)
+	{
+		return;
+	}
+
+	OPTICK_TAG("Dynamic Descriptors", uint32_t(m_NextVirtualSlot - m_CurrentFrameStart));
+	OPTICK_TAG("Descriptor Ring Stalls", m_Stalls);
+	m_Stalls = 0;
+
+	m_InFlightRegions.push_back(InFlightRegion{ m_NextVirtualSlot, fenceValue });
+	m_CurrentFrameStart = m_NextVirtualSlot;
+
+	// Release everything the GPU has already finished with
+	const uint64_t completedValue = m_Fence->GetCompletedValue();
+	while (!m_InFlightRegions.empty() && m_InFlightRegions.front().FenceValue <= completedValue)
+	{
+		m_VirtualLimit = m_InFlightRegions.front().VirtualEnd + (m_Capacity - m_DynamicStart);
+		m_InFlightRegions.pop_front();
+	}
+}
 }
 }
@@ -2,6 +2,8 @@
 
 #include <Graphics/Dx12/Dx12Common.h>
 
+#include <EASTL/deque.h>
+
 namespace Tempest
 {
 namespace Dx12
@@ -9,27 +11,62 @@ namespace Dx12
 // Use only a single descriptor heap for all shader visible resources
 // Split the memory into 2 pieces - first is for static scene resources which does not change
 // They are using simple linear allocation scheme, first are buffers, after that textures for materials, etc
+// At the end of the static part there could be a range reserved for descriptors which live for multiple frames (see DescriptorCache).
 // Second part is dynamic resources, which are allocated per frame, based on ring buffer scheme.
-// To avoid having to do synchronizations because multiple frames could be in flight, we allocated
-// 1 000 000 descriptors (this is the hardware limit for Tier 1 (lowest tier))
+// Every frame owns a region of the ring which is fenced by the value signaled in Present, so the ring never
+// overwrites descriptors which are still used by the GPU and it doesn't need to be huge.
+// NB: Not thread safe, all allocations are done from the render thread
 struct TwoPartRingBufferDescriptorHeapManager : Utils::NonCopyable
 {
-	void Initialize(ID3D12Device3* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity);
+	static const uint32_t sInvalidSlot = uint32_t(-1);
+
+	void Initialize(ID3D12Device3* device, ID3D12Fence* fence, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t capacity);
 	void Destroy();
 
 	// Allocate space for all static resources
 	void AllocateStaticResources(int numResources);
 
+	// Reserve a range after the static resources for descriptors which are managed from outside. Returns the first slot of the range
+	// NB: Must be called after AllocateStaticResources and before any dynamic allocation
+	uint32_t ReservePersistentResources(uint32_t numResources);
+
 	// Allocate a single new dynamic resource
-	// This is using ring buffer scheme for allocation
+	// This is using ring buffer scheme for allocation. If the ring is full it will wait for the oldest frame in flight.
+	// Returns sInvalidSlot if the current frame alone has used the whole ring, as every slot could still be read by it
 	// NB: You have to first call AllocateStaticResources before calling this method
 	uint32_t AllocateDynamicResource();
 
+	D3D12_CPU_DESCRIPTOR_HANDLE GetCPUHandle(uint32_t slot) const;
+
+	// Closes the region of the current frame, which will be released when the fence reaches fenceValue
+	void EndFrame(uint64_t fenceValue);
+
 	ComPtr<ID3D12DescriptorHeap> Heap;
 private:
+	// Returns false if there is no frame to wait for
+	bool WaitForOldestFrame();
+
+	ID3D12Fence* m_Fence = nullptr;
+	HANDLE m_FenceEvent = nullptr;
+	uint32_t m_DescriptorSize = 0;
+
 	uint32_t m_Capacity = 0;
 	uint32_t m_NumStaticResources = 0;
-	uint32_t m_CurrentSlot = 0;
+	uint32_t m_DynamicStart = 0;
+
+	// Virtual offsets inside of the dynamic part. They only increase, the physical slot is the offset modulo the dynamic capacity
+	uint64_t m_NextVirtualSlot = 0;
+	// Everything before this virtual offset is safe to be written to
+	uint64_t m_VirtualLimit = 0;
+	uint64_t m_CurrentFrameStart = 0;
+
+	struct InFlightRegion
+	{
+		uint64_t VirtualEnd;
+		uint64_t FenceValue;
+	};
+	eastl::deque<InFlightRegion> m_InFlightRegions;
+	uint32_t m_Stalls = 0;
 };
 }
 }
\ No newline at end of file
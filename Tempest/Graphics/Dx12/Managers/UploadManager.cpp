@@ -0,0 +1,371 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/Dx12/Managers/UploadManager.h>
+#include <Job/JobSystem.h>
+
+namespace Tempest
+{
+namespace Dx12
+{
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+void UploadManager::Initialize(ID3D12Device3* device, Job::JobSystem& jobSystem)
+{
+	m_Device = device;
+	m_JobSystem = &jobSystem;
+
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	CHECK_SUCCESS(m_Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_CopyQueue)));
+	m_CopyQueue->SetName(L"Upload Copy Queue");
+
+	CHECK_SUCCESS(m_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_Fence)));
+
+	m_Capacity = sRingSize;
+	m_Ring = CreateUploadHeap(m_Capacity, reinterpret_cast<void**>(&m_PersistentMappedMemoryPointer));
+	m_Ring->SetName(L"Upload Staging Ring");
+}
+
+void UploadManager::Destroy()
+{
+	Flush();
+	Wait(m_LastSubmittedTicket);
+
+	m_Regions.clear();
+	m_FreeContexts.clear();
+	m_InFlightContexts.clear();
+	m_InFlightHeaps.clear();
+
+	m_Ring->Unmap(0, nullptr);
+	m_Ring.Reset();
+	m_Fence.Reset();
+	m_CopyQueue.Reset();
+}
+
+ComPtr<ID3D12Resource> UploadManager::CreateUploadHeap(uint64_t size, void** mappedData)
+{
+	D3D12_HEAP_PROPERTIES props;
+	::ZeroMemory(&props, sizeof(D3D12_HEAP_PROPERTIES));
+	props.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	D3D12_RESOURCE_DESC desc;
+	::ZeroMemory(&desc, sizeof(D3D12_RESOURCE_DESC));
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Width = size;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	ComPtr<ID3D12Resource> heap;
+	CHECK_SUCCESS(m_Device->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&heap)));
+
+	D3D12_RANGE range;
+	::ZeroMemory(&range, sizeof(D3D12_RANGE)); // This will tell that we won't read the data from CPU
+	CHECK_SUCCESS(heap->Map(0, &range, mappedData));
+	return heap;
+}
+
+UploadData UploadManager::Allocate(uint64_t size)
+{
+	OPTICK_EVENT();
+	UploadData result;
+	size = AlignUp(eastl::max(size, uint64_t(1)), sAlignment);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	uint64_t virtualOffset = sInvalidStagingRegion;
+	result.StagingRegion = sInvalidStagingRegion;
+	if (size <= sMaxRingAllocation)
+	{
+		virtualOffset = AllocateStagingLocked(size, result.StagingRegion, lock);
+	}
+
+	if (virtualOffset != sInvalidStagingRegion)
+	{
+		result.UploadHeap = m_Ring;
+		result.MappedData = m_PersistentMappedMemoryPointer;
+		result.CurrentOffset = virtualOffset % m_Capacity;
+	}
+	else
+	{
+		result.UploadHeap = CreateUploadHeap(size, &result.MappedData);
+		result.UploadHeap->SetName(L"Dedicated Upload Heap");
+		result.CurrentOffset = 0;
+		++m_Statistics.DedicatedUploads;
+	}
+	result.BeginOffset = result.CurrentOffset;
+	result.EndOffset = result.CurrentOffset + size;
+
+	AcquireCommandContextLocked(result);
+
+	++m_Statistics.Uploads;
+	m_Statistics.StagedBytes += size;
+	return result;
+}
+
+uint64_t UploadManager::AllocateStagingLocked(uint64_t size, uint64_t& regionIndex, std::unique_lock<std::mutex>& lock)
+{
+	uint64_t start = 0;
+	uint64_t end = 0;
+	for (;;)
+	{
+		// Allocations never straddle the end of the ring, the rest of it is skipped and released with the allocation.
+		// Computed again after every wait, as other jobs could have allocated in the meantime
+		start = m_NextVirtualOffset;
+		const uint64_t physicalStart = start % m_Capacity;
+		if (physicalStart + size > m_Capacity)
+		{
+			start += m_Capacity - physicalStart;
+		}
+		end = start + size;
+
+		ReleaseCompletedLocked();
+		if (end - m_ReleasedVirtualEnd <= m_Capacity)
+		{
+			break;
+		}
+
+		// The oldest upload is still being written by some job. Waiting for it could block forever if it's the calling one
+		assert(!m_Regions.empty());
+		const UploadTicket oldestTicket = m_Regions.front().Ticket;
+		if (oldestTicket == 0)
+		{
+			return sInvalidStagingRegion;
+		}
+
+		if (oldestTicket == m_BatchTicket)
+		{
+			FlushLocked();
+		}
+		++m_Statistics.Stalls;
+
+		lock.unlock();
+		WaitForFence(oldestTicket);
+		lock.lock();
+	}
+
+	m_NextVirtualOffset = end;
+	regionIndex = m_FirstRegionIndex + m_Regions.size();
+	m_Regions.push_back(StagingRegion{ end, 0 });
+	return start;
+}
+
+void UploadManager::AcquireCommandContextLocked(UploadData& upload)
+{
+	while (!m_InFlightContexts.empty() && IsCompleted(m_InFlightContexts.front().Ticket))
+	{
+		m_FreeContexts.push_back(eastl::move(m_InFlightContexts.front()));
+		m_InFlightContexts.pop_front();
+	}
+
+	if (!m_FreeContexts.empty())
+	{
+		CommandContext& context = m_FreeContexts.back();
+		CHECK_SUCCESS(context.Allocator->Reset());
+		CHECK_SUCCESS(context.CommandList->Reset(context.Allocator.Get(), nullptr));
+		upload.Allocator = eastl::move(context.Allocator);
+		upload.CommandList = eastl::move(context.CommandList);
+		m_FreeContexts.pop_back();
+		return;
+	}
+
+	CHECK_SUCCESS(m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&upload.Allocator)));
+	upload.Allocator->SetName(L"Upload Command Allocator");
+
+	CHECK_SUCCESS(m_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, upload.Allocator.Get(), nullptr, IID_PPV_ARGS(&upload.CommandList)));
+	upload.CommandList->SetName(L"Upload Command List");
+}
+
+UploadTicket UploadManager::Submit(UploadData& upload)
+{
+	assert(upload.CurrentOffset <= upload.EndOffset);
+	// Closing can be done outside of the lock, as nobody else has the command list
+	CHECK_SUCCESS(upload.CommandList->Close());
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const UploadTicket ticket = m_BatchTicket;
+	if (upload.StagingRegion != sInvalidStagingRegion)
+	{
+		m_Regions[upload.StagingRegion - m_FirstRegionIndex].Ticket = ticket;
+	}
+	else
+	{
+		m_BatchHeaps.push_back(eastl::move(upload.UploadHeap));
+	}
+
+	m_BatchCommandLists.push_back(upload.CommandList.Get());
+	m_BatchContexts.push_back(CommandContext{ eastl::move(upload.Allocator), eastl::move(upload.CommandList), ticket });
+	m_BatchBytes += upload.EndOffset - upload.BeginOffset;
+	upload.UploadHeap.Reset();
+	upload.MappedData = nullptr;
+
+	if (m_BatchBytes >= sMaxBatchBytes)
+	{
+		FlushLocked();
+	}
+	return ticket;
+}
+
+void UploadManager::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	FlushLocked();
+}
+
+void UploadManager::FlushLocked()
+{
+	if (m_BatchCommandLists.empty())
+	{
+		return;
+	}
+
+	OPTICK_EVENT();
+	m_CopyQueue->ExecuteCommandLists(UINT(m_BatchCommandLists.size()), m_BatchCommandLists.data());
+	CHECK_SUCCESS(m_CopyQueue->Signal(m_Fence.Get(), m_BatchTicket));
+
+	for (CommandContext& context : m_BatchContexts)
+	{
+		m_InFlightContexts.push_back(eastl::move(context));
+	}
+	for (ComPtr<ID3D12Resource>& heap : m_BatchHeaps)
+	{
+		m_InFlightHeaps.push_back(DedicatedHeap{ eastl::move(heap), m_BatchTicket });
+	}
+	m_BatchCommandLists.clear();
+	m_BatchContexts.clear();
+	m_BatchHeaps.clear();
+	m_BatchBytes = 0;
+
+	m_LastSubmittedTicket = m_BatchTicket;
+	++m_BatchTicket;
+	++m_Statistics.Batches;
+}
+
+bool UploadManager::IsCompleted(UploadTicket ticket) const
+{
+	return m_Fence->GetCompletedValue() >= ticket;
+}
+
+void UploadManager::Wait(UploadTicket ticket)
+{
+	if (IsCompleted(ticket))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (ticket == m_BatchTicket)
+		{
+			FlushLocked();
+		}
+	}
+
+	WaitForFence(ticket);
+}
+
+void UploadManager::WaitForFence(UploadTicket ticket)
+{
+	OPTICK_EVENT();
+	if (!m_JobSystem->IsRunningJob())
+	{
+		// Null event blocks until the fence is reached, so any number of threads can wait at the same time
+		CHECK_SUCCESS(m_Fence->SetEventOnCompletion(ticket, nullptr));
+		return;
+	}
+
+	struct FenceWait
+	{
+		Job::JobSystem* JobSystem;
+		Job::Counter Counter;
+	};
+	FenceWait wait{ m_JobSystem };
+
+	HANDLE event = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	assert(event);
+	CHECK_SUCCESS(m_Fence->SetEventOnCompletion(ticket, event));
+
+	m_JobSystem->BeginExternalWork(&wait.Counter, 1);
+	HANDLE waitHandle = nullptr;
+	const BOOL registered = ::RegisterWaitForSingleObject(&waitHandle, event, [](PVOID data, BOOLEAN) {
+		FenceWait* wait = reinterpret_cast<FenceWait*>(data);
+		wait->JobSystem->FinishExternalWork(&wait->Counter);
+	}, &wait, INFINITE, WT_EXECUTEONLYONCE);
+
+	if (registered)
+	{
+		m_JobSystem->WaitForCounter(&wait.Counter, 0);
+		// The callback could still be returning, and it uses the wait on this stack
+		::UnregisterWaitEx(waitHandle, INVALID_HANDLE_VALUE);
+	}
+	else
+	{
+		::WaitForSingleObject(event, INFINITE);
+		m_JobSystem->FinishExternalWork(&wait.Counter);
+	}
+	::CloseHandle(event);
+}
+
+void UploadManager::AddFrameDependency(UploadTicket ticket)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_FrameDependency = eastl::max(m_FrameDependency, ticket);
+}
+
+void UploadManager::QueueWaitForFrameDependencies(ID3D12CommandQueue* queue)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_FrameDependency == 0 || IsCompleted(m_FrameDependency))
+	{
+		m_FrameDependency = 0;
+		return;
+	}
+
+	// The queue would wait for a fence value which is never signaled
+	if (m_FrameDependency == m_BatchTicket)
+	{
+		FlushLocked();
+	}
+	CHECK_SUCCESS(queue->Wait(m_Fence.Get(), m_FrameDependency));
+	m_FrameDependency = 0;
+}
+
+void UploadManager::ReleaseCompletedLocked()
+{
+	const UploadTicket completed = m_Fence->GetCompletedValue();
+	while (!m_Regions.empty() && m_Regions.front().Ticket != 0 && m_Regions.front().Ticket <= completed)
+	{
+		m_ReleasedVirtualEnd = m_Regions.front().VirtualEnd;
+		m_Regions.pop_front();
+		++m_FirstRegionIndex;
+	}
+
+	while (!m_InFlightHeaps.empty() && m_InFlightHeaps.front().Ticket <= completed)
+	{
+		m_InFlightHeaps.pop_front();
+	}
+}
+
+void UploadManager::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	FlushLocked();
+	ReleaseCompletedLocked();
+
+	m_LastFrameStatistics = m_Statistics;
+	m_Statistics = UploadFrameStatistics{};
+
+	OPTICK_TAG("Uploads", m_LastFrameStatistics.Uploads);
+	OPTICK_TAG("Upload Batches", m_LastFrameStatistics.Batches);
+	OPTICK_TAG("Upload Staged Bytes", m_LastFrameStatistics.StagedBytes);
+	OPTICK_TAG("Upload Stalls", m_LastFrameStatistics.Stalls);
+}
+}
+}
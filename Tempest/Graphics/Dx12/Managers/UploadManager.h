@@ -0,0 +1,158 @@
+#pragma once
+
+#include <Graphics/Dx12/Dx12Common.h>
+
+#include <mutex>
+#include <EASTL/deque.h>
+
+namespace Tempest
+{
+namespace Job
+{
+class JobSystem;
+}
+
+namespace Dx12
+{
+// Fence value of the batch an upload was submitted in. Zero is always completed
+using UploadTicket = uint64_t;
+
+// Staging memory and command list of a single upload. Resource managers write the data at CurrentOffset and record the copies
+struct UploadData
+{
+	ComPtr<ID3D12CommandAllocator> Allocator;
+	ComPtr<ID3D12GraphicsCommandList6> CommandList;
+	ComPtr<ID3D12Resource> UploadHeap;
+	// Start of the upload heap, offsets are from here
+	void* MappedData;
+	uint64_t CurrentOffset;
+	// Staging memory of the upload in the heap
+	uint64_t BeginOffset;
+	uint64_t EndOffset;
+	// Index of the ring region owning the staging memory, or invalid for a heap of its own
+	uint64_t StagingRegion;
+};
+
+struct UploadFrameStatistics
+{
+	uint32_t Uploads = 0;
+	uint32_t Batches = 0;
+	uint64_t StagedBytes = 0;
+	// Uploads which didn't fit in the ring and got a committed heap of their own
+	uint32_t DedicatedUploads = 0;
+	// How many times an allocation had to wait for the copy queue to release ring memory
+	uint32_t Stalls = 0;
+};
+
+// Staging memory and copy queue for the uploads of static resources, safe to be used from multiple jobs at the same time.
+// The staging memory of every upload is suballocated from a persistently mapped ring over a monotonically increasing virtual offset.
+// Every upload records in a command list of its own, so jobs only lock for the allocation and the submission, not while copying the data.
+// Submitted uploads are gathered in a batch, which is executed on the copy queue when it gets big enough, at the end of every frame
+// or when someone waits for it. Every batch signals its own fence value, which is the ticket of the uploads in it.
+// Ring memory and command lists of a batch are reused after its fence is reached. Uploads too big for the ring get a committed heap.
+// Copy queues cannot transition resources, so everything uploaded is left in the common state and promoted implicitly on its first use.
+struct UploadManager : Utils::NonCopyable
+{
+	static const uint64_t sInvalidStagingRegion = uint64_t(-1);
+
+	void Initialize(ID3D12Device3* device, Job::JobSystem& jobSystem);
+	// Waits for all submitted uploads
+	void Destroy();
+
+	UploadData Allocate(uint64_t size);
+	// Adds the upload to the current batch. The upload data must not be used afterwards
+	UploadTicket Submit(UploadData& upload);
+	// Executes the current batch on the copy queue
+	void Flush();
+	bool IsCompleted(UploadTicket ticket) const;
+	// Waits until the batch with this ticket is copied, submitting it if needed. Jobs yield their worker meanwhile
+	void Wait(UploadTicket ticket);
+	// The next frame waits on the GPU for this upload before it starts. Only for what the frame reads right away, like the level
+	// or grown buffers. Uploads which are swapped in later, like the streamed mips, are polled with IsCompleted instead
+	void AddFrameDependency(UploadTicket ticket);
+	// Makes the queue wait on the GPU for the dependencies added since the last call before executing anything else
+	void QueueWaitForFrameDependencies(ID3D12CommandQueue* queue);
+
+	// Flushes the batch of the frame and releases what the copy queue is done with
+	void EndFrame();
+
+	const UploadFrameStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	struct StagingRegion
+	{
+		uint64_t VirtualEnd;
+		// Zero until the upload is submitted
+		UploadTicket Ticket;
+	};
+
+	struct CommandContext
+	{
+		ComPtr<ID3D12CommandAllocator> Allocator;
+		ComPtr<ID3D12GraphicsCommandList6> CommandList;
+		UploadTicket Ticket;
+	};
+
+	struct DedicatedHeap
+	{
+		ComPtr<ID3D12Resource> Heap;
+		UploadTicket Ticket;
+	};
+
+	ComPtr<ID3D12Resource> CreateUploadHeap(uint64_t size, void** mappedData);
+	// Returns the virtual offset of the staging memory, or invalid if the ring cannot fit it.
+	// Unlocks while waiting for the copy queue, so other jobs can submit and allocate in the meantime
+	uint64_t AllocateStagingLocked(uint64_t size, uint64_t& regionIndex, std::unique_lock<std::mutex>& lock);
+	void AcquireCommandContextLocked(UploadData& upload);
+	void ReleaseCompletedLocked();
+	void FlushLocked();
+	// Jobs wait on a counter finished by the system thread pool when the fence is reached, anything else blocks
+	void WaitForFence(UploadTicket ticket);
+
+	ID3D12Device3* m_Device = nullptr;
+	Job::JobSystem* m_JobSystem = nullptr;
+	ComPtr<ID3D12CommandQueue> m_CopyQueue;
+	ComPtr<ID3D12Fence> m_Fence;
+
+	ComPtr<ID3D12Resource> m_Ring;
+	uint8_t* m_PersistentMappedMemoryPointer = nullptr;
+	uint64_t m_Capacity = 0;
+
+	std::mutex m_Mutex;
+	// Virtual offsets in bytes. They only increase, the physical offset is the virtual one modulo the capacity
+	uint64_t m_NextVirtualOffset = 0;
+	// Everything before this virtual offset is safe to be written to
+	uint64_t m_ReleasedVirtualEnd = 0;
+	// Regions are released in order, so an unsubmitted upload holds back everything allocated after it
+	eastl::deque<StagingRegion> m_Regions;
+	uint64_t m_FirstRegionIndex = 0;
+
+	eastl::vector<CommandContext> m_FreeContexts;
+	eastl::deque<CommandContext> m_InFlightContexts;
+	eastl::deque<DedicatedHeap> m_InFlightHeaps;
+
+	// Current batch, which will signal m_BatchTicket
+	eastl::vector<ID3D12CommandList*> m_BatchCommandLists;
+	eastl::vector<CommandContext> m_BatchContexts;
+	eastl::vector<ComPtr<ID3D12Resource>> m_BatchHeaps;
+	uint64_t m_BatchBytes = 0;
+	UploadTicket m_BatchTicket = 1;
+	UploadTicket m_LastSubmittedTicket = 0;
+	// Batches complete in order, so waiting for the newest dependency waits for all of them
+	UploadTicket m_FrameDependency = 0;
+
+	UploadFrameStatistics m_Statistics;
+	UploadFrameStatistics m_LastFrameStatistics;
+
+	static const uint64_t sRingSize = 64ull * 1024 * 1024;
+	// Bigger uploads get their own heap, so one of them cannot block the ring for everyone else
+	static const uint64_t sMaxRingAllocation = sRingSize / 2;
+	// Batches are submitted as soon as they stage that much, so the copy queue starts working during long loads
+	static const uint64_t sMaxBatchBytes = 16ull * 1024 * 1024;
+	// Allocations start aligned for texture data placement, which is the strictest requirement of copies
+	static const uint64_t sAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+};
+}
+}
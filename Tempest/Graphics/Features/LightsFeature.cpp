@@ -13,10 +13,13 @@ namespace GraphicsFeature
 void Lights::Initialize(const World& world, Renderer& renderer)
 {
 	m_DirectionalLightQuery.Init(world);
+	m_PointLightQuery.Init(world);
+	m_SpotLightQuery.Init(world);
 }
 
 void Lights::GatherData(const World& world, FrameData& frameData)
 {
+	frameData.Reserve(frameData.DirectionalLights);
 	m_DirectionalLightQuery.ForEach([&frameData](flecs::entity, Components::Transform& transform, Components::LightColorInfo& lightColorInfo, Tags::DirectionalLight) {
         const glm::mat4x4 scale = glm::scale(transform.Scale);
         const glm::mat4x4 rotate = glm::toMat4(transform.Rotation);
@@ -30,6 +33,46 @@ void Lights::GatherData(const World& world, FrameData& frameData)
 			lightColor
 		});
 	});
+
+	// Anything will do for the shadows if there is no light, as it is black
+	frameData.MainDirectionalLight = FrameData::DirectionalLight{ -sUpDirection, glm::vec3(0.0f) };
+	float mainLightLuminance = -1.0f;
+	for (const FrameData::DirectionalLight& light : frameData.DirectionalLights)
+	{
+		const float luminance = glm::dot(light.Color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+		if (luminance > mainLightLuminance)
+		{
+			mainLightLuminance = luminance;
+			frameData.MainDirectionalLight = light;
+		}
+	}
+
+	frameData.Reserve(frameData.LocalLights);
+	m_PointLightQuery.ForEach([&frameData](flecs::entity, Components::Transform& transform, Components::LightColorInfo& lightColorInfo, Components::PointLight& pointLight) {
+		frameData.LocalLights.push_back(FrameData::LocalLight{
+			transform.Position,
+			pointLight.Radius,
+			lightColorInfo.Color * lightColorInfo.Intensity,
+			0.0f,
+			sForwardDirection,
+			1.0f
+		});
+	});
+
+	m_SpotLightQuery.ForEach([&frameData](flecs::entity, Components::Transform& transform, Components::LightColorInfo& lightColorInfo, Components::SpotLight& spotLight) {
+		// Goes from 0 at the outer angle to 1 at the inner one
+		const float cosOuter = glm::cos(spotLight.OuterConeAngle);
+		const float spotScale = 1.0f / eastl::max(glm::cos(spotLight.InnerConeAngle) - cosOuter, 1e-4f);
+		frameData.LocalLights.push_back(FrameData::LocalLight{
+			transform.Position,
+			spotLight.Radius,
+			lightColorInfo.Color * lightColorInfo.Intensity,
+			spotScale,
+			glm::normalize(transform.Rotation * sForwardDirection),
+			-cosOuter * spotScale
+		});
+	});
+	OPTICK_TAG("Local Lights", uint32_t(frameData.LocalLights.size()));
 }
 }
 }
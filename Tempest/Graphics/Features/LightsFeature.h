@@ -19,6 +19,8 @@ struct Lights : RenderFeature
 	virtual void GenerateCommands(const FrameData&, RendererCommandList&, const RenderGraphBlackboard&) override {};
 private:
 	EntityQuery<Components::Transform, Components::LightColorInfo, Tags::DirectionalLight> m_DirectionalLightQuery;
+	EntityQuery<Components::Transform, Components::LightColorInfo, Components::PointLight> m_PointLightQuery;
+	EntityQuery<Components::Transform, Components::LightColorInfo, Components::SpotLight> m_SpotLightQuery;
 };
 }
 }
\ No newline at end of file
@@ -24,6 +24,7 @@ void Rects::Initialize(const World& world, Renderer& renderer)
 
 void Rects::GatherData(const World& world, FrameData& frameData)
 {
+	frameData.Reserve(frameData.Rects);
 	m_Query.ForEach([&frameData](flecs::entity, Components::Transform& transform, Components::Rect& rect) {
 		frameData.Rects.push_back(RectData{
 			transform.Position.x,
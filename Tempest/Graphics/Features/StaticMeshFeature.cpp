@@ -4,6 +4,7 @@
 #include <Graphics/RendererCommandList.h>
 #include <Graphics/Renderer.h>
 #include <Graphics/FrameData.h>
+#include <Graphics/RenderScene.h>
 #include <World/World.h>
 #include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
 #include <Graphics/RenderGraph.h>
@@ -12,10 +13,15 @@ namespace Tempest
 {
 namespace GraphicsFeature
 {
+// About a pixel at 1080p, in normalized screen height
+static const float sMaxScreenError = 2.0f / 1080.0f;
+// Switching to a coarser level needs the error to be this much lower than the limit, so instances don't flicker between levels
+static const float sLodHysteresis = 0.75f;
 
 void StaticMesh::Initialize(const World& world, Renderer& renderer)
 {
-	m_Query.Init(world);
+	m_Meshes = &renderer.Meshes;
+	m_Scene = &renderer.Scene;
 	m_Handle = renderer.RequestPipelineState(PipelineStateDescription{
 		"StaticMesh",
 		RenderPhase::Main
@@ -29,43 +35,126 @@ void StaticMesh::Initialize(const World& world, Renderer& renderer)
 
 void StaticMesh::GatherData(const World& world, FrameData& frameData)
 {
-	m_Query.ForEach([&frameData](flecs::entity, Components::Transform& transform, Components::StaticMesh& staticMesh) {
-		const glm::mat4x4 scale = glm::scale(transform.Scale);
-		const glm::mat4x4 rotate = glm::toMat4(transform.Rotation);
-		const glm::mat4x4 translate = glm::translate(transform.Position);
-
-		frameData.StaticMeshes.push_back(FrameData::StaticMeshData{
-			staticMesh.Mesh,
-			translate * rotate * scale
-		});
-	});
+	// The proxies are already up to date with the world, the rest is gathered only for the culled ones in GatherVisibleData
+}
+
+void StaticMesh::GatherVisibleData(const World& world, FrameData& frameData)
+{
+	OPTICK_EVENT();
+	// The views come with proxy indices. Every proxy visible in any of them gets its LOD and a single entry in the frame data,
+	// and the views are changed to point to that entry
+	eastl::span<StaticMeshProxy> proxies = m_Scene->GetStaticMeshes();
+	if (m_FrameMeshIndices.size() < proxies.size())
+	{
+		m_FrameMeshIndices.resize(proxies.size(), sInvalidIndex);
+	}
+	const size_t maxVisibleMeshes = eastl::min(frameData.MainViewStaticMeshes.size() + frameData.ShadowViewStaticMeshes.size(), proxies.size());
+	frameData.Reserve(frameData.StaticMeshes, uint32_t(maxVisibleMeshes));
+
+	uint32_t fullTriangles = 0;
+	uint32_t renderedTriangles = 0;
+	FrameDataArray<uint32_t>* viewMeshes[] = { &frameData.MainViewStaticMeshes, &frameData.ShadowViewStaticMeshes };
+	for (FrameDataArray<uint32_t>* meshes : viewMeshes)
+	{
+		for (uint32_t& meshIndex : *meshes)
+		{
+			const uint32_t instance = meshIndex;
+			uint32_t& frameMeshIndex = m_FrameMeshIndices[instance];
+			if (frameMeshIndex == sInvalidIndex)
+			{
+				StaticMeshProxy& proxy = proxies[instance];
+				proxy.Lod = SelectLod(proxy, frameData);
+				if (const MeshLodInfo* lodInfo = m_Meshes->GetLodInfo(proxy.Mesh))
+				{
+					fullTriangles += lodInfo->TriangleCounts[0];
+					renderedTriangles += lodInfo->TriangleCounts[proxy.Lod];
+				}
+
+				frameMeshIndex = uint32_t(frameData.StaticMeshes.size());
+				frameData.StaticMeshes.push_back(FrameData::StaticMeshData{
+					proxy.Mesh,
+					proxy.WorldMatrix,
+					false,
+					proxy.Lod,
+					instance
+				});
+			}
+			meshIndex = frameMeshIndex;
+		}
+	}
+
+	for (const FrameData::StaticMeshData& mesh : frameData.StaticMeshes)
+	{
+		m_FrameMeshIndices[mesh.Instance] = sInvalidIndex;
+	}
+
+	OPTICK_TAG("Full Triangles", fullTriangles);
+	OPTICK_TAG("Rendered Triangles", renderedTriangles);
+	OPTICK_TAG("LOD Saved Triangles", fullTriangles - renderedTriangles);
+}
+
+uint32_t StaticMesh::SelectLod(const StaticMeshProxy& proxy, const FrameData& frameData) const
+{
+	const MeshLodInfo* lodInfo = m_Meshes->GetLodInfo(proxy.Mesh);
+	if (!lodInfo || lodInfo->LodCount <= 1)
+	{
+		return 0;
+	}
+
+	// Distance to the closest point of the bounding sphere, so big meshes don't go coarse while the camera is next to them
+	const float distance = eastl::max(glm::length(proxy.BoundsCenter - frameData.CameraPosition) - proxy.BoundsRadius, 0.01f);
+	const float errorToScreen = proxy.MaxScale * frameData.ProjectionScale / distance;
+	const uint32_t previousLod = proxy.Lod;
+
+	uint32_t lod = 0;
+	for (uint32_t level = 1; level < lodInfo->LodCount; ++level)
+	{
+		const float maxError = level > previousLod ? sMaxScreenError * sLodHysteresis : sMaxScreenError;
+		if (lodInfo->Errors[level] * errorToScreen > maxError)
+		{
+			break;
+		}
+		lod = level;
+	}
+	return lod;
 }
 
 void StaticMesh::GenerateCommands(const FrameData& data, RendererCommandList& commandList, const RenderGraphBlackboard& blackboard)
 {
 	struct GeometryConstants
 	{
-		glm::mat4x4 worldMatrix;
+		uint32_t instanceIndex;
 		uint32_t meshletOffset;
 		uint32_t materialIndex;
 	};
 	Dx12::ConstantBufferDataManager& constantDataManager = blackboard.GetConstantDataManager();
 
-	for (const auto& mesh : data.StaticMeshes)
+	const bool isMainPhase = blackboard.GetRenderPhase() == RenderPhase::Main;
+	const FrameDataArray<uint32_t>& visibleMeshes = isMainPhase ? data.MainViewStaticMeshes : data.ShadowViewStaticMeshes;
+	for (uint32_t meshIndex : visibleMeshes)
 	{
+		const FrameData::StaticMeshData& mesh = data.StaticMeshes[meshIndex];
+		if (mesh.IsOccluded && isMainPhase)
+		{
+			continue;
+		}
+
 		auto primitiveMeshes = blackboard.GetRenderer().Meshes.GetMeshData(mesh.Mesh);
-		for(const auto& meshData : primitiveMeshes)
+		for (uint32_t primitiveIndex = 0; primitiveIndex < primitiveMeshes.size(); ++primitiveIndex)
 		{
+			const auto& meshData = primitiveMeshes[primitiveIndex];
+			const Definition::MeshLod& lod = blackboard.GetRenderer().Meshes.GetPrimitiveLod(mesh.Mesh, primitiveIndex, mesh.Lod);
+
 			GeometryConstants constants;
-			constants.worldMatrix = mesh.Transform;
-			constants.meshletOffset = meshData.meshlets_offset();
+			constants.instanceIndex = mesh.Instance;
+			constants.meshletOffset = lod.meshlets_offset();
 			constants.materialIndex = meshData.material_index();
 
 			RendererCommandDrawMeshlet command;
-			command.Pipeline = blackboard.GetRenderPhase() == RenderPhase::Main ? m_Handle : m_ShadowHandle;
+			command.Pipeline = isMainPhase ? m_Handle : m_ShadowHandle;
 			command.ParameterViews[size_t(ShaderParameterType::Scene)].ConstantDataOffset = blackboard.GetConstantDataOffset(BlackboardIdentifier{ "SceneData" });
 			command.ParameterViews[size_t(ShaderParameterType::Geometry)].ConstantDataOffset = constantDataManager.AddData(constants);
-			command.MeshletCount = meshData.meshlets_count();
+			command.MeshletCount = lod.meshlets_count();
 			commandList.AddCommand(command);
 		}
 	}
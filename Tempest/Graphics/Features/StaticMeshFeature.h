@@ -1,11 +1,13 @@
 #pragma once
 
 #include <Graphics/RenderFeature.h>
-#include <World/EntityQuery.h>
-#include <World/Components/Components.h>
 
 namespace Tempest
 {
+class MeshManager;
+class RenderScene;
+struct StaticMeshProxy;
+
 namespace GraphicsFeature
 {
 struct StaticMesh : RenderFeature
@@ -15,11 +17,19 @@ struct StaticMesh : RenderFeature
 
 	virtual void Initialize(const World& world, Renderer& renderer) override;
 	virtual void GatherData(const World&, FrameData&) override;
+	virtual void GatherVisibleData(const World&, FrameData&) override;
 	virtual void GenerateCommands(const FrameData& data, RendererCommandList& commandList, const RenderGraphBlackboard& blackboard) override;
 private:
-	EntityQuery<Components::Transform, Components::StaticMesh> m_Query;
+	uint32_t SelectLod(const StaticMeshProxy& proxy, const FrameData& frameData) const;
+
+	static const uint32_t sInvalidIndex = uint32_t(-1);
+
+	const MeshManager* m_Meshes = nullptr;
+	RenderScene* m_Scene = nullptr;
 	PipelineStateHandle m_Handle;
 	PipelineStateHandle m_ShadowHandle;
+	// Index in the frame data of every proxy, invalid for the ones not added yet. Reset after every frame
+	eastl::vector<uint32_t> m_FrameMeshIndices;
 };
 }
 }
\ No newline at end of file
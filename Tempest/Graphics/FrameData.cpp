@@ -0,0 +1,50 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/FrameData.h>
+
+namespace Tempest
+{
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+void FrameData::BeginFrame()
+{
+	++FrameIndex;
+	ResetArray(Rects);
+	ResetArray(StaticMeshes);
+	ResetArray(MainViewStaticMeshes);
+	ResetArray(ShadowViewStaticMeshes);
+	ResetArray(DirectionalLights);
+	ResetArray(LocalLights);
+
+	// The used size includes the overflow, so everything from the last frame fits in a single block from now on
+	if (m_UsedSize > m_Memory.size())
+	{
+		m_Memory.resize(m_UsedSize);
+	}
+	m_OverflowBlocks.clear();
+	m_UsedSize = 0;
+	m_OverflowSize = 0;
+}
+
+void* FrameData::Allocate(size_t size, size_t alignment)
+{
+	if (size == 0)
+	{
+		return nullptr;
+	}
+
+	const uint64_t offset = AlignUp(m_UsedSize, alignment);
+	m_UsedSize = offset + size;
+	if (m_UsedSize <= m_Memory.size())
+	{
+		return m_Memory.data() + offset;
+	}
+
+	m_OverflowBlocks.emplace_back(new uint8_t[size]);
+	m_OverflowSize += size;
+	return m_OverflowBlocks.back().get();
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Graphics/RendererTypes.h>
+#include <EASTL/type_traits.h>
 
 namespace Tempest
 {
@@ -14,26 +15,172 @@ struct RectData
 	glm::vec4 color;
 };
 
-struct FrameData
+struct FrameData;
+
+// Array living inside of the frame data memory. It is valid only until the next frame starts.
+// Growing past the reserved size is supported, but it wastes memory from the arena, so features should reserve up front.
+template<typename T>
+class FrameDataArray : Utils::NonCopyable
+{
+	// Nothing is destructed, the memory is just reused next frame
+	static_assert(eastl::is_trivially_destructible<T>::value, "Frame data must be trivially destructible");
+public:
+	void push_back(const T& value);
+
+	T* begin() { return m_Data; }
+	T* end() { return m_Data + m_Size; }
+	const T* begin() const { return m_Data; }
+	const T* end() const { return m_Data + m_Size; }
+	T& operator[](size_t index) { return m_Data[index]; }
+	const T& operator[](size_t index) const { return m_Data[index]; }
+	size_t size() const { return m_Size; }
+	bool empty() const { return m_Size == 0; }
+
+	// Size from the previous frame
+	uint32_t GetSizeHint() const
+	{
+		return m_SizeHint;
+	}
+private:
+	friend struct FrameData;
+
+	FrameData* m_Owner = nullptr;
+	T* m_Data = nullptr;
+	uint32_t m_Size = 0;
+	uint32_t m_Capacity = 0;
+	uint32_t m_SizeHint = 0;
+};
+
+// All data gathered from the world for a single frame. Everything is suballocated from one block of memory which is reused between frames.
+// Features reserve their arrays in GatherData, usually with the size from the previous frame, so in a steady state there are no allocations.
+// If the block is not enough, the missing memory comes from the heap for this frame and the block is grown in the next one.
+struct FrameData : Utils::NonCopyable
 {
-	uint64_t FrameIndex;
+	// Forgets all arrays from the previous frame and keeps their sizes as hints
+	void BeginFrame();
+
+	// Array must be empty. The memory could be grown later, but that is slower
+	template<typename T>
+	void Reserve(FrameDataArray<T>& array, uint32_t capacity)
+	{
+		assert(array.m_Size == 0);
+		array.m_Owner = this;
+		array.m_Data = reinterpret_cast<T*>(Allocate(sizeof(T) * capacity, alignof(T)));
+		array.m_Capacity = capacity;
+	}
+
+	// Reserves as much as was used in the previous frame
+	template<typename T>
+	void Reserve(FrameDataArray<T>& array)
+	{
+		Reserve(array, array.GetSizeHint());
+	}
+
+	uint64_t FrameIndex = 0;
 
 	glm::mat4x4 ViewProjection;
+	glm::mat4x4 View;
+	glm::mat4x4 Projection;
+	glm::mat4x4 ShadowViewProjection;
+	glm::vec3 CameraPosition;
+	float ProjectionScale;
+	float NearPlane;
+	float FarPlane;
 
-	// TODO: This is not very good memory wise as it contains pointers. We need a single allocation and just suballocate from it.
-	eastl::vector<RectData> Rects;
+	FrameDataArray<RectData> Rects;
 	// TODO: This should not be part of this. This class should only be a memory pool in which every feature writes arbitrary data.
 	struct StaticMeshData {
 		MeshHandle Mesh;
 		glm::mat4x4 Transform;
+		// Hidden behind other meshes in the main view. Shadows still need it, so it is not removed from the list
+		bool IsOccluded = false;
+		// Level of detail for all passes
+		uint32_t Lod = 0;
+		// Index in the GPU instance buffer of the render scene
+		uint32_t Instance = 0;
 	};
-	eastl::vector<StaticMeshData> StaticMeshes;
+	// Only the meshes visible in at least one of the views
+	FrameDataArray<StaticMeshData> StaticMeshes;
+	// Indices in StaticMeshes of the meshes inside of the frustum of each view
+	FrameDataArray<uint32_t> MainViewStaticMeshes;
+	FrameDataArray<uint32_t> ShadowViewStaticMeshes;
 
 	struct DirectionalLight
 	{
 		glm::vec3 Direction;
 		glm::vec3 Color;
 	};
-	eastl::vector<DirectionalLight> DirectionalLights;
+	FrameDataArray<DirectionalLight> DirectionalLights;
+	// Brightest of the directional lights, which is the one casting shadows. Black if there are no directional lights
+	DirectionalLight MainDirectionalLight;
+
+	// Point and spot lights, which are binned in the clusters of the main view
+	struct LocalLight
+	{
+		glm::vec3 Position;
+		float Radius;
+		glm::vec3 Color;
+		// The cone attenuation is saturate(dot(Direction, lightToPixel) * SpotScale + SpotOffset), so point lights have 0 and 1
+		float SpotScale;
+		glm::vec3 Direction;
+		float SpotOffset;
+	};
+	FrameDataArray<LocalLight> LocalLights;
+
+	uint64_t GetArenaSize() const
+	{
+		return m_Memory.size();
+	}
+
+	// Bytes which did not fit in the arena in the current frame
+	uint64_t GetOverflowSize() const
+	{
+		return m_OverflowSize;
+	}
+private:
+	template<typename T>
+	friend class FrameDataArray;
+
+	void* Allocate(size_t size, size_t alignment);
+
+	template<typename T>
+	void Grow(FrameDataArray<T>& array)
+	{
+		// The old memory is just left behind, it will be reused from the next frame
+		const uint32_t newCapacity = eastl::max(array.m_Capacity * 2, 16u);
+		T* newData = reinterpret_cast<T*>(Allocate(sizeof(T) * newCapacity, alignof(T)));
+		if (array.m_Size > 0)
+		{
+			memcpy(newData, array.m_Data, sizeof(T) * array.m_Size);
+		}
+		array.m_Data = newData;
+		array.m_Capacity = newCapacity;
+	}
+
+	template<typename T>
+	static void ResetArray(FrameDataArray<T>& array)
+	{
+		array.m_SizeHint = array.m_Size;
+		array.m_Data = nullptr;
+		array.m_Size = 0;
+		array.m_Capacity = 0;
+	}
+
+	eastl::vector<uint8_t> m_Memory;
+	uint64_t m_UsedSize = 0;
+	// Only used when the arena is full
+	eastl::vector<eastl::unique_ptr<uint8_t[]>> m_OverflowBlocks;
+	uint64_t m_OverflowSize = 0;
 };
+
+template<typename T>
+void FrameDataArray<T>::push_back(const T& value)
+{
+	if (m_Size == m_Capacity)
+	{
+		assert(m_Owner && "Array must be reserved before use");
+		m_Owner->Grow(*this);
+	}
+	m_Data[m_Size++] = value;
+}
 }
@@ -4,38 +4,136 @@
 
 namespace Tempest
 {
-eastl::span<const Definition::PrimitiveMeshData> MeshManager::GetMeshData(MeshHandle handle) const
+template<typename T>
+static eastl::span<const T> ViewOf(const flatbuffers::Vector<const T*>* vector)
 {
-	auto findItr = m_StaticMeshes.find(handle);
-	if(findItr != m_StaticMeshes.end())
-	{
-		return eastl::span<const Definition::PrimitiveMeshData>(
-			&m_PrimitiveMeshes[findItr->second.primitive_mesh_offset()],
-			findItr->second.primitive_mesh_count()
-		);
-	}
-
-	return {};
+	return vector ? eastl::span<const T>(reinterpret_cast<const T*>(vector->Data()), vector->size()) : eastl::span<const T>();
 }
 
 void MeshManager::LoadFromDatabase(const Definition::GeometryDatabase* database)
 {
-	m_PrimitiveMeshes.reserve(database->primitive_meshes()->size());
-	for(const auto& primitiveMesh : *database->primitive_meshes())
+	if (!m_Meshes.empty())
 	{
-		m_PrimitiveMeshes.push_back(*primitiveMesh);
+		LOG(Error, StaticMeshes, "Only a single geometry database is supported!");
+		assert(false);
+		return;
 	}
 
+	// Copied, so the database can be released after its buffers are uploaded
+	const eastl::span<const Definition::PrimitiveMeshData> databasePrimitiveMeshes = ViewOf(database->primitive_meshes());
+	const eastl::span<const Definition::PrimitiveMeshLods> databasePrimitiveLods = ViewOf(database->primitive_lods());
+	const eastl::span<const Definition::MeshLod> databaseLods = ViewOf(database->lods());
+	const eastl::span<const Definition::Material> databaseMaterials = ViewOf(database->materials());
+	m_PrimitiveMeshes.assign(databasePrimitiveMeshes.begin(), databasePrimitiveMeshes.end());
+	m_Materials.assign(databaseMaterials.begin(), databaseMaterials.end());
+	if (database->primitive_uv_densities() && database->primitive_uv_densities()->size() == m_PrimitiveMeshes.size())
+	{
+		m_UVDensities.assign(database->primitive_uv_densities()->data(), database->primitive_uv_densities()->data() + database->primitive_uv_densities()->size());
+	}
+	if (databasePrimitiveLods.size() == m_PrimitiveMeshes.size())
+	{
+		m_PrimitiveLods.assign(databasePrimitiveLods.begin(), databasePrimitiveLods.end());
+		m_Lods.assign(databaseLods.begin(), databaseLods.end());
+	}
+	else
+	{
+		// Older databases are cooked without levels of detail, so the full mesh is the only one
+		m_PrimitiveLods.reserve(m_PrimitiveMeshes.size());
+		m_Lods.reserve(m_PrimitiveMeshes.size());
+		for (const Definition::PrimitiveMeshData& primitiveMesh : m_PrimitiveMeshes)
+		{
+			uint32_t triangleCount = 0;
+			for (uint32_t meshletIndex = primitiveMesh.meshlets_offset(); meshletIndex < primitiveMesh.meshlets_offset() + primitiveMesh.meshlets_count(); ++meshletIndex)
+			{
+				triangleCount += database->meshlet_buffer()->Get(meshletIndex)->triangle_count();
+			}
+			m_PrimitiveLods.emplace_back(uint32_t(m_Lods.size()), 1);
+			m_Lods.emplace_back(primitiveMesh.meshlets_offset(), primitiveMesh.meshlets_count(), triangleCount, 0.0f);
+		}
+	}
+	const eastl::span<const Definition::PrimitiveMeshData> primitiveMeshes(m_PrimitiveMeshes.data(), m_PrimitiveMeshes.size());
+	const eastl::span<const Definition::PrimitiveMeshLods> primitiveLods(m_PrimitiveLods.data(), m_PrimitiveLods.size());
+	const eastl::span<const float> uvDensities(m_UVDensities.data(), m_UVDensities.size());
+
+	// Mappings are sorted by the index, so the last one is the biggest
+	const uint32_t meshCount = database->mappings()->size() > 0 ? database->mappings()->Get(database->mappings()->size() - 1)->index() + 1 : 0;
+	m_Meshes.resize(meshCount);
+	m_LodInfos.resize(meshCount);
 	for (const auto& meshMapping : *database->mappings())
 	{
-		// All static meshes should have the vertex buffer from the geometry database
 		MeshHandle handle(meshMapping->index());
-		if(m_StaticMeshes.find(handle) != m_StaticMeshes.end())
+		if (!m_Meshes[handle].Primitives.empty())
 		{
 			LOG(Error, StaticMeshes, "Trying to insert a static mesh which is already registered!");
 			assert(false);
 		}
-		m_StaticMeshes.emplace(eastl::make_pair(handle, meshMapping->mesh_data()));
+
+		const Definition::MeshData& meshData = meshMapping->mesh_data();
+		MeshEntry& mesh = m_Meshes[handle];
+		mesh.Primitives = primitiveMeshes.subspan(meshData.primitive_mesh_offset(), meshData.primitive_mesh_count());
+		mesh.PrimitiveLods = primitiveLods.subspan(meshData.primitive_mesh_offset(), meshData.primitive_mesh_count());
+		if (!uvDensities.empty())
+		{
+			mesh.UVDensities = uvDensities.subspan(meshData.primitive_mesh_offset(), meshData.primitive_mesh_count());
+		}
+
+		MeshLodInfo& lodInfo = m_LodInfos[handle];
+		for (const Definition::PrimitiveMeshLods& lods : mesh.PrimitiveLods)
+		{
+			lodInfo.LodCount = eastl::max(lodInfo.LodCount, eastl::min(lods.lod_count(), sMaxMeshLods));
+		}
+
+		for (uint32_t level = 0; level < lodInfo.LodCount; ++level)
+		{
+			for (const Definition::PrimitiveMeshLods& lods : mesh.PrimitiveLods)
+			{
+				const Definition::MeshLod& lod = m_Lods[lods.lod_offset() + eastl::min(level, lods.lod_count() - 1)];
+				lodInfo.Errors[level] = eastl::max(lodInfo.Errors[level], lod.error());
+				lodInfo.TriangleCounts[level] += lod.triangle_count();
+			}
+		}
+	}
+
+	// Older databases are cooked without occluders
+	if (!database->occluders() || database->occluders()->size() != database->primitive_meshes()->size())
+	{
+		LOG(Warning, StaticMeshes, "Geometry database has no occluder data, occlusion culling will not be used for it.");
+		return;
+	}
+
+	m_Occluders.resize(meshCount);
+	for (const auto& meshMapping : *database->mappings())
+	{
+		MeshOccluder& occluder = m_Occluders[MeshHandle(meshMapping->index())];
+		occluder.BoundsMin = glm::vec3(FLT_MAX);
+		occluder.BoundsMax = glm::vec3(-FLT_MAX);
+
+		const Definition::MeshData& meshData = meshMapping->mesh_data();
+		for (uint32_t primitiveIndex = meshData.primitive_mesh_offset(); primitiveIndex < meshData.primitive_mesh_offset() + meshData.primitive_mesh_count(); ++primitiveIndex)
+		{
+			const Definition::OccluderData* primitiveOccluder = database->occluders()->Get(primitiveIndex);
+			occluder.BoundsMin = glm::min(occluder.BoundsMin, glm::vec3(primitiveOccluder->bounds_min().x(), primitiveOccluder->bounds_min().y(), primitiveOccluder->bounds_min().z()));
+			occluder.BoundsMax = glm::max(occluder.BoundsMax, glm::vec3(primitiveOccluder->bounds_max().x(), primitiveOccluder->bounds_max().y(), primitiveOccluder->bounds_max().z()));
+
+			const uint32_t vertexOffset = uint32_t(occluder.Vertices.size());
+			uint32_t primitiveVertexCount = 0;
+			for (uint32_t i = 0; i < primitiveOccluder->index_count(); ++i)
+			{
+				const uint32_t index = database->occluder_indices()->Get(primitiveOccluder->index_offset() + i);
+				occluder.Indices.push_back(vertexOffset + index);
+				primitiveVertexCount = eastl::max(primitiveVertexCount, index + 1);
+			}
+
+			for (uint32_t i = 0; i < primitiveVertexCount; ++i)
+			{
+				const Common::Tempest::Vec3* vertex = database->occluder_vertices()->Get(primitiveOccluder->vertex_offset() + i);
+				occluder.Vertices.emplace_back(vertex->x(), vertex->y(), vertex->z());
+			}
+		}
+
+		MeshLodInfo& lodInfo = m_LodInfos[MeshHandle(meshMapping->index())];
+		lodInfo.BoundsCenter = (occluder.BoundsMin + occluder.BoundsMax) * 0.5f;
+		lodInfo.BoundsRadius = glm::length(occluder.BoundsMax - occluder.BoundsMin) * 0.5f;
 	}
 }
 }
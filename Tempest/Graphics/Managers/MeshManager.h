@@ -11,14 +11,90 @@ namespace Definition {
 	struct GeometryDatabase;
 }
 
+// Simplified version of the whole mesh (all primitives merged) used for occlusion culling on the CPU
+struct MeshOccluder
+{
+	glm::vec3 BoundsMin = glm::vec3(0.0f);
+	glm::vec3 BoundsMax = glm::vec3(0.0f);
+	eastl::vector<glm::vec3> Vertices;
+	eastl::vector<uint32_t> Indices;
+};
+
+static const uint32_t sMaxMeshLods = 8;
+
+// Data for selecting the level of detail of a whole mesh. Levels are shared between all primitives,
+// primitives with fewer levels just keep using their last one.
+struct MeshLodInfo
+{
+	// Bounds come from the occluder data, without it the origin of the mesh is used for the distance
+	glm::vec3 BoundsCenter = glm::vec3(0.0f);
+	float BoundsRadius = 0.0f;
+	uint32_t LodCount = 0;
+	// Max error between all primitives, in mesh space units
+	eastl::array<float, sMaxMeshLods> Errors = {};
+	eastl::array<uint32_t, sMaxMeshLods> TriangleCounts = {};
+};
+
+// All lookups are a single index by the handle, as mesh handles are the dense mapping indices from the geometry database.
+// The small per primitive data is copied out of the database, so it doesn't have to stay loaded after its buffers are uploaded.
 class MeshManager : Utils::NonCopyable
 {
 public:
-	eastl::span<const Definition::PrimitiveMeshData> GetMeshData(MeshHandle handle) const;
+	eastl::span<const Definition::PrimitiveMeshData> GetMeshData(MeshHandle handle) const
+	{
+		return handle < m_Meshes.size() ? m_Meshes[handle].Primitives : eastl::span<const Definition::PrimitiveMeshData>();
+	}
+
+	const MeshLodInfo* GetLodInfo(MeshHandle handle) const
+	{
+		return handle < m_LodInfos.size() ? &m_LodInfos[handle] : nullptr;
+	}
+
+	// Meshlets to draw for the primitive of the mesh, lod is clamped to the levels of that primitive
+	const Definition::MeshLod& GetPrimitiveLod(MeshHandle handle, uint32_t primitiveIndex, uint32_t lod) const
+	{
+		const Definition::PrimitiveMeshLods& primitiveLods = m_Meshes[handle].PrimitiveLods[primitiveIndex];
+		return m_Lods[primitiveLods.lod_offset() + eastl::min(lod, primitiveLods.lod_count() - 1)];
+	}
+
+	// UV units per mesh space unit of the primitive. 0 if unknown, as older databases don't have it
+	float GetPrimitiveUVDensity(MeshHandle handle, uint32_t primitiveIndex) const
+	{
+		const eastl::span<const float> densities = m_Meshes[handle].UVDensities;
+		return primitiveIndex < densities.size() ? densities[primitiveIndex] : 0.0f;
+	}
+
+	const Definition::Material& GetMaterial(uint32_t materialIndex) const
+	{
+		return m_Materials[materialIndex];
+	}
+
+	// Returns nullptr if the geometry database doesn't have occluders
+	const MeshOccluder* GetOccluder(MeshHandle handle) const
+	{
+		return handle < m_Occluders.size() ? &m_Occluders[handle] : nullptr;
+	}
+
 	void LoadFromDatabase(const Definition::GeometryDatabase* database);
 private:
-	MeshHandle m_Handle = 0;
-	eastl::unordered_map<MeshHandle, Definition::MeshData> m_StaticMeshes;
+	// Views inside of the copied data below
+	struct MeshEntry
+	{
+		eastl::span<const Definition::PrimitiveMeshData> Primitives;
+		eastl::span<const Definition::PrimitiveMeshLods> PrimitiveLods;
+		eastl::span<const float> UVDensities;
+	};
+
+	eastl::vector<MeshEntry> m_Meshes;
+	eastl::vector<MeshLodInfo> m_LodInfos;
+	// Empty if the database doesn't have occluders
+	eastl::vector<MeshOccluder> m_Occluders;
 	eastl::vector<Definition::PrimitiveMeshData> m_PrimitiveMeshes;
+	// Generated for older databases without levels of detail
+	eastl::vector<Definition::PrimitiveMeshLods> m_PrimitiveLods;
+	eastl::vector<Definition::MeshLod> m_Lods;
+	// Empty for older databases without them
+	eastl::vector<float> m_UVDensities;
+	eastl::vector<Definition::Material> m_Materials;
 };
 }
@@ -0,0 +1,400 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/OcclusionCulling.h>
+#include <Graphics/Managers/MeshManager.h>
+#include <Graphics/FrameData.h>
+#include <Job/JobSystem.h>
+#include <EASTL/sort.h>
+
+#include <emmintrin.h>
+#include <chrono>
+
+namespace Tempest
+{
+// Anything closer than this is treated as crossing the near plane
+static const float sMinClipW = 1e-3f;
+
+SoftwareOcclusionCulling::SoftwareOcclusionCulling()
+	: m_Depth(sWidth * sHeight, 1.0f)
+	, m_BlockMaxDepth(sBlocksX * sBlocksY, 1.0f)
+{
+}
+
+void SoftwareOcclusionCulling::Execute(Job::JobSystem& jobSystem, const MeshManager& meshes, const glm::vec3& cameraPosition, FrameData& frameData)
+{
+	OPTICK_EVENT();
+	m_LastFrameStatistics = OcclusionCullingStatistics{};
+	m_LastFrameStatistics.TriangleBudget = m_TriangleBudget;
+	if (frameData.MainViewStaticMeshes.empty())
+	{
+		return;
+	}
+
+	m_Meshes = &meshes;
+	m_FrameData = &frameData;
+	m_OccludedMeshes = 0;
+
+	const auto rasterizationStart = std::chrono::high_resolution_clock::now();
+
+	SelectOccluders(meshes, cameraPosition, frameData);
+	SetupTriangles(meshes, frameData);
+
+	{
+		eastl::array<Job::JobDecl, sTilesX * sTilesY> jobs;
+		for (Job::JobDecl& job : jobs)
+		{
+			job = Job::JobDecl{ RasterizeTileJob, this };
+		}
+		Job::Counter counter;
+		jobSystem.RunJobs("Occlusion Rasterize Tile", jobs.data(), uint32_t(jobs.size()), &counter);
+		jobSystem.WaitForCounter(&counter, 0);
+	}
+
+	const auto rasterizationEnd = std::chrono::high_resolution_clock::now();
+	m_LastFrameStatistics.RasterizationMilliseconds = std::chrono::duration<float, std::milli>(rasterizationEnd - rasterizationStart).count();
+
+	// Don't test anything if there is nothing to hide behind
+	if (!m_Triangles.empty())
+	{
+		const uint32_t jobCount = (uint32_t(frameData.MainViewStaticMeshes.size()) + sMeshesPerTestJob - 1) / sMeshesPerTestJob;
+		// TODO: This should be temporary memory
+		eastl::vector<Job::JobDecl> jobs(jobCount, Job::JobDecl{ TestMeshesJob, this });
+		Job::Counter counter;
+		jobSystem.RunJobs("Occlusion Test Meshes", jobs.data(), jobCount, &counter);
+		jobSystem.WaitForCounter(&counter, 0);
+		m_LastFrameStatistics.TestedMeshes = uint32_t(frameData.MainViewStaticMeshes.size());
+	}
+	m_LastFrameStatistics.OccludedMeshes = m_OccludedMeshes.load();
+
+	// Adapt the amount of work for the next frame to fit into the budget
+	if (m_LastFrameStatistics.RasterizationMilliseconds > sTimeBudgetMilliseconds)
+	{
+		m_TriangleBudget = eastl::max(sMinTriangleBudget, m_TriangleBudget - m_TriangleBudget / 4);
+	}
+	else if (m_LastFrameStatistics.RasterizationMilliseconds < sTimeBudgetMilliseconds * 0.5f)
+	{
+		m_TriangleBudget = eastl::min(sMaxTriangleBudget, m_TriangleBudget + m_TriangleBudget / 8);
+	}
+
+	m_Meshes = nullptr;
+	m_FrameData = nullptr;
+
+	OPTICK_TAG("Occluders", m_LastFrameStatistics.Occluders);
+	OPTICK_TAG("Occluder Triangles", m_LastFrameStatistics.OccluderTriangles);
+	OPTICK_TAG("Occluded Meshes", m_LastFrameStatistics.OccludedMeshes);
+	OPTICK_TAG("Rasterization ms", m_LastFrameStatistics.RasterizationMilliseconds);
+}
+
+void SoftwareOcclusionCulling::SelectOccluders(const MeshManager& meshes, const glm::vec3& cameraPosition, const FrameData& frameData)
+{
+	OPTICK_EVENT();
+	struct Candidate
+	{
+		uint32_t MeshIndex;
+		float ScreenSize;
+	};
+	eastl::vector<Candidate> candidates;
+
+	// Meshes outside of the frustum can't hide anything
+	for (uint32_t meshIndex : frameData.MainViewStaticMeshes)
+	{
+		const FrameData::StaticMeshData& mesh = frameData.StaticMeshes[meshIndex];
+		const MeshOccluder* occluder = meshes.GetOccluder(mesh.Mesh);
+		if (!occluder || occluder->Indices.empty())
+		{
+			continue;
+		}
+
+		// Rough bounding sphere in world space, it is enough to find the biggest occluders on screen
+		const glm::vec3 center = glm::vec3(mesh.Transform * glm::vec4((occluder->BoundsMin + occluder->BoundsMax) * 0.5f, 1.0f));
+		const float maxScale = eastl::max(glm::length(glm::vec3(mesh.Transform[0])), eastl::max(glm::length(glm::vec3(mesh.Transform[1])), glm::length(glm::vec3(mesh.Transform[2]))));
+		const float radius = glm::length(occluder->BoundsMax - occluder->BoundsMin) * 0.5f * maxScale;
+		const float distance = eastl::max(glm::length(center - cameraPosition), 0.001f);
+
+		const float screenSize = radius / distance;
+		if (screenSize >= sMinOccluderScreenSize)
+		{
+			candidates.push_back(Candidate{ meshIndex, screenSize });
+		}
+	}
+
+	eastl::sort(candidates.begin(), candidates.end(), [](const Candidate& left, const Candidate& right) {
+		return left.ScreenSize > right.ScreenSize;
+	});
+
+	m_SelectedOccluders.clear();
+	for (uint32_t i = 0; i < eastl::min(uint32_t(candidates.size()), sMaxOccluders); ++i)
+	{
+		m_SelectedOccluders.push_back(candidates[i].MeshIndex);
+	}
+}
+
+void SoftwareOcclusionCulling::SetupTriangles(const MeshManager& meshes, const FrameData& frameData)
+{
+	OPTICK_EVENT();
+	m_Triangles.clear();
+	for (eastl::vector<uint32_t>& bin : m_TileBins)
+	{
+		bin.clear();
+	}
+
+	uint32_t processedTriangles = 0;
+	for (uint32_t meshIndex : m_SelectedOccluders)
+	{
+		const FrameData::StaticMeshData& mesh = frameData.StaticMeshes[meshIndex];
+		const MeshOccluder* occluder = meshes.GetOccluder(mesh.Mesh);
+		const uint32_t triangleCount = uint32_t(occluder->Indices.size() / 3);
+		// Occluders are sorted by importance, so just stop when we are out of budget
+		if (processedTriangles + triangleCount > m_TriangleBudget)
+		{
+			break;
+		}
+		processedTriangles += triangleCount;
+		++m_LastFrameStatistics.Occluders;
+
+		const glm::mat4x4 worldViewProjection = frameData.ViewProjection * mesh.Transform;
+		m_TransformedVertices.resize(occluder->Vertices.size());
+		for (uint32_t i = 0; i < occluder->Vertices.size(); ++i)
+		{
+			m_TransformedVertices[i] = worldViewProjection * glm::vec4(occluder->Vertices[i], 1.0f);
+		}
+
+		for (uint32_t i = 0; i < triangleCount; ++i)
+		{
+			SetupTriangle(
+				m_TransformedVertices[occluder->Indices[i * 3 + 0]],
+				m_TransformedVertices[occluder->Indices[i * 3 + 1]],
+				m_TransformedVertices[occluder->Indices[i * 3 + 2]]
+			);
+		}
+	}
+
+	m_LastFrameStatistics.OccluderTriangles = processedTriangles;
+	m_LastFrameStatistics.RasterizedTriangles = uint32_t(m_Triangles.size());
+}
+
+void SoftwareOcclusionCulling::SetupTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+{
+	// We don't clip, triangles crossing the near plane are just not used as occluders which is still conservative
+	if (clip0.w < sMinClipW || clip1.w < sMinClipW || clip2.w < sMinClipW)
+	{
+		return;
+	}
+
+	auto toScreen = [](const glm::vec4& clip) {
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		return glm::vec3((ndc.x * 0.5f + 0.5f) * float(sWidth), (0.5f - ndc.y * 0.5f) * float(sHeight), ndc.z);
+	};
+	glm::vec3 v0 = toScreen(clip0);
+	glm::vec3 v1 = toScreen(clip1);
+	glm::vec3 v2 = toScreen(clip2);
+
+	// Behind the far plane, so it cannot hide anything
+	const float depth = eastl::max(v0.z, eastl::max(v1.z, v2.z));
+	if (depth >= 1.0f)
+	{
+		return;
+	}
+
+	// Accept both windings as we render the simplified mesh, which could have its triangles flipped
+	const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+	if (glm::abs(area) < 1e-6f)
+	{
+		return;
+	}
+	if (area < 0.0f)
+	{
+		eastl::swap(v1, v2);
+	}
+
+	ScreenTriangle triangle;
+	triangle.MinX = eastl::max(int32_t(glm::floor(eastl::min(v0.x, eastl::min(v1.x, v2.x)))), 0);
+	triangle.MinY = eastl::max(int32_t(glm::floor(eastl::min(v0.y, eastl::min(v1.y, v2.y)))), 0);
+	triangle.MaxX = eastl::min(int32_t(glm::ceil(eastl::max(v0.x, eastl::max(v1.x, v2.x)))), int32_t(sWidth) - 1);
+	triangle.MaxY = eastl::min(int32_t(glm::ceil(eastl::max(v0.y, eastl::max(v1.y, v2.y)))), int32_t(sHeight) - 1);
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+	{
+		return;
+	}
+
+	const glm::vec3* vertices[] = { &v0, &v1, &v2 };
+	for (int edge = 0; edge < 3; ++edge)
+	{
+		const glm::vec3& from = *vertices[edge];
+		const glm::vec3& to = *vertices[(edge + 1) % 3];
+		triangle.EdgeA[edge] = from.y - to.y;
+		triangle.EdgeB[edge] = to.x - from.x;
+		triangle.EdgeC[edge] = -(triangle.EdgeA[edge] * from.x + triangle.EdgeB[edge] * from.y);
+	}
+	triangle.Depth = depth;
+
+	const uint32_t triangleIndex = uint32_t(m_Triangles.size());
+	m_Triangles.push_back(triangle);
+
+	for (int32_t tileY = triangle.MinY / int32_t(sTileHeight); tileY <= triangle.MaxY / int32_t(sTileHeight); ++tileY)
+	{
+		for (int32_t tileX = triangle.MinX / int32_t(sTileWidth); tileX <= triangle.MaxX / int32_t(sTileWidth); ++tileX)
+		{
+			m_TileBins[tileY * sTilesX + tileX].push_back(triangleIndex);
+		}
+	}
+}
+
+void SoftwareOcclusionCulling::RasterizeTile(uint32_t tileIndex)
+{
+	OPTICK_EVENT();
+	const int32_t tileMinX = int32_t((tileIndex % sTilesX) * sTileWidth);
+	const int32_t tileMinY = int32_t((tileIndex / sTilesX) * sTileHeight);
+	const int32_t tileMaxX = tileMinX + int32_t(sTileWidth) - 1;
+	const int32_t tileMaxY = tileMinY + int32_t(sTileHeight) - 1;
+
+	const __m128 farDepth = _mm_set1_ps(1.0f);
+	for (int32_t y = tileMinY; y <= tileMaxY; ++y)
+	{
+		for (int32_t x = tileMinX; x <= tileMaxX; x += 4)
+		{
+			_mm_storeu_ps(&m_Depth[y * sWidth + x], farDepth);
+		}
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 pixelCenterOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	for (uint32_t triangleIndex : m_TileBins[tileIndex])
+	{
+		const ScreenTriangle& triangle = m_Triangles[triangleIndex];
+		const __m128 depth = _mm_set1_ps(triangle.Depth);
+		const __m128 edgeA0 = _mm_set1_ps(triangle.EdgeA[0]);
+		const __m128 edgeA1 = _mm_set1_ps(triangle.EdgeA[1]);
+		const __m128 edgeA2 = _mm_set1_ps(triangle.EdgeA[2]);
+
+		// Tiles are aligned to 4 pixels, so a group of 4 never goes outside of the tile
+		const int32_t startX = eastl::max(triangle.MinX, tileMinX) & ~3;
+		const int32_t endX = eastl::min(triangle.MaxX, tileMaxX);
+		const int32_t startY = eastl::max(triangle.MinY, tileMinY);
+		const int32_t endY = eastl::min(triangle.MaxY, tileMaxY);
+		for (int32_t y = startY; y <= endY; ++y)
+		{
+			const float pixelY = float(y) + 0.5f;
+			const __m128 row0 = _mm_set1_ps(triangle.EdgeB[0] * pixelY + triangle.EdgeC[0]);
+			const __m128 row1 = _mm_set1_ps(triangle.EdgeB[1] * pixelY + triangle.EdgeC[1]);
+			const __m128 row2 = _mm_set1_ps(triangle.EdgeB[2] * pixelY + triangle.EdgeC[2]);
+			float* depthRow = &m_Depth[y * sWidth];
+			for (int32_t x = startX; x <= endX; x += 4)
+			{
+				const __m128 pixelX = _mm_add_ps(_mm_set1_ps(float(x)), pixelCenterOffsets);
+				const __m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), row0);
+				const __m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), row1);
+				const __m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), row2);
+				const __m128 coverage = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+				if (_mm_movemask_ps(coverage) == 0)
+				{
+					continue;
+				}
+
+				const __m128 oldDepth = _mm_loadu_ps(depthRow + x);
+				const __m128 newDepth = _mm_min_ps(oldDepth, depth);
+				_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(coverage, newDepth), _mm_andnot_ps(coverage, oldDepth)));
+			}
+		}
+	}
+
+	// Update the max depth of the blocks inside of this tile
+	for (int32_t blockY = tileMinY / int32_t(sBlockSize); blockY <= tileMaxY / int32_t(sBlockSize); ++blockY)
+	{
+		for (int32_t blockX = tileMinX / int32_t(sBlockSize); blockX <= tileMaxX / int32_t(sBlockSize); ++blockX)
+		{
+			__m128 maxDepth = _mm_setzero_ps();
+			for (int32_t y = blockY * sBlockSize; y < (blockY + 1) * int32_t(sBlockSize); ++y)
+			{
+				const float* depthRow = &m_Depth[y * sWidth + blockX * sBlockSize];
+				maxDepth = _mm_max_ps(maxDepth, _mm_max_ps(_mm_loadu_ps(depthRow), _mm_loadu_ps(depthRow + 4)));
+			}
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(2, 3, 0, 1)));
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(1, 0, 3, 2)));
+			m_BlockMaxDepth[blockY * sBlocksX + blockX] = _mm_cvtss_f32(maxDepth);
+		}
+	}
+}
+
+void SoftwareOcclusionCulling::TestMeshes(uint32_t jobIndex)
+{
+	OPTICK_EVENT();
+	const uint32_t start = jobIndex * sMeshesPerTestJob;
+	const uint32_t end = eastl::min(start + sMeshesPerTestJob, uint32_t(m_FrameData->MainViewStaticMeshes.size()));
+	uint32_t occludedMeshes = 0;
+	for (uint32_t visibleIndex = start; visibleIndex < end; ++visibleIndex)
+	{
+		FrameData::StaticMeshData& mesh = m_FrameData->StaticMeshes[m_FrameData->MainViewStaticMeshes[visibleIndex]];
+		const MeshOccluder* occluder = m_Meshes->GetOccluder(mesh.Mesh);
+		if (!occluder)
+		{
+			continue;
+		}
+
+		mesh.IsOccluded = IsBoxOccluded(m_FrameData->ViewProjection * mesh.Transform, occluder->BoundsMin, occluder->BoundsMax);
+		occludedMeshes += mesh.IsOccluded ? 1 : 0;
+	}
+	m_OccludedMeshes.fetch_add(occludedMeshes);
+}
+
+bool SoftwareOcclusionCulling::IsBoxOccluded(const glm::mat4x4& worldViewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+	glm::vec2 screenMin(FLT_MAX);
+	glm::vec2 screenMax(-FLT_MAX);
+	float minDepth = FLT_MAX;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const glm::vec4 position(
+			(corner & 1) ? boundsMax.x : boundsMin.x,
+			(corner & 2) ? boundsMax.y : boundsMin.y,
+			(corner & 4) ? boundsMax.z : boundsMin.z,
+			1.0f
+		);
+		const glm::vec4 clip = worldViewProjection * position;
+		// The camera is inside or very close to the box
+		if (clip.w < sMinClipW)
+		{
+			return false;
+		}
+
+		const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		const glm::vec2 screen((ndc.x * 0.5f + 0.5f) * float(sWidth), (0.5f - ndc.y * 0.5f) * float(sHeight));
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		minDepth = eastl::min(minDepth, ndc.z);
+	}
+
+	// Outside of the screen. This is a job for the frustum culling, not for us
+	if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= float(sWidth) || screenMin.y >= float(sHeight))
+	{
+		return false;
+	}
+
+	const int32_t blockMinX = eastl::max(int32_t(screenMin.x), 0) / int32_t(sBlockSize);
+	const int32_t blockMinY = eastl::max(int32_t(screenMin.y), 0) / int32_t(sBlockSize);
+	const int32_t blockMaxX = eastl::min(int32_t(screenMax.x), int32_t(sWidth) - 1) / int32_t(sBlockSize);
+	const int32_t blockMaxY = eastl::min(int32_t(screenMax.y), int32_t(sHeight) - 1) / int32_t(sBlockSize);
+	for (int32_t blockY = blockMinY; blockY <= blockMaxY; ++blockY)
+	{
+		for (int32_t blockX = blockMinX; blockX <= blockMaxX; ++blockX)
+		{
+			// Something in this block is farther than the closest point of the box, so it could be visible
+			if (m_BlockMaxDepth[blockY * sBlocksX + blockX] >= minDepth)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void SoftwareOcclusionCulling::RasterizeTileJob(uint32_t index, void* data)
+{
+	reinterpret_cast<SoftwareOcclusionCulling*>(data)->RasterizeTile(index);
+}
+
+void SoftwareOcclusionCulling::TestMeshesJob(uint32_t index, void* data)
+{
+	reinterpret_cast<SoftwareOcclusionCulling*>(data)->TestMeshes(index);
+}
+}
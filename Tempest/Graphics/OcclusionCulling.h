@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+
+#include <atomic>
+
+namespace Tempest
+{
+namespace Job { class JobSystem; }
+class MeshManager;
+
+struct OcclusionCullingStatistics
+{
+	uint32_t Occluders = 0;
+	uint32_t OccluderTriangles = 0;
+	uint32_t RasterizedTriangles = 0;
+	uint32_t TriangleBudget = 0;
+	uint32_t TestedMeshes = 0;
+	uint32_t OccludedMeshes = 0;
+	float RasterizationMilliseconds = 0.0f;
+};
+
+// Occlusion culling for the main view done on the CPU.
+// The simplified meshes of the biggest occluders close to the camera are rendered in a small depth buffer
+// and the screen space bounds of all static meshes are tested against it.
+// Every occluder triangle is written with its farthest depth, so the depth buffer is always conservative.
+// The screen is split in tiles, which are rasterized in parallel jobs with 4 pixels at a time using SSE coverage masks.
+// The number of occluder triangles is adapted every frame in order to stay inside of a fixed time budget.
+class SoftwareOcclusionCulling : Utils::NonCopyable
+{
+public:
+	SoftwareOcclusionCulling();
+
+	// Marks occluded static meshes inside the frame data. Must be called from a job
+	void Execute(Job::JobSystem& jobSystem, const MeshManager& meshes, const glm::vec3& cameraPosition, FrameData& frameData);
+
+	const OcclusionCullingStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	struct ScreenTriangle
+	{
+		// Edge functions A * x + B * y + C, which are positive inside of the triangle
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		float Depth;
+		int32_t MinX;
+		int32_t MinY;
+		int32_t MaxX;
+		int32_t MaxY;
+	};
+
+	void SelectOccluders(const MeshManager& meshes, const glm::vec3& cameraPosition, const FrameData& frameData);
+	void SetupTriangles(const MeshManager& meshes, const FrameData& frameData);
+	void SetupTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+	void RasterizeTile(uint32_t tileIndex);
+	void TestMeshes(uint32_t jobIndex);
+	bool IsBoxOccluded(const glm::mat4x4& worldViewProjection, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+	static void RasterizeTileJob(uint32_t index, void* data);
+	static void TestMeshesJob(uint32_t index, void* data);
+
+	static const uint32_t sWidth = 256;
+	static const uint32_t sHeight = 128;
+	static const uint32_t sTileWidth = 64;
+	static const uint32_t sTileHeight = 32;
+	static const uint32_t sTilesX = sWidth / sTileWidth;
+	static const uint32_t sTilesY = sHeight / sTileHeight;
+	// Max depth of every block is used for the tests, instead of going through all the pixels
+	static const uint32_t sBlockSize = 8;
+	static const uint32_t sBlocksX = sWidth / sBlockSize;
+	static const uint32_t sBlocksY = sHeight / sBlockSize;
+
+	static const uint32_t sMaxOccluders = 32;
+	static const uint32_t sMinTriangleBudget = 512;
+	static const uint32_t sMaxTriangleBudget = 16384;
+	static const uint32_t sMeshesPerTestJob = 64;
+	static constexpr float sTimeBudgetMilliseconds = 1.0f;
+	// Approximate size on screen (radius / distance) under which a mesh is not considered as an occluder
+	static constexpr float sMinOccluderScreenSize = 0.05f;
+
+	eastl::vector<float> m_Depth;
+	eastl::vector<float> m_BlockMaxDepth;
+	eastl::vector<ScreenTriangle> m_Triangles;
+	eastl::array<eastl::vector<uint32_t>, sTilesX * sTilesY> m_TileBins;
+	eastl::vector<uint32_t> m_SelectedOccluders;
+	eastl::vector<glm::vec4> m_TransformedVertices;
+	uint32_t m_TriangleBudget = 4096;
+
+	// Valid only during Execute
+	const MeshManager* m_Meshes = nullptr;
+	FrameData* m_FrameData = nullptr;
+	std::atomic<uint32_t> m_OccludedMeshes = 0;
+
+	OcclusionCullingStatistics m_LastFrameStatistics;
+};
+}
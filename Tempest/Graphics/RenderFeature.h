@@ -12,6 +12,8 @@ struct RenderFeature
 
 	virtual void Initialize(const World& world, Renderer& renderer) = 0;
 	virtual void GatherData(const World& world, FrameData& frameData) = 0;
+	// Called after the views are culled, for the data which is needed only for what is visible
+	virtual void GatherVisibleData(const World& world, FrameData& frameData) {}
 	virtual void GenerateCommands(const FrameData& data, RendererCommandList& commandList, const RenderGraphBlackboard& blackboard) = 0;
 };
 }
\ No newline at end of file
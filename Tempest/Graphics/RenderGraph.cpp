@@ -1,9 +1,11 @@
 #include <CommonIncludes.h>
 #include <Graphics/RenderGraph.h>
-#include <Graphics/Dx12/Managers/TextureManager.h>
+#include <Graphics/TransientAliasingPlanner.h>
 #include <Graphics/Dx12/Dx12Backend.h>
 #include <Graphics/Renderer.h>
 
+#include <cstdlib>
+
 namespace Tempest
 {
 // TODO: This should not be here
@@ -35,65 +37,328 @@ RenderGraphResourceHandle RenderGraph::RequestTexture(const Dx12::TextureDescrip
 	RenderGraphResourceHandle result = m_NextHandle;
 	m_NextHandle++;
 
-	auto&&[handle, state] = m_TextureManager.RequestTexture(description);
-
-	m_Textures[result] = { handle, StateFromDx12State(state) };
+	m_TransientTextures.push_back({ result, description });
 	return result;
 }
 
-RendererCommandList RenderGraph::Compile()
+void RenderGraph::AllocateTransientTextures()
+{
+	OPTICK_EVENT();
+	if (m_TransientTextures.empty())
+	{
+		return;
+	}
+
+	// Find lifetime of every texture as first and last pass using it
+	eastl::vector<TransientResourceRequest> requests;
+	requests.reserve(m_TransientTextures.size());
+	eastl::vector<uint32_t> usedTransientTextures;
+	usedTransientTextures.reserve(m_TransientTextures.size());
+	for (uint32_t textureIndex = 0; textureIndex < m_TransientTextures.size(); ++textureIndex)
+	{
+		const TransientTexture& texture = m_TransientTextures[textureIndex];
+		TransientResourceRequest request{ 0, 0, uint32_t(-1), 0 };
+		for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+		{
+			if (m_Passes[passIndex].IsCulled)
+			{
+				continue;
+			}
+
+			for (const auto& resource : m_Passes[passIndex].Description.UsedResources)
+			{
+				if (resource.Handle == texture.Handle)
+				{
+					request.FirstPass = eastl::min(request.FirstPass, passIndex);
+					request.LastPass = eastl::max(request.LastPass, passIndex);
+				}
+			}
+		}
+
+		// Nobody is using it (or all users were culled), so no need to create it at all
+		if (request.FirstPass == uint32_t(-1))
+		{
+			continue;
+		}
+
+		auto&&[size, alignment] = m_TextureManager.GetAllocationInfo(texture.Description);
+		request.Size = size;
+		request.Alignment = alignment;
+		requests.push_back(request);
+		usedTransientTextures.push_back(textureIndex);
+	}
+
+	TransientAliasingPlan plan = PlanTransientAliasing(requests);
+	OPTICK_TAG("Transient Textures", uint32_t(requests.size()));
+	OPTICK_TAG("Transient Memory Without Aliasing", plan.NaiveSize);
+	OPTICK_TAG("Transient Memory With Aliasing", plan.HeapSize);
+	OPTICK_TAG("Transient Memory Saved", plan.GetMemorySaved());
+
+	m_TextureManager.ReserveHeap(plan.HeapSize);
+	for (uint32_t i = 0; i < usedTransientTextures.size(); ++i)
+	{
+		const TransientTexture& texture = m_TransientTextures[usedTransientTextures[i]];
+		auto&&[handle, state] = m_TextureManager.RequestTexture(texture.Description, plan.Placements[i].HeapOffset);
+
+		ResourceCurrentState& currentState = m_Textures[texture.Handle];
+		currentState.Handle = handle;
+		currentState.State = StateFromDx12State(state);
+		currentState.NeedsAliasingBarrier = plan.Placements[i].SharesMemory;
+	}
+}
+
+void RenderGraph::CullPasses()
+{
+	OPTICK_EVENT();
+	// Passes which don't start a new render pass are drawing into the targets of the one that started it
+	eastl::vector<uint32_t> renderPassStart(m_Passes.size(), uint32_t(-1));
+	uint32_t currentRenderPassStart = uint32_t(-1);
+	for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+	{
+		if (m_Passes[passIndex].Description.StartNewPass)
+		{
+			currentRenderPassStart = passIndex;
+		}
+		renderPassStart[passIndex] = currentRenderPassStart;
+	}
+
+	// Walk backwards from the imported resources (which are used outside of the graph) and keep
+	// only the passes which contribute to them
+	eastl::unordered_set<RenderGraphResourceHandle> neededResources;
+	eastl::vector<bool> forceAlive(m_Passes.size(), false);
+	uint32_t culledPasses = 0;
+	for (uint32_t passIndex = uint32_t(m_Passes.size()); passIndex-- > 0;)
+	{
+		Pass& pass = m_Passes[passIndex];
+
+		bool isAlive = forceAlive[passIndex];
+		bool hasOutputs = false;
+		auto checkOutput = [&](RenderGraphResourceHandle handle) {
+			if (handle == 0)
+			{
+				return;
+			}
+			hasOutputs = true;
+			isAlive = isAlive || IsImportedResource(handle) || neededResources.find(handle) != neededResources.end();
+		};
+
+		for (const auto& resource : pass.Description.UsedResources)
+		{
+			if (resource.Usage != RenderGraphBuilder::ResourceUsage::Read)
+			{
+				checkOutput(resource.Handle);
+			}
+		}
+		if (renderPassStart[passIndex] != uint32_t(-1))
+		{
+			const RenderGraphBuilder& renderPass = m_Passes[renderPassStart[passIndex]].Description;
+			checkOutput(renderPass.RenderTarget.Handle);
+			checkOutput(renderPass.DepthStencilTarget.Handle);
+		}
+
+		// We don't know what a pass without any outputs is doing, so keep it
+		pass.IsCulled = hasOutputs && !isAlive;
+		if (pass.IsCulled)
+		{
+			++culledPasses;
+			continue;
+		}
+
+		if (renderPassStart[passIndex] != passIndex && renderPassStart[passIndex] != uint32_t(-1))
+		{
+			forceAlive[renderPassStart[passIndex]] = true;
+		}
+
+		// Targets which are not loaded are fully overwritten here, so previous writers are not needed for them
+		if (pass.Description.StartNewPass)
+		{
+			if (pass.Description.RenderTarget.LoadAction != TextureTargetLoadAction::Load)
+			{
+				neededResources.erase(pass.Description.RenderTarget.Handle);
+			}
+			if (pass.Description.DepthStencilTarget.LoadAction != TextureTargetLoadAction::Load)
+			{
+				neededResources.erase(pass.Description.DepthStencilTarget.Handle);
+			}
+		}
+
+		for (const auto& resource : pass.Description.UsedResources)
+		{
+			const bool isOverwritten = (resource.Usage == RenderGraphBuilder::ResourceUsage::RenderTarget && pass.Description.RenderTarget.LoadAction != TextureTargetLoadAction::Load)
+				|| (resource.Usage == RenderGraphBuilder::ResourceUsage::DepthStencil && pass.Description.DepthStencilTarget.LoadAction != TextureTargetLoadAction::Load);
+			if (!isOverwritten)
+			{
+				neededResources.insert(resource.Handle);
+			}
+		}
+	}
+
+	OPTICK_TAG("Culled Passes", culledPasses);
+}
+
+bool RenderGraph::IsImportedResource(RenderGraphResourceHandle handle) const
+{
+	return eastl::find_if(m_TransientTextures.begin(), m_TransientTextures.end(), [handle](const TransientTexture& texture) {
+		return texture.Handle == handle;
+	}) == m_TransientTextures.end();
+}
+
+void RenderGraph::PlanBarriers()
+{
+	OPTICK_EVENT();
+	m_BarrierBatches.clear();
+	m_BarrierBatches.resize(m_Passes.size());
+
+	auto nextAlivePass = [this](uint32_t passIndex, bool needsNewRenderPass) {
+		for (++passIndex; passIndex < m_Passes.size(); ++passIndex)
+		{
+			if (!m_Passes[passIndex].IsCulled && (!needsNewRenderPass || m_Passes[passIndex].Description.StartNewPass))
+			{
+				break;
+			}
+		}
+		return passIndex;
+	};
+
+	// First pass from which the resource is not used anymore, so a transition could start there.
+	// Targets are bound until the end of the render pass, so they are idle only after it
+	eastl::unordered_map<RenderGraphResourceHandle, uint32_t> idleFromPass;
+	uint32_t barrierCount = 0;
+	uint32_t splitBarrierCount = 0;
+	for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+	{
+		const Pass& pass = m_Passes[passIndex];
+		if (pass.IsCulled)
+		{
+			continue;
+		}
+
+		eastl::vector<RendererCommandBarrier>& batch = m_BarrierBatches[passIndex];
+		for (const auto& resource : pass.Description.UsedResources)
+		{
+			ResourceCurrentState& currentState = m_Textures[resource.Handle];
+			if (currentState.NeedsAliasingBarrier)
+			{
+				RendererCommandBarrier aliasingBarrier;
+				aliasingBarrier.TextureHandle = currentState.Handle;
+				aliasingBarrier.Kind = BarrierKind::Aliasing;
+				batch.push_back(aliasingBarrier);
+
+				currentState.NeedsAliasingBarrier = false;
+			}
+
+			if (ResourceNeedsBarrier(resource))
+			{
+				RendererCommandBarrier transition;
+				transition.TextureHandle = currentState.Handle;
+				transition.BeforeState = currentState.State;
+				transition.AfterState = ResolveResourceRequiredState(resource);
+
+				auto idleItr = idleFromPass.find(resource.Handle);
+				if (idleItr != idleFromPass.end() && idleItr->second < passIndex)
+				{
+					// Resource is idle for some passes, so give the GPU a chance to do the transition while they are running
+					transition.Kind = BarrierKind::TransitionBegin;
+					m_BarrierBatches[idleItr->second].push_back(transition);
+					transition.Kind = BarrierKind::TransitionEnd;
+					++splitBarrierCount;
+				}
+				batch.push_back(transition);
+				++barrierCount;
+
+				currentState.State = transition.AfterState;
+				m_TextureManager.UpdateCurrentState(transition.TextureHandle, Dx12::Dx12StateFromState(transition.AfterState));
+			}
+		}
+
+		for (const auto& resource : pass.Description.UsedResources)
+		{
+			const bool isTarget = resource.Usage == RenderGraphBuilder::ResourceUsage::RenderTarget
+				|| resource.Usage == RenderGraphBuilder::ResourceUsage::DepthStencil;
+			idleFromPass[resource.Handle] = nextAlivePass(passIndex, isTarget);
+		}
+	}
+
+	OPTICK_TAG("Barriers", barrierCount);
+	OPTICK_TAG("Split Barriers", splitBarrierCount);
+}
+
+void RenderGraph::Compile(RendererCommandList& commandList)
 {
 	// TODO: Make Multi Threaded using the Job System (per pass for example)
-	RendererCommandList commandList;
+
+	CullPasses();
+	AllocateTransientTextures();
+	PlanBarriers();
 
 	bool passIsStarted = false;
-	for (Pass& pass : m_Passes)
+	for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
 	{
+		Pass& pass = m_Passes[passIndex];
+		if (pass.IsCulled)
+		{
+			continue;
+		}
+
 		if (passIsStarted && pass.Description.StartNewPass)
 		{
 			RendererCommandEndRenderPass endRenderPassCommand;
 			commandList.AddCommand(endRenderPassCommand);
 		}
 
+		// All transitions between the passes go in a single batch
+		const eastl::vector<RendererCommandBarrier>& barriers = m_BarrierBatches[passIndex];
+		if (!barriers.empty())
+		{
+			RendererCommandBarrierBatch batchCommand;
+			batchCommand.BarrierCount = uint32_t(barriers.size());
+			commandList.AddCommand(batchCommand, eastl::span<const RendererCommandBarrier>(barriers.data(), barriers.size()));
+		}
+
 		for (auto& resource : pass.Description.UsedResources) {
 			auto textureHandle = ResolveResourceToHandle(resource.Handle);
-			if (ResourceNeedsBarrier(resource)) {
-				RendererCommandBarrier transitionToDepthRead;
-				transitionToDepthRead.TextureHandle = textureHandle;
-				transitionToDepthRead.BeforeState = ResolveResourceCurrentState(resource.Handle);
-				transitionToDepthRead.AfterState = ResolveResourceRequiredState(resource);
-				commandList.AddCommand(transitionToDepthRead);
-
-				m_Textures[resource.Handle].State = transitionToDepthRead.AfterState;
-				m_TextureManager.UpdateCurrentState(transitionToDepthRead.TextureHandle, Dx12::Dx12StateFromState(transitionToDepthRead.AfterState));
-			}
 
-			if (resource.Usage == RenderGraphBuilder::ResourceUsage::Read
-				&& m_Textures[textureHandle].ViewSlot == -1)
+			if (resource.Usage != RenderGraphBuilder::ResourceUsage::Read)
 			{
-				uint32_t textureSlot = m_Blackboard.GetRenderer().m_Backend->GetDevice()->m_MainDescriptorHeap.AllocateDynamicResource();
-
-				D3D12_CPU_DESCRIPTOR_HANDLE handle(m_Blackboard.GetRenderer().m_Backend->GetDevice()->m_MainDescriptorHeap.Heap->GetCPUDescriptorHandleForHeapStart());
-				handle.ptr += textureSlot * m_Blackboard.GetRenderer().m_Backend->GetDevice()->GetDevice()->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+				continue;
+			}
 
+			// Pooled transient textures keep their handle between frames, so their views are created only once
+			Dx12::Dx12Device* device = m_Blackboard.GetRenderer().m_Backend->GetDevice();
+			const Dx12::TextureDescription& textureDescription = m_Blackboard.GetRenderer().m_Backend->Managers.Texture.GetTextureDescription(textureHandle);
+			const DXGI_FORMAT viewFormat = Dx12::DxFormatForShaderResourceView(textureDescription.Format);
+			auto [textureSlot, needsView] = device->m_MainDescriptorCache.GetOrAllocate(Dx12::DescriptorViewKey{ textureHandle, Dx12::DescriptorViewType::ShaderResource, viewFormat });
+			if (textureSlot == Dx12::DescriptorCache::sInvalidSlot)
+			{
+				// Every cached view could still be used by the GPU, so this one lives only for the frame
+				textureSlot = device->m_MainDescriptorHeap.AllocateDynamicResource();
+				needsView = true;
+			}
+			if (textureSlot == Dx12::TwoPartRingBufferDescriptorHeapManager::sInvalidSlot)
+			{
+				// The pass would read a descriptor which doesn't exist
+				LOG(Fatal, Renderer, "No descriptor left for a render graph texture!");
+				std::abort();
+			}
+			if (needsView)
+			{
 				D3D12_SHADER_RESOURCE_VIEW_DESC desc;
 				::ZeroMemory(&desc, sizeof(D3D12_SHADER_RESOURCE_VIEW_DESC));
-				desc.Format = DXGI_FORMAT_R32_FLOAT; // TODO: This should come from the texture description
+				desc.Format = viewFormat;
 				desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 				desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 				desc.Texture2D.MostDetailedMip = 0;
-				desc.Texture2D.MipLevels = 1;
+				desc.Texture2D.MipLevels = textureDescription.MipLevels;
 				desc.Texture2D.PlaneSlice = 0;
 				desc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-				m_Blackboard.GetRenderer().m_Backend->GetDevice()->GetDevice()->CreateShaderResourceView(
-					m_Blackboard.GetRenderer().m_Backend->Managers.Texture.GetTexture(ResolveResourceToHandle(resource.Handle)),
+				device->GetDevice()->CreateShaderResourceView(
+					m_Blackboard.GetRenderer().m_Backend->Managers.Texture.GetTexture(textureHandle),
 					&desc,
-					handle
+					device->m_MainDescriptorHeap.GetCPUHandle(textureSlot)
 				);
-				m_Textures[textureHandle].ViewSlot = textureSlot;
-				m_Blackboard.SetTextureSlot(resource.Handle, textureSlot);
 			}
+			m_Blackboard.SetTextureSlot(resource.Handle, textureSlot);
 		}
 
 		if (pass.Description.StartNewPass)
@@ -118,8 +383,6 @@ RendererCommandList RenderGraph::Compile()
 		RendererCommandEndRenderPass endRenderPassCommand;
 		commandList.AddCommand(endRenderPassCommand);
 	}
-
-	return commandList;
 }
 
 TextureHandle RenderGraph::ResolveResourceToHandle(RenderGraphResourceHandle handle)
@@ -150,7 +413,7 @@ ResourceState RenderGraph::ResolveResourceRequiredState(const RenderGraphBuilder
 		return ResourceState::RenderTarget;
 	case RenderGraphBuilder::ResourceUsage::DepthStencil:
 		return ResourceState::DepthWrite;
-	default:
+	default:
 		assert(false);
 		return ResourceState::RenderTarget;
 	}
@@ -2,7 +2,9 @@
 
 #include <Graphics/RendererTypes.h>
 #include <Graphics/RendererCommandList.h>
+#include <Graphics/Dx12/Managers/TextureManager.h>
 #include <EASTL/functional.h>
+#include <EASTL/unordered_set.h>
 
 namespace Tempest
 {
@@ -11,8 +13,6 @@ class Renderer;
 namespace Dx12
 {
 struct ConstantBufferDataManager;
-struct TextureDescription;
-class TemporaryTextureManager;
 }
 
 struct BlackboardIdentifier
@@ -153,6 +153,8 @@ class RenderGraph : Utils::NonCopyable
 public:
 	RenderGraph(Renderer& renderer, const FrameData& frameData, Dx12::ConstantBufferDataManager& constantManager, Dx12::TemporaryTextureManager& textureManager);
 
+	// The texture is only created during Compile, when the lifetimes of all resources are known,
+	// so textures which are not used at the same time can share the same memory
 	RenderGraphResourceHandle RequestTexture(const Dx12::TextureDescription& description);
 
 	// TODO: UE4 is taking lambda by template and then moves the data into a linear allocator inside the graph, instead of doing allocations
@@ -164,7 +166,9 @@ public:
 		m_Passes.emplace_back(Pass{ name, eastl::move(builder), eastl::move(compile) });
 	}
 
-	RendererCommandList Compile();
+	// Passes which don't contribute to the imported resources (like the backbuffer) are culled,
+	// together with the transient textures used only by them. The commands are appended to the list
+	void Compile(RendererCommandList& commandList);
 private:
 	Dx12::TemporaryTextureManager& m_TextureManager;
 
@@ -176,6 +180,7 @@ private:
 		const char* Name;
 		RenderGraphBuilder Description;
 		eastl::function<void(RendererCommandList&, RenderGraphBlackboard&)> CompileFunction;
+		bool IsCulled = false;
 	};
 	eastl::vector<Pass> m_Passes;
 
@@ -183,11 +188,27 @@ private:
 	{
 		TextureHandle Handle;
 		ResourceState State;
-		uint32_t ViewSlot = uint32_t(-1);
+		// Memory is aliased with another transient texture, so we need aliasing barrier before the first use
+		bool NeedsAliasingBarrier = false;
 	};
 	eastl::unordered_map<RenderGraphResourceHandle, ResourceCurrentState> m_Textures;
 	RenderGraphResourceHandle m_NextHandle = sBackbufferDepthStencilRenderGraphHandle + 1;
 
+	struct TransientTexture
+	{
+		RenderGraphResourceHandle Handle;
+		Dx12::TextureDescription Description;
+	};
+	eastl::vector<TransientTexture> m_TransientTextures;
+
+	// Barriers to be issued before every pass
+	eastl::vector<eastl::vector<RendererCommandBarrier>> m_BarrierBatches;
+
+	void CullPasses();
+	bool IsImportedResource(RenderGraphResourceHandle handle) const;
+	void AllocateTransientTextures();
+	void PlanBarriers();
+
 	TextureHandle ResolveResourceToHandle(RenderGraphResourceHandle handle);
 	ResourceState ResolveResourceCurrentState(RenderGraphResourceHandle handle);
 	ResourceState ResolveResourceRequiredState(const RenderGraphBuilder::UsedResource& resource);
@@ -0,0 +1,266 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/RenderScene.h>
+#include <Graphics/Managers/MeshManager.h>
+#include <Graphics/Dx12/Dx12Backend.h>
+#include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
+#include <World/World.h>
+
+#include <EASTL/sort.h>
+
+namespace Tempest
+{
+RenderScene::~RenderScene()
+{
+	// The world outlives the renderer, so the observers must not call us after this
+	if (m_SetObserver)
+	{
+		m_SetObserver.destruct();
+	}
+	if (m_RemoveObserver)
+	{
+		m_RemoveObserver.destruct();
+	}
+}
+
+void RenderScene::Initialize(const World& world, const MeshManager& meshes, Dx12::Backend& backend)
+{
+	OPTICK_EVENT();
+	m_Meshes = &meshes;
+	m_Backend = &backend;
+
+	// The first iteration reports every table as changed, so this picks up the entities loaded with the level
+	m_TransformQuery.Init(world);
+	Update();
+
+	m_SetObserver = world.m_EntityWorld.observer<const Components::Transform, const Components::StaticMesh>("RenderSceneSetStaticMesh")
+		.event(flecs::OnSet)
+		.each([this](flecs::entity entity, const Components::Transform& transform, const Components::StaticMesh& staticMesh) {
+			SetProxy(entity.id(), transform, staticMesh);
+		});
+
+	m_RemoveObserver = world.m_EntityWorld.observer<const Components::Transform, const Components::StaticMesh>("RenderSceneRemoveStaticMesh")
+		.event(flecs::OnRemove)
+		.each([this](flecs::entity entity, const Components::Transform&, const Components::StaticMesh&) {
+			DestroyProxy(entity.id());
+		});
+}
+
+void RenderScene::Update()
+{
+	OPTICK_EVENT();
+	m_TransformQuery.Query.iter([this](flecs::iter& it, const Components::Transform* transforms, const Components::StaticMesh* staticMeshes) {
+		// Systems write the transforms in place, which only marks the whole table as changed
+		if (!it.changed())
+		{
+			return;
+		}
+		++m_Statistics.ChangedTables;
+
+		for (auto i : it)
+		{
+			const flecs::entity_t entity = it.entity(i).id();
+			auto findItr = m_ProxyIndices.find(entity);
+			if (findItr == m_ProxyIndices.end())
+			{
+				// The components were added without being set, so the observer did not see it
+				SetProxy(entity, transforms[i], staticMeshes[i]);
+			}
+			else if (memcmp(&m_StaticMeshes[findItr->second].Transform, &transforms[i], sizeof(Components::Transform)) != 0)
+			{
+				UpdateTransform(findItr->second, transforms[i]);
+			}
+		}
+	});
+
+	OPTICK_TAG("Changed Tables", m_Statistics.ChangedTables);
+	OPTICK_TAG("Updated Proxies", m_Statistics.UpdatedProxies);
+}
+
+void RenderScene::SetProxy(flecs::entity_t entity, const Components::Transform& transform, const Components::StaticMesh& staticMesh)
+{
+	auto insertResult = m_ProxyIndices.insert(entity);
+	if (insertResult.second)
+	{
+		insertResult.first->second = uint32_t(m_StaticMeshes.size());
+		StaticMeshProxy& proxy = m_StaticMeshes.push_back();
+		proxy.Entity = entity;
+		proxy.Lod = 0;
+		proxy.BvhItem = SceneBvh::sInvalidItem;
+		++m_Statistics.CreatedProxies;
+	}
+
+	const uint32_t index = insertResult.first->second;
+	m_StaticMeshes[index].Mesh = staticMesh.Mesh;
+	UpdateTransform(index, transform);
+}
+
+void RenderScene::DestroyProxy(flecs::entity_t entity)
+{
+	auto findItr = m_ProxyIndices.find(entity);
+	if (findItr == m_ProxyIndices.end())
+	{
+		return;
+	}
+
+	// Keep the proxies dense, the last one takes the place of the removed one and is uploaded again
+	const uint32_t index = findItr->second;
+	const uint32_t lastIndex = uint32_t(m_StaticMeshes.size() - 1);
+	m_ProxyIndices.erase(findItr);
+	m_Bvh.Remove(m_StaticMeshes[index].BvhItem);
+	if (index != lastIndex)
+	{
+		m_StaticMeshes[index] = m_StaticMeshes[lastIndex];
+		m_ProxyIndices[m_StaticMeshes[index].Entity] = index;
+		m_Bvh.SetUserData(m_StaticMeshes[index].BvhItem, index);
+		MarkDirty(index);
+	}
+	m_StaticMeshes.pop_back();
+	++m_Statistics.DestroyedProxies;
+}
+
+void RenderScene::UpdateTransform(uint32_t index, const Components::Transform& transform)
+{
+	StaticMeshProxy& proxy = m_StaticMeshes[index];
+	proxy.Transform = transform;
+	proxy.WorldMatrix = glm::translate(transform.Position) * glm::toMat4(transform.Rotation) * glm::scale(transform.Scale);
+
+	const MeshLodInfo* lodInfo = m_Meshes->GetLodInfo(proxy.Mesh);
+	proxy.MaxScale = eastl::max(glm::abs(transform.Scale.x), eastl::max(glm::abs(transform.Scale.y), glm::abs(transform.Scale.z)));
+	proxy.BoundsCenter = transform.Position + transform.Rotation * ((lodInfo ? lodInfo->BoundsCenter : glm::vec3(0.0f)) * transform.Scale);
+	proxy.BoundsRadius = lodInfo ? lodInfo->BoundsRadius * proxy.MaxScale : 0.0f;
+
+	// Meshes without bounds can't be culled
+	const BoundingBox bounds{ proxy.BoundsCenter - glm::vec3(proxy.BoundsRadius), proxy.BoundsCenter + glm::vec3(proxy.BoundsRadius) };
+	const BoundingBox* boundsPtr = lodInfo ? &bounds : nullptr;
+	if (proxy.BvhItem == SceneBvh::sInvalidItem)
+	{
+		proxy.BvhItem = m_Bvh.Insert(index, boundsPtr);
+	}
+	else
+	{
+		m_Bvh.Move(proxy.BvhItem, boundsPtr);
+	}
+
+	++m_Statistics.UpdatedProxies;
+	MarkDirty(index);
+}
+
+void RenderScene::MarkDirty(uint32_t index)
+{
+	// Never shrinks, so an instance which is removed and added again in the same frame is not listed twice
+	if (index >= m_IsInstanceDirty.size())
+	{
+		m_IsInstanceDirty.resize(index + 1, 0);
+	}
+	if (!m_IsInstanceDirty[index])
+	{
+		m_IsInstanceDirty[index] = 1;
+		m_DirtyInstances.push_back(index);
+	}
+}
+
+void RenderScene::PrepareInstanceBuffer()
+{
+	if (m_InstanceBuffer.Capacity != 0 && m_StaticMeshes.size() <= m_InstanceBuffer.Capacity)
+	{
+		return;
+	}
+
+	// Everything is written in the new buffer, so there is nothing left for the delta upload
+	m_UploadData.clear();
+	m_UploadData.reserve(m_StaticMeshes.size());
+	for (const StaticMeshProxy& proxy : m_StaticMeshes)
+	{
+		m_UploadData.push_back(InstanceData{ proxy.WorldMatrix });
+	}
+	for (uint32_t index : m_DirtyInstances)
+	{
+		m_IsInstanceDirty[index] = 0;
+	}
+	m_DirtyInstances.clear();
+
+	m_Backend->Managers.Buffer.GrowBuffer(m_InstanceBuffer, Dx12::Dx12Device::ShaderResourceSlot::Instances, uint32_t(m_StaticMeshes.size()), sMinInstanceCapacity,
+		sizeof(InstanceData), m_UploadData.data(), uint32_t(m_UploadData.size() * sizeof(InstanceData)));
+	m_UploadData.clear();
+}
+
+void RenderScene::RecordInstanceUploads(RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager)
+{
+	OPTICK_EVENT();
+	assert(m_InstanceBuffer.Capacity >= m_StaticMeshes.size() && "PrepareInstanceBuffer must be called before recording");
+
+	// Sorted, so neighbouring instances are merged in a single copy
+	eastl::sort(m_DirtyInstances.begin(), m_DirtyInstances.end());
+
+	const uint32_t instanceSize = uint32_t(sizeof(InstanceData));
+	eastl::vector<RendererBufferUpdateRegion>& regions = m_UploadRegions;
+	regions.clear();
+	size_t firstRegionInUpload = 0;
+	// The regions point inside of the upload data, until it is placed in the constant buffer
+	auto flushUpload = [&]() {
+		if (m_UploadData.empty())
+		{
+			return;
+		}
+		const uint32_t dataOffset = constantManager.AddRawData(m_UploadData.data(), uint32_t(m_UploadData.size()) * instanceSize);
+		for (size_t i = firstRegionInUpload; i < regions.size(); ++i)
+		{
+			regions[i].ConstantDataOffset += dataOffset;
+		}
+		firstRegionInUpload = regions.size();
+		m_UploadData.clear();
+	};
+
+	uint32_t uploadedInstances = 0;
+	for (uint32_t index : m_DirtyInstances)
+	{
+		m_IsInstanceDirty[index] = 0;
+		// Removed after it was changed
+		if (index >= m_StaticMeshes.size())
+		{
+			continue;
+		}
+
+		if (m_UploadData.size() == sMaxInstancesPerUpload)
+		{
+			flushUpload();
+		}
+
+		const uint32_t destinationOffset = index * instanceSize;
+		if (regions.size() > firstRegionInUpload && regions.back().DestinationOffset + regions.back().Size == destinationOffset)
+		{
+			regions.back().Size += instanceSize;
+		}
+		else
+		{
+			RendererBufferUpdateRegion& region = regions.push_back();
+			region.DestinationOffset = destinationOffset;
+			region.ConstantDataOffset = uint32_t(m_UploadData.size()) * instanceSize;
+			region.Size = instanceSize;
+		}
+		m_UploadData.push_back(InstanceData{ m_StaticMeshes[index].WorldMatrix });
+		++uploadedInstances;
+	}
+	flushUpload();
+	m_DirtyInstances.clear();
+
+	if (!regions.empty())
+	{
+		RendererCommandUpdateBuffer command;
+		command.Buffer = m_InstanceBuffer.Handle;
+		command.RegionCount = uint32_t(regions.size());
+		commandList.AddCommand(command, eastl::span<const RendererBufferUpdateRegion>(regions.data(), regions.size()));
+	}
+
+	m_Statistics.StaticMeshes = uint32_t(m_StaticMeshes.size());
+	m_Statistics.UploadedInstances = uploadedInstances;
+	m_Statistics.UploadRegions = uint32_t(regions.size());
+	m_Statistics.InstanceCapacity = m_InstanceBuffer.Capacity;
+	OPTICK_TAG("Static Mesh Proxies", m_Statistics.StaticMeshes);
+	OPTICK_TAG("Uploaded Instances", m_Statistics.UploadedInstances);
+	OPTICK_TAG("Instance Upload Regions", m_Statistics.UploadRegions);
+	m_LastFrameStatistics = m_Statistics;
+	m_Statistics = RenderSceneStatistics{};
+}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+#include <Graphics/RendererCommandList.h>
+#include <World/EntityQuery.h>
+#include <World/Components/Components.h>
+#include <Graphics/SceneBvh.h>
+
+namespace Tempest
+{
+namespace Dx12 { class Backend; struct ConstantBufferDataManager; }
+class MeshManager;
+
+// Render side copy of an entity with a transform and a static mesh.
+// Its index in the scene is also its index in the GPU instance buffer.
+struct StaticMeshProxy
+{
+	flecs::entity_t Entity;
+	MeshHandle Mesh;
+	Components::Transform Transform;
+	glm::mat4x4 WorldMatrix;
+	// Bounding sphere in world space. Without LOD info it is the origin of the mesh
+	glm::vec3 BoundsCenter;
+	float BoundsRadius;
+	float MaxScale;
+	// Level of detail selected in the last frame, needed for the hysteresis
+	uint32_t Lod;
+	// Culling returns the index of the proxy
+	uint32_t BvhItem;
+};
+
+struct RenderSceneStatistics
+{
+	uint32_t StaticMeshes = 0;
+	uint32_t CreatedProxies = 0;
+	uint32_t DestroyedProxies = 0;
+	uint32_t UpdatedProxies = 0;
+	// Tables of the ECS in which transforms were written since the last frame
+	uint32_t ChangedTables = 0;
+	uint32_t UploadedInstances = 0;
+	uint32_t UploadRegions = 0;
+	uint32_t InstanceCapacity = 0;
+};
+
+// Persistent render side scene, which is kept in sync with the ECS instead of being rebuilt every frame.
+// Proxies are created and destroyed by flecs observers. Transforms written in place by the systems don't trigger observers,
+// so every frame only the tables which flecs reports as changed are visited.
+// The world matrices live in a GPU buffer, in which only the changed instances are copied every frame.
+class RenderScene : Utils::NonCopyable
+{
+public:
+	~RenderScene();
+
+	// Creates proxies for all entities already in the world and starts listening for changes
+	void Initialize(const World& world, const MeshManager& meshes, Dx12::Backend& backend);
+	// Picks up the transforms changed since the last call
+	void Update();
+
+	// Grows the GPU instance buffer if the proxies don't fit. Must be called before the frame is recorded
+	void PrepareInstanceBuffer();
+	// Copies the changed instances in the GPU buffer. Must be recorded before any draw using them
+	void RecordInstanceUploads(RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager);
+
+	eastl::span<StaticMeshProxy> GetStaticMeshes()
+	{
+		return m_StaticMeshes;
+	}
+
+	eastl::span<const StaticMeshProxy> GetStaticMeshes() const
+	{
+		return m_StaticMeshes;
+	}
+
+	// Heap index of the view of the instance buffer, which changes when it grows
+	uint32_t GetInstanceDescriptorIndex() const
+	{
+		return m_InstanceBuffer.DescriptorIndex;
+	}
+
+	SceneBvh& GetBvh()
+	{
+		return m_Bvh;
+	}
+
+	const RenderSceneStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	// What the shaders see for every instance
+	struct InstanceData
+	{
+		glm::mat4x4 WorldMatrix;
+	};
+
+	void SetProxy(flecs::entity_t entity, const Components::Transform& transform, const Components::StaticMesh& staticMesh);
+	void DestroyProxy(flecs::entity_t entity);
+	void UpdateTransform(uint32_t index, const Components::Transform& transform);
+	void MarkDirty(uint32_t index);
+
+	static const uint32_t sMinInstanceCapacity = 1024;
+	// Bigger uploads are split, so a single allocation does not take too much of the constant buffer ring
+	static const uint32_t sMaxInstancesPerUpload = 4096;
+
+	const MeshManager* m_Meshes = nullptr;
+	Dx12::Backend* m_Backend = nullptr;
+
+	EntityQuery<const Components::Transform, const Components::StaticMesh> m_TransformQuery;
+	flecs::entity m_SetObserver;
+	flecs::entity m_RemoveObserver;
+
+	eastl::vector<StaticMeshProxy> m_StaticMeshes;
+	eastl::unordered_map<flecs::entity_t, uint32_t> m_ProxyIndices;
+	SceneBvh m_Bvh;
+
+	// Instances which need to be copied to the GPU this frame
+	eastl::vector<uint32_t> m_DirtyInstances;
+	eastl::vector<uint8_t> m_IsInstanceDirty;
+	eastl::vector<InstanceData> m_UploadData;
+	eastl::vector<RendererBufferUpdateRegion> m_UploadRegions;
+
+	GrowableBuffer m_InstanceBuffer;
+
+	RenderSceneStatistics m_Statistics;
+	RenderSceneStatistics m_LastFrameStatistics;
+};
+}
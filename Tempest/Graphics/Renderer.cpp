@@ -1,6 +1,7 @@
 #include <CommonIncludes.h>
 #include <Graphics/Renderer.h>
 #include <Graphics/Dx12/Dx12Backend.h>
+#include <Graphics/CommandListValidator.h>
 #include <Engine.h>
 
 #include <Graphics/RendererCommandList.h>
@@ -25,6 +26,9 @@ Renderer::Renderer()
 	//m_RenderFeatures.emplace_back(new GraphicsFeature::Rects);
 	m_RenderFeatures.emplace_back(new GraphicsFeature::StaticMesh);
 	m_RenderFeatures.emplace_back(new GraphicsFeature::Lights);
+#ifdef _DEBUG
+	EnableCommandListValidation(true);
+#endif
 }
 
 Renderer::~Renderer()
@@ -34,6 +38,10 @@ Renderer::~Renderer()
 void Renderer::InitializeAfterLevelLoad(const World& world)
 {
 	OPTICK_EVENT();
+	Scene.Initialize(world, Meshes, *m_Backend);
+	Scene.PrepareInstanceBuffer();
+	m_LightCulling.Initialize(*m_Backend);
+
 	for (const auto& feature : m_RenderFeatures)
 	{
 		feature->Initialize(world, *this);
@@ -68,21 +76,75 @@ bool Renderer::CreateWindowSurface(WindowHandle handle)
 	return true;
 }
 
-FrameData Renderer::GatherWorldData(const World& world)
+const FrameData& Renderer::GatherWorldData(const World& world)
 {
 	OPTICK_EVENT();
-	// TODO: No need to return it.
-	FrameData frameData;
+	FrameData& frameData = m_FrameData;
+	frameData.BeginFrame();
 	assert(m_Views.size() == 1);
 	frameData.ViewProjection = m_Views[0]->GetViewProjection();
+	frameData.View = m_Views[0]->GetView();
+	frameData.Projection = m_Views[0]->GetProjection();
+	frameData.CameraPosition = m_Views[0]->Position;
+	frameData.ProjectionScale = m_Views[0]->GetProjectionScale();
+	frameData.NearPlane = m_Views[0]->GetNearPlane();
+	frameData.FarPlane = m_Views[0]->GetFarPlane();
+
+	// Only the entities changed since the last frame are visited
+	Scene.Update();
 
 	for (const auto& feature : m_RenderFeatures)
 	{
 		feature->GatherData(world, frameData);
 	}
+
+	// TODO: Fit the shadow view to the camera frustum
+	const glm::mat4x4 shadowProjection = glm::ortho(-60.0f, 60.0f, -60.0f, 60.0f, 1.0f, 1.0f + 120.0f);
+	const glm::vec3 lightDirection = frameData.MainDirectionalLight.Direction;
+	// Looking straight down needs another up direction
+	const glm::vec3 shadowUp = glm::abs(glm::dot(lightDirection, sUpDirection)) > 0.99f ? sForwardDirection : sUpDirection;
+	const glm::mat4x4 shadowView = glm::lookAt(-lightDirection * 60.0f, glm::vec3(0.0f), shadowUp);
+	frameData.ShadowViewProjection = shadowProjection * shadowView;
+
+	CullStaticMeshes(frameData);
+	for (const auto& feature : m_RenderFeatures)
+	{
+		feature->GatherVisibleData(world, frameData);
+	}
+	m_LightCulling.Execute(gEngine->GetJobSystem(), frameData);
+	m_OcclusionCulling.Execute(gEngine->GetJobSystem(), Meshes, frameData.CameraPosition, frameData);
+	m_TextureStreaming.GatherRequests(Meshes, frameData, m_Backend->GetDevice()->GetSwapChainSize().y);
+
+	OPTICK_TAG("Frame Data Arena Size", frameData.GetArenaSize());
+	OPTICK_TAG("Frame Data Overflow Size", frameData.GetOverflowSize());
 	return frameData;
 }
 
+void Renderer::CullStaticMeshes(FrameData& frameData)
+{
+	OPTICK_EVENT();
+	SceneBvh& bvh = Scene.GetBvh();
+	bvh.Update(gEngine->GetJobSystem());
+
+	// The views get the indices of the visible proxies, which the static mesh feature turns into indices in the frame data
+	const glm::mat4x4 viewProjections[] = { frameData.ViewProjection, frameData.ShadowViewProjection };
+	bvh.Cull(gEngine->GetJobSystem(), viewProjections);
+
+	FrameDataArray<uint32_t>* viewMeshes[] = { &frameData.MainViewStaticMeshes, &frameData.ShadowViewStaticMeshes };
+	for (uint32_t view = 0; view < 2; ++view)
+	{
+		const eastl::span<const uint32_t> visibleItems = bvh.GetVisibleItems(view);
+		frameData.Reserve(*viewMeshes[view], uint32_t(visibleItems.size()));
+		for (uint32_t meshIndex : visibleItems)
+		{
+			viewMeshes[view]->push_back(meshIndex);
+		}
+	}
+
+	OPTICK_TAG("Main View Meshes", uint32_t(frameData.MainViewStaticMeshes.size()));
+	OPTICK_TAG("Shadow View Meshes", uint32_t(frameData.ShadowViewStaticMeshes.size()));
+}
+
 // TODO: this will be good to be shared between the shader code and C++ if possible
 struct SceneConstantData
 {
@@ -92,18 +154,23 @@ struct SceneConstantData
 	glm::vec4 LightColor;
 	glm::vec3 CameraWorldPosition;
 	uint32_t LightShadowMapIndex;
+	glm::vec4 CameraForward;
+	ClusterShaderParameters Clusters;
+	uint32_t InstancesIndex;
 };
 
 void Renderer::RenderFrame(const FrameData& data)
 {
 	OPTICK_EVENT();
 
+	// Before anything is recorded, as it could recreate textures used by the frame
+	m_TextureStreaming.Update();
+	Scene.PrepareInstanceBuffer();
+	m_LightCulling.PrepareBuffers(data);
+
 	RenderGraph graph(*this, data, m_Backend->GetDevice()->GetConstantDataManager(), m_Backend->Managers.TemporaryTexture);
 
-	glm::mat4 shadowMatrix;
-	auto projectionMatrix = glm::ortho(-60.0f, 60.0f, -60.0f, 60.0f, 1.0f, 1.0f + 120.0f);
-	auto viewMatrix = glm::lookAt(-data.DirectionalLights[0].Direction * 60.0f, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
-	shadowMatrix = projectionMatrix * viewMatrix;
+	const glm::mat4 shadowMatrix = data.ShadowViewProjection;
 
 	auto shadowTextureId = graph.RequestTexture(Dx12::TextureDescription{
 		Dx12::TextureType::Texture2D,
@@ -122,10 +189,13 @@ void Renderer::RenderFrame(const FrameData& data)
 			SceneConstantData sceneData {
 				shadowMatrix,
 				shadowMatrix,
-				glm::vec4(data.DirectionalLights[0].Direction, 0.0f),
-				glm::vec4(data.DirectionalLights[0].Color, 1.0f),
+				glm::vec4(data.MainDirectionalLight.Direction, 0.0f),
+				glm::vec4(data.MainDirectionalLight.Color, 1.0f),
 				blackboard.GetRenderer().m_Views[0]->Position,
 				0,
+				glm::vec4(blackboard.GetRenderer().m_Views[0]->Forward, 0.0f),
+				ClusterShaderParameters{},
+				blackboard.GetRenderer().Scene.GetInstanceDescriptorIndex()
 			};
 
 			blackboard.SetConstantDataOffset(BlackboardIdentifier{ "SceneData" }, blackboard.GetConstantDataManager().AddData(sceneData));
@@ -145,13 +215,17 @@ void Renderer::RenderFrame(const FrameData& data)
 
 		return [&shadowMatrix, shadowTextureId](RendererCommandList& commandList, RenderGraphBlackboard& blackboard) {
 			const FrameData& data = blackboard.GetFrameData();
+			const Renderer& renderer = blackboard.GetRenderer();
 			SceneConstantData sceneData{
-				blackboard.GetRenderer().m_Views[0]->GetViewProjection(),
+				renderer.m_Views[0]->GetViewProjection(),
 				shadowMatrix,
-				glm::vec4(data.DirectionalLights[0].Direction, 0.0f),
-				glm::vec4(data.DirectionalLights[0].Color, 1.0f),
-				blackboard.GetRenderer().m_Views[0]->Position,
-				blackboard.GetTextureSlot(shadowTextureId)
+				glm::vec4(data.MainDirectionalLight.Direction, 0.0f),
+				glm::vec4(data.MainDirectionalLight.Color, 1.0f),
+				renderer.m_Views[0]->Position,
+				blackboard.GetTextureSlot(shadowTextureId),
+				glm::vec4(renderer.m_Views[0]->Forward, 0.0f),
+				renderer.m_LightCulling.GetShaderParameters(data, renderer.m_Backend->GetDevice()->GetSwapChainSize()),
+				renderer.Scene.GetInstanceDescriptorIndex()
 			};
 			blackboard.SetConstantDataOffset(BlackboardIdentifier{ "SceneData" }, blackboard.GetConstantDataManager().AddData(sceneData));
 			blackboard.SetRenderPhase(RenderPhase::Main);
@@ -163,11 +237,51 @@ void Renderer::RenderFrame(const FrameData& data)
 		};
 	});
 
-	auto commandList = graph.Compile();
+	RendererCommandList commandList;
+	// All passes read the instances, so they are updated before anything else
+	Scene.RecordInstanceUploads(commandList, m_Backend->GetDevice()->GetConstantDataManager());
+	m_TextureStreaming.RecordSlotUploads(commandList, m_Backend->GetDevice()->GetConstantDataManager());
+	m_LightCulling.RecordUploads(data, commandList, m_Backend->GetDevice()->GetConstantDataManager());
+	graph.Compile(commandList);
+
+	if (m_CommandListValidator)
+	{
+		m_CommandListValidator->SetConstantBufferSize(m_Backend->GetDevice()->GetConstantDataManager().GetSizeInBytes());
+		m_CommandListValidator->Validate(commandList);
+	}
+
+	if (!m_CommandListDumpPath.empty())
+	{
+		CommandListValidator::SerializeToFile(commandList, m_CommandListDumpPath.c_str());
+		m_CommandListDumpPath.clear();
+	}
 
 	m_Backend->RenderFrame(commandList);
 }
 
+void Renderer::EnableCommandListValidation(bool enable)
+{
+	if (!enable)
+	{
+		m_CommandListValidator.reset();
+		return;
+	}
+
+	if (!m_CommandListValidator)
+	{
+		m_CommandListValidator.reset(new CommandListValidator);
+		for (PipelineStateHandle handle : m_RequestedPipelines)
+		{
+			m_CommandListValidator->RegisterPipelineState(handle);
+		}
+	}
+}
+
+void Renderer::DumpNextFrameCommandList(const char* filePath)
+{
+	m_CommandListDumpPath = filePath;
+}
+
 void Renderer::RegisterView(const Camera* camera)
 {
 	m_Views.emplace_back(camera);
@@ -217,21 +331,30 @@ PipelineStateHandle Renderer::RequestPipelineState(const PipelineStateDescriptio
 		desc.DepthBias = 0.001f;
 	}
 
-	return m_Backend->Managers.Pipeline.CreateGraphicsPipeline(desc);
+	PipelineStateHandle handle = m_Backend->Managers.Pipeline.CreateGraphicsPipeline(desc);
+	m_RequestedPipelines.push_back(handle);
+	if (m_CommandListValidator)
+	{
+		m_CommandListValidator->RegisterPipelineState(handle);
+	}
+	return handle;
 }
 
 struct LoadGeometryStaticFunctionData
 {
 	Renderer* object;
 	const char* databaseName;
+	Dx12::UploadTicket uploadTicket;
 };
 
 void Renderer::LoadGeometryAndTextureDatabase(const char* geometryDatabaseName, const char* textureDatabaseName)
 {
 	// First just load texture database, as we need to determine the descriptor heap size
 	// Afterwards start a Job to load the geometry, and continue with loading texture database in current job
+	// Both uploads go through the copy queue at the same time and the first frame waits for them on the GPU
 
-	const Definition::TextureDatabase* textureDatabase = gEngine->GetResourceLoader().LoadResource<Definition::TextureDatabase>(textureDatabaseName);
+	m_TextureDatabase = gEngine->GetResourceLoader().LoadResource<Definition::TextureDatabase>(textureDatabaseName);
+	const Definition::TextureDatabase* textureDatabase = m_TextureDatabase.Get();
 	if (!textureDatabase)
 	{
 		LOG(Warning, Renderer, "Texture Database is Invalid!");
@@ -243,12 +366,13 @@ void Renderer::LoadGeometryAndTextureDatabase(const char* geometryDatabaseName,
 
 	LoadGeometryStaticFunctionData jobData{
 		this,
-		geometryDatabaseName
+		geometryDatabaseName,
+		0
 	};
 	Job::JobDecl loadGeometryJob {
 	[](uint32_t, void* dataPtr) {
 		LoadGeometryStaticFunctionData* data = (LoadGeometryStaticFunctionData*)dataPtr;
-		data->object->LoadGeometryDatabase(data->databaseName);
+		data->uploadTicket = data->object->LoadGeometryDatabase(data->databaseName);
 		}, &jobData
 	};
 	Job::Counter counter;
@@ -259,37 +383,28 @@ void Renderer::LoadGeometryAndTextureDatabase(const char* geometryDatabaseName,
 	{
 		// Just wait for the geometry and return
 		gEngine->GetJobSystem().WaitForCounter(&counter, 0);
+		m_Backend->MakeFrameWaitForUpload(jobData.uploadTicket);
 		return;
 	}
 
-	Dx12::UploadData uploadData = m_Backend->PrepareUpload(textureDatabase->texture_data_buffer()->size());
-	for (uint32_t i = 0; i < textureDatabase->mappings()->size(); ++i)
-	{
-		const auto& texture = textureDatabase->mappings()->Get(i);
-		Dx12::TextureDescription textureDescription;
-		textureDescription.Type = Dx12::TextureType::Texture2D;
-		textureDescription.Format = Dx12::DxFormatForStorageFromTextureFormat(texture->texture_data());
-		textureDescription.Width = texture->texture_data().width();
-		textureDescription.Height = texture->texture_data().height();
-		textureDescription.Size = texture->texture_buffer_byte_count();
-		textureDescription.Data = textureDatabase->texture_data_buffer()->data() + texture->texture_buffer_offset();
-
-		TextureHandle handle = m_Backend->Managers.Texture.CreateTexture(textureDescription, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &uploadData);
-		m_Backend->GetDevice()->AddStaticTextureDescriptor(m_Backend->Managers.Texture.GetTexture(handle), Dx12::DxFormatForViewFromTextureFormat(texture->texture_data()), 1, i);
-	}
+	// Only the smallest mips are loaded now, the rest are streamed when the meshes using them are on screen
+	m_TextureStreaming.Initialize(*m_Backend, textureDatabase);
+	Dx12::UploadData uploadData = m_Backend->PrepareUpload(uint32_t(m_TextureStreaming.GetResidentUploadSize()));
+	m_TextureStreaming.CreateResidentTextures(uploadData);
+	const Dx12::UploadTicket textureTicket = m_Backend->SubmitUpload(uploadData);
 
 	gEngine->GetJobSystem().WaitForCounter(&counter, 0);
-	// TODO: This should happen before the wait, but the method is currently thread unsafe and will fail, due to Fence objects used
-	m_Backend->ExecuteUpload(uploadData);
+	m_Backend->MakeFrameWaitForUpload(jobData.uploadTicket);
+	m_Backend->MakeFrameWaitForUpload(textureTicket);
 }
 
-void Renderer::LoadGeometryDatabase(const char* geometryDatabaseName)
+uint64_t Renderer::LoadGeometryDatabase(const char* geometryDatabaseName)
 {
-	const Definition::GeometryDatabase* geometryDatabase = gEngine->GetResourceLoader().LoadResource<Definition::GeometryDatabase>(geometryDatabaseName);
+	AssetHandle<Definition::GeometryDatabase> geometryDatabase = gEngine->GetResourceLoader().LoadResource<Definition::GeometryDatabase>(geometryDatabaseName);
 	if(!geometryDatabase)
 	{
 		LOG(Warning, Renderer, "Geometry Database is Invalid!");
-		return;
+		return 0;
 	}
 
 	uint32_t totalGeometrySize = geometryDatabase->vertex_buffer()->size()
@@ -335,9 +450,16 @@ void Renderer::LoadGeometryDatabase(const char* geometryDatabaseName)
 		m_Backend->GetDevice()->AddStaticBufferDescriptor(m_Backend->Managers.Buffer.GetBuffer(m_MaterialData), geometryDatabase->materials()->size(), sizeof(Definition::Material), Dx12::Dx12Device::ShaderResourceSlot::Materials);
 	}
 
-	m_Backend->ExecuteUpload(uploadData);
+	const Dx12::UploadTicket ticket = m_Backend->SubmitUpload(uploadData);
+
+	Meshes.LoadFromDatabase(geometryDatabase.Get());
 
-	Meshes.LoadFromDatabase(geometryDatabase);
+	// The buffers are in the upload heap and the meshes copied what they need, so nothing points inside of the database anymore
+	if (!gEngine->GetOptions().ReleaseAssetsAfterUpload)
+	{
+		m_GeometryDatabase = eastl::move(geometryDatabase);
+	}
+	return ticket;
 }
 }
 
@@ -3,12 +3,19 @@
 #include <Platform/WindowsPlatform.h>
 #include <Graphics/RendererTypes.h>
 #include <Graphics/Managers/MeshManager.h>
+#include <Graphics/OcclusionCulling.h>
+#include <Graphics/TextureStreaming.h>
+#include <Graphics/ClusteredLightCulling.h>
+#include <Graphics/RenderScene.h>
+#include <Graphics/FrameData.h>
+#include <Resources/ResourceLoader.h>
 
 namespace Tempest
 {
 class World;
 class Camera;
 struct RenderFeature;
+class CommandListValidator;
 // This is forward declare and used through a pointer to avoid pulling Dx12 headers into rest of the engine
 namespace Dx12 { class Backend; struct ConstantBufferDataManager; }
 namespace Definition { struct ShaderLibrary; }
@@ -27,26 +34,54 @@ public:
 	bool CreateWindowSurface(WindowHandle handle);
 
 	void LoadGeometryAndTextureDatabase(const char* geometryDatabaseName, const char* textureDatabaseName);
-	void LoadGeometryDatabase(const char* geometryDatabaseName); // Don't use this directly, go through LoadGeometryAndTextureDatabase
+	// Returns the ticket of the upload. Don't use this directly, go through LoadGeometryAndTextureDatabase
+	uint64_t LoadGeometryDatabase(const char* geometryDatabaseName);
 	void InitializeAfterLevelLoad(const World& world);
-	FrameData GatherWorldData(const World& world);
+	// The data is valid until the next call
+	const FrameData& GatherWorldData(const World& world);
 	void RenderFrame(const FrameData& data);
 
+	// Every frame will be validated on the CPU before sending it to the Dx12 backend
+	void EnableCommandListValidation(bool enable);
+	// Writes the command list of the next frame to the file, so it could be diffed with previous runs
+	void DumpNextFrameCommandList(const char* filePath);
+
 	void RegisterView(const Camera* camera);
 	void UnregisterView(const Camera* camera);
+	// First registered view, null before the level is loaded
+	const Camera* GetMainView() const
+	{
+		return m_Views.empty() ? nullptr : m_Views[0];
+	}
 
 	// TODO: potentially this could be moved someplace else
 	PipelineStateHandle RequestPipelineState(const PipelineStateDescription& description);
 
 	// Managers
 	MeshManager Meshes;
+	RenderScene Scene;
 	// TODO: Hide this
 	eastl::unique_ptr<class Dx12::Backend> m_Backend;
 private:
+	// Fills the visible meshes of every view from the bounding volume hierarchy of the scene
+	void CullStaticMeshes(FrameData& frameData);
+
+	eastl::unique_ptr<CommandListValidator> m_CommandListValidator;
+	eastl::string m_CommandListDumpPath;
+	eastl::vector<PipelineStateHandle> m_RequestedPipelines;
+
 	eastl::vector<eastl::unique_ptr<RenderFeature>> m_RenderFeatures;
 	eastl::vector<const Camera*> m_Views;
+	SoftwareOcclusionCulling m_OcclusionCulling;
+	TextureStreaming m_TextureStreaming;
+	ClusteredLightCulling m_LightCulling;
+	FrameData m_FrameData;
 
-	const Definition::ShaderLibrary* m_ShaderLibrary;
+	AssetHandle<Definition::ShaderLibrary> m_ShaderLibrary;
+	// Mips are streamed from it, so it stays loaded with the level
+	AssetHandle<Definition::TextureDatabase> m_TextureDatabase;
+	// Released right after the upload, unless the engine is told to keep uploaded assets
+	AssetHandle<Definition::GeometryDatabase> m_GeometryDatabase;
 
 	BufferHandle m_VertexData;
 	BufferHandle m_MeshletData;
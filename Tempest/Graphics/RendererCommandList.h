@@ -11,6 +11,8 @@ enum class RendererCommandType : uint8_t
 	BeginRenderPass,
 	EndRenderPass,
 	Barrier,
+	BarrierBatch,
+	UpdateBuffer,
 	Count
 };
 
@@ -90,6 +92,17 @@ enum class ResourceState : uint8_t
 	DepthRead,
 };
 
+enum class BarrierKind : uint8_t
+{
+	Transition,
+	// Split transition. The GPU can do the transition at any time between the begin and the end,
+	// so the resource must not be used in between
+	TransitionBegin,
+	TransitionEnd,
+	// The texture starts using memory, which was used by another resource before that. States are ignored
+	Aliasing,
+};
+
 struct RendererCommandBarrier : RendererCommand<RendererCommandType::Barrier>
 {
 	union
@@ -101,6 +114,29 @@ struct RendererCommandBarrier : RendererCommand<RendererCommandType::Barrier>
 	// TODO: Consider having only after state, and tracking state of resource internally
 	ResourceState BeforeState;
 	ResourceState AfterState;
+	BarrierKind Kind = BarrierKind::Transition;
+};
+
+// Issues all barriers at once. The command is followed by BarrierCount RendererCommandBarrier in the command list
+struct RendererCommandBarrierBatch : RendererCommand<RendererCommandType::BarrierBatch>
+{
+	uint32_t BarrierCount;
+};
+
+// Part of a buffer which is overwritten with data from the constant buffer
+struct alignas(16) RendererBufferUpdateRegion
+{
+	uint32_t DestinationOffset;
+	uint32_t ConstantDataOffset;
+	uint32_t Size;
+};
+
+// Copies data from the constant buffer in a GPU buffer, before any following command reads it.
+// The command is followed by RegionCount RendererBufferUpdateRegion in the command list
+struct RendererCommandUpdateBuffer : RendererCommand<RendererCommandType::UpdateBuffer>
+{
+	BufferHandle Buffer;
+	uint32_t RegionCount;
 };
 
 struct RendererCommandList
@@ -112,6 +148,15 @@ struct RendererCommandList
 		m_DataBuffer.insert(m_DataBuffer.end(), reinterpret_cast<const uint8_t*>(&command), reinterpret_cast<const uint8_t*>(&command) + sizeof(T));
 	}
 
+	// Command with variable size, the payload is placed directly after it
+	template<typename T, typename TPayload>
+	void AddCommand(const T& command, eastl::span<const TPayload> payload)
+	{
+		m_DataBuffer.reserve(m_DataBuffer.size() + sizeof(T) + payload.size_bytes());
+		AddCommand(command);
+		m_DataBuffer.insert(m_DataBuffer.end(), reinterpret_cast<const uint8_t*>(payload.data()), reinterpret_cast<const uint8_t*>(payload.data()) + payload.size_bytes());
+	}
+
 //private:
 	eastl::vector<uint8_t> m_DataBuffer;
 };
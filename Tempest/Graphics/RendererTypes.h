@@ -21,6 +21,18 @@ using MeshHandle = uint32_t;
 using BufferHandle = uint32_t;
 using TextureHandle = uint32_t;
 
+// Buffer which grows by doubling, for data the frames update in place. See BufferManager::GrowBuffer
+struct GrowableBuffer
+{
+	BufferHandle Handle = 0;
+	// Zero until the buffer is created
+	uint32_t Capacity = 0;
+	// Heap index of the view the shaders read, which changes when the buffer grows
+	uint32_t DescriptorIndex = 0;
+	// Frames submitted before this fence could still read the previous view
+	uint64_t PreviousViewFence = 0;
+};
+
 // Render Graph Types
 using RenderGraphResourceHandle = uint32_t;
 // TODO: This could be imported explicitly probably
@@ -0,0 +1,670 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/SceneBvh.h>
+#include <Job/JobSystem.h>
+
+#include <cfloat>
+#include <chrono>
+
+namespace Tempest
+{
+using StatisticsClock = std::chrono::high_resolution_clock;
+
+static const uint32_t sAllPlanes = (1u << 6) - 1;
+
+// Planes are pointing inside, in the form used by the D3D clip space (z from 0 to w)
+static eastl::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4x4& viewProjection)
+{
+	const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	eastl::array<glm::vec4, 6> planes = {
+		row3 + row0,
+		row3 - row0,
+		row3 + row1,
+		row3 - row1,
+		row2,
+		row3 - row2,
+	};
+	for (glm::vec4& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return planes;
+}
+
+// Returns false if the box is outside of any plane in the mask.
+// Planes which have the box fully inside are removed from the mask, so the children don't test them again
+static bool IntersectFrustum(const eastl::array<glm::vec4, 6>& planes, const glm::vec3& min, const glm::vec3& max, uint32_t& planeMask)
+{
+	for (uint32_t planeIndex = 0; planeIndex < 6; ++planeIndex)
+	{
+		if ((planeMask & (1u << planeIndex)) == 0)
+		{
+			continue;
+		}
+
+		const glm::vec4& plane = planes[planeIndex];
+		// Corners farthest along and against the normal of the plane
+		const glm::vec3 positive(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+		const glm::vec3 negative(plane.x >= 0.0f ? min.x : max.x, plane.y >= 0.0f ? min.y : max.y, plane.z >= 0.0f ? min.z : max.z);
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+		{
+			return false;
+		}
+		if (glm::dot(glm::vec3(plane), negative) + plane.w >= 0.0f)
+		{
+			planeMask &= ~(1u << planeIndex);
+		}
+	}
+	return true;
+}
+
+static float SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+	const glm::vec3 size = max - min;
+	if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f)
+	{
+		return 0.0f;
+	}
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static BoundingBox EmptyBox()
+{
+	return BoundingBox{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+}
+
+static void GrowBox(BoundingBox& box, const glm::vec3& min, const glm::vec3& max)
+{
+	box.Min = glm::min(box.Min, min);
+	box.Max = glm::max(box.Max, max);
+}
+
+uint32_t SceneBvh::AllocateItem()
+{
+	if (!m_FreeItems.empty())
+	{
+		const uint32_t item = m_FreeItems.back();
+		m_FreeItems.pop_back();
+		return item;
+	}
+	m_Items.push_back();
+	return uint32_t(m_Items.size() - 1);
+}
+
+uint32_t SceneBvh::Insert(uint32_t userData, const BoundingBox* bounds)
+{
+	const uint32_t itemIndex = AllocateItem();
+	Item& item = m_Items[itemIndex];
+	item.UserData = userData;
+	// Treated as not moving, so the items of a newly loaded level go straight in the static tree
+	item.LastMovedFrame = 0;
+	item.State = ItemState::Free;
+	if (bounds)
+	{
+		item.Bounds = *bounds;
+		AddToList(m_PendingItems, ItemState::Pending, itemIndex);
+	}
+	else
+	{
+		AddToList(m_UnboundedItems, ItemState::Unbounded, itemIndex);
+	}
+	return itemIndex;
+}
+
+void SceneBvh::Remove(uint32_t item)
+{
+	Detach(item);
+	m_FreeItems.push_back(item);
+}
+
+void SceneBvh::Move(uint32_t itemIndex, const BoundingBox* bounds)
+{
+	Item& item = m_Items[itemIndex];
+	item.LastMovedFrame = m_FrameIndex;
+	if (!bounds)
+	{
+		if (item.State != ItemState::Unbounded)
+		{
+			Detach(itemIndex);
+			AddToList(m_UnboundedItems, ItemState::Unbounded, itemIndex);
+		}
+		return;
+	}
+
+	item.Bounds = *bounds;
+	switch (item.State)
+	{
+	case ItemState::Dynamic:
+		m_DynamicMoved = true;
+		break;
+	case ItemState::Pending:
+		break;
+	default:
+		// The static tree is never refit, so the item waits for the next build of the dynamic one
+		Detach(itemIndex);
+		AddToList(m_PendingItems, ItemState::Pending, itemIndex);
+		break;
+	}
+}
+
+void SceneBvh::SetUserData(uint32_t item, uint32_t userData)
+{
+	m_Items[item].UserData = userData;
+}
+
+void SceneBvh::Detach(uint32_t itemIndex)
+{
+	Item& item = m_Items[itemIndex];
+	auto removeFromList = [this](eastl::vector<uint32_t>& list, uint32_t position) {
+		const uint32_t lastItem = list.back();
+		list[position] = lastItem;
+		m_Items[lastItem].Reference = position;
+		list.pop_back();
+	};
+
+	switch (item.State)
+	{
+	case ItemState::Static:
+		++m_StaticTree.DeadReferences;
+		break;
+	case ItemState::Dynamic:
+		++m_DynamicTree.DeadReferences;
+		break;
+	case ItemState::Pending:
+		removeFromList(m_PendingItems, item.Reference);
+		break;
+	case ItemState::Unbounded:
+		removeFromList(m_UnboundedItems, item.Reference);
+		break;
+	default:
+		break;
+	}
+	item.State = ItemState::Free;
+}
+
+void SceneBvh::AddToList(eastl::vector<uint32_t>& list, ItemState state, uint32_t item)
+{
+	m_Items[item].State = state;
+	m_Items[item].Reference = uint32_t(list.size());
+	list.push_back(item);
+}
+
+bool SceneBvh::IsReferenceAlive(const Tree& tree, uint32_t reference) const
+{
+	const Item& item = m_Items[tree.References[reference]];
+	return item.State == tree.State && item.Reference == reference;
+}
+
+bool SceneBvh::IsSettled(const Item& item) const
+{
+	return m_FrameIndex - item.LastMovedFrame >= sSettleFrames;
+}
+
+void SceneBvh::Update(Job::JobSystem& jobSystem)
+{
+	OPTICK_EVENT();
+	const auto updateStart = StatisticsClock::now();
+	++m_FrameIndex;
+	m_StaticTree.State = ItemState::Static;
+	m_DynamicTree.State = ItemState::Dynamic;
+	m_Statistics = SceneBvhStatistics{};
+
+	uint32_t aliveDynamicItems = 0;
+	uint32_t settledItems = 0;
+	for (uint32_t reference = 0; reference < m_DynamicTree.References.size(); ++reference)
+	{
+		if (IsReferenceAlive(m_DynamicTree, reference))
+		{
+			++aliveDynamicItems;
+			settledItems += IsSettled(m_Items[m_DynamicTree.References[reference]]) ? 1 : 0;
+		}
+	}
+	for (uint32_t item : m_PendingItems)
+	{
+		settledItems += IsSettled(m_Items[item]) ? 1 : 0;
+	}
+	const uint32_t aliveStaticItems = uint32_t(m_StaticTree.References.size()) - m_StaticTree.DeadReferences;
+
+	const bool isFirstBuild = m_StaticTree.References.empty() && settledItems > 0;
+	const bool hasManySettled = settledItems >= eastl::max(sMinRebuildItems, aliveStaticItems / 8);
+	const bool hasManyDeadStatic = m_StaticTree.DeadReferences >= sMinRebuildItems && m_StaticTree.DeadReferences > m_StaticTree.References.size() / 4;
+	const bool canRebuildStatic = m_FrameIndex - m_LastStaticRebuildFrame >= sMinStaticRebuildInterval;
+	if (isFirstBuild || ((hasManySettled || hasManyDeadStatic) && canRebuildStatic))
+	{
+		// Everything which stopped moving goes in the static tree, the rest in the dynamic one
+		eastl::vector<uint32_t> staticItems;
+		eastl::vector<uint32_t> dynamicItems;
+		staticItems.reserve(aliveStaticItems + settledItems);
+		dynamicItems.reserve(aliveDynamicItems + m_PendingItems.size());
+		for (uint32_t reference = 0; reference < m_StaticTree.References.size(); ++reference)
+		{
+			if (IsReferenceAlive(m_StaticTree, reference))
+			{
+				staticItems.push_back(m_StaticTree.References[reference]);
+			}
+		}
+		auto addMovingItem = [&](uint32_t item) {
+			(IsSettled(m_Items[item]) ? staticItems : dynamicItems).push_back(item);
+		};
+		for (uint32_t reference = 0; reference < m_DynamicTree.References.size(); ++reference)
+		{
+			if (IsReferenceAlive(m_DynamicTree, reference))
+			{
+				addMovingItem(m_DynamicTree.References[reference]);
+			}
+		}
+		for (uint32_t item : m_PendingItems)
+		{
+			addMovingItem(item);
+		}
+		m_PendingItems.clear();
+
+		m_StaticTree.References = eastl::move(staticItems);
+		m_DynamicTree.References = eastl::move(dynamicItems);
+		BuildTree(m_StaticTree, jobSystem);
+		BuildTree(m_DynamicTree, jobSystem);
+		m_LastStaticRebuildFrame = m_FrameIndex;
+		m_DynamicNeedsRebuild = false;
+		++m_Statistics.StaticRebuilds;
+		++m_Statistics.DynamicRebuilds;
+	}
+	else
+	{
+		const bool hasManyPending = m_PendingItems.size() > eastl::max(sMinRebuildItems, aliveDynamicItems / 8);
+		const bool hasManyDeadDynamic = m_DynamicTree.DeadReferences >= sMinRebuildItems && m_DynamicTree.DeadReferences > m_DynamicTree.References.size() / 4;
+		if (hasManyPending || hasManyDeadDynamic || m_DynamicNeedsRebuild)
+		{
+			eastl::vector<uint32_t> dynamicItems;
+			dynamicItems.reserve(aliveDynamicItems + m_PendingItems.size());
+			for (uint32_t reference = 0; reference < m_DynamicTree.References.size(); ++reference)
+			{
+				if (IsReferenceAlive(m_DynamicTree, reference))
+				{
+					dynamicItems.push_back(m_DynamicTree.References[reference]);
+				}
+			}
+			dynamicItems.insert(dynamicItems.end(), m_PendingItems.begin(), m_PendingItems.end());
+			m_PendingItems.clear();
+
+			m_DynamicTree.References = eastl::move(dynamicItems);
+			BuildTree(m_DynamicTree, jobSystem);
+			m_DynamicNeedsRebuild = false;
+			++m_Statistics.DynamicRebuilds;
+		}
+		else if (m_DynamicMoved)
+		{
+			// The rebuild is left for the next frame, the refit tree is still correct, just slower to traverse
+			const float cost = RefitTree(m_DynamicTree);
+			m_DynamicNeedsRebuild = cost > m_DynamicTree.BuildCost * sMaxRefitCostRatio;
+			++m_Statistics.DynamicRefits;
+		}
+	}
+	m_DynamicMoved = false;
+
+	m_Statistics.StaticItems = uint32_t(m_StaticTree.References.size()) - m_StaticTree.DeadReferences;
+	m_Statistics.DynamicItems = uint32_t(m_DynamicTree.References.size()) - m_DynamicTree.DeadReferences;
+	m_Statistics.PendingItems = uint32_t(m_PendingItems.size());
+	m_Statistics.UnboundedItems = uint32_t(m_UnboundedItems.size());
+	m_Statistics.StaticNodes = m_StaticTree.NodeCount;
+	m_Statistics.DynamicNodes = m_DynamicTree.NodeCount;
+	m_Statistics.UpdateMilliseconds = std::chrono::duration<float, std::milli>(StatisticsClock::now() - updateStart).count();
+
+	OPTICK_TAG("Static Items", m_Statistics.StaticItems);
+	OPTICK_TAG("Dynamic Items", m_Statistics.DynamicItems);
+	OPTICK_TAG("Pending Items", m_Statistics.PendingItems);
+	OPTICK_TAG("Static Rebuilds", m_Statistics.StaticRebuilds);
+	OPTICK_TAG("Dynamic Rebuilds", m_Statistics.DynamicRebuilds);
+}
+
+void SceneBvh::BuildTree(Tree& tree, Job::JobSystem& jobSystem)
+{
+	OPTICK_EVENT();
+	const uint32_t count = uint32_t(tree.References.size());
+	tree.DeadReferences = 0;
+	tree.BuildCost = 0.0f;
+	tree.NodeCount = 0;
+	if (count > 0)
+	{
+		// Children are allocated in pairs, so there are never more than 2 * count - 1 nodes
+		tree.Nodes.resize(count * 2);
+		tree.NodeCount = 1;
+		BuildNode(BuildTask{ this, &tree, &jobSystem, 0, 0, count, 0 });
+	}
+
+	for (uint32_t reference = 0; reference < count; ++reference)
+	{
+		Item& item = m_Items[tree.References[reference]];
+		item.State = tree.State;
+		item.Reference = reference;
+	}
+
+	for (uint32_t nodeIndex = 0; nodeIndex < tree.NodeCount; ++nodeIndex)
+	{
+		const Node& node = tree.Nodes[nodeIndex];
+		tree.BuildCost += node.Count == 0 ? SurfaceArea(node.Min, node.Max) : 0.0f;
+	}
+	CollectTaskRoots(tree);
+}
+
+void SceneBvh::BuildNode(const BuildTask& task)
+{
+	Tree& tree = *task.Target;
+	Node& node = tree.Nodes[task.NodeIndex];
+	const uint32_t count = task.End - task.Begin;
+
+	BoundingBox bounds = EmptyBox();
+	BoundingBox centerBounds = EmptyBox();
+	for (uint32_t reference = task.Begin; reference < task.End; ++reference)
+	{
+		const BoundingBox& itemBounds = m_Items[tree.References[reference]].Bounds;
+		const glm::vec3 center = (itemBounds.Min + itemBounds.Max) * 0.5f;
+		GrowBox(bounds, itemBounds.Min, itemBounds.Max);
+		GrowBox(centerBounds, center, center);
+	}
+	node.Min = bounds.Min;
+	node.Max = bounds.Max;
+
+	if (count <= sMaxLeafItems || task.Depth >= sMaxDepth)
+	{
+		node.First = task.Begin;
+		node.Count = count;
+		return;
+	}
+
+	// Binned SAH over the centers, along the axis on which they are spread the most
+	const glm::vec3 extent = centerBounds.Max - centerBounds.Min;
+	const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	uint32_t middle = task.Begin + count / 2;
+	if (extent[axis] > 0.0f)
+	{
+		const float binScale = float(sBuildBins) / extent[axis];
+		const float binStart = centerBounds.Min[axis];
+		auto getBin = [this, axis, binScale, binStart](uint32_t item) {
+			const BoundingBox& itemBounds = m_Items[item].Bounds;
+			const float center = (itemBounds.Min[axis] + itemBounds.Max[axis]) * 0.5f;
+			return eastl::min(uint32_t((center - binStart) * binScale), sBuildBins - 1);
+		};
+
+		struct Bin
+		{
+			BoundingBox Bounds = EmptyBox();
+			uint32_t Count = 0;
+		};
+		eastl::array<Bin, sBuildBins> bins;
+		for (uint32_t reference = task.Begin; reference < task.End; ++reference)
+		{
+			const uint32_t item = tree.References[reference];
+			Bin& bin = bins[getBin(item)];
+			GrowBox(bin.Bounds, m_Items[item].Bounds.Min, m_Items[item].Bounds.Max);
+			++bin.Count;
+		}
+
+		// Sweep from the left to get the cost of every left side, then from the right to find the cheapest split
+		eastl::array<float, sBuildBins> leftCosts;
+		BoundingBox sweepBounds = EmptyBox();
+		uint32_t sweepCount = 0;
+		for (uint32_t binIndex = 0; binIndex < sBuildBins - 1; ++binIndex)
+		{
+			GrowBox(sweepBounds, bins[binIndex].Bounds.Min, bins[binIndex].Bounds.Max);
+			sweepCount += bins[binIndex].Count;
+			leftCosts[binIndex] = sweepCount > 0 ? SurfaceArea(sweepBounds.Min, sweepBounds.Max) * float(sweepCount) : -1.0f;
+		}
+
+		float bestCost = FLT_MAX;
+		uint32_t bestSplit = 0;
+		sweepBounds = EmptyBox();
+		sweepCount = 0;
+		for (uint32_t binIndex = sBuildBins - 1; binIndex > 0; --binIndex)
+		{
+			GrowBox(sweepBounds, bins[binIndex].Bounds.Min, bins[binIndex].Bounds.Max);
+			sweepCount += bins[binIndex].Count;
+			// Both sides must have something
+			if (sweepCount == 0 || leftCosts[binIndex - 1] < 0.0f)
+			{
+				continue;
+			}
+			const float cost = leftCosts[binIndex - 1] + SurfaceArea(sweepBounds.Min, sweepBounds.Max) * float(sweepCount);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = binIndex - 1;
+			}
+		}
+
+		uint32_t splitMiddle = task.Begin;
+		for (uint32_t reference = task.Begin; reference < task.End; ++reference)
+		{
+			if (getBin(tree.References[reference]) <= bestSplit)
+			{
+				eastl::swap(tree.References[reference], tree.References[splitMiddle]);
+				++splitMiddle;
+			}
+		}
+		if (splitMiddle != task.Begin && splitMiddle != task.End)
+		{
+			middle = splitMiddle;
+		}
+	}
+
+	const uint32_t firstChild = tree.NodeCount.fetch_add(2);
+	node.First = firstChild;
+	node.Count = 0;
+
+	BuildTask childTasks[2] = {
+		BuildTask{ this, &tree, task.JobSystem, firstChild, task.Begin, middle, task.Depth + 1 },
+		BuildTask{ this, &tree, task.JobSystem, firstChild + 1, middle, task.End, task.Depth + 1 },
+	};
+	if (count > sParallelBuildItems)
+	{
+		Job::JobDecl jobs[2] = {
+			Job::JobDecl{ BuildNodeJob, &childTasks[0] },
+			Job::JobDecl{ BuildNodeJob, &childTasks[1] },
+		};
+		Job::Counter counter;
+		task.JobSystem->RunJobs("Scene BVH Build", jobs, 2, &counter);
+		task.JobSystem->WaitForCounter(&counter, 0);
+	}
+	else
+	{
+		BuildNode(childTasks[0]);
+		BuildNode(childTasks[1]);
+	}
+}
+
+void SceneBvh::BuildNodeJob(uint32_t, void* data)
+{
+	const BuildTask* task = reinterpret_cast<const BuildTask*>(data);
+	task->Bvh->BuildNode(*task);
+}
+
+float SceneBvh::RefitTree(Tree& tree)
+{
+	OPTICK_EVENT();
+	float cost = 0.0f;
+	// Children are always allocated after their parent, so going backwards visits them first
+	for (uint32_t nodeIndex = tree.NodeCount; nodeIndex-- > 0;)
+	{
+		Node& node = tree.Nodes[nodeIndex];
+		BoundingBox bounds = EmptyBox();
+		if (node.Count > 0)
+		{
+			for (uint32_t reference = node.First; reference < node.First + node.Count; ++reference)
+			{
+				if (IsReferenceAlive(tree, reference))
+				{
+					const BoundingBox& itemBounds = m_Items[tree.References[reference]].Bounds;
+					GrowBox(bounds, itemBounds.Min, itemBounds.Max);
+				}
+			}
+		}
+		else
+		{
+			const Node& left = tree.Nodes[node.First];
+			const Node& right = tree.Nodes[node.First + 1];
+			GrowBox(bounds, left.Min, left.Max);
+			GrowBox(bounds, right.Min, right.Max);
+			cost += SurfaceArea(bounds.Min, bounds.Max);
+		}
+		node.Min = bounds.Min;
+		node.Max = bounds.Max;
+	}
+	return cost;
+}
+
+void SceneBvh::CollectTaskRoots(Tree& tree)
+{
+	tree.TaskRoots.clear();
+	if (tree.NodeCount == 0)
+	{
+		return;
+	}
+
+	// Breadth first, so every job gets a similar part of the tree
+	tree.TaskRoots.push_back(0);
+	eastl::vector<uint32_t> nextRoots;
+	for (uint32_t depth = 0; depth < sTaskRootDepth; ++depth)
+	{
+		nextRoots.clear();
+		for (uint32_t root : tree.TaskRoots)
+		{
+			const Node& node = tree.Nodes[root];
+			if (node.Count > 0)
+			{
+				nextRoots.push_back(root);
+			}
+			else
+			{
+				nextRoots.push_back(node.First);
+				nextRoots.push_back(node.First + 1);
+			}
+		}
+		tree.TaskRoots.swap(nextRoots);
+	}
+}
+
+void SceneBvh::Cull(Job::JobSystem& jobSystem, eastl::span<const glm::mat4x4> viewProjections)
+{
+	OPTICK_EVENT();
+	assert(viewProjections.size() <= sMaxViews);
+	const auto cullStart = StatisticsClock::now();
+
+	m_CullTasks.clear();
+	for (uint32_t view = 0; view < viewProjections.size(); ++view)
+	{
+		m_ViewPlanes[view] = ExtractFrustumPlanes(viewProjections[view]);
+		for (const Tree* tree : { &m_StaticTree, &m_DynamicTree })
+		{
+			for (uint32_t root : tree->TaskRoots)
+			{
+				m_CullTasks.push_back(CullTask{ view, tree, root });
+			}
+		}
+		m_CullTasks.push_back(CullTask{ view, nullptr, 0 });
+	}
+	if (m_CullTaskResults.size() < m_CullTasks.size())
+	{
+		m_CullTaskResults.resize(m_CullTasks.size());
+	}
+
+	{
+		eastl::vector<Job::JobDecl> jobs(m_CullTasks.size(), Job::JobDecl{ CullJob, this });
+		Job::Counter counter;
+		jobSystem.RunJobs("Scene BVH Cull", jobs.data(), uint32_t(jobs.size()), &counter);
+		jobSystem.WaitForCounter(&counter, 0);
+	}
+
+	for (uint32_t view = 0; view < sMaxViews; ++view)
+	{
+		m_VisibleItems[view].clear();
+	}
+	for (uint32_t taskIndex = 0; taskIndex < m_CullTasks.size(); ++taskIndex)
+	{
+		const eastl::vector<uint32_t>& result = m_CullTaskResults[taskIndex];
+		eastl::vector<uint32_t>& visibleItems = m_VisibleItems[m_CullTasks[taskIndex].View];
+		visibleItems.insert(visibleItems.end(), result.begin(), result.end());
+	}
+
+	m_Statistics.CullTasks = uint32_t(m_CullTasks.size());
+	m_Statistics.CullMilliseconds = std::chrono::duration<float, std::milli>(StatisticsClock::now() - cullStart).count();
+	OPTICK_TAG("Cull Tasks", m_Statistics.CullTasks);
+	OPTICK_TAG("Visible Items Main", uint32_t(m_VisibleItems[0].size()));
+	m_LastFrameStatistics = m_Statistics;
+}
+
+void SceneBvh::CullJob(uint32_t index, void* data)
+{
+	SceneBvh* bvh = reinterpret_cast<SceneBvh*>(data);
+	eastl::vector<uint32_t>& result = bvh->m_CullTaskResults[index];
+	result.clear();
+	bvh->CullSubtree(bvh->m_CullTasks[index], result);
+}
+
+void SceneBvh::CullSubtree(const CullTask& task, eastl::vector<uint32_t>& result) const
+{
+	const eastl::array<glm::vec4, 6>& planes = m_ViewPlanes[task.View];
+	if (!task.Source)
+	{
+		for (uint32_t item : m_UnboundedItems)
+		{
+			result.push_back(m_Items[item].UserData);
+		}
+		for (uint32_t item : m_PendingItems)
+		{
+			uint32_t planeMask = sAllPlanes;
+			if (IntersectFrustum(planes, m_Items[item].Bounds.Min, m_Items[item].Bounds.Max, planeMask))
+			{
+				result.push_back(m_Items[item].UserData);
+			}
+		}
+		return;
+	}
+
+	const Tree& tree = *task.Source;
+	struct StackEntry
+	{
+		uint32_t NodeIndex;
+		uint32_t PlaneMask;
+	};
+	// Depth first, one child is always taken right away, so the stack is not deeper than the tree
+	eastl::array<StackEntry, sMaxDepth + 2> stack;
+	uint32_t stackSize = 0;
+	stack[stackSize++] = StackEntry{ task.Root, sAllPlanes };
+	while (stackSize > 0)
+	{
+		const StackEntry entry = stack[--stackSize];
+		const Node& node = tree.Nodes[entry.NodeIndex];
+		uint32_t planeMask = entry.PlaneMask;
+		if (!IntersectFrustum(planes, node.Min, node.Max, planeMask))
+		{
+			continue;
+		}
+
+		if (node.Count == 0)
+		{
+			assert(stackSize + 2 <= stack.size());
+			stack[stackSize++] = StackEntry{ node.First + 1, planeMask };
+			stack[stackSize++] = StackEntry{ node.First, planeMask };
+			continue;
+		}
+
+		for (uint32_t reference = node.First; reference < node.First + node.Count; ++reference)
+		{
+			if (!IsReferenceAlive(tree, reference))
+			{
+				continue;
+			}
+			const Item& item = m_Items[tree.References[reference]];
+			// With an empty mask the node is fully inside, so there is nothing to test
+			uint32_t itemPlaneMask = planeMask;
+			if (IntersectFrustum(planes, item.Bounds.Min, item.Bounds.Max, itemPlaneMask))
+			{
+				result.push_back(item.UserData);
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+
+#include <atomic>
+
+namespace Tempest
+{
+namespace Job { class JobSystem; }
+
+struct BoundingBox
+{
+	glm::vec3 Min;
+	glm::vec3 Max;
+};
+
+struct SceneBvhStatistics
+{
+	uint32_t StaticItems = 0;
+	uint32_t DynamicItems = 0;
+	// Items which moved recently and are not in any tree yet, they are tested one by one
+	uint32_t PendingItems = 0;
+	// Items without bounds, they are never culled
+	uint32_t UnboundedItems = 0;
+	uint32_t StaticNodes = 0;
+	uint32_t DynamicNodes = 0;
+	uint32_t StaticRebuilds = 0;
+	uint32_t DynamicRebuilds = 0;
+	uint32_t DynamicRefits = 0;
+	uint32_t CullTasks = 0;
+	float UpdateMilliseconds = 0.0f;
+	float CullMilliseconds = 0.0f;
+};
+
+// Bounding volume hierarchy over the bounds of the render scene, used to cull all views hierarchically.
+// There are two trees. Items which didn't move for a while are in the static one, which is only rebuilt when enough of them
+// settled down or were removed. Moving items are in the dynamic tree, which is refit every frame and rebuilt when its quality drops.
+// Items which started moving since the last rebuild wait in a small list, which is tested linearly.
+// Removed items are left in the trees and skipped by the traversal until the next rebuild.
+// Both the builds and the traversal of the views are split in jobs.
+class SceneBvh : Utils::NonCopyable
+{
+public:
+	static const uint32_t sInvalidItem = uint32_t(-1);
+	static const uint32_t sMaxViews = 4;
+
+	// Item without bounds is always visible. The user data is what the culling returns
+	uint32_t Insert(uint32_t userData, const BoundingBox* bounds);
+	void Remove(uint32_t item);
+	void Move(uint32_t item, const BoundingBox* bounds);
+	void SetUserData(uint32_t item, uint32_t userData);
+
+	// Refits and rebuilds the trees with the changes since the last call. Must be called from a job
+	void Update(Job::JobSystem& jobSystem);
+	// Finds the items in the frustum of every view. Views are traversed in parallel. Must be called from a job
+	void Cull(Job::JobSystem& jobSystem, eastl::span<const glm::mat4x4> viewProjections);
+	// User data of the items visible in the view from the last Cull
+	eastl::span<const uint32_t> GetVisibleItems(uint32_t view) const
+	{
+		return m_VisibleItems[view];
+	}
+
+	const SceneBvhStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	friend struct SceneBvhBenchmark;
+
+	enum class ItemState : uint8_t
+	{
+		Free,
+		Static,
+		Dynamic,
+		Pending,
+		Unbounded,
+	};
+
+	struct Item
+	{
+		BoundingBox Bounds;
+		uint32_t UserData;
+		// Position in the references of its tree or in its list. Stale references to the item are detected with it
+		uint32_t Reference;
+		uint64_t LastMovedFrame;
+		ItemState State;
+	};
+
+	struct Node
+	{
+		glm::vec3 Min;
+		// Inner nodes have their two children next to each other, leaves point to the references of the tree
+		uint32_t First;
+		glm::vec3 Max;
+		// Zero for inner nodes
+		uint32_t Count;
+	};
+
+	struct Tree
+	{
+		ItemState State;
+		eastl::vector<Node> Nodes;
+		std::atomic<uint32_t> NodeCount = 0;
+		eastl::vector<uint32_t> References;
+		// Subtrees which are traversed by separate jobs
+		eastl::vector<uint32_t> TaskRoots;
+		uint32_t DeadReferences = 0;
+		// Surface area of all inner nodes right after the build. Refits make it bigger
+		float BuildCost = 0.0f;
+	};
+
+	struct BuildTask
+	{
+		SceneBvh* Bvh;
+		Tree* Target;
+		Job::JobSystem* JobSystem;
+		uint32_t NodeIndex;
+		uint32_t Begin;
+		uint32_t End;
+		uint32_t Depth;
+	};
+
+	struct CullTask
+	{
+		uint32_t View;
+		// Null for the pending and the unbounded items
+		const Tree* Source;
+		uint32_t Root;
+	};
+
+	uint32_t AllocateItem();
+	void Detach(uint32_t item);
+	void AddToList(eastl::vector<uint32_t>& list, ItemState state, uint32_t item);
+	bool IsReferenceAlive(const Tree& tree, uint32_t reference) const;
+	bool IsSettled(const Item& item) const;
+
+	void BuildTree(Tree& tree, Job::JobSystem& jobSystem);
+	void BuildNode(const BuildTask& task);
+	static void BuildNodeJob(uint32_t, void* data);
+	// Returns the surface area of all inner nodes
+	float RefitTree(Tree& tree);
+	void CollectTaskRoots(Tree& tree);
+
+	void CullSubtree(const CullTask& task, eastl::vector<uint32_t>& result) const;
+	static void CullJob(uint32_t index, void* data);
+
+	// Items which didn't move for this many frames go in the static tree on its next rebuild
+	static const uint64_t sSettleFrames = 60;
+	static const uint64_t sMinStaticRebuildInterval = 30;
+	static const uint32_t sMinRebuildItems = 64;
+	static const uint32_t sMaxLeafItems = 4;
+	static const uint32_t sBuildBins = 16;
+	static const uint32_t sMaxDepth = 48;
+	// Ranges bigger than this are built in separate jobs
+	static const uint32_t sParallelBuildItems = 8192;
+	// Depth of the subtrees given to the cull jobs
+	static const uint32_t sTaskRootDepth = 3;
+	// Refit trees worse than this compared to the build are rebuilt
+	static constexpr float sMaxRefitCostRatio = 2.0f;
+
+	eastl::vector<Item> m_Items;
+	eastl::vector<uint32_t> m_FreeItems;
+	eastl::vector<uint32_t> m_PendingItems;
+	eastl::vector<uint32_t> m_UnboundedItems;
+	Tree m_StaticTree;
+	Tree m_DynamicTree;
+	bool m_DynamicMoved = false;
+	// Refits made the dynamic tree too slow to traverse
+	bool m_DynamicNeedsRebuild = false;
+	// Starts after the settle period, so inserted items are treated as not moving
+	uint64_t m_FrameIndex = sSettleFrames;
+	uint64_t m_LastStaticRebuildFrame = 0;
+
+	// Valid only during Cull
+	eastl::array<eastl::array<glm::vec4, 6>, sMaxViews> m_ViewPlanes;
+	eastl::vector<CullTask> m_CullTasks;
+	eastl::vector<eastl::vector<uint32_t>> m_CullTaskResults;
+	eastl::array<eastl::vector<uint32_t>, sMaxViews> m_VisibleItems;
+
+	SceneBvhStatistics m_Statistics;
+	SceneBvhStatistics m_LastFrameStatistics;
+};
+}
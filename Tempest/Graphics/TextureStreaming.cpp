@@ -0,0 +1,443 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/TextureStreaming.h>
+#include <Graphics/Managers/MeshManager.h>
+#include <Graphics/FrameData.h>
+#include <Graphics/Dx12/Dx12Backend.h>
+#include <Graphics/Dx12/Managers/ConstantBufferDataManager.h>
+#include <EASTL/sort.h>
+
+namespace Tempest
+{
+// Bigger than the mip count of any texture, so everything ends up in its tail mips
+static const uint32_t sMaxMipBias = 16;
+// Anything closer than this wants the texel density at that distance
+static const float sMinDistance = 0.1f;
+
+static Dx12::TextureDescription DescriptionForMips(const Definition::TextureData& data, eastl::span<const Definition::TextureMip> mips, const uint8_t* buffer, uint32_t mostDetailedMip)
+{
+	Dx12::TextureDescription description;
+	description.Type = Dx12::TextureType::Texture2D;
+	description.Format = Dx12::DxFormatForStorageFromTextureFormat(data);
+	description.Width = eastl::max(data.width() >> mostDetailedMip, 1u);
+	description.Height = eastl::max(data.height() >> mostDetailedMip, 1u);
+	description.Data = buffer + mips[mostDetailedMip].offset();
+	description.Size = mips.back().offset() + mips.back().byte_count() - mips[mostDetailedMip].offset();
+	description.MipLevels = uint32_t(mips.size()) - mostDetailedMip;
+	return description;
+}
+
+void TextureStreaming::Initialize(Dx12::Backend& backend, const Definition::TextureDatabase* database)
+{
+	m_Backend = &backend;
+	m_Database = database;
+
+	const auto* mappings = database->mappings();
+	const bool hasMips = database->mip_ranges() && database->mips() && database->mip_ranges()->size() == mappings->size();
+	if (hasMips)
+	{
+		m_Mips = eastl::span<const Definition::TextureMip>(reinterpret_cast<const Definition::TextureMip*>(database->mips()->Data()), database->mips()->size());
+	}
+	else
+	{
+		// Older databases are cooked without mips, so the whole texture is its only mip
+		LOG(Warning, Renderer, "Texture database has no mips, textures will not be streamed.");
+		m_GeneratedMips.reserve(mappings->size());
+		for (const auto& mapping : *mappings)
+		{
+			m_GeneratedMips.emplace_back(mapping->texture_buffer_offset(), mapping->texture_buffer_byte_count());
+		}
+		m_Mips = m_GeneratedMips;
+	}
+
+	m_Textures.resize(mappings->size());
+	m_TextureSlots.resize(mappings->size());
+	m_ChangedSlots.clear();
+	for (uint32_t i = 0; i < mappings->size(); ++i)
+	{
+		const Definition::TextureData& data = mappings->Get(i)->texture_data();
+		StreamedTexture& texture = m_Textures[i];
+		texture.Width = data.width();
+		texture.Height = data.height();
+		texture.FirstMip = hasMips ? database->mip_ranges()->Get(i)->mip_offset() : i;
+		texture.MipCount = hasMips ? database->mip_ranges()->Get(i)->mip_count() : 1;
+
+		// The most detailed mip of a block compressed texture must be made of whole blocks, so not every mip can be the first one
+		const bool isBlockCompressed = data.format() != Definition::TextureFormat_RGBA8;
+		auto canBeFirstMip = [&texture, isBlockCompressed](uint32_t mip) {
+			return !isBlockCompressed || ((texture.Width >> mip) % 4 == 0 && (texture.Height >> mip) % 4 == 0);
+		};
+		texture.TailMip = 0;
+		while (eastl::max(texture.Width >> texture.TailMip, texture.Height >> texture.TailMip) > sTailMipSize
+			&& texture.TailMip + 1 < texture.MipCount
+			&& canBeFirstMip(texture.TailMip + 1))
+		{
+			++texture.TailMip;
+		}
+		texture.ResidentMip = texture.TailMip;
+		texture.RequestedMip = texture.TailMip;
+		m_TextureSlots[i] = GetDescriptorSlot(i, texture.SlotVersion);
+	}
+}
+
+uint64_t TextureStreaming::GetResidentUploadSize() const
+{
+	uint64_t size = m_TextureSlots.size() * sizeof(uint32_t);
+	for (uint32_t i = 0; i < m_Textures.size(); ++i)
+	{
+		size += GetUploadSize(i, m_Textures[i].TailMip);
+	}
+	return size;
+}
+
+void TextureStreaming::CreateResidentTextures(Dx12::UploadData& upload)
+{
+	OPTICK_EVENT();
+	const uint32_t slotBufferSize = uint32_t(m_TextureSlots.size() * sizeof(uint32_t));
+	m_SlotBuffer = m_Backend->Managers.Buffer.CreateBuffer(Dx12::BufferDescription{
+		Dx12::BufferType::Vertex,
+		slotBufferSize,
+		m_TextureSlots.data()
+	}, &upload);
+	m_Backend->GetDevice()->AddStaticBufferDescriptor(m_Backend->Managers.Buffer.GetBuffer(m_SlotBuffer), uint32_t(m_TextureSlots.size()), sizeof(uint32_t), Dx12::Dx12Device::ShaderResourceSlot::TextureSlots);
+
+	// Nothing is rendered yet, so the descriptors could be written right away
+	for (uint32_t i = 0; i < m_Textures.size(); ++i)
+	{
+		SetResidentTexture(i, m_Textures[i].TailMip, CreateTexture(i, m_Textures[i].TailMip, upload));
+	}
+}
+
+void TextureStreaming::GatherRequests(const MeshManager& meshes, const FrameData& frameData, uint32_t viewportHeight)
+{
+	OPTICK_EVENT();
+	++m_FrameIndex;
+	for (StreamedTexture& texture : m_Textures)
+	{
+		texture.RequestedMip = texture.TailMip;
+	}
+
+	const float pixelsPerWorldUnitAtUnitDistance = frameData.ProjectionScale * float(viewportHeight) * 0.5f;
+	// Only the meshes in the camera frustum
+	for (uint32_t meshIndex : frameData.MainViewStaticMeshes)
+	{
+		const FrameData::StaticMeshData& staticMesh = frameData.StaticMeshes[meshIndex];
+		if (staticMesh.IsOccluded)
+		{
+			continue;
+		}
+
+		const MeshLodInfo* lodInfo = meshes.GetLodInfo(staticMesh.Mesh);
+		const glm::vec3 axisX(staticMesh.Transform[0]);
+		const glm::vec3 axisY(staticMesh.Transform[1]);
+		const glm::vec3 axisZ(staticMesh.Transform[2]);
+		const float maxScale = glm::sqrt(eastl::max(glm::dot(axisX, axisX), eastl::max(glm::dot(axisY, axisY), glm::dot(axisZ, axisZ))));
+		const glm::vec3 center = glm::vec3(staticMesh.Transform * glm::vec4(lodInfo ? lodInfo->BoundsCenter : glm::vec3(0.0f), 1.0f));
+		const float radius = lodInfo ? lodInfo->BoundsRadius * maxScale : 0.0f;
+		if (maxScale <= 0.0f)
+		{
+			continue;
+		}
+
+		// The closest point of the bounds decides, so big meshes next to the camera get their full resolution
+		const float distance = eastl::max(glm::length(center - frameData.CameraPosition) - radius, sMinDistance);
+		const float pixelsPerWorldUnit = pixelsPerWorldUnitAtUnitDistance / distance;
+
+		const eastl::span<const Definition::PrimitiveMeshData> primitives = meshes.GetMeshData(staticMesh.Mesh);
+		for (uint32_t primitiveIndex = 0; primitiveIndex < primitives.size(); ++primitiveIndex)
+		{
+			const Definition::Material& material = meshes.GetMaterial(primitives[primitiveIndex].material_index());
+			const float uvDensity = meshes.GetPrimitiveUVDensity(staticMesh.Mesh, primitiveIndex) / maxScale;
+			RequestMip(material.albedo_color_texture_index(), uvDensity, pixelsPerWorldUnit);
+			RequestMip(material.metallic_roughness_texture_index(), uvDensity, pixelsPerWorldUnit);
+		}
+	}
+}
+
+void TextureStreaming::RequestMip(uint32_t textureIndex, float uvDensity, float pixelsPerWorldUnit)
+{
+	// Materials use -1 for missing textures
+	if (textureIndex >= m_Textures.size())
+	{
+		return;
+	}
+
+	StreamedTexture& texture = m_Textures[textureIndex];
+	texture.LastUsedFrame = m_FrameIndex;
+
+	// Without UV density there is no way to know, so the full resolution is used
+	uint32_t mip = 0;
+	if (uvDensity > 0.0f)
+	{
+		// Every mip halves the texels, so one texel per pixel is reached after log2 of that many mips
+		const float texelsPerPixel = float(eastl::max(texture.Width, texture.Height)) * uvDensity / pixelsPerWorldUnit;
+		mip = texelsPerPixel > 1.0f ? uint32_t(glm::log2(texelsPerPixel)) : 0;
+	}
+	texture.RequestedMip = eastl::min(texture.RequestedMip, eastl::min(mip, texture.TailMip));
+}
+
+void TextureStreaming::Update()
+{
+	OPTICK_EVENT();
+	TextureStreamingStatistics statistics;
+	statistics.Textures = uint32_t(m_Textures.size());
+	statistics.MemoryBudget = m_MemoryBudget;
+	CompleteUploads(statistics);
+
+	// Least recently used first
+	eastl::vector<uint32_t> order(m_Textures.size());
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		order[i] = i;
+		statistics.RequestedTextures += m_Textures[i].LastUsedFrame == m_FrameIndex ? 1 : 0;
+	}
+	eastl::sort(order.begin(), order.end(), [this](uint32_t left, uint32_t right) {
+		return m_Textures[left].LastUsedFrame < m_Textures[right].LastUsedFrame;
+	});
+
+	// Requested textures get their mips. The rest keep what they have, until the memory is needed for something else.
+	// If that is not enough, all requests are made coarser by the same bias, so no texture is singled out.
+	eastl::vector<uint32_t> targetMips(m_Textures.size());
+	uint32_t mipBias = 0;
+	for (;;)
+	{
+		uint64_t memory = 0;
+		for (uint32_t i = 0; i < m_Textures.size(); ++i)
+		{
+			const StreamedTexture& texture = m_Textures[i];
+			targetMips[i] = texture.LastUsedFrame == m_FrameIndex ? eastl::min(texture.RequestedMip + mipBias, texture.TailMip) : texture.ResidentMip;
+			memory += GetMipChainSize(texture, targetMips[i]);
+		}
+
+		if (mipBias == 0)
+		{
+			statistics.RequestedMemory = memory;
+		}
+
+		for (uint32_t textureIndex : order)
+		{
+			const StreamedTexture& texture = m_Textures[textureIndex];
+			// Sorted, so all the rest are used in this frame
+			if (memory <= m_MemoryBudget || texture.LastUsedFrame == m_FrameIndex)
+			{
+				break;
+			}
+			memory -= GetMipChainSize(texture, targetMips[textureIndex]) - GetMipChainSize(texture, texture.TailMip);
+			targetMips[textureIndex] = texture.TailMip;
+		}
+
+		if (memory <= m_MemoryBudget || mipBias >= sMaxMipBias)
+		{
+			break;
+		}
+		++mipBias;
+	}
+	statistics.MipBias = mipBias;
+
+	eastl::vector<uint32_t> changes;
+	for (uint32_t i = 0; i < m_Textures.size(); ++i)
+	{
+		// The new texture will need the other slot, which must be free by the time the upload is done
+		if (targetMips[i] != m_Textures[i].ResidentMip && !m_Textures[i].IsUploading && m_Backend->IsFrameFenceCompleted(m_Textures[i].PreviousSlotFence))
+		{
+			changes.push_back(i);
+		}
+	}
+
+	// Freeing memory goes first, then the textures which are the farthest from what they need
+	eastl::sort(changes.begin(), changes.end(), [this, &targetMips](uint32_t left, uint32_t right) {
+		const int32_t leftMissingMips = int32_t(m_Textures[left].ResidentMip) - int32_t(targetMips[left]);
+		const int32_t rightMissingMips = int32_t(m_Textures[right].ResidentMip) - int32_t(targetMips[right]);
+		if ((leftMissingMips < 0) != (rightMissingMips < 0))
+		{
+			return leftMissingMips < 0;
+		}
+		if (leftMissingMips != rightMissingMips)
+		{
+			return leftMissingMips > rightMissingMips;
+		}
+		return left < right;
+	});
+
+	uint64_t uploadSize = 0;
+	uint32_t changeCount = 0;
+	for (; changeCount < changes.size(); ++changeCount)
+	{
+		const uint64_t textureUploadSize = GetUploadSize(changes[changeCount], targetMips[changes[changeCount]]);
+		if (changeCount > 0 && uploadSize + textureUploadSize > sMaxUploadBytesPerFrame)
+		{
+			break;
+		}
+		uploadSize += textureUploadSize;
+	}
+
+	if (changeCount > 0)
+	{
+		Dx12::UploadData uploadData = m_Backend->PrepareUpload(uint32_t(uploadSize));
+		PendingUpload& pendingUpload = m_PendingUploads.push_back();
+		pendingUpload.Textures.reserve(changeCount);
+		for (uint32_t i = 0; i < changeCount; ++i)
+		{
+			const uint32_t textureIndex = changes[i];
+			pendingUpload.Textures.push_back(UploadedTexture{ textureIndex, targetMips[textureIndex], CreateTexture(textureIndex, targetMips[textureIndex], uploadData) });
+			m_Textures[textureIndex].IsUploading = true;
+		}
+		// The old textures stay in use until the copy is done
+		pendingUpload.Ticket = m_Backend->SubmitUpload(uploadData);
+		statistics.UploadedBytes = uploadSize;
+	}
+
+	for (const StreamedTexture& texture : m_Textures)
+	{
+		statistics.ResidentMemory += GetMipChainSize(texture, texture.ResidentMip);
+	}
+	for (const PendingUpload& pendingUpload : m_PendingUploads)
+	{
+		statistics.UploadingTextures += uint32_t(pendingUpload.Textures.size());
+	}
+
+	OPTICK_TAG("Streamed In Textures", statistics.StreamedInTextures);
+	OPTICK_TAG("Streamed Out Textures", statistics.StreamedOutTextures);
+	OPTICK_TAG("Uploading Textures", statistics.UploadingTextures);
+	OPTICK_TAG("Texture Mip Bias", statistics.MipBias);
+	OPTICK_TAG("Resident Texture Memory", statistics.ResidentMemory);
+	OPTICK_TAG("Requested Texture Memory", statistics.RequestedMemory);
+	m_LastFrameStatistics = statistics;
+}
+
+void TextureStreaming::CompleteUploads(TextureStreamingStatistics& statistics)
+{
+	while (!m_PendingUploads.empty() && m_Backend->IsUploadCompleted(m_PendingUploads.front().Ticket))
+	{
+		for (const UploadedTexture& uploaded : m_PendingUploads.front().Textures)
+		{
+			StreamedTexture& texture = m_Textures[uploaded.TextureIndex];
+			if (uploaded.MostDetailedMip < texture.ResidentMip)
+			{
+				++statistics.StreamedInTextures;
+			}
+			else
+			{
+				++statistics.StreamedOutTextures;
+			}
+			texture.IsUploading = false;
+			SetResidentTexture(uploaded.TextureIndex, uploaded.MostDetailedMip, uploaded.Handle);
+		}
+		m_PendingUploads.pop_front();
+	}
+
+	while (!m_RetiredTextures.empty() && m_Backend->IsFrameFenceCompleted(m_RetiredTextures.front().FrameFence))
+	{
+		m_Backend->Managers.Texture.DestroyTexture(m_RetiredTextures.front().Handle);
+		m_RetiredTextures.pop_front();
+	}
+}
+
+uint64_t TextureStreaming::GetMipChainSize(const StreamedTexture& texture, uint32_t mostDetailedMip) const
+{
+	uint64_t size = 0;
+	for (uint32_t mip = mostDetailedMip; mip < texture.MipCount; ++mip)
+	{
+		size += m_Mips[texture.FirstMip + mip].byte_count();
+	}
+	return size;
+}
+
+uint64_t TextureStreaming::GetUploadSize(uint32_t textureIndex, uint32_t mostDetailedMip) const
+{
+	const StreamedTexture& texture = m_Textures[textureIndex];
+	const Dx12::TextureDescription description = DescriptionForMips(
+		m_Database->mappings()->Get(textureIndex)->texture_data(),
+		m_Mips.subspan(texture.FirstMip, texture.MipCount),
+		m_Database->texture_data_buffer()->data(),
+		mostDetailedMip
+	);
+	return m_Backend->Managers.Texture.GetUploadSize(description);
+}
+
+TextureHandle TextureStreaming::CreateTexture(uint32_t textureIndex, uint32_t mostDetailedMip, Dx12::UploadData& upload)
+{
+	const StreamedTexture& texture = m_Textures[textureIndex];
+	const Dx12::TextureDescription description = DescriptionForMips(
+		m_Database->mappings()->Get(textureIndex)->texture_data(),
+		m_Mips.subspan(texture.FirstMip, texture.MipCount),
+		m_Database->texture_data_buffer()->data(),
+		mostDetailedMip
+	);
+	return m_Backend->Managers.Texture.CreateTexture(description, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, &upload);
+}
+
+void TextureStreaming::SetResidentTexture(uint32_t textureIndex, uint32_t mostDetailedMip, TextureHandle handle)
+{
+	StreamedTexture& texture = m_Textures[textureIndex];
+	if (texture.Handle)
+	{
+		// Every frame submitted until now could still sample the old texture through the current slot,
+		// the frame being recorded is the first one to read the other slot
+		assert(m_Backend->IsFrameFenceCompleted(texture.PreviousSlotFence));
+		texture.SlotVersion ^= 1;
+		texture.PreviousSlotFence = m_Backend->GetSubmittedFrameFence();
+		m_RetiredTextures.push_back(RetiredTexture{ texture.Handle, texture.PreviousSlotFence });
+		m_TextureSlots[textureIndex] = GetDescriptorSlot(textureIndex, texture.SlotVersion);
+		m_ChangedSlots.push_back(textureIndex);
+	}
+
+	m_Backend->GetDevice()->AddStaticTextureDescriptor(
+		m_Backend->Managers.Texture.GetTexture(handle),
+		Dx12::DxFormatForViewFromTextureFormat(m_Database->mappings()->Get(textureIndex)->texture_data()),
+		texture.MipCount - mostDetailedMip,
+		GetDescriptorSlot(textureIndex, texture.SlotVersion) - uint32_t(Dx12::Dx12Device::ShaderResourceSlot::TextureStart)
+	);
+	texture.Handle = handle;
+	texture.ResidentMip = mostDetailedMip;
+}
+
+uint32_t TextureStreaming::GetDescriptorSlot(uint32_t textureIndex, uint32_t slotVersion)
+{
+	return uint32_t(Dx12::Dx12Device::ShaderResourceSlot::TextureStart) + textureIndex * 2 + slotVersion;
+}
+
+void TextureStreaming::RecordSlotUploads(RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager)
+{
+	if (m_ChangedSlots.empty())
+	{
+		return;
+	}
+
+	OPTICK_EVENT();
+	// Sorted, so neighbouring textures are merged in a single copy
+	eastl::sort(m_ChangedSlots.begin(), m_ChangedSlots.end());
+
+	const uint32_t slotSize = uint32_t(sizeof(uint32_t));
+	m_SlotUploadData.clear();
+	m_SlotUploadRegions.clear();
+	for (uint32_t textureIndex : m_ChangedSlots)
+	{
+		const uint32_t destinationOffset = textureIndex * slotSize;
+		if (!m_SlotUploadRegions.empty() && m_SlotUploadRegions.back().DestinationOffset + m_SlotUploadRegions.back().Size == destinationOffset)
+		{
+			m_SlotUploadRegions.back().Size += slotSize;
+		}
+		else
+		{
+			RendererBufferUpdateRegion& region = m_SlotUploadRegions.push_back();
+			region.DestinationOffset = destinationOffset;
+			region.ConstantDataOffset = uint32_t(m_SlotUploadData.size()) * slotSize;
+			region.Size = slotSize;
+		}
+		m_SlotUploadData.push_back(m_TextureSlots[textureIndex]);
+	}
+	m_ChangedSlots.clear();
+
+	const uint32_t dataOffset = constantManager.AddRawData(m_SlotUploadData.data(), uint32_t(m_SlotUploadData.size()) * slotSize);
+	for (RendererBufferUpdateRegion& region : m_SlotUploadRegions)
+	{
+		region.ConstantDataOffset += dataOffset;
+	}
+
+	RendererCommandUpdateBuffer command;
+	command.Buffer = m_SlotBuffer;
+	command.RegionCount = uint32_t(m_SlotUploadRegions.size());
+	commandList.AddCommand(command, eastl::span<const RendererBufferUpdateRegion>(m_SlotUploadRegions.data(), m_SlotUploadRegions.size()));
+}
+}
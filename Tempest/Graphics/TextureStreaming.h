@@ -0,0 +1,150 @@
+#pragma once
+
+#include <Graphics/RendererTypes.h>
+#include <Graphics/RendererCommandList.h>
+#include <DataDefinitions/TextureDatabase_generated.h>
+
+#include <EASTL/deque.h>
+
+namespace Tempest
+{
+namespace Dx12 { class Backend; struct UploadData; struct ConstantBufferDataManager; }
+class MeshManager;
+struct FrameData;
+
+struct TextureStreamingStatistics
+{
+	uint32_t Textures = 0;
+	// Textures used by the visible static meshes this frame
+	uint32_t RequestedTextures = 0;
+	uint32_t StreamedInTextures = 0;
+	uint32_t StreamedOutTextures = 0;
+	// Added to every requested mip when the requests don't fit in the budget
+	uint32_t MipBias = 0;
+	uint64_t ResidentMemory = 0;
+	// Memory which would be used if every request is satisfied
+	uint64_t RequestedMemory = 0;
+	uint64_t MemoryBudget = 0;
+	uint64_t UploadedBytes = 0;
+	// Textures whose new mips are still being copied
+	uint32_t UploadingTextures = 0;
+};
+
+// Keeps only the mips of the static textures, which the materials on screen need.
+// The needed mip is found from the projected texel density of every visible primitive, using the UV density cooked in the geometry database.
+// Textures are recreated with the new mip range when it changes, the data always comes from the texture database which stays loaded.
+// The new textures are copied on the copy queue without stalling the frame. Every texture has two descriptor slots and the shaders
+// find the current one through a table, which the frame updates once the copy is done. The old slot is written again
+// and the old texture is destroyed only after the frames which could still use them are finished.
+// When the requests don't fit in the memory budget, the least recently used textures are dropped to their smallest mips first.
+class TextureStreaming : Utils::NonCopyable
+{
+public:
+	// Reads the mip ranges of all textures. The database must stay loaded, as the mips are streamed from it
+	void Initialize(Dx12::Backend& backend, const Definition::TextureDatabase* database);
+	// Size of the upload heap needed for CreateResidentTextures
+	uint64_t GetResidentUploadSize() const;
+	// Creates all textures with only their smallest mips, which are never streamed out, and the table of their slots
+	void CreateResidentTextures(Dx12::UploadData& upload);
+
+	// Finds the most detailed mip every texture needs for the static meshes in the main view
+	void GatherRequests(const MeshManager& meshes, const FrameData& frameData, uint32_t viewportHeight);
+	// Starts recreating the textures which need more or less mips and swaps in the ones which are uploaded.
+	// Must be called before the frame is recorded
+	void Update();
+	// Points the slot table to the textures swapped in this frame. Must be recorded before any draw using them
+	void RecordSlotUploads(RendererCommandList& commandList, Dx12::ConstantBufferDataManager& constantManager);
+
+	void SetMemoryBudget(uint64_t budget)
+	{
+		m_MemoryBudget = budget;
+	}
+
+	const TextureStreamingStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	struct StreamedTexture
+	{
+		uint32_t Width;
+		uint32_t Height;
+		// Range inside of the mips of the database
+		uint32_t FirstMip;
+		uint32_t MipCount;
+		// Mips from this one to the end are always resident
+		uint32_t TailMip;
+		// Most detailed mip in GPU memory
+		uint32_t ResidentMip;
+		// Most detailed mip needed in the current frame. TailMip if not used
+		uint32_t RequestedMip;
+		uint64_t LastUsedFrame = 0;
+		TextureHandle Handle = 0;
+		// Which of the two descriptor slots the shaders read
+		uint32_t SlotVersion = 0;
+		// Frames submitted before this fence could still read the other slot, so it is not written before that
+		uint64_t PreviousSlotFence = 0;
+		// Another mip range is being uploaded, so the texture is not changed again until it is in
+		bool IsUploading = false;
+	};
+
+	struct UploadedTexture
+	{
+		uint32_t TextureIndex;
+		uint32_t MostDetailedMip;
+		TextureHandle Handle;
+	};
+
+	struct PendingUpload
+	{
+		// Dx12::UploadTicket, which is not included to keep Dx12 headers out of the renderer
+		uint64_t Ticket;
+		eastl::vector<UploadedTexture> Textures;
+	};
+
+	struct RetiredTexture
+	{
+		TextureHandle Handle;
+		// Frame fence after which the GPU doesn't use the texture anymore
+		uint64_t FrameFence;
+	};
+
+	void RequestMip(uint32_t textureIndex, float uvDensity, float pixelsPerWorldUnit);
+	uint64_t GetMipChainSize(const StreamedTexture& texture, uint32_t mostDetailedMip) const;
+	uint64_t GetUploadSize(uint32_t textureIndex, uint32_t mostDetailedMip) const;
+	static uint32_t GetDescriptorSlot(uint32_t textureIndex, uint32_t slotVersion);
+	// The new texture is not visible to the shaders until SetResidentTexture
+	TextureHandle CreateTexture(uint32_t textureIndex, uint32_t mostDetailedMip, Dx12::UploadData& upload);
+	// Writes the descriptor of the new resource in the free slot of the texture. The old one is destroyed once the frames in flight are finished
+	void SetResidentTexture(uint32_t textureIndex, uint32_t mostDetailedMip, TextureHandle handle);
+	// Swaps in the textures of the finished uploads and destroys the retired ones which the GPU is done with
+	void CompleteUploads(TextureStreamingStatistics& statistics);
+
+	// Mips at and below this size are always resident
+	static const uint32_t sTailMipSize = 64;
+	static const uint64_t sDefaultMemoryBudget = 256ull * 1024 * 1024;
+	// Limits the hitch from streaming, the rest of the changes are done in the next frames
+	static const uint64_t sMaxUploadBytesPerFrame = 32ull * 1024 * 1024;
+
+	Dx12::Backend* m_Backend = nullptr;
+	const Definition::TextureDatabase* m_Database = nullptr;
+	eastl::vector<StreamedTexture> m_Textures;
+	eastl::span<const Definition::TextureMip> m_Mips;
+	// Only used for older databases without mips
+	eastl::vector<Definition::TextureMip> m_GeneratedMips;
+	uint64_t m_MemoryBudget = sDefaultMemoryBudget;
+	uint64_t m_FrameIndex = 1;
+	// In submission order, so they complete in order
+	eastl::deque<PendingUpload> m_PendingUploads;
+	eastl::deque<RetiredTexture> m_RetiredTextures;
+
+	BufferHandle m_SlotBuffer = 0;
+	// What the slot table holds after the frame copies the changes
+	eastl::vector<uint32_t> m_TextureSlots;
+	eastl::vector<uint32_t> m_ChangedSlots;
+	eastl::vector<uint32_t> m_SlotUploadData;
+	eastl::vector<RendererBufferUpdateRegion> m_SlotUploadRegions;
+
+	TextureStreamingStatistics m_LastFrameStatistics;
+};
+}
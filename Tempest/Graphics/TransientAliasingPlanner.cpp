@@ -0,0 +1,100 @@
+#include <CommonIncludes.h>
+
+#include <Graphics/TransientAliasingPlanner.h>
+#include <Logging.h>
+#include <EASTL/sort.h>
+
+namespace Tempest
+{
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return alignment > 1 ? ((value + alignment - 1) / alignment) * alignment : value;
+}
+
+static bool LifetimesOverlap(const TransientResourceRequest& first, const TransientResourceRequest& second)
+{
+	return first.FirstPass <= second.LastPass && second.FirstPass <= first.LastPass;
+}
+
+TransientAliasingPlan PlanTransientAliasing(eastl::span<const TransientResourceRequest> requests)
+{
+	TransientAliasingPlan plan;
+	plan.Placements.resize(requests.size());
+
+	eastl::vector<uint32_t> order(requests.size());
+	for (uint32_t i = 0; i < order.size(); ++i)
+	{
+		order[i] = i;
+		plan.NaiveSize += AlignUp(requests[i].Size, requests[i].Alignment);
+	}
+
+	// Big resources first as they are the hardest to fit in the gaps. Keep it deterministic for equal sizes.
+	eastl::sort(order.begin(), order.end(), [&requests](uint32_t left, uint32_t right) {
+		if (requests[left].Size != requests[right].Size)
+		{
+			return requests[left].Size > requests[right].Size;
+		}
+		return left < right;
+	});
+
+	struct MemoryRange
+	{
+		uint64_t Start;
+		uint64_t End;
+		uint32_t Request;
+	};
+	eastl::vector<MemoryRange> placedRanges;
+	placedRanges.reserve(requests.size());
+	eastl::vector<MemoryRange> occupiedRanges;
+	occupiedRanges.reserve(requests.size());
+
+	for (uint32_t requestIndex : order)
+	{
+		const TransientResourceRequest& request = requests[requestIndex];
+
+		// Only resources alive at the same time as us are blocking memory
+		occupiedRanges.clear();
+		for (const MemoryRange& range : placedRanges)
+		{
+			if (LifetimesOverlap(request, requests[range.Request]))
+			{
+				occupiedRanges.push_back(range);
+			}
+		}
+		eastl::sort(occupiedRanges.begin(), occupiedRanges.end(), [](const MemoryRange& left, const MemoryRange& right) {
+			return left.Start < right.Start;
+		});
+
+		// First gap which can hold the resource
+		uint64_t offset = 0;
+		for (const MemoryRange& range : occupiedRanges)
+		{
+			if (AlignUp(offset, request.Alignment) + request.Size <= range.Start)
+			{
+				break;
+			}
+			offset = eastl::max(offset, range.End);
+		}
+		offset = AlignUp(offset, request.Alignment);
+
+		plan.Placements[requestIndex].HeapOffset = offset;
+		plan.HeapSize = eastl::max(plan.HeapSize, offset + request.Size);
+		placedRanges.push_back({ offset, offset + request.Size, requestIndex });
+	}
+
+	// Mark everything that is sharing memory with another resource
+	for (uint32_t i = 0; i < placedRanges.size(); ++i)
+	{
+		for (uint32_t j = i + 1; j < placedRanges.size(); ++j)
+		{
+			if (placedRanges[i].Start < placedRanges[j].End && placedRanges[j].Start < placedRanges[i].End)
+			{
+				plan.Placements[placedRanges[i].Request].SharesMemory = true;
+				plan.Placements[placedRanges[j].Request].SharesMemory = true;
+			}
+		}
+	}
+
+	return plan;
+}
+}
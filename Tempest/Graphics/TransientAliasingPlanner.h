@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Defines.h>
+
+namespace Tempest
+{
+// Lifetime and memory requirements of a single transient resource inside the render graph.
+// Passes are indices in the order the graph is going to execute them.
+struct TransientResourceRequest
+{
+	uint64_t Size;
+	uint64_t Alignment;
+	uint32_t FirstPass;
+	uint32_t LastPass;
+};
+
+struct TransientResourcePlacement
+{
+	uint64_t HeapOffset = 0;
+	// The memory of this resource is used by some other resource as well, so it needs an aliasing barrier
+	// before the first use and its content must be initialized (cleared or fully overwritten)
+	bool SharesMemory = false;
+};
+
+struct TransientAliasingPlan
+{
+	// Same order as the requests
+	eastl::vector<TransientResourcePlacement> Placements;
+	// Memory needed for all resources when aliasing
+	uint64_t HeapSize = 0;
+	// Memory needed if every resource got its own allocation
+	uint64_t NaiveSize = 0;
+
+	uint64_t GetMemorySaved() const
+	{
+		return NaiveSize - HeapSize;
+	}
+};
+
+// Packs resources, whose lifetimes does not overlap, into the same memory range of a single heap.
+// This doesn't know anything about the graphics API, it only works with sizes and pass indices.
+// Uses greedy first fit with the biggest resources placed first.
+TransientAliasingPlan PlanTransientAliasing(eastl::span<const TransientResourceRequest> requests);
+
+}
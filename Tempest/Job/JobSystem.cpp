@@ -86,12 +86,23 @@ JobSystem::JobSystem(uint32_t numWorkerThreads, uint32_t numFibers, uint32_t fib
 					ThreadTag::Worker)
 			);
 		}
+		// Add an IO Thread on top of the requested ones, as it mostly sleeps in blocking calls
+		m_WorkerThreads.emplace_back(
+			std::thread(
+				&JobSystem::WorkerThreadEntryPoint,
+				this,
+				ThreadTag::IO)
+		);
 	}
 }
 
 void JobSystem::Quit()
 {
 	m_Quit.store(true);
+	{
+		std::lock_guard<std::mutex> lock(m_IOWakeMutex);
+	}
+	m_IOWakeCondition.notify_all();
 }
 
 void JobSystem::WaitForCompletion()
@@ -109,8 +120,9 @@ void JobSystem::WaitForCompletion()
 
 void JobSystem::WorkerThreadEntryPoint(ThreadTag tag)
 {
-	OPTICK_THREAD("WorkerThread");
-	SetThreadName("WorkerThread");
+	const char* threadName = tag == ThreadTag::IO ? "IOThread" : "WorkerThread";
+	OPTICK_THREAD(threadName);
+	SetThreadName(threadName);
 
 	tlsWorkerThreadData.Tag = tag;
 	tlsWorkerThreadData.InitialFiber = ::ConvertThreadToFiber(this);
@@ -136,7 +148,7 @@ JobSystem::NextFreeFiber JobSystem::GetNextFreeFiber()
 	return NextFreeFiber{ m_Fibers[freeFiberIndex], freeFiberIndex };
 }
 
-void JobSystem::RunJobs(const char* name, JobDecl* jobs, uint32_t numJobs, Counter* counter, ThreadTag tag)
+void JobSystem::RunJobs(const char* name, JobDecl* jobs, uint32_t numJobs, Counter* counter, ThreadTag tag, JobPriority priority)
 {
 #ifdef DEBUG_JOB_SYSTEM
 	for (auto i = 0u; i < numJobs; ++i)
@@ -150,10 +162,27 @@ void JobSystem::RunJobs(const char* name, JobDecl* jobs, uint32_t numJobs, Count
 		counter->Value.store(numJobs);
 	}
 
+	ThreadQueues& queues = m_ThreadSpecificJobs[uint8_t(tag)];
+	Queue<JobData>& jobQueue = priority == JobPriority::Background ? queues.BackgroundJobs : queues.Jobs;
 	for (auto i = 0u; i < numJobs; ++i)
 	{
-		m_ThreadSpecificJobs[uint8_t(tag)].Jobs.Enqueue({ jobs[i], counter, name, i });
+		jobQueue.Enqueue({ jobs[i], counter, name, i });
 	}
+
+	if (tag == ThreadTag::IO && numJobs > 0)
+	{
+		// Taking the lock after the jobs are queued means the IO thread either sees them when it checks before sleeping,
+		// or is already sleeping and gets the notification
+		{
+			std::lock_guard<std::mutex> lock(m_IOWakeMutex);
+		}
+		m_IOWakeCondition.notify_one();
+	}
+}
+
+bool JobSystem::IsRunningJob() const
+{
+	return tlsWorkerThreadData.CurrentJobName != nullptr;
 }
 
 void JobSystem::WaitForCounter(Counter* counter, uint32_t value)
@@ -179,6 +208,7 @@ void JobSystem::WaitForCounter(Counter* counter, uint32_t value)
 		waitingFiberItr->second.FiberId = tlsWorkerThreadData.CurrentFiberId;
 		waitingFiberItr->second.TargetValue = value;
 		waitingFiberItr->second.JobName = tlsWorkerThreadData.CurrentJobName;
+		waitingFiberItr->second.Tag = tlsWorkerThreadData.Tag;
 		waitingFiberItr->second.CanBeMadeReady = false;
 
 		tlsWorkerThreadData.CanBeMadeReadyFlag = &waitingFiberItr->second.CanBeMadeReady;
@@ -220,11 +250,11 @@ bool JobSystem::FiberLoopBody(JobSystem* system, ThreadQueues& jobQueues)
 
 		return true;
 	}
-	// Take new task
-	else if (!jobQueues.Jobs.Empty())
+	// Take new task, background ones only when there is nothing else
+	else if (!jobQueues.Jobs.Empty() || !jobQueues.BackgroundJobs.Empty())
 	{
 		JobData jobData;
-		if (!jobQueues.Jobs.Dequeue(jobData))
+		if (!jobQueues.Jobs.Dequeue(jobData) && !jobQueues.BackgroundJobs.Dequeue(jobData))
 		{
 			return false;
 		}
@@ -240,28 +270,7 @@ bool JobSystem::FiberLoopBody(JobSystem* system, ThreadQueues& jobQueues)
 		// This task is done. Decrement its counter
 		if (jobData.Counter)
 		{
-			{
-				std::lock_guard<std::mutex> lock(system->m_WaitingFibersMutex);
-
-				jobData.Counter->Value.fetch_sub(1);
-				auto count = system->m_WaitingFibers.count(jobData.Counter);
-				for (auto i = 0; i < count; ++i)
-				{
-					auto findIt = system->m_WaitingFibers.find(jobData.Counter);
-					if (jobData.Counter->Value.load() <= findIt->second.TargetValue)
-					{
-						// Busy loop on this flag. If it is false, it means that
-						// this waiting thread has not switched to another fiber
-						// Adding it in the readyFibersList will expose a chance
-						// to corrupt the stack of the fiber if we switch to it before
-						// it has switched
-						while (!findIt->second.CanBeMadeReady.load());
-
-						jobQueues.ReadyFibers.Enqueue(ReadyFiber{ findIt->second.FiberId, findIt->second.JobName });
-						system->m_WaitingFibers.erase(findIt);
-					}
-				}
-			}
+			system->DecrementCounter(jobData.Counter);
 		}
 		return true;
 	}
@@ -269,6 +278,47 @@ bool JobSystem::FiberLoopBody(JobSystem* system, ThreadQueues& jobQueues)
 	return false;
 }
 
+void JobSystem::DecrementCounter(Counter* counter)
+{
+	std::lock_guard<std::mutex> lock(m_WaitingFibersMutex);
+
+	counter->Value.fetch_sub(1);
+	auto range = m_WaitingFibers.equal_range(counter);
+	for (auto waitingIt = range.first; waitingIt != range.second;)
+	{
+		if (counter->Value.load() > waitingIt->second.TargetValue)
+		{
+			++waitingIt;
+			continue;
+		}
+
+		// Busy loop on this flag. If it is false, it means that
+		// this waiting thread has not switched to another fiber
+		// Adding it in the readyFibersList will expose a chance
+		// to corrupt the stack of the fiber if we switch to it before
+		// it has switched
+		while (!waitingIt->second.CanBeMadeReady.load());
+
+		// Jobs waiting on the IO thread should not keep it from reading
+		const ThreadTag readyTag = waitingIt->second.Tag == ThreadTag::IO ? ThreadTag::Worker : waitingIt->second.Tag;
+		m_ThreadSpecificJobs[uint8_t(readyTag)].ReadyFibers.Enqueue(ReadyFiber{ waitingIt->second.FiberId, waitingIt->second.JobName });
+		waitingIt = m_WaitingFibers.erase(waitingIt);
+	}
+}
+
+void JobSystem::BeginExternalWork(Counter* counter, uint32_t count)
+{
+	assert(counter);
+	std::lock_guard<std::mutex> lock(m_WaitingFibersMutex);
+	counter->Value.fetch_add(count);
+}
+
+void JobSystem::FinishExternalWork(Counter* counter)
+{
+	assert(counter);
+	DecrementCounter(counter);
+}
+
 void JobSystem::FiberEntryPoint(void* params)
 {
 	auto system = reinterpret_cast<JobSystem*>(params);
@@ -279,11 +329,20 @@ void JobSystem::FiberEntryPoint(void* params)
 	{
 		// First try to execute from current thread specific jobs
 		bool didWeRunAJob = FiberLoopBody(system, system->m_ThreadSpecificJobs[uint8_t(tlsWorkerThreadData.Tag)]);
-		// If we are not Worker specific, try to execute a worker jobs as well
-		if (!didWeRunAJob && tlsWorkerThreadData.Tag != ThreadTag::Worker)
+		// The Windows thread executes worker jobs as well. The IO thread does not, as its jobs could be waiting behind a long one
+		if (!didWeRunAJob && tlsWorkerThreadData.Tag == ThreadTag::Windows)
 		{
 			FiberLoopBody(system, system->m_ThreadSpecificJobs[uint8_t(ThreadTag::Worker)]);
 		}
+		else if (!didWeRunAJob && tlsWorkerThreadData.Tag == ThreadTag::IO)
+		{
+			// Nothing to read, sleep until something is submitted instead of taking a core from the workers
+			ThreadQueues& ioQueues = system->m_ThreadSpecificJobs[uint8_t(ThreadTag::IO)];
+			std::unique_lock<std::mutex> lock(system->m_IOWakeMutex);
+			system->m_IOWakeCondition.wait(lock, [system, &ioQueues]() {
+				return system->m_Quit.load() || !ioQueues.Jobs.Empty() || !ioQueues.BackgroundJobs.Empty();
+			});
+		}
 	}
 
 	// return to Thread fiber to finish threads
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 #include <Job/Queue.h>
 
@@ -33,9 +34,18 @@ enum class ThreadTag : uint8_t
 {
 	Worker, // Standard Worker thread
 	Windows, // Thread that executes windows calls as the message pump is thread specific
+	IO, // Thread that is allowed to block on file reads, so workers never do
 	Count
 };
 
+// Background jobs are started only when there is nothing else to run on the thread, so streaming never delays the frame.
+// Once started they are not preempted, so they should be short or wait on counters, and they continue as any other job
+enum class JobPriority : uint8_t
+{
+	Normal,
+	Background
+};
+
 using FiberHandle = void*;
 
 class TEMPEST_API JobSystem
@@ -45,12 +55,20 @@ public:
 	~JobSystem();
 
 	// Can be called from anywhere
-	void RunJobs(const char* name, JobDecl* jobs, uint32_t numJobs, Counter* counter = nullptr, ThreadTag threadToRunOn = ThreadTag::Worker);
+	void RunJobs(const char* name, JobDecl* jobs, uint32_t numJobs, Counter* counter = nullptr, ThreadTag threadToRunOn = ThreadTag::Worker, JobPriority priority = JobPriority::Normal);
 
-	// Note only 1 job can wait on some counter. This sounds reasonable for now. Implement if ever needed.
-	// Can be called only from a Job
+	// Any number of jobs can wait on the same counter. They continue on the same kind of thread they waited on,
+	// except for the IO thread, whose jobs continue on the workers. Can be called only from a Job
 	void WaitForCounter(Counter* counter, uint32_t value);
 
+	// Work done outside of jobs, like asynchronous I/O, can be waited on with the same counters.
+	// Begin must be called before the work can finish, Finish can be called from any thread
+	void BeginExternalWork(Counter* counter, uint32_t count);
+	void FinishExternalWork(Counter* counter);
+
+	// Whether the calling thread is running a job, so it can wait on counters instead of blocking
+	bool IsRunningJob() const;
+
 	// Will set internal flag to quit all fibers after they finish their current task
 	// After that worker threads will stop.
 	void Quit();
@@ -83,12 +101,14 @@ private:
 		unsigned FiberId;
 		unsigned TargetValue;
 		const char* JobName;
+		ThreadTag Tag;
 		std::atomic<bool> CanBeMadeReady;
 	};
 
 	struct ThreadQueues
 	{
 		Queue<JobData> Jobs;
+		Queue<JobData> BackgroundJobs;
 		Queue<ReadyFiber> ReadyFibers;
 	};
 
@@ -96,6 +116,8 @@ private:
 	static void FiberEntryPoint(void* params);
 	// Returns whether we have executed a fiber
 	static bool FiberLoopBody(JobSystem* system, ThreadQueues& jobQueues);
+	// Fibers waiting for the counter are made ready in the queues of the threads they waited on
+	void DecrementCounter(Counter* counter);
 
 	void CleanUpOldFiber();
 	NextFreeFiber GetNextFreeFiber();
@@ -109,6 +131,10 @@ private:
 
 	std::atomic<bool> m_Quit;
 
+	// The IO thread sleeps on this while it has no jobs, it is woken when jobs are submitted for it or on quit
+	std::mutex m_IOWakeMutex;
+	std::condition_variable m_IOWakeCondition;
+
 	//
 	std::mutex m_WaitingFibersMutex;
 	eastl::unordered_multimap<Counter*, WaitingFiber> m_WaitingFibers;
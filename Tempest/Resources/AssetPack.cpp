@@ -0,0 +1,240 @@
+#include <CommonIncludes.h>
+
+#include <Resources/AssetPack.h>
+#include <Logging.h>
+
+#include <Windows.h>
+
+namespace Tempest
+{
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return ((value + alignment - 1) / alignment) * alignment;
+}
+
+AssetPack::~AssetPack()
+{
+	if (m_View)
+	{
+		::UnmapViewOfFile(m_View);
+	}
+	if (m_File)
+	{
+		::CloseHandle(m_File);
+	}
+}
+
+uint64_t AssetPack::HashName(const char* name, size_t length)
+{
+	// FNV-1a, it is written in the pack so it must never change without bumping the version
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= uint8_t(name[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+eastl::vector<uint8_t> AssetPack::Build(eastl::span<const AssetPackInput> assets)
+{
+	OPTICK_EVENT();
+	// At most half full, so probes stay short
+	uint32_t slotCount = 1;
+	while (slotCount < assets.size() * 2)
+	{
+		slotCount *= 2;
+	}
+
+	uint32_t namesSize = 0;
+	for (const AssetPackInput& asset : assets)
+	{
+		namesSize += uint32_t(asset.Name.size());
+	}
+
+	const uint64_t slotsOffset = sizeof(AssetPackHeader);
+	const uint64_t entriesOffset = AlignUp(slotsOffset + slotCount * sizeof(uint32_t), alignof(AssetPackEntry));
+	const uint64_t namesOffset = entriesOffset + assets.size() * sizeof(AssetPackEntry);
+	const uint64_t tableSize = namesOffset + namesSize;
+
+	uint64_t packSize = AlignUp(tableSize, sPayloadAlignment);
+	for (const AssetPackInput& asset : assets)
+	{
+		packSize = AlignUp(packSize + asset.Data.size(), sPayloadAlignment);
+	}
+
+	eastl::vector<uint8_t> result;
+	result.resize(packSize, 0);
+	AssetPackHeader* header = reinterpret_cast<AssetPackHeader*>(result.data());
+	header->Magic = sMagic;
+	header->Version = sVersion;
+	header->EntryCount = uint32_t(assets.size());
+	header->SlotCount = slotCount;
+	header->NamesSize = namesSize;
+	header->PayloadAlignment = sPayloadAlignment;
+	header->TableSize = tableSize;
+
+	uint32_t* slots = reinterpret_cast<uint32_t*>(result.data() + slotsOffset);
+	AssetPackEntry* entries = reinterpret_cast<AssetPackEntry*>(result.data() + entriesOffset);
+	char* names = reinterpret_cast<char*>(result.data() + namesOffset);
+
+	uint32_t nameOffset = 0;
+	uint64_t payloadOffset = AlignUp(tableSize, sPayloadAlignment);
+	for (uint32_t index = 0; index < assets.size(); ++index)
+	{
+		const AssetPackInput& asset = assets[index];
+		AssetPackEntry& entry = entries[index];
+		entry.NameHash = HashName(asset.Name.c_str(), asset.Name.size());
+		entry.Offset = payloadOffset;
+		entry.Size = asset.Data.size();
+		entry.NameOffset = nameOffset;
+		entry.NameLength = uint32_t(asset.Name.size());
+
+		memcpy(names + nameOffset, asset.Name.c_str(), asset.Name.size());
+		memcpy(result.data() + payloadOffset, asset.Data.data(), asset.Data.size());
+		nameOffset += entry.NameLength;
+		payloadOffset = AlignUp(payloadOffset + entry.Size, sPayloadAlignment);
+
+		uint32_t slot = uint32_t(entry.NameHash & (slotCount - 1));
+		while (slots[slot] != 0)
+		{
+			slot = (slot + 1) & (slotCount - 1);
+		}
+		slots[slot] = index + 1;
+	}
+	return result;
+}
+
+bool AssetPack::ValidateTable(uint64_t packSize) const
+{
+	const AssetPackHeader& header = *m_Header;
+	if (header.Magic != sMagic || header.Version != sVersion || header.SlotCount == 0 || (header.SlotCount & (header.SlotCount - 1)) != 0 || header.SlotCount <= header.EntryCount)
+	{
+		return false;
+	}
+
+	const uint64_t entriesOffset = AlignUp(sizeof(AssetPackHeader) + uint64_t(header.SlotCount) * sizeof(uint32_t), alignof(AssetPackEntry));
+	const uint64_t namesOffset = entriesOffset + uint64_t(header.EntryCount) * sizeof(AssetPackEntry);
+	if (namesOffset + header.NamesSize != header.TableSize || header.TableSize > packSize)
+	{
+		return false;
+	}
+
+	// Checked once when opening, so the lookups and the loads can trust the table
+	for (uint32_t index = 0; index < header.EntryCount; ++index)
+	{
+		const AssetPackEntry& entry = m_Entries[index];
+		if (entry.Offset < header.TableSize || entry.Offset + entry.Size > packSize || uint64_t(entry.NameOffset) + entry.NameLength > header.NamesSize)
+		{
+			return false;
+		}
+	}
+	for (uint32_t slot = 0; slot < header.SlotCount; ++slot)
+	{
+		if (m_Slots[slot] > header.EntryCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool AssetPack::Open(const std::filesystem::path& filePath, bool useMemoryMapping, AsyncFileReader& reader)
+{
+	OPTICK_EVENT();
+	uint64_t packSize = 0;
+	const uint8_t* table = nullptr;
+	if (useMemoryMapping)
+	{
+		HANDLE file = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = nullptr;
+		if (::GetFileSizeEx(file, &fileSize) && uint64_t(fileSize.QuadPart) >= sizeof(AssetPackHeader))
+		{
+			mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		// The view keeps the mapping and the file alive
+		::CloseHandle(file);
+		if (!mapping)
+		{
+			return false;
+		}
+
+		m_View = reinterpret_cast<const uint8_t*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		::CloseHandle(mapping);
+		if (!m_View)
+		{
+			return false;
+		}
+		packSize = uint64_t(fileSize.QuadPart);
+		table = m_View;
+	}
+	else
+	{
+		m_File = reader.OpenFile(filePath);
+		if (!m_File)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		AssetPackHeader header;
+		if (!::GetFileSizeEx(m_File, &fileSize)
+			|| uint64_t(fileSize.QuadPart) < sizeof(AssetPackHeader)
+			|| !reader.ReadBlocking(m_File, 0, &header, sizeof(AssetPackHeader))
+			|| header.TableSize < sizeof(AssetPackHeader)
+			|| header.TableSize > uint64_t(fileSize.QuadPart))
+		{
+			return false;
+		}
+		packSize = uint64_t(fileSize.QuadPart);
+
+		m_Table.resize(header.TableSize);
+		if (!reader.ReadBlocking(m_File, 0, m_Table.data(), m_Table.size()))
+		{
+			return false;
+		}
+		table = m_Table.data();
+	}
+
+	m_Header = reinterpret_cast<const AssetPackHeader*>(table);
+	m_Slots = reinterpret_cast<const uint32_t*>(table + sizeof(AssetPackHeader));
+	m_Entries = reinterpret_cast<const AssetPackEntry*>(table + AlignUp(sizeof(AssetPackHeader) + uint64_t(m_Header->SlotCount) * sizeof(uint32_t), alignof(AssetPackEntry)));
+	m_Names = reinterpret_cast<const char*>(m_Entries + m_Header->EntryCount);
+	// Nothing past the header is read before it is known to be inside of the table
+	if (!ValidateTable(packSize))
+	{
+		FORMAT_LOG(Error, Resources, "Asset pack (%s) is not valid.", filePath.c_str());
+		m_Header = nullptr;
+		return false;
+	}
+	return true;
+}
+
+const AssetPackEntry* AssetPack::Find(const char* name) const
+{
+	if (!m_Header)
+	{
+		return nullptr;
+	}
+
+	const size_t length = strlen(name);
+	const uint64_t hash = HashName(name, length);
+	const uint32_t mask = m_Header->SlotCount - 1;
+	// The table always has empty slots, so the probe ends
+	for (uint32_t slot = uint32_t(hash & mask); m_Slots[slot] != 0; slot = (slot + 1) & mask)
+	{
+		const AssetPackEntry& entry = m_Entries[m_Slots[slot] - 1];
+		if (entry.NameHash == hash && entry.NameLength == length && memcmp(m_Names + entry.NameOffset, name, length) == 0)
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+}
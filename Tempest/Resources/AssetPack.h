@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Resources/AsyncFileReader.h>
+
+#include <filesystem>
+
+namespace Tempest
+{
+// Laid out at the start of the pack, followed by the table of contents. It is the slots of the hash table, the entries
+// and the names of the assets, in this order. Payloads come after the table of contents
+struct AssetPackHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t EntryCount;
+	// Power of two, every slot is an entry index plus one, zero for empty slots
+	uint32_t SlotCount;
+	uint32_t NamesSize;
+	// Every payload starts at a multiple of this from the start of the pack
+	uint32_t PayloadAlignment;
+	// Size of the header and the table of contents
+	uint64_t TableSize;
+};
+
+struct AssetPackEntry
+{
+	uint64_t NameHash;
+	uint64_t Offset;
+	uint64_t Size;
+	// Position of the name in the names of the table of contents, names are not null terminated
+	uint32_t NameOffset;
+	uint32_t NameLength;
+};
+
+// Input of the pack building at cook time
+struct AssetPackInput
+{
+	eastl::string Name;
+	eastl::vector<uint8_t> Data;
+};
+
+// All cooked assets in a single file with a prebuilt table of contents, so the loader doesn't touch the file system for every asset.
+// The table of contents is an open addressing hash table of the asset names, so finding an asset is a hash and a probe or two.
+// Payloads are aligned to pages, so they can be used from a mapping of the pack or read with offsets from its single file handle.
+class AssetPack : Utils::NonCopyable
+{
+public:
+	static const uint32_t sMagic = 0x4B415054; // TPAK
+	static const uint32_t sVersion = 1;
+	static const uint32_t sPayloadAlignment = 4096;
+	static constexpr const char* sFileName = "Assets.tpk";
+
+	~AssetPack();
+
+	static uint64_t HashName(const char* name, size_t length);
+	// Lays out the table of contents and the payloads of the assets. Used at cook time
+	static eastl::vector<uint8_t> Build(eastl::span<const AssetPackInput> assets);
+
+	// Maps the whole pack, or opens it through the reader so the assets can be read asynchronously from it
+	bool Open(const std::filesystem::path& filePath, bool useMemoryMapping, AsyncFileReader& reader);
+	bool IsOpen() const
+	{
+		return m_Header != nullptr;
+	}
+	bool IsMapped() const
+	{
+		return m_View != nullptr;
+	}
+
+	// Null if the asset is not in the pack
+	const AssetPackEntry* Find(const char* name) const;
+
+	// Data of the asset in the mapping of the pack
+	const uint8_t* GetMappedData(const AssetPackEntry& entry) const
+	{
+		assert(IsMapped());
+		return m_View + entry.Offset;
+	}
+	// File to read the assets from when the pack is not mapped
+	void* GetFile() const
+	{
+		return m_File;
+	}
+	uint32_t GetAssetCount() const
+	{
+		return m_Header ? m_Header->EntryCount : 0;
+	}
+private:
+	bool ValidateTable(uint64_t packSize) const;
+
+	const AssetPackHeader* m_Header = nullptr;
+	const uint32_t* m_Slots = nullptr;
+	const AssetPackEntry* m_Entries = nullptr;
+	const char* m_Names = nullptr;
+
+	// Either the whole pack is mapped, or the table of contents is read in memory and the file stays open
+	const uint8_t* m_View = nullptr;
+	eastl::vector<uint8_t> m_Table;
+	void* m_File = nullptr;
+};
+}
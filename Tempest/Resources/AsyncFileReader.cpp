@@ -0,0 +1,295 @@
+#include <CommonIncludes.h>
+
+#include <Resources/AsyncFileReader.h>
+
+#include <Windows.h>
+
+namespace Tempest
+{
+struct AsyncFileReader::ReadRequest
+{
+	AsyncFileReader* Reader;
+	std::filesystem::path FilePath;
+	HANDLE File;
+	// Files opened with OpenFile are owned by the caller
+	bool OwnsFile;
+	uint64_t Offset;
+	uint8_t* Destination;
+	uint64_t Size;
+	bool* Success;
+	Job::Counter* Counters[2];
+	std::atomic<uint32_t> RemainingChunks;
+	std::atomic<bool> Failed;
+};
+
+struct AsyncFileReader::ReadChunk
+{
+	// Must be first, the completion port gives back its address
+	OVERLAPPED Overlapped;
+	ReadRequest* Request;
+	DWORD Size;
+};
+
+AsyncFileReader::AsyncFileReader(Job::JobSystem& jobSystem, bool useOverlappedIO)
+	: m_JobSystem(jobSystem)
+	, m_UseOverlappedIO(useOverlappedIO)
+{
+	if (m_UseOverlappedIO)
+	{
+		m_Port = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+		if (!m_Port)
+		{
+			LOG(Warning, Resources, "Failed to create IO completion port, falling back to blocking reads");
+			m_UseOverlappedIO = false;
+			return;
+		}
+		m_CompletionThread = std::thread(&AsyncFileReader::CompletionThreadEntryPoint, this);
+	}
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+	if (m_Port)
+	{
+		// Empty completion tells the thread to stop
+		::PostQueuedCompletionStatus(m_Port, 0, 0, nullptr);
+		m_CompletionThread.join();
+		::CloseHandle(m_Port);
+	}
+}
+
+AsyncFileReader::ReadRequest* AsyncFileReader::CreateRequest(void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter)
+{
+	ReadRequest* request = new ReadRequest;
+	request->Reader = this;
+	request->File = INVALID_HANDLE_VALUE;
+	request->OwnsFile = true;
+	request->Offset = 0;
+	request->Destination = reinterpret_cast<uint8_t*>(destination);
+	request->Size = size;
+	request->Success = success;
+	request->Counters[0] = counter;
+	request->Counters[1] = secondCounter;
+	request->Failed = false;
+
+	for (Job::Counter* requestCounter : request->Counters)
+	{
+		if (requestCounter)
+		{
+			m_JobSystem.BeginExternalWork(requestCounter, 1);
+		}
+	}
+	return request;
+}
+
+void AsyncFileReader::Read(const std::filesystem::path& filePath, void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter)
+{
+	ReadRequest* request = CreateRequest(destination, size, success, counter, secondCounter);
+	request->FilePath = filePath;
+
+	if (m_UseOverlappedIO && size > 0)
+	{
+		request->File = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (request->File != INVALID_HANDLE_VALUE && ::CreateIoCompletionPort(request->File, m_Port, 0, 0))
+		{
+			ReadOverlapped(request);
+			return;
+		}
+
+		// Fallback for files which could not go through the port
+		if (request->File != INVALID_HANDLE_VALUE)
+		{
+			::CloseHandle(request->File);
+			request->File = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	Job::JobDecl readJob{ ReadBlockingJob, request };
+	m_JobSystem.RunJobs("Blocking File Read", &readJob, 1, nullptr, Job::ThreadTag::IO);
+}
+
+void AsyncFileReader::Read(void* file, uint64_t offset, void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter)
+{
+	ReadRequest* request = CreateRequest(destination, size, success, counter, secondCounter);
+	request->File = file;
+	request->OwnsFile = false;
+	request->Offset = offset;
+
+	// Files opened by the reader are already on the port when overlapped I/O is used
+	if (m_UseOverlappedIO && size > 0)
+	{
+		ReadOverlapped(request);
+		return;
+	}
+
+	Job::JobDecl readJob{ ReadBlockingJob, request };
+	m_JobSystem.RunJobs("Blocking File Read", &readJob, 1, nullptr, Job::ThreadTag::IO);
+}
+
+void AsyncFileReader::ReadOverlapped(ReadRequest* request)
+{
+	const uint32_t chunkCount = uint32_t((request->Size + sChunkSize - 1) / sChunkSize);
+	request->RemainingChunks = chunkCount;
+	for (uint32_t i = 0; i < chunkCount; ++i)
+	{
+		const uint64_t offset = uint64_t(i) * sChunkSize;
+		const uint64_t fileOffset = request->Offset + offset;
+		ReadChunk* chunk = new ReadChunk;
+		::ZeroMemory(&chunk->Overlapped, sizeof(OVERLAPPED));
+		chunk->Overlapped.Offset = DWORD(fileOffset & 0xFFFFFFFF);
+		chunk->Overlapped.OffsetHigh = DWORD(fileOffset >> 32);
+		chunk->Request = request;
+		chunk->Size = DWORD(eastl::min(sChunkSize, request->Size - offset));
+
+		// Finished reads are queued on the port as well, so every chunk is completed by the completion thread
+		if (!::ReadFile(request->File, request->Destination + offset, chunk->Size, nullptr, &chunk->Overlapped) && ::GetLastError() != ERROR_IO_PENDING)
+		{
+			request->Failed = true;
+			delete chunk;
+			if (request->RemainingChunks.fetch_sub(1) == 1)
+			{
+				Finish(request);
+			}
+		}
+	}
+}
+
+void* AsyncFileReader::OpenFile(const std::filesystem::path& filePath)
+{
+	const DWORD flags = FILE_ATTRIBUTE_NORMAL | (m_UseOverlappedIO ? FILE_FLAG_OVERLAPPED : 0);
+	HANDLE file = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return nullptr;
+	}
+
+	if (m_UseOverlappedIO && !::CreateIoCompletionPort(file, m_Port, 0, 0))
+	{
+		FORMAT_LOG(Warning, Resources, "Failed to add (%s) to the IO completion port.", filePath.c_str());
+		::CloseHandle(file);
+		return nullptr;
+	}
+	return file;
+}
+
+bool AsyncFileReader::ReadBlocking(void* file, uint64_t offset, void* destination, uint64_t size)
+{
+	// Overlapped files need an event to wait on. Its low bit keeps the completion out of the port, where nobody expects it
+	HANDLE event = ::CreateEventW(nullptr, TRUE, FALSE, nullptr);
+	if (!event)
+	{
+		return false;
+	}
+
+	bool succeeded = true;
+	for (uint64_t chunkOffset = 0; chunkOffset < size && succeeded; chunkOffset += sChunkSize)
+	{
+		const uint64_t fileOffset = offset + chunkOffset;
+		const DWORD chunkSize = DWORD(eastl::min(sChunkSize, size - chunkOffset));
+		OVERLAPPED overlapped;
+		::ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+		overlapped.Offset = DWORD(fileOffset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = DWORD(fileOffset >> 32);
+		overlapped.hEvent = HANDLE(ULONG_PTR(event) | 1);
+
+		DWORD readBytes = 0;
+		if (!::ReadFile(file, reinterpret_cast<uint8_t*>(destination) + chunkOffset, chunkSize, nullptr, &overlapped) && ::GetLastError() != ERROR_IO_PENDING)
+		{
+			succeeded = false;
+		}
+		else if (!::GetOverlappedResult(file, &overlapped, &readBytes, TRUE) || readBytes != chunkSize)
+		{
+			succeeded = false;
+		}
+	}
+	::CloseHandle(event);
+	return succeeded;
+}
+
+void AsyncFileReader::ReadBlockingJob(uint32_t, void* data)
+{
+	ReadRequest* request = reinterpret_cast<ReadRequest*>(data);
+	request->Reader->ProcessBlockingRead(request);
+}
+
+void AsyncFileReader::ProcessBlockingRead(ReadRequest* request)
+{
+	OPTICK_EVENT();
+	if (request->OwnsFile)
+	{
+		request->File = ::CreateFileW(request->FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (request->File == INVALID_HANDLE_VALUE)
+		{
+			request->Failed = true;
+			Finish(request);
+			return;
+		}
+	}
+
+	if (!ReadBlocking(request->File, request->Offset, request->Destination, request->Size))
+	{
+		request->Failed = true;
+	}
+	Finish(request);
+}
+
+void AsyncFileReader::Finish(ReadRequest* request)
+{
+	if (request->OwnsFile && request->File != INVALID_HANDLE_VALUE)
+	{
+		::CloseHandle(request->File);
+	}
+
+	if (request->Failed && request->OwnsFile)
+	{
+		FORMAT_LOG(Error, Resources, "Failed to read (%s).", request->FilePath.c_str());
+	}
+	else if (request->Failed)
+	{
+		FORMAT_LOG(Error, Resources, "Failed to read %llu bytes at offset %llu of an open file.", request->Size, request->Offset);
+	}
+	*request->Success = !request->Failed;
+
+	Job::Counter* counters[2] = { request->Counters[0], request->Counters[1] };
+	delete request;
+
+	// The counters could let the owner of the destination go, so nothing of the request is touched after them
+	for (Job::Counter* counter : counters)
+	{
+		if (counter)
+		{
+			m_JobSystem.FinishExternalWork(counter);
+		}
+	}
+}
+
+void AsyncFileReader::CompletionThreadEntryPoint()
+{
+	OPTICK_THREAD("IOCompletionThread");
+	while (true)
+	{
+		DWORD transferredBytes = 0;
+		ULONG_PTR key = 0;
+		OVERLAPPED* overlapped = nullptr;
+		const BOOL result = ::GetQueuedCompletionStatus(m_Port, &transferredBytes, &key, &overlapped, INFINITE);
+		if (!overlapped)
+		{
+			// Either the port is closed or we are asked to stop
+			return;
+		}
+
+		ReadChunk* chunk = reinterpret_cast<ReadChunk*>(overlapped);
+		ReadRequest* request = chunk->Request;
+		if (!result || transferredBytes != chunk->Size)
+		{
+			request->Failed = true;
+		}
+		delete chunk;
+
+		if (request->RemainingChunks.fetch_sub(1) == 1)
+		{
+			Finish(request);
+		}
+	}
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Job/JobSystem.h>
+
+#include <filesystem>
+#include <thread>
+
+namespace Tempest
+{
+// Reads whole files without blocking the job which asked for them. Completions are reported through job counters.
+// Files are read with overlapped I/O in chunks, and a thread of the reader waits on the completion port and finishes
+// the counters when all chunks of a file arrive. If overlapped I/O is disabled or the file cannot be opened for it,
+// the read is a blocking one in a job on the IO thread, so workers are never stalled by the disk.
+// Files which are read many times, like asset packs, can be kept open and read with offsets.
+class AsyncFileReader : Utils::NonCopyable
+{
+public:
+	AsyncFileReader(Job::JobSystem& jobSystem, bool useOverlappedIO);
+	~AsyncFileReader();
+
+	// Reads size bytes from the start of the file in destination, which must be alive until the read is done.
+	// Both counters are decremented when the read finishes, the second one is optional. Success is written before that.
+	// Can be called from any thread
+	void Read(const std::filesystem::path& filePath, void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter = nullptr);
+	// Same as above, for size bytes at the offset of a file opened with OpenFile
+	void Read(void* file, uint64_t offset, void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter = nullptr);
+
+	// Opens a file to be kept open for many reads. The caller closes the handle after all reads from it are done. Null on failure
+	void* OpenFile(const std::filesystem::path& filePath);
+	// Reads on the calling thread, which blocks until the data is there. Works with any file handle
+	bool ReadBlocking(void* file, uint64_t offset, void* destination, uint64_t size);
+private:
+	struct ReadRequest;
+	struct ReadChunk;
+
+	ReadRequest* CreateRequest(void* destination, uint64_t size, bool* success, Job::Counter* counter, Job::Counter* secondCounter);
+	// Issues the chunks of the read, the file must be on the completion port
+	void ReadOverlapped(ReadRequest* request);
+	void ProcessBlockingRead(ReadRequest* request);
+	static void ReadBlockingJob(uint32_t, void* data);
+	void Finish(ReadRequest* request);
+	void CompletionThreadEntryPoint();
+
+	// Reads bigger than this are split, as a single read can be at most 4GB and smaller ones keep the disk queue full
+	static const uint64_t sChunkSize = 4ull * 1024 * 1024;
+
+	Job::JobSystem& m_JobSystem;
+	bool m_UseOverlappedIO;
+	// Completion port
+	void* m_Port = nullptr;
+	std::thread m_CompletionThread;
+};
+}
@@ -0,0 +1,240 @@
+#include <CommonIncludes.h>
+
+#include <Resources/CompressedContainer.h>
+#include <Logging.h>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+namespace Tempest
+{
+static uint64_t GetBlockUncompressedSize(const CompressedContainerHeader& header, uint32_t block)
+{
+	const uint64_t begin = uint64_t(block) * header.BlockSize;
+	return eastl::min(uint64_t(header.BlockSize), header.UncompressedSize - begin);
+}
+
+static uint64_t GetTableSize(uint32_t blockCount)
+{
+	return sizeof(CompressedContainerHeader) + (uint64_t(blockCount) + 1) * sizeof(uint64_t);
+}
+
+const CompressedContainerHeader* CompressedContainer::Validate(const uint8_t* data, size_t size)
+{
+	if (size < sizeof(CompressedContainerHeader))
+	{
+		return nullptr;
+	}
+
+	const CompressedContainerHeader* header = reinterpret_cast<const CompressedContainerHeader*>(data);
+	if (header->Magic != sMagic || header->Version != sVersion || header->Codec >= CompressionCodec::Count || header->BlockSize == 0)
+	{
+		return nullptr;
+	}
+
+	const uint64_t expectedBlocks = (header->UncompressedSize + header->BlockSize - 1) / header->BlockSize;
+	if (header->BlockCount != expectedBlocks || GetTableSize(header->BlockCount) > size)
+	{
+		return nullptr;
+	}
+
+	// Blocks must be in order and inside of the data, so the jobs don't have to check it
+	const uint64_t* offsets = reinterpret_cast<const uint64_t*>(header + 1);
+	if (offsets[0] != GetTableSize(header->BlockCount) || offsets[header->BlockCount] > size)
+	{
+		return nullptr;
+	}
+	for (uint32_t block = 0; block < header->BlockCount; ++block)
+	{
+		if (offsets[block + 1] < offsets[block])
+		{
+			return nullptr;
+		}
+	}
+	return header;
+}
+
+bool CompressedContainer::IsContainer(const uint8_t* data, size_t size)
+{
+	return size >= sizeof(uint32_t) && *reinterpret_cast<const uint32_t*>(data) == sMagic;
+}
+
+uint64_t CompressedContainer::GetUncompressedSize(const uint8_t* data, size_t size)
+{
+	const CompressedContainerHeader* header = Validate(data, size);
+	return header ? header->UncompressedSize : 0;
+}
+
+const char* CompressedContainer::GetCodecName(CompressionCodec codec)
+{
+	switch (codec)
+	{
+	case CompressionCodec::LZ4:
+		return "LZ4";
+	case CompressionCodec::Zstd:
+		return "Zstd";
+	default:
+		return "Unknown";
+	}
+}
+
+void CompressedContainer::CompressBlock(const CompressTask& task, uint32_t block)
+{
+	const uint64_t begin = uint64_t(block) * task.BlockSize;
+	const int sourceSize = int(eastl::min(uint64_t(task.BlockSize), task.SourceSize - begin));
+	const char* source = reinterpret_cast<const char*>(task.Source + begin);
+	eastl::vector<uint8_t>& result = (*task.Blocks)[block];
+
+	size_t compressedSize = 0;
+	if (task.Codec == CompressionCodec::LZ4)
+	{
+		result.resize(LZ4_compressBound(sourceSize));
+		compressedSize = size_t(LZ4_compress_HC(source, reinterpret_cast<char*>(result.data()), sourceSize, int(result.size()), sLZ4Level));
+	}
+	else
+	{
+		result.resize(ZSTD_compressBound(sourceSize));
+		compressedSize = ZSTD_compress(result.data(), result.size(), source, sourceSize, sZstdLevel);
+		if (ZSTD_isError(compressedSize))
+		{
+			compressedSize = 0;
+		}
+	}
+
+	// Equal sizes mean the block is stored as it is, so blocks which are not smaller are copied
+	if (compressedSize == 0 || compressedSize >= size_t(sourceSize))
+	{
+		result.resize(sourceSize);
+		memcpy(result.data(), source, sourceSize);
+		return;
+	}
+	result.resize(compressedSize);
+}
+
+void CompressedContainer::CompressBlockJob(uint32_t block, void* data)
+{
+	OPTICK_EVENT();
+	CompressBlock(*reinterpret_cast<const CompressTask*>(data), block);
+}
+
+eastl::vector<uint8_t> CompressedContainer::Compress(Job::JobSystem& jobSystem, const uint8_t* data, size_t size, CompressionCodec codec, uint32_t blockSize)
+{
+	OPTICK_EVENT();
+	assert(blockSize > 0 && codec < CompressionCodec::Count);
+	const uint32_t blockCount = uint32_t((uint64_t(size) + blockSize - 1) / blockSize);
+
+	eastl::vector<eastl::vector<uint8_t>> blocks;
+	blocks.resize(blockCount);
+	CompressTask task{ data, size, blockSize, codec, &blocks };
+
+	eastl::vector<Job::JobDecl> jobs;
+	jobs.resize(blockCount);
+	for (Job::JobDecl& job : jobs)
+	{
+		job.EntryPoint = CompressBlockJob;
+		job.Data = &task;
+	}
+	if (blockCount > 0)
+	{
+		Job::Counter counter;
+		jobSystem.RunJobs("Compress Blocks", jobs.data(), blockCount, &counter);
+		jobSystem.WaitForCounter(&counter, 0);
+	}
+
+	uint64_t totalSize = GetTableSize(blockCount);
+	for (const eastl::vector<uint8_t>& block : blocks)
+	{
+		totalSize += block.size();
+	}
+
+	eastl::vector<uint8_t> result;
+	result.resize(totalSize);
+	CompressedContainerHeader* header = reinterpret_cast<CompressedContainerHeader*>(result.data());
+	header->Magic = sMagic;
+	header->Version = sVersion;
+	header->Codec = codec;
+	header->UncompressedSize = size;
+	header->BlockSize = blockSize;
+	header->BlockCount = blockCount;
+
+	uint64_t* offsets = reinterpret_cast<uint64_t*>(header + 1);
+	uint64_t offset = GetTableSize(blockCount);
+	for (uint32_t block = 0; block < blockCount; ++block)
+	{
+		offsets[block] = offset;
+		memcpy(result.data() + offset, blocks[block].data(), blocks[block].size());
+		offset += blocks[block].size();
+	}
+	offsets[blockCount] = offset;
+	return result;
+}
+
+bool CompressedContainer::DecompressBlock(const DecompressTask& task, uint32_t block)
+{
+	const uint64_t uncompressedSize = GetBlockUncompressedSize(*task.Header, block);
+	const uint64_t compressedSize = task.Offsets[block + 1] - task.Offsets[block];
+	const uint8_t* source = task.Data + task.Offsets[block];
+	uint8_t* destination = task.Destination + uint64_t(block) * task.Header->BlockSize;
+
+	if (compressedSize == uncompressedSize)
+	{
+		memcpy(destination, source, uncompressedSize);
+		return true;
+	}
+
+	if (task.Header->Codec == CompressionCodec::LZ4)
+	{
+		const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(source), reinterpret_cast<char*>(destination), int(compressedSize), int(uncompressedSize));
+		return result >= 0 && uint64_t(result) == uncompressedSize;
+	}
+
+	const size_t result = ZSTD_decompress(destination, size_t(uncompressedSize), source, size_t(compressedSize));
+	return !ZSTD_isError(result) && result == uncompressedSize;
+}
+
+void CompressedContainer::DecompressBlockJob(uint32_t block, void* data)
+{
+	OPTICK_EVENT();
+	DecompressTask& task = *reinterpret_cast<DecompressTask*>(data);
+	if (!DecompressBlock(task, block))
+	{
+		task.Failed.store(true, std::memory_order_relaxed);
+	}
+}
+
+bool CompressedContainer::Decompress(Job::JobSystem& jobSystem, const uint8_t* data, size_t size, uint8_t* destination, uint64_t destinationSize)
+{
+	OPTICK_EVENT();
+	const CompressedContainerHeader* header = Validate(data, size);
+	if (!header || header->UncompressedSize != destinationSize)
+	{
+		return false;
+	}
+
+	DecompressTask task;
+	task.Data = data;
+	task.Header = header;
+	task.Offsets = reinterpret_cast<const uint64_t*>(header + 1);
+	task.Destination = destination;
+
+	// Not worth going through the job system for a single block
+	if (header->BlockCount <= 1)
+	{
+		return header->BlockCount == 0 || DecompressBlock(task, 0);
+	}
+
+	eastl::vector<Job::JobDecl> jobs;
+	jobs.resize(header->BlockCount);
+	for (Job::JobDecl& job : jobs)
+	{
+		job.EntryPoint = DecompressBlockJob;
+		job.Data = &task;
+	}
+	Job::Counter counter;
+	jobSystem.RunJobs("Decompress Blocks", jobs.data(), header->BlockCount, &counter);
+	jobSystem.WaitForCounter(&counter, 0);
+
+	return !task.Failed.load(std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Job/JobSystem.h>
+
+namespace Tempest
+{
+enum class CompressionCodec : uint16_t
+{
+	// Fast to decompress, for assets which are on the load path
+	LZ4,
+	// Smaller, but slower to decompress
+	Zstd,
+	Count
+};
+
+// Laid out at the start of the file, followed by a table of BlockCount + 1 offsets of the blocks from the start of the file
+// and then by the blocks themselves. The size of a block is the difference of its offset and the next one
+struct CompressedContainerHeader
+{
+	uint32_t Magic;
+	uint16_t Version;
+	CompressionCodec Codec;
+	uint64_t UncompressedSize;
+	// Every block is this big uncompressed, except the last one
+	uint32_t BlockSize;
+	uint32_t BlockCount;
+};
+
+// Container of an asset split in independently compressed blocks, so they can be compressed and decompressed in parallel jobs.
+// Assets are compressed at cook time, so the codecs are used at their slower levels which give better ratios without
+// making the decompression any slower. Blocks which don't get smaller are stored as they are and just copied.
+// Every block is decompressed straight in its place in the destination, so there are no intermediate copies.
+class TEMPEST_API CompressedContainer
+{
+public:
+	static const uint32_t sMagic = 0x504D4354; // TCMP
+	static const uint16_t sVersion = 1;
+	static const uint32_t sDefaultBlockSize = 256 * 1024;
+
+	static bool IsContainer(const uint8_t* data, size_t size);
+	// Zero if the data is not a valid container
+	static uint64_t GetUncompressedSize(const uint8_t* data, size_t size);
+
+	// Compresses every block in a job of its own. Must be called from a job
+	static eastl::vector<uint8_t> Compress(Job::JobSystem& jobSystem, const uint8_t* data, size_t size, CompressionCodec codec, uint32_t blockSize = sDefaultBlockSize);
+	// Decompresses the blocks in parallel jobs in the destination, which must be GetUncompressedSize big. Must be called from a job
+	static bool Decompress(Job::JobSystem& jobSystem, const uint8_t* data, size_t size, uint8_t* destination, uint64_t destinationSize);
+
+	static const char* GetCodecName(CompressionCodec codec);
+private:
+	friend struct CompressedContainerBenchmark;
+
+	struct CompressTask
+	{
+		const uint8_t* Source;
+		uint64_t SourceSize;
+		uint32_t BlockSize;
+		CompressionCodec Codec;
+		eastl::vector<eastl::vector<uint8_t>>* Blocks;
+	};
+
+	struct DecompressTask
+	{
+		const uint8_t* Data;
+		const CompressedContainerHeader* Header;
+		const uint64_t* Offsets;
+		uint8_t* Destination;
+		std::atomic<bool> Failed = false;
+	};
+
+	// Returns the header if the data is a valid container, null otherwise
+	static const CompressedContainerHeader* Validate(const uint8_t* data, size_t size);
+
+	static void CompressBlock(const CompressTask& task, uint32_t block);
+	static void CompressBlockJob(uint32_t block, void* data);
+	static bool DecompressBlock(const DecompressTask& task, uint32_t block);
+	static void DecompressBlockJob(uint32_t block, void* data);
+
+	// Cook time levels, the ratio is what matters there
+	static const int sLZ4Level = 9;
+	static const int sZstdLevel = 15;
+};
+}
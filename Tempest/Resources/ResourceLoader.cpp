@@ -2,45 +2,505 @@
 
 #include <Resources/ResourceLoader.h>
 #include <Logging.h>
-#include <fstream>
+#include <chrono>
+
+#include <DataDefinitions/Level_generated.h>
+#include <DataDefinitions/Sector_generated.h>
+#include <DataDefinitions/GeometryDatabase_generated.h>
+#include <DataDefinitions/TextureDatabase_generated.h>
+#include <DataDefinitions/AudioDatabase_generated.h>
+#include <DataDefinitions/ShaderLibrary_generated.h>
+
+#include <Windows.h>
+#include <Psapi.h>
 
 namespace Tempest
 {
-ResourceLoader::ResourceLoader(const char* dataFolder)
+static const char* sAssetTypeNames[] = {
+	"Level",
+	"Geometry database",
+	"Texture database",
+	"Audio database",
+	"Shader library",
+	"Level sector",
+	"Other",
+};
+static_assert(sizeof(sAssetTypeNames) / sizeof(sAssetTypeNames[0]) == size_t(AssetType::Count));
+
+ResourceLoader::ResourceLoader(const char* dataFolder, bool useMemoryMapping, Job::JobSystem& jobSystem, bool useOverlappedIO, bool useAssetPack, uint64_t memoryBudget)
 	: m_DataFolder(dataFolder)
+	, m_UseMemoryMapping(useMemoryMapping)
+	, m_JobSystem(jobSystem)
+	, m_MemoryBudget(memoryBudget)
+	, m_Reader(jobSystem, useOverlappedIO)
 {
+	m_Statistics.MemoryBudget = memoryBudget;
+
 	if (!std::filesystem::is_directory(m_DataFolder)) {
 		FORMAT_LOG(Fatal, Resources, "Given asset folder (%s) is not a directory! Aborting.", m_DataFolder.c_str());
 		std::exit(1);
 	}
-	// TODO: Go through the directory and index the files
+
+	const std::filesystem::path packPath = m_DataFolder / AssetPack::sFileName;
+	if (useAssetPack && std::filesystem::is_regular_file(packPath)) {
+		if (m_Pack.Open(packPath, m_UseMemoryMapping, m_Reader)) {
+			FORMAT_LOG(Info, Resources, "Opened asset pack (%s) with %u assets.", packPath.c_str(), m_Pack.GetAssetCount());
+		} else {
+			FORMAT_LOG(Warning, Resources, "Failed to open asset pack (%s), loading loose files.", packPath.c_str());
+		}
+	}
 }
 
-ResourceLoader::AssetMap::iterator ResourceLoader::EnsureResourceIsLoaded(const char* fileName)
+ResourceLoader::~ResourceLoader()
+{
+	uint32_t referencedAssets = 0;
+	for (AssetShard& shard : m_Shards)
+	{
+		for (auto& asset : shard.Assets)
+		{
+			++referencedAssets;
+			FreeAsset(*asset.second);
+		}
+	}
+	if (referencedAssets > 0) {
+		FORMAT_LOG(Warning, Resources, "%u assets are still referenced when the resource loader is destroyed.", referencedAssets);
+	}
+}
+
+AssetType ResourceLoader::GetAssetType(const std::filesystem::path& filePath)
+{
+	const std::pair<const char*, AssetType> extensions[] = {
+		{ Definition::LevelExtension(), AssetType::Level },
+		{ Definition::GeometryDatabaseExtension(), AssetType::GeometryDatabase },
+		{ Definition::TextureDatabaseExtension(), AssetType::TextureDatabase },
+		{ Definition::AudioDatabaseExtension(), AssetType::AudioDatabase },
+		{ Definition::ShaderLibraryExtension(), AssetType::ShaderLibrary },
+		{ Definition::SectorExtension(), AssetType::Sector },
+	};
+
+	// Extensions of the definitions don't have the dot
+	const std::string extension = filePath.extension().string();
+	for (const auto& type : extensions)
+	{
+		if (extension.size() > 1 && strcmp(extension.c_str() + 1, type.first) == 0) {
+			return type.second;
+		}
+	}
+	return AssetType::Other;
+}
+
+void ResourceLoader::AddReference(LoadedAsset* asset)
+{
+	std::lock_guard<std::mutex> lock(m_Shards[asset->Shard].Mutex);
+	++asset->References;
+}
+
+void ResourceLoader::ReleaseReference(LoadedAsset* asset)
+{
+	AssetShard& shard = m_Shards[asset->Shard];
+	eastl::unique_ptr<LoadedAsset> released;
+	{
+		// References are only added under this lock, so no one can find the asset after it is removed here
+		std::lock_guard<std::mutex> lock(shard.Mutex);
+		if (--asset->References > 0) {
+			return;
+		}
+		auto findItr = shard.Assets.find(asset->FilePath);
+		assert(findItr != shard.Assets.end() && findItr->second.get() == asset);
+		released = eastl::move(findItr->second);
+		shard.Assets.erase(findItr);
+	}
+	FreeAsset(*released);
+}
+
+bool ResourceLoader::ReserveMemory(const LoadedAsset& asset, uint64_t bytes)
+{
+	uint64_t residentBytes = 0;
+	uint64_t reservedBytes = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+		// Loads in flight count too, so many of them starting together cannot go past the budget
+		if (m_MemoryBudget == 0 || m_Statistics.ResidentBytes + m_Statistics.ReservedBytes + bytes <= m_MemoryBudget) {
+			m_Statistics.ReservedBytes += bytes;
+			return true;
+		}
+		++m_Statistics.RejectedLoads;
+		residentBytes = m_Statistics.ResidentBytes;
+		reservedBytes = m_Statistics.ReservedBytes;
+	}
+
+	FORMAT_LOG(Error, Resources, "Asset (%s) needing %.2f MB to load does not fit in the budget, %.2f MB are resident and %.2f MB reserved of %.2f MB.",
+		asset.FilePath.c_str(),
+		float(bytes) / (1024.0f * 1024.0f),
+		float(residentBytes) / (1024.0f * 1024.0f),
+		float(reservedBytes) / (1024.0f * 1024.0f),
+		float(m_MemoryBudget) / (1024.0f * 1024.0f));
+	return false;
+}
+
+void ResourceLoader::MakeResident(const LoadedAsset& asset, uint64_t reservedBytes)
+{
+	assert(asset.Size <= reservedBytes);
+	std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+	m_Statistics.ReservedBytes -= reservedBytes;
+	AssetTypeUsage& usage = m_Statistics.Usage[size_t(asset.Type)];
+	++usage.ResidentAssets;
+	usage.ResidentBytes += asset.Size;
+	usage.PeakResidentBytes = eastl::max(usage.PeakResidentBytes, usage.ResidentBytes);
+	m_Statistics.ResidentBytes += asset.Size;
+}
+
+void ResourceLoader::ReleaseReservation(uint64_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+	m_Statistics.ReservedBytes -= bytes;
+}
+
+void ResourceLoader::FreeAsset(LoadedAsset& asset)
+{
+	if (asset.State.load(std::memory_order_acquire) == AssetState::Loaded) {
+		std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+		AssetTypeUsage& usage = m_Statistics.Usage[size_t(asset.Type)];
+		--usage.ResidentAssets;
+		usage.ResidentBytes -= asset.Size;
+		++usage.ReleasedAssets;
+		usage.ReleasedBytes += asset.Size;
+		m_Statistics.ResidentBytes -= asset.Size;
+	}
+
+	// Owned storage goes away with the asset. Data in the mapping of the pack stays mapped until the end, but its pages
+	// are not written, so the system can just drop them from the working set
+	if (asset.IsMapped) {
+		::UnmapViewOfFile(asset.Data);
+		asset.IsMapped = false;
+	}
+	asset.Data = nullptr;
+	asset.Size = 0;
+	asset.Storage.set_capacity(0);
+}
+
+AssetReference ResourceLoader::EnsureResourceIsLoaded(const char* fileName)
 {
 	std::filesystem::path filePath = m_DataFolder / fileName;
+	const uint32_t shardIndex = uint32_t(filesystem_path_hash()(filePath) % sShardCount);
+	AssetShard& shard = m_Shards[shardIndex];
 
-	AssetMap::iterator findItr = m_LoadedAssets.find(filePath);
-	// We have the file already loaded
-	if (findItr != m_LoadedAssets.end()) {
-		return findItr;
+	LoadedAsset* asset = nullptr;
+	bool isLoadingHere = false;
+	{
+		std::lock_guard<std::mutex> lock(shard.Mutex);
+		auto findItr = shard.Assets.find(filePath);
+		if (findItr != shard.Assets.end()) {
+			asset = findItr->second.get();
+		} else {
+			// Everyone finding the asset from now on waits for this job to load it
+			asset = new LoadedAsset;
+			asset->Shard = shardIndex;
+			asset->Type = GetAssetType(filePath);
+			asset->FilePath = filePath;
+			m_JobSystem.BeginExternalWork(&asset->LoadCounter, 1);
+			shard.Assets.emplace(filePath, eastl::unique_ptr<LoadedAsset>(asset));
+			isLoadingHere = true;
+		}
+		// Taken before waiting, so the asset is not released while it is loading
+		++asset->References;
 	}
+	AssetReference reference(this, asset);
+
+	if (!isLoadingHere) {
+		if (asset->State.load(std::memory_order_acquire) == AssetState::Loading) {
+			{
+				std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+				++m_Statistics.DeduplicatedRequests;
+			}
+			m_JobSystem.WaitForCounter(&asset->LoadCounter, 0);
+		}
+		return asset->State.load(std::memory_order_acquire) == AssetState::Loaded ? eastl::move(reference) : AssetReference();
+	}
+
+	const bool loaded = LoadAsset(fileName, filePath, *asset);
+	asset->State.store(loaded ? AssetState::Loaded : AssetState::Failed, std::memory_order_release);
+	// The state is final before anyone waiting is woken up
+	m_JobSystem.FinishExternalWork(&asset->LoadCounter);
+	// Failed assets are removed with their last reference, so they are tried again on the next request
+	return loaded ? eastl::move(reference) : AssetReference();
+}
 
-	if (!std::filesystem::is_regular_file(filePath)) {
+bool ResourceLoader::LoadAsset(const char* fileName, const std::filesystem::path& filePath, LoadedAsset& asset)
+{
+	// Packed assets don't need the file system at all
+	const AssetPackEntry* packEntry = m_Pack.Find(fileName);
+	if (!packEntry && !std::filesystem::is_regular_file(filePath)) {
 		FORMAT_LOG(Error, Resources, "Given filepath (%s) is not a file.", filePath.c_str());
-		return m_LoadedAssets.end(); // invalid end iterator
+		return false;
+	}
+
+	OPTICK_EVENT();
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	// The data on disk and the decompressed one are both alive while decompressing, so that is the peak of the load.
+	// It is checked against the budget before anything is mapped or allocated
+	const uint64_t fileSize = packEntry ? packEntry->Size : std::filesystem::file_size(filePath);
+	const uint64_t reservedBytes = fileSize + ReadUncompressedSize(filePath, packEntry, fileSize);
+	if (!ReserveMemory(asset, reservedBytes)) {
+		return false;
+	}
+
+	bool loaded = false;
+	if (packEntry) {
+		loaded = LoadPackedAsset(*packEntry, filePath, asset);
+	} else {
+		// Empty files cannot be mapped
+		loaded = (m_UseMemoryMapping && MapFile(filePath, asset)) || ReadFile(filePath, nullptr, asset);
+	}
+	if (!loaded) {
+		ReleaseReservation(reservedBytes);
+		FORMAT_LOG(Error, Resources, "Failed to load (%s).", filePath.c_str());
+		return false;
 	}
 
-	uint64_t size = std::filesystem::file_size(filePath);
+	{
+		std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+		++m_Statistics.LoadedAssets;
+		m_Statistics.PackedAssets += packEntry ? 1 : 0;
+		(asset.IsMapped || (packEntry && m_Pack.IsMapped()) ? m_Statistics.MappedBytes : m_Statistics.ReadBytes) += asset.Size;
+	}
 
-	std::ifstream stream(filePath, std::ios::binary);
-	assert(stream.good());
+	if (!DecompressIfNeeded(filePath, asset)) {
+		ReleaseReservation(reservedBytes);
+		return false;
+	}
+	// Only if the file was changed between reading its header and loading it
+	if (asset.Size > reservedBytes) {
+		ReleaseReservation(reservedBytes);
+		FORMAT_LOG(Error, Resources, "Asset (%s) got bigger than its reservation while loading.", filePath.c_str());
+		return false;
+	}
+	MakeResident(asset, reservedBytes);
 
-	eastl::vector<uint8_t> data(size);
-	stream.read((char*)data.data(), size);
+	const float loadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+	m_Statistics.LoadMilliseconds += loadMilliseconds;
+	return true;
+}
 
-	auto[it, didInsert] = m_LoadedAssets.emplace(filePath, std::move(data));
-	assert(didInsert);
-	return it;
+uint64_t ResourceLoader::ReadUncompressedSize(const std::filesystem::path& filePath, const AssetPackEntry* packEntry, uint64_t fileSize)
+{
+	if (fileSize < sizeof(CompressedContainerHeader)) {
+		return 0;
+	}
+
+	CompressedContainerHeader header;
+	if (packEntry && m_Pack.IsMapped()) {
+		memcpy(&header, m_Pack.GetMappedData(*packEntry), sizeof(header));
+	} else {
+		// A small asynchronous read, so the worker is free while it is in flight
+		Job::Counter readCounter;
+		bool succeeded = false;
+		if (packEntry) {
+			m_Reader.Read(m_Pack.GetFile(), packEntry->Offset, &header, sizeof(header), &succeeded, &readCounter);
+		} else {
+			m_Reader.Read(filePath, &header, sizeof(header), &succeeded, &readCounter);
+		}
+		m_JobSystem.WaitForCounter(&readCounter, 0);
+		if (!succeeded) {
+			return 0;
+		}
+	}
+	return CompressedContainer::IsContainer(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) ? header.UncompressedSize : 0;
+}
+
+void ResourceLoader::LoadRequestedJob(uint32_t index, void* data)
+{
+	RequestBatch* batch = reinterpret_cast<RequestBatch*>(data);
+	batch->References[index] = batch->Loader->EnsureResourceIsLoaded(batch->FileNames[index].c_str());
+	if (batch->RemainingJobs.fetch_sub(1) == 1) {
+		delete batch;
+	}
+}
+
+void ResourceLoader::RequestResources(const char* const* fileNames, uint32_t count, AssetReference* references, Job::Counter* counter)
+{
+	OPTICK_EVENT();
+	assert(references || count == 0);
+	// Names are copied, so the caller does not have to keep them alive
+	RequestBatch* batch = new RequestBatch;
+	batch->Loader = this;
+	batch->FileNames.reserve(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		batch->FileNames.push_back(fileNames[i]);
+	}
+	batch->References = references;
+	batch->RemainingJobs = count;
+
+	eastl::vector<Job::JobDecl> jobs;
+	jobs.resize(count);
+	for (Job::JobDecl& job : jobs)
+	{
+		job.EntryPoint = LoadRequestedJob;
+		job.Data = batch;
+	}
+	if (count == 0) {
+		delete batch;
+	}
+	m_JobSystem.RunJobs("Load Asset", jobs.data(), count, counter);
+}
+
+bool ResourceLoader::MapFile(const std::filesystem::path& filePath, LoadedAsset& asset)
+{
+	HANDLE file = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		::CloseHandle(file);
+		return false;
+	}
+
+	// The view keeps the mapping and the file alive, so the handles are not needed after it is created
+	HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	::CloseHandle(file);
+	if (!mapping) {
+		return false;
+	}
+
+	void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	::CloseHandle(mapping);
+	if (!view) {
+		return false;
+	}
+
+	asset.Data = reinterpret_cast<const uint8_t*>(view);
+	asset.Size = size_t(fileSize.QuadPart);
+	asset.IsMapped = true;
+
+	// Start reading the whole file in the background, instead of faulting it in page by page when it is consumed
+	WIN32_MEMORY_RANGE_ENTRY range{ view, asset.Size };
+	if (!::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0)) {
+		FORMAT_LOG(Warning, Resources, "Prefetch of (%s) failed.", filePath.c_str());
+	}
+	return true;
+}
+
+bool ResourceLoader::ReadFile(const std::filesystem::path& filePath, const AssetPackEntry* packEntry, LoadedAsset& asset)
+{
+	const uint64_t size = packEntry ? packEntry->Size : std::filesystem::file_size(filePath);
+	asset.Storage.resize(size);
+
+	// Only this job waits for the read, so the counter can be on its stack
+	Job::Counter readCounter;
+	bool succeeded = false;
+	if (packEntry) {
+		m_Reader.Read(m_Pack.GetFile(), packEntry->Offset, asset.Storage.data(), size, &succeeded, &readCounter);
+	} else {
+		m_Reader.Read(filePath, asset.Storage.data(), size, &succeeded, &readCounter);
+	}
+	m_JobSystem.WaitForCounter(&readCounter, 0);
+	if (!succeeded) {
+		return false;
+	}
+
+	asset.Data = asset.Storage.data();
+	asset.Size = asset.Storage.size();
+	asset.IsMapped = false;
+	return true;
+}
+
+bool ResourceLoader::LoadPackedAsset(const AssetPackEntry& entry, const std::filesystem::path& filePath, LoadedAsset& asset)
+{
+	if (!m_Pack.IsMapped()) {
+		return ReadFile(filePath, &entry, asset);
+	}
+
+	// The data stays in the mapping of the pack, which is released with it
+	asset.Data = m_Pack.GetMappedData(entry);
+	asset.Size = size_t(entry.Size);
+	asset.IsMapped = false;
+
+	WIN32_MEMORY_RANGE_ENTRY range{ const_cast<uint8_t*>(asset.Data), asset.Size };
+	::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+	return true;
+}
+
+bool ResourceLoader::DecompressIfNeeded(const std::filesystem::path& filePath, LoadedAsset& asset)
+{
+	if (!CompressedContainer::IsContainer(asset.Data, asset.Size)) {
+		return true;
+	}
+
+	OPTICK_EVENT();
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	eastl::vector<uint8_t> storage;
+	storage.resize(CompressedContainer::GetUncompressedSize(asset.Data, asset.Size));
+	const bool decompressed = !storage.empty() && CompressedContainer::Decompress(m_JobSystem, asset.Data, asset.Size, storage.data(), storage.size());
+
+	// Compressed data is not needed anymore
+	if (asset.IsMapped) {
+		::UnmapViewOfFile(asset.Data);
+	}
+	asset.Storage = eastl::move(storage);
+	asset.Data = asset.Storage.data();
+	asset.Size = asset.Storage.size();
+	asset.IsMapped = false;
+
+	if (!decompressed) {
+		FORMAT_LOG(Error, Resources, "Failed to decompress (%s).", filePath.c_str());
+		return false;
+	}
+
+	const float decompressMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+	++m_Statistics.DecompressedAssets;
+	m_Statistics.DecompressedBytes += asset.Size;
+	m_Statistics.DecompressMilliseconds += decompressMilliseconds;
+	return true;
+}
+
+void ResourceLoader::LogStatistics(const char* reason) const
+{
+	PROCESS_MEMORY_COUNTERS_EX memory;
+	::ZeroMemory(&memory, sizeof(memory));
+	::GetProcessMemoryInfo(::GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&memory), sizeof(memory));
+
+	const ResourceLoaderStatistics statistics = GetStatistics();
+	FORMAT_LOG(Info, Resources, "%s: %u assets loaded (%u packed, %u deduplicated requests) in %.2f ms (%s), %.2f MB mapped, %.2f MB read, %u decompressed to %.2f MB in %.2f ms. Working set %.2f MB, private %.2f MB",
+		reason,
+		statistics.LoadedAssets,
+		statistics.PackedAssets,
+		statistics.DeduplicatedRequests,
+		statistics.LoadMilliseconds,
+		m_UseMemoryMapping ? "memory mapped" : "read",
+		float(statistics.MappedBytes) / (1024.0f * 1024.0f),
+		float(statistics.ReadBytes) / (1024.0f * 1024.0f),
+		statistics.DecompressedAssets,
+		float(statistics.DecompressedBytes) / (1024.0f * 1024.0f),
+		statistics.DecompressMilliseconds,
+		float(memory.WorkingSetSize) / (1024.0f * 1024.0f),
+		float(memory.PrivateUsage) / (1024.0f * 1024.0f));
+
+	FORMAT_LOG(Info, Resources, "%s: %.2f MB resident and %.2f MB reserved of %.2f MB budget, %u loads rejected",
+		reason,
+		float(statistics.ResidentBytes) / (1024.0f * 1024.0f),
+		float(statistics.ReservedBytes) / (1024.0f * 1024.0f),
+		float(statistics.MemoryBudget) / (1024.0f * 1024.0f),
+		statistics.RejectedLoads);
+	for (size_t type = 0; type < size_t(AssetType::Count); ++type)
+	{
+		const AssetTypeUsage& usage = statistics.Usage[type];
+		if (usage.PeakResidentBytes == 0) {
+			continue;
+		}
+		FORMAT_LOG(Info, Resources, "    %s: %u resident with %.2f MB (peak %.2f MB), %u released with %.2f MB",
+			sAssetTypeNames[type],
+			usage.ResidentAssets,
+			float(usage.ResidentBytes) / (1024.0f * 1024.0f),
+			float(usage.PeakResidentBytes) / (1024.0f * 1024.0f),
+			usage.ReleasedAssets,
+			float(usage.ReleasedBytes) / (1024.0f * 1024.0f));
+	}
 }
 }
\ No newline at end of file
@@ -2,40 +2,328 @@
 
 #include <EASTL/hash_map.h>
 #include <filesystem>
+#include <atomic>
+#include <mutex>
 
 #include <flatbuffers/flatbuffers.h>
 
+#include <Resources/AsyncFileReader.h>
+#include <Resources/AssetPack.h>
+#include <Resources/CompressedContainer.h>
+
 namespace Tempest
 {
-class ResourceLoader
+class AssetReference;
+template<typename ResourceType>
+class AssetHandle;
+
+// Found from the extension of the file
+enum class AssetType : uint8_t
+{
+	Level,
+	GeometryDatabase,
+	TextureDatabase,
+	AudioDatabase,
+	ShaderLibrary,
+	Sector,
+	Other,
+	Count
+};
+
+struct AssetTypeUsage
+{
+	uint32_t ResidentAssets = 0;
+	uint64_t ResidentBytes = 0;
+	uint64_t PeakResidentBytes = 0;
+	uint32_t ReleasedAssets = 0;
+	uint64_t ReleasedBytes = 0;
+};
+
+struct ResourceLoaderStatistics
+{
+	uint32_t LoadedAssets = 0;
+	// Assets found in the asset pack, the rest are loose files
+	uint32_t PackedAssets = 0;
+	// Requests for assets which were already being loaded by another job, they waited for that load instead of loading again
+	uint32_t DeduplicatedRequests = 0;
+	// Bytes consumed straight from file mappings
+	uint64_t MappedBytes = 0;
+	// Bytes copied in memory owned by the loader
+	uint64_t ReadBytes = 0;
+	// Assets which were in compressed containers, their size on disk is in the mapped or read bytes
+	uint32_t DecompressedAssets = 0;
+	uint64_t DecompressedBytes = 0;
+	float DecompressMilliseconds = 0.0f;
+	float LoadMilliseconds = 0.0f;
+	// Size of the assets which are referenced right now, after decompression
+	uint64_t ResidentBytes = 0;
+	// Held by the loads in flight, for both the data on disk and the decompressed one
+	uint64_t ReservedBytes = 0;
+	// Zero if there is no budget
+	uint64_t MemoryBudget = 0;
+	// Loads which failed because the asset didn't fit in the budget
+	uint32_t RejectedLoads = 0;
+	eastl::array<AssetTypeUsage, size_t(AssetType::Count)> Usage;
+};
+
+// Loads the assets in the data folder and keeps them while they are referenced.
+// Assets are flatbuffers, which are used in place. By default the files are memory mapped read only and the flatbuffer
+// roots point straight in the mapping, so nothing is copied and the pages are shared with the file cache.
+// The whole view is prefetched, as most assets are consumed from start to end right after loading.
+// The old path reading every file in a vector is kept for comparison. Reads are asynchronous, so the job waiting for one
+// does not block its worker, and files can be requested ahead of time to have the reads of many of them in flight together.
+// Assets cooked in compressed containers are decompressed in parallel jobs in memory owned by the loader, right after they are
+// mapped or read. The compressed data is released after that, so only the flatbuffers are kept.
+// If the data folder has an asset pack, assets are looked up in its table of contents first and loaded from its single
+// mapping or file handle. Loose files are still loaded for assets which are not in the pack, like the shader library.
+// Any number of jobs can load at the same time. Assets are in a table split in shards, each with a lock which is held only
+// to find or add an asset, never while loading it. The first job asking for an asset loads it, everyone else asking while
+// it is loading waits on the counter of that load, so every asset is loaded once.
+// Every load returns a reference to the asset. The asset is released when its last reference is released, so assets whose
+// data is copied somewhere else, like the geometry uploaded to the GPU, can be dropped right after that. Assets which are
+// released and requested again are loaded again. Resident memory is tracked per type of asset and if there is a budget,
+// loads which don't fit in it fail instead of growing past it. The peak memory of a load, the size on disk and the
+// decompressed size from the header of the container, is reserved before anything is allocated for it. The reservation is
+// turned in the resident size of the asset when the load succeeds and given back when it fails.
+class ResourceLoader : Utils::NonCopyable
 {
 struct filesystem_path_hash
 {
 	size_t operator()(const std::filesystem::path& p) const { return std::filesystem::hash_value(p); }
 };
-using AssetMap = eastl::hash_map<std::filesystem::path, eastl::vector<uint8_t>, filesystem_path_hash>;
+
+enum class AssetState : uint8_t
+{
+	Loading,
+	Loaded,
+	Failed,
+};
+
+struct LoadedAsset
+{
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+	// Empty for mapped assets, whose data is the view of the file
+	eastl::vector<uint8_t> Storage;
+	bool IsMapped = false;
+	// Data is written only by the loading job, and read only after the state is not loading anymore
+	std::atomic<AssetState> State = AssetState::Loading;
+	// Reached when the load is done, either way
+	Job::Counter LoadCounter;
+	// Guarded by the lock of the shard. The loading job and everyone waiting for it hold a reference too
+	uint32_t References = 0;
+	uint32_t Shard = 0;
+	AssetType Type = AssetType::Other;
+	std::filesystem::path FilePath;
+};
+// Assets are never moved, so the other jobs can keep pointers to them while the table grows
+using AssetMap = eastl::hash_map<std::filesystem::path, eastl::unique_ptr<LoadedAsset>, filesystem_path_hash>;
+
+struct AssetShard
+{
+	std::mutex Mutex;
+	AssetMap Assets;
+};
+
+// Assets asked for together with RequestResources, deleted by the last job loading them
+struct RequestBatch
+{
+	ResourceLoader* Loader;
+	eastl::vector<eastl::string> FileNames;
+	AssetReference* References;
+	std::atomic<uint32_t> RemainingJobs;
+};
 
 public:
-	ResourceLoader(const char* dataFolder);
+	// Budget of the resident memory of the assets in bytes, zero for no budget
+	ResourceLoader(const char* dataFolder, bool useMemoryMapping, Job::JobSystem& jobSystem, bool useOverlappedIO, bool useAssetPack, uint64_t memoryBudget);
+	~ResourceLoader();
 
+	// Empty handle if the asset failed to load
 	template<typename ResourceType>
-	const ResourceType* LoadResource(const char* fileName)
+	AssetHandle<ResourceType> LoadResource(const char* fileName);
+
+	// Blocks the calling job until the asset is loaded, but not the thread, as reads are asynchronous. Empty if it failed to load.
+	// Can be called from many jobs at the same time, only one of them loads the asset. Can be called only from a job
+	AssetReference EnsureResourceIsLoaded(const char* fileName);
+
+	// Starts loading the files in jobs without blocking. Every reference is filled when its file is loaded and keeps it alive until
+	// it is released, so the references must live until the counter is reached. The counter must not be used for anything else
+	// until then. Can be called from anywhere
+	void RequestResources(const char* const* fileNames, uint32_t count, AssetReference* references, Job::Counter* counter);
+
+	// Logs what was loaded so far together with the memory of the process
+	void LogStatistics(const char* reason) const;
+
+	ResourceLoaderStatistics GetStatistics() const
 	{
-		AssetMap::iterator it = EnsureResourceIsLoaded(fileName);
-		if (it == m_LoadedAssets.end()) {
-			return nullptr;
+		std::lock_guard<std::mutex> lock(m_StatisticsMutex);
+		return m_Statistics;
+	}
+private:
+	friend class AssetReference;
+
+	static const uint32_t sShardCount = 16;
+
+	static AssetType GetAssetType(const std::filesystem::path& filePath);
+	void AddReference(LoadedAsset* asset);
+	// Removes the asset from the table and frees it when this was the last reference
+	void ReleaseReference(LoadedAsset* asset);
+	// Holds the bytes for a load which is about to start, false if they don't fit in the budget
+	bool ReserveMemory(const LoadedAsset& asset, uint64_t bytes);
+	// Turns the reservation in the resident size of the loaded asset, the rest is given back
+	void MakeResident(const LoadedAsset& asset, uint64_t reservedBytes);
+	void ReleaseReservation(uint64_t bytes);
+	// Gives back the memory of the asset, it must not be in the table anymore
+	void FreeAsset(LoadedAsset& asset);
+
+	// Loads the asset in the record owned by the calling job and makes it resident
+	bool LoadAsset(const char* fileName, const std::filesystem::path& filePath, LoadedAsset& asset);
+	// Reads just the header of a compressed container, zero if the file is not one
+	uint64_t ReadUncompressedSize(const std::filesystem::path& filePath, const AssetPackEntry* packEntry, uint64_t fileSize);
+	bool MapFile(const std::filesystem::path& filePath, LoadedAsset& asset);
+	// Reads through the asynchronous reader and waits for it, from the pack if the entry is given
+	bool ReadFile(const std::filesystem::path& filePath, const AssetPackEntry* packEntry, LoadedAsset& asset);
+	bool LoadPackedAsset(const AssetPackEntry& entry, const std::filesystem::path& filePath, LoadedAsset& asset);
+	// Replaces the data of the asset with the decompressed one if it is a compressed container
+	bool DecompressIfNeeded(const std::filesystem::path& filePath, LoadedAsset& asset);
+	static void LoadRequestedJob(uint32_t index, void* data);
+
+	std::filesystem::path m_DataFolder;
+	bool m_UseMemoryMapping;
+	Job::JobSystem& m_JobSystem;
+	uint64_t m_MemoryBudget;
+	eastl::array<AssetShard, sShardCount> m_Shards;
+	// Declared before the reader, so its file is closed after the reader stops
+	AssetPack m_Pack;
+	AsyncFileReader m_Reader;
+
+	mutable std::mutex m_StatisticsMutex;
+	ResourceLoaderStatistics m_Statistics;
+};
+
+// Keeps a loaded asset alive, the asset is released with its last reference. Can be copied and released from any thread
+class AssetReference
+{
+public:
+	AssetReference() = default;
+	AssetReference(const AssetReference& other)
+		: m_Loader(other.m_Loader)
+		, m_Asset(other.m_Asset)
+	{
+		if (m_Asset) {
+			m_Loader->AddReference(m_Asset);
 		}
-		const ResourceType* resource = flatbuffers::GetRoot<ResourceType>(it->second.data());
-#ifdef _DEBUG
-		flatbuffers::Verifier verifier(it->second.data(), it->second.size());
-		assert(resource->Verify(verifier));
-#endif
-		return resource;
+	}
+	AssetReference(AssetReference&& other)
+		: m_Loader(other.m_Loader)
+		, m_Asset(other.m_Asset)
+	{
+		other.m_Loader = nullptr;
+		other.m_Asset = nullptr;
+	}
+	AssetReference& operator=(const AssetReference& other)
+	{
+		if (this != &other) {
+			AssetReference copy(other);
+			*this = eastl::move(copy);
+		}
+		return *this;
+	}
+	AssetReference& operator=(AssetReference&& other)
+	{
+		if (this != &other) {
+			Release();
+			eastl::swap(m_Loader, other.m_Loader);
+			eastl::swap(m_Asset, other.m_Asset);
+		}
+		return *this;
+	}
+	~AssetReference()
+	{
+		Release();
 	}
 
-	AssetMap::iterator EnsureResourceIsLoaded(const char* fileName);
+	void Release()
+	{
+		if (m_Asset) {
+			m_Loader->ReleaseReference(m_Asset);
+			m_Loader = nullptr;
+			m_Asset = nullptr;
+		}
+	}
+
+	bool IsValid() const
+	{
+		return m_Asset != nullptr;
+	}
+	const uint8_t* GetData() const
+	{
+		return m_Asset->Data;
+	}
+	size_t GetSize() const
+	{
+		return m_Asset->Size;
+	}
 private:
-	std::filesystem::path m_DataFolder;
-	AssetMap m_LoadedAssets;
+	friend class ResourceLoader;
+	// Takes over a reference which is already added
+	AssetReference(ResourceLoader* loader, ResourceLoader::LoadedAsset* asset)
+		: m_Loader(loader)
+		, m_Asset(asset)
+	{}
+
+	ResourceLoader* m_Loader = nullptr;
+	ResourceLoader::LoadedAsset* m_Asset = nullptr;
 };
+
+// Reference to a loaded flatbuffer together with its root
+template<typename ResourceType>
+class AssetHandle
+{
+public:
+	AssetHandle() = default;
+	AssetHandle(AssetReference&& reference, const ResourceType* resource)
+		: m_Reference(eastl::move(reference))
+		, m_Resource(resource)
+	{}
+
+	// The resource and everything pointing inside of it is not valid after this
+	void Release()
+	{
+		m_Reference.Release();
+		m_Resource = nullptr;
+	}
+
+	const ResourceType* Get() const
+	{
+		return m_Resource;
+	}
+	const ResourceType* operator->() const
+	{
+		return m_Resource;
+	}
+	explicit operator bool() const
+	{
+		return m_Resource != nullptr;
+	}
+private:
+	AssetReference m_Reference;
+	const ResourceType* m_Resource = nullptr;
+};
+
+template<typename ResourceType>
+AssetHandle<ResourceType> ResourceLoader::LoadResource(const char* fileName)
+{
+	AssetReference reference = EnsureResourceIsLoaded(fileName);
+	if (!reference.IsValid()) {
+		return AssetHandle<ResourceType>();
+	}
+	const ResourceType* resource = flatbuffers::GetRoot<ResourceType>(reference.GetData());
+#ifdef _DEBUG
+	flatbuffers::Verifier verifier(reference.GetData(), reference.GetSize());
+	assert(resource->Verify(verifier));
+#endif
+	return AssetHandle<ResourceType>(eastl::move(reference), resource);
+}
 }
\ No newline at end of file
@@ -10,6 +10,14 @@ struct SceneSettings
 	float4 LightColor;
 	float3 CameraWorldPosition;
 	uint LightShadowMapIndex;
+	float4 CameraForward;
+	// Tiles in X and Y, depth slices and number of local lights
+	uint4 ClusterGrid;
+	// Tiles per pixel in X and Y, scale and bias from log of the view depth to a slice
+	float4 ClusterParameters;
+	// Heap indices of the local lights, light clusters and light indices, which move when the buffers grow
+	uint4 ClusterBuffers;
+	uint InstancesIndex;
 };
 
 ConstantBuffer<SceneSettings> g_Scene : register(b0, space0);
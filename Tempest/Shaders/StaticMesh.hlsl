@@ -19,13 +19,18 @@ struct VertexOutput
 
 struct GeometryConstants
 {
-	float4x4 WorldMatrix;
+	uint instanceIndex;
 	uint meshletOffset;
 	uint materialIndex;
 };
 
 ConstantBuffer<GeometryConstants> g_Geometry : register(b0, space1);
 
+struct Instance
+{
+	float4x4 WorldMatrix;
+};
+
 struct Meshlet
 {
 	uint vertex_offset;
@@ -34,6 +39,22 @@ struct Meshlet
 	uint triangle_count;
 };
 
+struct LocalLight
+{
+	float3 Position;
+	float Radius;
+	float3 Color;
+	float SpotScale;
+	float3 Direction;
+	float SpotOffset;
+};
+
+struct ClusterRange
+{
+	uint Offset;
+	uint Count;
+};
+
 struct Material
 {
 	float4 BaseColor;
@@ -54,6 +75,7 @@ void MeshShaderMain(
 	StructuredBuffer<Meshlet> meshlets = ResourceDescriptorHeap[0];
 	Buffer<uint> meshletsIndices = ResourceDescriptorHeap[1];
 	StructuredBuffer<VertexLayout> meshletsVertices = ResourceDescriptorHeap[2];
+	StructuredBuffer<Instance> instances = ResourceDescriptorHeap[g_Scene.InstancesIndex];
 
 	Meshlet meshlet = meshlets[gid + g_Geometry.meshletOffset];
 	SetMeshOutputCounts(meshlet.vertex_count, meshlet.triangle_count);
@@ -68,12 +90,13 @@ void MeshShaderMain(
 		uint vertexIndex = meshlet.vertex_offset + gtid;
 		VertexLayout vertexData = meshletsVertices[vertexIndex];
 
-		float4x4 mvp = mul(g_Scene.ViewProjection, g_Geometry.WorldMatrix);
+		float4x4 worldMatrix = instances[g_Geometry.instanceIndex].WorldMatrix;
+		float4x4 mvp = mul(g_Scene.ViewProjection, worldMatrix);
 		VertexOutput result;
 		result.Position = mul(mvp, float4(vertexData.Position, 1.0));
-		result.PositionWorld = mul(g_Geometry.WorldMatrix, float4(vertexData.Position, 1.0)).xyz;
+		result.PositionWorld = mul(worldMatrix, float4(vertexData.Position, 1.0)).xyz;
 		// TODO: This should be inverse transpose of the world matrix
-		result.NormalWorld = mul(g_Geometry.WorldMatrix, float4(vertexData.Normal, 0.0)).xyz;
+		result.NormalWorld = mul(worldMatrix, float4(vertexData.Normal, 0.0)).xyz;
 		result.UV = vertexData.UV;
 
 		verts[gtid] = result;
@@ -84,29 +107,69 @@ void MeshShaderMain(
 SamplerState MaterialTextureSampler : register(s0, space0);
 SamplerComparisonState ShadowMapSampler : register(s1, space0);
 
+ShadingSurfaceInfo ComputeShadingInfo(float3 N, float3 V, float3 L)
+{
+	const float3 H = normalize(L + V); // Halfway between light and view
+
+	ShadingSurfaceInfo shadingInfo;
+	shadingInfo.NdotH = saturate(dot(N, H));
+	shadingInfo.NdotL = saturate(dot(N, L));
+	shadingInfo.NdotV = saturate(dot(N, V));
+	shadingInfo.VdotH = saturate(dot(V, H));
+	return shadingInfo;
+}
+
+// Point and spot lights from the cluster of the pixel
+float3 ShadeLocalLights(float4 pixelPosition, float3 positionWorld, float3 N, float3 V, PBRMaterialComponents material)
+{
+	StructuredBuffer<LocalLight> lights = ResourceDescriptorHeap[g_Scene.ClusterBuffers.x];
+	StructuredBuffer<ClusterRange> clusters = ResourceDescriptorHeap[g_Scene.ClusterBuffers.y];
+	StructuredBuffer<uint> lightIndices = ResourceDescriptorHeap[g_Scene.ClusterBuffers.z];
+
+	const float viewDepth = dot(positionWorld - g_Scene.CameraWorldPosition, g_Scene.CameraForward.xyz);
+	const uint2 tile = min(uint2(pixelPosition.xy * g_Scene.ClusterParameters.xy), g_Scene.ClusterGrid.xy - 1);
+	const uint slice = uint(clamp(log(max(viewDepth, 1e-4)) * g_Scene.ClusterParameters.z + g_Scene.ClusterParameters.w, 0.0, float(g_Scene.ClusterGrid.z - 1)));
+	const ClusterRange cluster = clusters[(slice * g_Scene.ClusterGrid.y + tile.y) * g_Scene.ClusterGrid.x + tile.x];
+
+	float3 result = float3(0.0, 0.0, 0.0);
+	for (uint i = 0; i < cluster.Count; ++i)
+	{
+		const LocalLight light = lights[lightIndices[cluster.Offset + i]];
+		const float3 toLight = light.Position - positionWorld;
+		const float distanceSquared = dot(toLight, toLight);
+		const float3 L = toLight * rsqrt(max(distanceSquared, 1e-8));
+
+		// Inverse square falloff, smoothly going to 0 at the radius
+		const float radiusFactor = saturate(1.0 - pow(distanceSquared / (light.Radius * light.Radius), 2.0));
+		float attenuation = radiusFactor * radiusFactor / max(distanceSquared, 1e-4);
+		const float spotFactor = saturate(dot(light.Direction, -L) * light.SpotScale + light.SpotOffset);
+		attenuation *= spotFactor * spotFactor;
+
+		const ShadingSurfaceInfo shadingInfo = ComputeShadingInfo(N, V, L);
+		result += BRDF_PBR(shadingInfo, material) * light.Color * attenuation * shadingInfo.NdotL;
+	}
+	return result;
+}
+
 float4 PixelShaderMain(VertexOutput input) : SV_TARGET
 {
 	StructuredBuffer<Material> materials = ResourceDescriptorHeap[3];
+	// Streamed textures move between two descriptors, this is the current one of every texture
+	StructuredBuffer<uint> textureSlots = ResourceDescriptorHeap[4];
 
 	float ambientFactor = 0.05f;
 
 	const float3 N = normalize(input.NormalWorld);
 	const float3 V = normalize(g_Scene.CameraWorldPosition - input.PositionWorld);
 	const float3 L = normalize(-g_Scene.LightDirection.xyz);
-	const float3 H = normalize(L + V); // Halfway between light and view
-
-	ShadingSurfaceInfo shadingInfo;
-	shadingInfo.NdotH = saturate(dot(N, H));
-	shadingInfo.NdotL = saturate(dot(N, L));
-	shadingInfo.NdotV = saturate(dot(N, V));
-	shadingInfo.VdotH = saturate(dot(V, H));
+	const ShadingSurfaceInfo shadingInfo = ComputeShadingInfo(N, V, L);
 
 	PBRMaterialComponents material;
 
 	{
 		float4 color = materials[g_Geometry.materialIndex].BaseColor;
 		if(materials[g_Geometry.materialIndex].BaseColorTextureIndex != -1) {
-			Texture2D<float4> baseTexture = ResourceDescriptorHeap[4 + materials[g_Geometry.materialIndex].BaseColorTextureIndex];
+			Texture2D<float4> baseTexture = ResourceDescriptorHeap[textureSlots[materials[g_Geometry.materialIndex].BaseColorTextureIndex]];
 			color *= baseTexture.Sample(MaterialTextureSampler, input.UV);
 		}
 		material.BaseColor = color.rgb;
@@ -116,7 +179,7 @@ float4 PixelShaderMain(VertexOutput input) : SV_TARGET
 		float metallic = materials[g_Geometry.materialIndex].Metallic;
 		float peceptualRoughness = materials[g_Geometry.materialIndex].Roughness;
 		if(materials[g_Geometry.materialIndex].MetallicRoughnessTextureIndex != -1) {
-			Texture2D<float4> metallicRoughnessTexture = ResourceDescriptorHeap[4 + materials[g_Geometry.materialIndex].MetallicRoughnessTextureIndex];
+			Texture2D<float4> metallicRoughnessTexture = ResourceDescriptorHeap[textureSlots[materials[g_Geometry.materialIndex].MetallicRoughnessTextureIndex]];
 			float4 sampledValues = metallicRoughnessTexture.Sample(MaterialTextureSampler, input.UV);
 			// In GLTF metallic and roughness are packed in B and G channel of a single texture
 			metallic *= sampledValues.b;
@@ -153,6 +216,7 @@ float4 PixelShaderMain(VertexOutput input) : SV_TARGET
 	float shadowFactor = sum / 16.0;
 
 	const float3 result = (material.BaseColor * ambientFactor) // ambient
-		+ (BRDF_PBR(shadingInfo, material) * g_Scene.LightColor.rgb * shadowFactor * shadingInfo.NdotL); // Don't forget the cos of N and L factor which is outside of the BRDF in the integral
+		+ (BRDF_PBR(shadingInfo, material) * g_Scene.LightColor.rgb * shadowFactor * shadingInfo.NdotL) // Don't forget the cos of N and L factor which is outside of the BRDF in the integral
+		+ ShadeLocalLights(input.Position, input.PositionWorld, N, V, material);
 	return float4(result, 1.0);
 }
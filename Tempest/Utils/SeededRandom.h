@@ -0,0 +1,39 @@
+#pragma once
+
+namespace Tempest
+{
+namespace Utils
+{
+// Linear congruential generator, which gives the same numbers on every run, so generated test and benchmark data can be compared.
+// The numbers are not good enough for anything else
+class SeededRandom
+{
+public:
+	explicit SeededRandom(uint32_t seed = 12345)
+		: m_State(seed)
+	{
+	}
+
+	// In [0, range)
+	uint32_t NextUint(uint32_t range)
+	{
+		return Next() % range;
+	}
+
+	// In [0, 1)
+	float NextFloat()
+	{
+		return float(Next()) / float(1 << 24);
+	}
+private:
+	// Only the top 24 bits, the low bits of the generator have short periods
+	uint32_t Next()
+	{
+		m_State = m_State * 1664525u + 1013904223u;
+		return m_State >> 8;
+	}
+
+	uint32_t m_State;
+};
+}
+}
@@ -7,10 +7,17 @@ namespace Tempest
 void Camera::SetPerspectiveProjection(float aspectRatio, float fov, float znear, float zfar)
 {
 	m_Projection = glm::perspective(fov, aspectRatio, znear, zfar);
+	m_NearPlane = znear;
+	m_FarPlane = zfar;
 }
 
 glm::mat4x4 Camera::GetViewProjection() const
 {
-	return m_Projection * glm::lookAt(Position, Position + Forward, Up);
+	return m_Projection * GetView();
+}
+
+glm::mat4x4 Camera::GetView() const
+{
+	return glm::lookAt(Position, Position + Forward, Up);
 }
 }
@@ -7,11 +7,31 @@ class Camera
 public:
 	void SetPerspectiveProjection(float aspectRatio, float fov, float znear, float zfar);
 	glm::mat4x4 GetViewProjection() const;
+	glm::mat4x4 GetView() const;
+	const glm::mat4x4& GetProjection() const
+	{
+		return m_Projection;
+	}
+	float GetNearPlane() const
+	{
+		return m_NearPlane;
+	}
+	float GetFarPlane() const
+	{
+		return m_FarPlane;
+	}
+	// 1 / tan(fov / 2), converts a size at distance 1 to normalized screen height
+	float GetProjectionScale() const
+	{
+		return m_Projection[1][1];
+	}
 
 	glm::vec3 Position;
 	glm::vec3 Forward;
 	glm::vec3 Up;
 private:
 	glm::mat4x4 m_Projection;
+	float m_NearPlane;
+	float m_FarPlane;
 };
 }
\ No newline at end of file
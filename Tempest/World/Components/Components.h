@@ -65,6 +65,24 @@ struct LightColorInfo
 	static constexpr const char* Name = "LightColorInfo";
 };
 
+// Light shining in all directions from the position of the entity. Nothing is lit past the radius
+struct PointLight
+{
+	float Radius;
+
+	static constexpr const char* Name = "PointLight";
+};
+
+// Light shining in a cone along the forward direction of the entity. Angles are from the axis of the cone, in radians
+struct SpotLight
+{
+	float Radius;
+	float InnerConeAngle;
+	float OuterConeAngle;
+
+	static constexpr const char* Name = "SpotLight";
+};
+
 struct CarPhysicsPart
 {
 	physx::PxRigidBody* CarActor;
@@ -0,0 +1,326 @@
+#include <CommonIncludes.h>
+
+#include <World/LevelStreaming.h>
+#include <Engine.h>
+
+#include <EASTL/sort.h>
+#include <chrono>
+#include <thread>
+
+namespace Tempest
+{
+LevelStreaming::LevelStreaming()
+	: m_LoadQueue(eastl::make_shared<LoadQueue>())
+{}
+
+LevelStreaming::~LevelStreaming()
+{
+	// Not called from a job, so it can't wait on the counter. Queued jobs see the shut down when they start,
+	// they could also never start if the job system has quit already
+	eastl::vector<LoadTask*> finishedLoads;
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_LoadQueue->Mutex);
+			m_LoadQueue->IsShutDown = true;
+			if (m_LoadQueue->RunningLoads == 0)
+			{
+				finishedLoads.swap(m_LoadQueue->FinishedLoads);
+				break;
+			}
+		}
+		std::this_thread::yield();
+	}
+
+	for (LoadTask* task : finishedLoads)
+	{
+		delete task;
+	}
+}
+
+void LevelStreaming::Initialize(const Definition::Level& level)
+{
+	// The loads in flight point at the sectors of the previous level
+	if (m_LoadsInFlight > 0)
+	{
+		WaitForLoads();
+	}
+	m_Sectors.clear();
+	if (!level.sectors())
+	{
+		return;
+	}
+
+	m_Sectors.reserve(level.sectors()->size());
+	for (const Definition::LevelSector* levelSector : *level.sectors())
+	{
+		Sector& sector = m_Sectors.push_back();
+		sector.BoundsMin = glm::vec3(levelSector->bounds_min()->x(), levelSector->bounds_min()->y(), levelSector->bounds_min()->z());
+		sector.BoundsMax = glm::vec3(levelSector->bounds_max()->x(), levelSector->bounds_max()->y(), levelSector->bounds_max()->z());
+		sector.FileName = levelSector->file()->c_str();
+	}
+	m_Statistics.Sectors = uint32_t(m_Sectors.size());
+	FORMAT_LOG(Info, Game, "Level has %u sectors, streamed in at %.1f and out at %.1f units.", uint32_t(m_Sectors.size()), m_StreamInDistance, m_StreamOutDistance);
+}
+
+float LevelStreaming::GetDistance(const Sector& sector, const glm::vec3& position) const
+{
+	// Zero inside of the bounds
+	const glm::vec3 closestPoint = glm::clamp(position, sector.BoundsMin, sector.BoundsMax);
+	return glm::length(position - closestPoint);
+}
+
+void LevelStreaming::LoadSectorJob(uint32_t, void* data)
+{
+	LoadTask* task = reinterpret_cast<LoadTask*>(data);
+	// The task is deleted by the streaming once it is in the finished loads, so the queue is kept alive here
+	const eastl::shared_ptr<LoadQueue> queue = task->Queue;
+	bool isLoading = false;
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		if (!queue->IsShutDown)
+		{
+			++queue->RunningLoads;
+			isLoading = true;
+		}
+	}
+
+	if (isLoading)
+	{
+		task->Data = gEngine->GetResourceLoader().LoadResource<Definition::Sector>(task->FileName.c_str());
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queue->Mutex);
+		if (queue->IsShutDown)
+		{
+			delete task;
+		}
+		else
+		{
+			queue->FinishedLoads.push_back(task);
+		}
+		// Last, so the destructor doesn't return while the task is still used
+		if (isLoading)
+		{
+			--queue->RunningLoads;
+		}
+	}
+	gEngine->GetJobSystem().FinishExternalWork(&queue->PendingLoads);
+}
+
+void LevelStreaming::StartLoads(const glm::vec3& position, uint32_t maxLoads, Job::JobPriority priority)
+{
+	eastl::vector<Job::JobDecl> jobs;
+	for (uint32_t index = 0; index < m_Sectors.size() && m_LoadsInFlight + jobs.size() < maxLoads; ++index)
+	{
+		Sector& sector = m_Sectors[index];
+		if (sector.State != SectorState::Unloaded || sector.RetryUpdate > m_UpdateIndex || GetDistance(sector, position) > m_StreamInDistance)
+		{
+			continue;
+		}
+
+		sector.State = SectorState::Loading;
+		jobs.push_back(Job::JobDecl{ LoadSectorJob, new LoadTask{ m_LoadQueue, index, sector.FileName } });
+	}
+
+	if (jobs.empty())
+	{
+		return;
+	}
+
+	// Counted before the jobs run, so waiting never misses one of them
+	m_LoadsInFlight += uint32_t(jobs.size());
+	gEngine->GetJobSystem().BeginExternalWork(&m_LoadQueue->PendingLoads, uint32_t(jobs.size()));
+	gEngine->GetJobSystem().RunJobs("Load Level Sector", jobs.data(), uint32_t(jobs.size()), nullptr, Job::ThreadTag::Worker, priority);
+}
+
+void LevelStreaming::WaitForLoads()
+{
+	gEngine->GetJobSystem().WaitForCounter(&m_LoadQueue->PendingLoads, 0);
+	CollectFinishedLoads();
+	assert(m_LoadsInFlight == 0);
+}
+
+void LevelStreaming::CollectFinishedLoads()
+{
+	eastl::vector<LoadTask*> finishedLoads;
+	{
+		std::lock_guard<std::mutex> lock(m_LoadQueue->Mutex);
+		finishedLoads.swap(m_LoadQueue->FinishedLoads);
+	}
+
+	for (LoadTask* task : finishedLoads)
+	{
+		Sector& sector = m_Sectors[task->SectorIndex];
+		if (task->Data)
+		{
+			sector.Data = eastl::move(task->Data);
+			sector.State = SectorState::Loaded;
+			sector.FailedLoads = 0;
+		}
+		else
+		{
+			// A missing file stays missing, but reads can fail for a while, so it is tried again less and less often
+			++sector.FailedLoads;
+			const uint32_t doublings = sector.FailedLoads - 1 < sMaxRetryDoublings ? sector.FailedLoads - 1 : sMaxRetryDoublings;
+			sector.RetryUpdate = m_UpdateIndex + (sRetryDelayUpdates << doublings);
+			FORMAT_LOG(Warning, Game, "Level sector (%s) failed to load %u times, it will be tried again.", sector.FileName.c_str(), sector.FailedLoads);
+			sector.State = SectorState::Unloaded;
+		}
+		--m_LoadsInFlight;
+		delete task;
+	}
+}
+
+void LevelStreaming::AddToWorld(World& world, Sector& sector)
+{
+	OPTICK_EVENT();
+	const Definition::Sector* data = sector.Data.Get();
+	if (data->entities())
+	{
+		// flecs parses null terminated strings
+		const eastl::string json(reinterpret_cast<const char*>(data->entities()->data()), data->entities()->size());
+		world.m_EntityWorld.from_json(json.c_str());
+	}
+
+	sector.Entities.clear();
+	if (data->entity_names())
+	{
+		sector.Entities.reserve(data->entity_names()->size());
+		for (const flatbuffers::String* name : *data->entity_names())
+		{
+			const flecs::entity entity = world.m_EntityWorld.lookup(name->c_str());
+			if (entity)
+			{
+				sector.Entities.push_back(entity.id());
+			}
+		}
+	}
+
+	// Everything is copied in the world, so the file is not needed anymore
+	sector.Data.Release();
+	sector.State = SectorState::InWorld;
+	++m_Statistics.StreamedInSectors;
+	m_Statistics.AddedEntities += uint32_t(sector.Entities.size());
+}
+
+void LevelStreaming::RemoveFromWorld(World& world, Sector& sector)
+{
+	OPTICK_EVENT();
+	// Deferred, so flecs applies all of them together instead of moving the tables after every entity
+	world.m_EntityWorld.defer_begin();
+	for (flecs::entity_t entity : sector.Entities)
+	{
+		// Gameplay could have destroyed it already
+		if (world.m_EntityWorld.is_alive(entity))
+		{
+			world.m_EntityWorld.entity(entity).destruct();
+		}
+	}
+	world.m_EntityWorld.defer_end();
+
+	m_Statistics.RemovedEntities += uint32_t(sector.Entities.size());
+	++m_Statistics.StreamedOutSectors;
+	sector.Entities.clear();
+	sector.State = SectorState::Unloaded;
+}
+
+void LevelStreaming::LoadAround(World& world, const glm::vec3& position)
+{
+	OPTICK_EVENT();
+	if (m_Sectors.empty())
+	{
+		return;
+	}
+
+	// Nothing else is running while the level loads, so there is no limit and no need for the background
+	StartLoads(position, uint32_t(m_Sectors.size()), Job::JobPriority::Normal);
+	WaitForLoads();
+
+	for (Sector& sector : m_Sectors)
+	{
+		if (sector.State == SectorState::Loaded)
+		{
+			AddToWorld(world, sector);
+		}
+	}
+	FORMAT_LOG(Info, Game, "Loaded %u level sectors with %u entities around the camera.", m_Statistics.StreamedInSectors, m_Statistics.AddedEntities);
+}
+
+void LevelStreaming::Update(World& world, const glm::vec3& position)
+{
+	OPTICK_EVENT();
+	if (m_Sectors.empty())
+	{
+		return;
+	}
+
+	++m_UpdateIndex;
+	CollectFinishedLoads();
+	StartLoads(position, sMaxLoadsInFlight, Job::JobPriority::Background);
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+	uint32_t changes = 0;
+	// Removals go first, as they make the tables smaller before anything is added to them
+	for (Sector& sector : m_Sectors)
+	{
+		if (changes < sMaxWorldChangesPerFrame && sector.State == SectorState::InWorld && GetDistance(sector, position) > m_StreamOutDistance)
+		{
+			RemoveFromWorld(world, sector);
+			++changes;
+		}
+	}
+
+	// Loaded sectors which went out of range while loading are dropped, the rest are added with the closest first
+	eastl::vector<uint32_t> sectorsToAdd;
+	for (uint32_t index = 0; index < m_Sectors.size(); ++index)
+	{
+		Sector& sector = m_Sectors[index];
+		if (sector.State != SectorState::Loaded)
+		{
+			continue;
+		}
+
+		if (GetDistance(sector, position) > m_StreamOutDistance)
+		{
+			sector.Data.Release();
+			sector.State = SectorState::Unloaded;
+		}
+		else
+		{
+			sectorsToAdd.push_back(index);
+		}
+	}
+	eastl::sort(sectorsToAdd.begin(), sectorsToAdd.end(), [this, &position](uint32_t left, uint32_t right) {
+		return GetDistance(m_Sectors[left], position) < GetDistance(m_Sectors[right], position);
+	});
+	for (uint32_t index : sectorsToAdd)
+	{
+		if (changes >= sMaxWorldChangesPerFrame)
+		{
+			break;
+		}
+		AddToWorld(world, m_Sectors[index]);
+		++changes;
+	}
+
+	m_Statistics.ApplyMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+	m_Statistics.LoadingSectors = m_LoadsInFlight;
+	m_Statistics.ResidentSectors = 0;
+	for (const Sector& sector : m_Sectors)
+	{
+		m_Statistics.ResidentSectors += sector.State == SectorState::InWorld ? 1 : 0;
+	}
+
+	OPTICK_TAG("Resident Sectors", m_Statistics.ResidentSectors);
+	OPTICK_TAG("Loading Sectors", m_Statistics.LoadingSectors);
+	OPTICK_TAG("Streamed In Sectors", m_Statistics.StreamedInSectors);
+	OPTICK_TAG("Streamed Out Sectors", m_Statistics.StreamedOutSectors);
+	OPTICK_TAG("Sector Apply ms", m_Statistics.ApplyMilliseconds);
+
+	m_LastFrameStatistics = m_Statistics;
+	m_Statistics = LevelStreamingStatistics();
+	m_Statistics.Sectors = uint32_t(m_Sectors.size());
+}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <World/World.h>
+#include <Resources/ResourceLoader.h>
+#include <DataDefinitions/Level_generated.h>
+#include <DataDefinitions/Sector_generated.h>
+
+#include <EASTL/shared_ptr.h>
+
+#include <mutex>
+
+namespace Tempest
+{
+struct LevelStreamingStatistics
+{
+	uint32_t Sectors = 0;
+	// Sectors whose entities are in the world
+	uint32_t ResidentSectors = 0;
+	uint32_t LoadingSectors = 0;
+	uint32_t StreamedInSectors = 0;
+	uint32_t StreamedOutSectors = 0;
+	uint32_t AddedEntities = 0;
+	uint32_t RemovedEntities = 0;
+	// Time spent changing the world between the updates
+	float ApplyMilliseconds = 0.0f;
+};
+
+// Keeps the sectors of the level around the camera in the world. Maelstrom splits the entities of big levels on a grid, every
+// sector in a file of its own, and the level keeps only the entities which are everywhere, like the sun.
+// Sector files are loaded on background jobs, so they run only when the workers have nothing else to do. Entities can only be
+// added and removed between world updates, so the loaded sectors are applied at the start of the frame. Only a few sectors
+// change every frame, the closest ones first, and every removal is a single deferred batch, so flecs moves every table once.
+// Sectors are streamed out farther than they are streamed in, so moving along a border doesn't load the same sector again and again.
+class LevelStreaming : Utils::NonCopyable
+{
+public:
+	LevelStreaming();
+	// Waits for the loads which are running, the queued ones drop their sector when they start
+	~LevelStreaming();
+
+	// Copies the sectors of the level, as the level is released after loading. Waits for the loads of the previous level,
+	// so must be called from a job
+	void Initialize(const Definition::Level& level);
+	// Loads everything in range and adds it to the world, so the level starts complete. Must be called from a job, between world updates
+	void LoadAround(World& world, const glm::vec3& position);
+	// Starts loading the sectors which came in range and applies the finished ones. Must be called from a job, between world updates
+	void Update(World& world, const glm::vec3& position);
+
+	bool HasSectors() const
+	{
+		return !m_Sectors.empty();
+	}
+
+	// Distances from the bounds of the sectors
+	void SetDistances(float streamInDistance, float streamOutDistance)
+	{
+		assert(streamInDistance <= streamOutDistance);
+		m_StreamInDistance = streamInDistance;
+		m_StreamOutDistance = streamOutDistance;
+	}
+
+	const LevelStreamingStatistics& GetLastFrameStatistics() const
+	{
+		return m_LastFrameStatistics;
+	}
+private:
+	enum class SectorState : uint8_t
+	{
+		Unloaded,
+		// A job is loading the file
+		Loading,
+		// The file is loaded, but the entities are not in the world yet
+		Loaded,
+		InWorld,
+	};
+
+	struct Sector
+	{
+		glm::vec3 BoundsMin;
+		glm::vec3 BoundsMax;
+		eastl::string FileName;
+		SectorState State = SectorState::Unloaded;
+		// Sectors which failed to load are tried again later, waiting longer after every failure
+		uint32_t FailedLoads = 0;
+		uint64_t RetryUpdate = 0;
+		AssetHandle<Definition::Sector> Data;
+		// Found when the entities are added, so they can be removed without going through their names again
+		eastl::vector<flecs::entity_t> Entities;
+	};
+
+	struct LoadTask;
+
+	// Shared with the load jobs, so a job which starts after the streaming is gone finds it shut down instead of freed memory
+	struct LoadQueue
+	{
+		std::mutex Mutex;
+		eastl::vector<LoadTask*> FinishedLoads;
+		// Jobs which are reading their sector right now
+		uint32_t RunningLoads = 0;
+		bool IsShutDown = false;
+		// Every started load until its job is done, so they can be waited for
+		Job::Counter PendingLoads;
+	};
+
+	// Owned by the job until it is in the finished loads. Everything is copied, so it doesn't point in the sectors
+	struct LoadTask
+	{
+		eastl::shared_ptr<LoadQueue> Queue;
+		uint32_t SectorIndex;
+		eastl::string FileName;
+		AssetHandle<Definition::Sector> Data;
+	};
+
+	static void LoadSectorJob(uint32_t, void* data);
+	float GetDistance(const Sector& sector, const glm::vec3& position) const;
+	// Starts loading the sectors in range, at most up to the limit of loads in flight
+	void StartLoads(const glm::vec3& position, uint32_t maxLoads, Job::JobPriority priority);
+	// Must be called from a job
+	void WaitForLoads();
+	void CollectFinishedLoads();
+	void AddToWorld(World& world, Sector& sector);
+	void RemoveFromWorld(World& world, Sector& sector);
+
+	// Each sector added or removed is one change
+	static const uint32_t sMaxWorldChangesPerFrame = 2;
+	static const uint32_t sMaxLoadsInFlight = 4;
+	// Updates before a failed sector is tried again, doubled after every failure up to the limit
+	static const uint64_t sRetryDelayUpdates = 60;
+	static const uint32_t sMaxRetryDoublings = 6;
+	static constexpr float sDefaultStreamInDistance = 96.0f;
+	static constexpr float sDefaultStreamOutDistance = 128.0f;
+
+	eastl::vector<Sector> m_Sectors;
+	float m_StreamInDistance = sDefaultStreamInDistance;
+	float m_StreamOutDistance = sDefaultStreamOutDistance;
+	uint32_t m_LoadsInFlight = 0;
+	uint64_t m_UpdateIndex = 0;
+	eastl::shared_ptr<LoadQueue> m_LoadQueue;
+
+	LevelStreamingStatistics m_Statistics;
+	LevelStreamingStatistics m_LastFrameStatistics;
+};
+}
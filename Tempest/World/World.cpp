@@ -90,6 +90,12 @@ WorldStorage::WorldStorage()
     m_EntityWorld.component<Components::LightColorInfo>(Components::LightColorInfo::Name)
         .member<glm::vec3>("Color")
         .member<float>("Intensity");
+	m_EntityWorld.component<Components::PointLight>(Components::PointLight::Name)
+		.member<float>("Radius");
+	m_EntityWorld.component<Components::SpotLight>(Components::SpotLight::Name)
+		.member<float>("Radius")
+		.member<float>("InnerConeAngle")
+		.member<float>("OuterConeAngle");
 	RegisterComponent<Components::VehicleController>(m_EntityWorld);
 	RegisterComponent<Components::Faction>(m_EntityWorld);
 
@@ -0,0 +1,56 @@
+#include "Tests.h"
+
+#include <filesystem>
+
+struct TestCase
+{
+	const char* Name;
+	void (*Function)(TestContext&);
+};
+
+static const TestCase sTests[] = {
+	{ "Transient Aliasing", &TestTransientAliasing },
+};
+
+// Returns the number of failed tests, so a nonzero exit code means a failure
+int main()
+{
+	char exePath[MAX_PATH];
+	::GetModuleFileNameA(NULL, exePath, MAX_PATH);
+	std::filesystem::current_path(std::filesystem::path(exePath).parent_path());
+
+	Tempest::EngineCoreOptions options;
+	options.NumWorkerThreads = std::thread::hardware_concurrency();
+	options.ResourceFolder = "../../Tempest/Shaders/";
+	options.UseAssetPack = false;
+
+	int failedTests = 0;
+	{
+		Tempest::EngineCore engine(options);
+
+		Tempest::Job::JobDecl job{ [](uint32_t, void* failedTestsData) {
+			int& failedTests = *(int*)failedTestsData;
+			for (const TestCase& test : sTests)
+			{
+				TestContext context;
+				test.Function(context);
+				if (context.Failures == 0)
+				{
+					FORMAT_LOG(Info, Tests, "%s: passed", test.Name);
+				}
+				else
+				{
+					FORMAT_LOG(Error, Tests, "%s: %u checks failed", test.Name, context.Failures);
+					++failedTests;
+				}
+			}
+
+			Tempest::gEngineCore->GetJobSystem().Quit();
+		}, &failedTests };
+
+		engine.GetJobSystem().RunJobs("Run Tests", &job, 1, nullptr, Tempest::Job::ThreadTag::Worker);
+		engine.GetJobSystem().WaitForCompletion();
+	}
+
+	return failedTests;
+}
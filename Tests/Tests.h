@@ -0,0 +1,22 @@
+#pragma once
+
+#include <EngineCore.h>
+
+struct TestContext
+{
+	uint32_t Failures = 0;
+};
+
+// Logs the failed condition and fails the test, but keeps going, so every broken case in it is reported
+#define TEST_CHECK(Context, Condition, Message, ...) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			FORMAT_LOG(Error, Tests, "%s(%d): " Message, __FILE__, __LINE__, __VA_ARGS__); \
+			++(Context).Failures; \
+		} \
+	} \
+	while(0)
+
+void TestTransientAliasing(TestContext& context);
@@ -0,0 +1,108 @@
+#include "Tests.h"
+
+#include <Graphics/TransientAliasingPlanner.h>
+#include <Utils/SeededRandom.h>
+
+using namespace Tempest;
+
+static bool LifetimesOverlap(const TransientResourceRequest& first, const TransientResourceRequest& second)
+{
+	return first.FirstPass <= second.LastPass && second.FirstPass <= first.LastPass;
+}
+
+// Checks the invariants every plan must keep, whatever the requests are
+static void CheckPlan(TestContext& context, const char* name, eastl::span<const TransientResourceRequest> requests, const TransientAliasingPlan& plan)
+{
+	TEST_CHECK(context, plan.Placements.size() == requests.size(), "(%s) %u placements for %u requests", name, uint32_t(plan.Placements.size()), uint32_t(requests.size()));
+	if (plan.Placements.size() != requests.size())
+	{
+		return;
+	}
+
+	for (uint32_t i = 0; i < requests.size(); ++i)
+	{
+		const TransientResourcePlacement& placement = plan.Placements[i];
+		TEST_CHECK(context, requests[i].Alignment <= 1 || placement.HeapOffset % requests[i].Alignment == 0,
+			"(%s) resource %u at offset %llu is not aligned to %llu", name, i, placement.HeapOffset, requests[i].Alignment);
+		TEST_CHECK(context, placement.HeapOffset + requests[i].Size <= plan.HeapSize,
+			"(%s) resource %u ends past the heap of %llu bytes", name, i, plan.HeapSize);
+
+		bool sharesMemory = false;
+		for (uint32_t j = 0; j < requests.size(); ++j)
+		{
+			const TransientResourcePlacement& other = plan.Placements[j];
+			const bool memoryOverlaps = placement.HeapOffset < other.HeapOffset + requests[j].Size && other.HeapOffset < placement.HeapOffset + requests[i].Size;
+			if (i == j || !memoryOverlaps)
+			{
+				continue;
+			}
+			sharesMemory = true;
+			TEST_CHECK(context, i > j || !LifetimesOverlap(requests[i], requests[j]),
+				"(%s) resources %u and %u are alive together in the same memory", name, i, j);
+		}
+		TEST_CHECK(context, sharesMemory == placement.SharesMemory,
+			"(%s) resource %u is %s marked as sharing memory", name, i, placement.SharesMemory ? "wrongly" : "not");
+	}
+
+	TEST_CHECK(context, plan.HeapSize <= plan.NaiveSize,
+		"(%s) heap of %llu bytes is bigger than the %llu bytes without aliasing", name, plan.HeapSize, plan.NaiveSize);
+}
+
+void TestTransientAliasing(TestContext& context)
+{
+	const uint64_t megabyte = 1024 * 1024;
+	const uint64_t placementAlignment = 64 * 1024;
+
+	// Disjoint lifetimes, the second one must reuse the memory of the first
+	{
+		const TransientResourceRequest requests[] = {
+			{ 4 * megabyte, placementAlignment, 0, 1 },
+			{ 4 * megabyte, placementAlignment, 2, 3 },
+		};
+		const TransientAliasingPlan plan = PlanTransientAliasing(requests);
+		CheckPlan(context, "reuse", requests, plan);
+		TEST_CHECK(context, plan.HeapSize == 4 * megabyte && plan.Placements[0].HeapOffset == plan.Placements[1].HeapOffset,
+			"(reuse) disjoint lifetimes got a heap of %llu bytes instead of %llu", plan.HeapSize, 4 * megabyte);
+	}
+
+	// Lifetimes touching on a single pass are overlapping, nothing can be shared
+	{
+		const TransientResourceRequest requests[] = {
+			{ 2 * megabyte, placementAlignment, 0, 2 },
+			{ 2 * megabyte, placementAlignment, 2, 4 },
+			{ 1 * megabyte, placementAlignment, 1, 3 },
+		};
+		const TransientAliasingPlan plan = PlanTransientAliasing(requests);
+		CheckPlan(context, "overlap", requests, plan);
+		TEST_CHECK(context, plan.HeapSize == plan.NaiveSize,
+			"(overlap) overlapping lifetimes got a heap of %llu bytes instead of %llu", plan.HeapSize, plan.NaiveSize);
+	}
+
+	// Odd sizes and mixed alignments, the offsets after the small resources must be rounded up
+	{
+		const TransientResourceRequest requests[] = {
+			{ 1000, 256, 0, 5 },
+			{ 3 * megabyte + 1, placementAlignment, 0, 5 },
+			{ 70000, 4 * megabyte, 1, 2 },
+			{ 12345, placementAlignment, 3, 4 },
+		};
+		CheckPlan(context, "alignment", requests, PlanTransientAliasing(requests));
+	}
+
+	// A frame worth of render targets with random lifetimes
+	{
+		Utils::SeededRandom random;
+		const uint32_t passCount = 40;
+		eastl::vector<TransientResourceRequest> requests(200);
+		for (TransientResourceRequest& request : requests)
+		{
+			request.Size = uint64_t(1 + random.NextUint(32 * 1024)) * 256;
+			request.Alignment = random.NextUint(8) == 0 ? 4 * megabyte : placementAlignment;
+			request.FirstPass = random.NextUint(passCount);
+			request.LastPass = request.FirstPass + random.NextUint(passCount - request.FirstPass);
+		}
+		const TransientAliasingPlan plan = PlanTransientAliasing(requests);
+		CheckPlan(context, "random", requests, plan);
+		TEST_CHECK(context, plan.HeapSize < plan.NaiveSize, "(random) nothing was aliased, heap of %llu bytes", plan.HeapSize);
+	}
+}
@@ -395,6 +395,231 @@ pub mod tempest {
             }
         }
 
+        // struct MeshLod, aligned to 4
+        #[repr(C, align(4))]
+        #[derive(Clone, Copy, Debug, PartialEq)]
+        pub struct MeshLod {
+            meshlets_offset_: u32,
+            meshlets_count_: u32,
+            triangle_count_: u32,
+            error_: f32,
+        } // pub struct MeshLod
+        impl flatbuffers::SafeSliceAccess for MeshLod {}
+        impl<'a> flatbuffers::Follow<'a> for MeshLod {
+            type Inner = &'a MeshLod;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                <&'a MeshLod>::follow(buf, loc)
+            }
+        }
+        impl<'a> flatbuffers::Follow<'a> for &'a MeshLod {
+            type Inner = &'a MeshLod;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                flatbuffers::follow_cast_ref::<MeshLod>(buf, loc)
+            }
+        }
+        impl<'b> flatbuffers::Push for MeshLod {
+            type Output = MeshLod;
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(self as *const MeshLod as *const u8, Self::size())
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+        impl<'b> flatbuffers::Push for &'b MeshLod {
+            type Output = MeshLod;
+
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(*self as *const MeshLod as *const u8, Self::size())
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+
+        impl MeshLod {
+            pub fn new<'a>(
+                _meshlets_offset: u32,
+                _meshlets_count: u32,
+                _triangle_count: u32,
+                _error: f32,
+            ) -> Self {
+                MeshLod {
+                    meshlets_offset_: _meshlets_offset.to_little_endian(),
+                    meshlets_count_: _meshlets_count.to_little_endian(),
+                    triangle_count_: _triangle_count.to_little_endian(),
+                    error_: _error.to_little_endian(),
+                }
+            }
+            pub fn meshlets_offset<'a>(&'a self) -> u32 {
+                self.meshlets_offset_.from_little_endian()
+            }
+            pub fn meshlets_count<'a>(&'a self) -> u32 {
+                self.meshlets_count_.from_little_endian()
+            }
+            pub fn triangle_count<'a>(&'a self) -> u32 {
+                self.triangle_count_.from_little_endian()
+            }
+            pub fn error<'a>(&'a self) -> f32 {
+                self.error_.from_little_endian()
+            }
+        }
+
+        // struct PrimitiveMeshLods, aligned to 4
+        #[repr(C, align(4))]
+        #[derive(Clone, Copy, Debug, PartialEq)]
+        pub struct PrimitiveMeshLods {
+            lod_offset_: u32,
+            lod_count_: u32,
+        } // pub struct PrimitiveMeshLods
+        impl flatbuffers::SafeSliceAccess for PrimitiveMeshLods {}
+        impl<'a> flatbuffers::Follow<'a> for PrimitiveMeshLods {
+            type Inner = &'a PrimitiveMeshLods;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                <&'a PrimitiveMeshLods>::follow(buf, loc)
+            }
+        }
+        impl<'a> flatbuffers::Follow<'a> for &'a PrimitiveMeshLods {
+            type Inner = &'a PrimitiveMeshLods;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                flatbuffers::follow_cast_ref::<PrimitiveMeshLods>(buf, loc)
+            }
+        }
+        impl<'b> flatbuffers::Push for PrimitiveMeshLods {
+            type Output = PrimitiveMeshLods;
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        self as *const PrimitiveMeshLods as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+        impl<'b> flatbuffers::Push for &'b PrimitiveMeshLods {
+            type Output = PrimitiveMeshLods;
+
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        *self as *const PrimitiveMeshLods as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+
+        impl PrimitiveMeshLods {
+            pub fn new<'a>(_lod_offset: u32, _lod_count: u32) -> Self {
+                PrimitiveMeshLods {
+                    lod_offset_: _lod_offset.to_little_endian(),
+                    lod_count_: _lod_count.to_little_endian(),
+                }
+            }
+            pub fn lod_offset<'a>(&'a self) -> u32 {
+                self.lod_offset_.from_little_endian()
+            }
+            pub fn lod_count<'a>(&'a self) -> u32 {
+                self.lod_count_.from_little_endian()
+            }
+        }
+
+        // struct OccluderData, aligned to 4
+        #[repr(C, align(4))]
+        #[derive(Clone, Copy, Debug, PartialEq)]
+        pub struct OccluderData {
+            vertex_offset_: u32,
+            index_offset_: u32,
+            index_count_: u32,
+            bounds_min_: super::super::common::tempest::Vec3,
+            bounds_max_: super::super::common::tempest::Vec3,
+        } // pub struct OccluderData
+        impl flatbuffers::SafeSliceAccess for OccluderData {}
+        impl<'a> flatbuffers::Follow<'a> for OccluderData {
+            type Inner = &'a OccluderData;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                <&'a OccluderData>::follow(buf, loc)
+            }
+        }
+        impl<'a> flatbuffers::Follow<'a> for &'a OccluderData {
+            type Inner = &'a OccluderData;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                flatbuffers::follow_cast_ref::<OccluderData>(buf, loc)
+            }
+        }
+        impl<'b> flatbuffers::Push for OccluderData {
+            type Output = OccluderData;
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        self as *const OccluderData as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+        impl<'b> flatbuffers::Push for &'b OccluderData {
+            type Output = OccluderData;
+
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        *self as *const OccluderData as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+
+        impl OccluderData {
+            pub fn new<'a>(
+                _vertex_offset: u32,
+                _index_offset: u32,
+                _index_count: u32,
+                _bounds_min: &'a super::super::common::tempest::Vec3,
+                _bounds_max: &'a super::super::common::tempest::Vec3,
+            ) -> Self {
+                OccluderData {
+                    vertex_offset_: _vertex_offset.to_little_endian(),
+                    index_offset_: _index_offset.to_little_endian(),
+                    index_count_: _index_count.to_little_endian(),
+                    bounds_min_: *_bounds_min,
+                    bounds_max_: *_bounds_max,
+                }
+            }
+            pub fn vertex_offset<'a>(&'a self) -> u32 {
+                self.vertex_offset_.from_little_endian()
+            }
+            pub fn index_offset<'a>(&'a self) -> u32 {
+                self.index_offset_.from_little_endian()
+            }
+            pub fn index_count<'a>(&'a self) -> u32 {
+                self.index_count_.from_little_endian()
+            }
+            pub fn bounds_min<'a>(&'a self) -> &'a super::super::common::tempest::Vec3 {
+                &self.bounds_min_
+            }
+            pub fn bounds_max<'a>(&'a self) -> &'a super::super::common::tempest::Vec3 {
+                &self.bounds_max_
+            }
+        }
+
         pub enum GeometryDatabaseOffset {}
         #[derive(Copy, Clone, Debug, PartialEq)]
 
@@ -423,6 +648,24 @@ pub mod tempest {
                 args: &'args GeometryDatabaseArgs<'args>,
             ) -> flatbuffers::WIPOffset<GeometryDatabase<'bldr>> {
                 let mut builder = GeometryDatabaseBuilder::new(_fbb);
+                if let Some(x) = args.primitive_uv_densities {
+                    builder.add_primitive_uv_densities(x);
+                }
+                if let Some(x) = args.lods {
+                    builder.add_lods(x);
+                }
+                if let Some(x) = args.primitive_lods {
+                    builder.add_primitive_lods(x);
+                }
+                if let Some(x) = args.occluder_indices {
+                    builder.add_occluder_indices(x);
+                }
+                if let Some(x) = args.occluder_vertices {
+                    builder.add_occluder_vertices(x);
+                }
+                if let Some(x) = args.occluders {
+                    builder.add_occluders(x);
+                }
                 if let Some(x) = args.mappings {
                     builder.add_mappings(x);
                 }
@@ -450,6 +693,12 @@ pub mod tempest {
             pub const VT_PRIMITIVE_MESHES: flatbuffers::VOffsetT = 10;
             pub const VT_MATERIALS: flatbuffers::VOffsetT = 12;
             pub const VT_MAPPINGS: flatbuffers::VOffsetT = 14;
+            pub const VT_OCCLUDERS: flatbuffers::VOffsetT = 16;
+            pub const VT_OCCLUDER_VERTICES: flatbuffers::VOffsetT = 18;
+            pub const VT_OCCLUDER_INDICES: flatbuffers::VOffsetT = 20;
+            pub const VT_PRIMITIVE_LODS: flatbuffers::VOffsetT = 22;
+            pub const VT_LODS: flatbuffers::VOffsetT = 24;
+            pub const VT_PRIMITIVE_UV_DENSITIES: flatbuffers::VOffsetT = 26;
 
             #[inline]
             pub fn vertex_buffer(&self) -> Option<&'a [u8]> {
@@ -505,6 +754,57 @@ pub mod tempest {
                     )
                     .map(|v| v.safe_slice())
             }
+            #[inline]
+            pub fn occluders(&self) -> Option<&'a [OccluderData]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<OccluderData>>>(
+                        GeometryDatabase::VT_OCCLUDERS,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn occluder_vertices(&self) -> Option<&'a [super::super::common::tempest::Vec3]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<
+                        flatbuffers::Vector<super::super::common::tempest::Vec3>,
+                    >>(GeometryDatabase::VT_OCCLUDER_VERTICES, None)
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn occluder_indices(&self) -> Option<flatbuffers::Vector<'a, u32>> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<'a, u32>>>(
+                        GeometryDatabase::VT_OCCLUDER_INDICES,
+                        None,
+                    )
+            }
+            #[inline]
+            pub fn primitive_lods(&self) -> Option<&'a [PrimitiveMeshLods]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<PrimitiveMeshLods>>>(
+                        GeometryDatabase::VT_PRIMITIVE_LODS,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn lods(&self) -> Option<&'a [MeshLod]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<MeshLod>>>(
+                        GeometryDatabase::VT_LODS,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn primitive_uv_densities(&self) -> Option<flatbuffers::Vector<'a, f32>> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<'a, f32>>>(
+                        GeometryDatabase::VT_PRIMITIVE_UV_DENSITIES,
+                        None,
+                    )
+            }
         }
 
         pub struct GeometryDatabaseArgs<'a> {
@@ -515,6 +815,18 @@ pub mod tempest {
                 Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, PrimitiveMeshData>>>,
             pub materials: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, Material>>>,
             pub mappings: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, MeshMapping>>>,
+            pub occluders: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, OccluderData>>>,
+            pub occluder_vertices: Option<
+                flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'a, super::super::common::tempest::Vec3>,
+                >,
+            >,
+            pub occluder_indices: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, u32>>>,
+            pub primitive_lods:
+                Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, PrimitiveMeshLods>>>,
+            pub lods: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, MeshLod>>>,
+            pub primitive_uv_densities:
+                Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, f32>>>,
         }
         impl<'a> Default for GeometryDatabaseArgs<'a> {
             #[inline]
@@ -526,6 +838,12 @@ pub mod tempest {
                     primitive_meshes: None,
                     materials: None,
                     mappings: None,
+                    occluders: None,
+                    occluder_vertices: None,
+                    occluder_indices: None,
+                    primitive_lods: None,
+                    lods: None,
+                    primitive_uv_densities: None,
                 }
             }
         }
@@ -597,6 +915,66 @@ pub mod tempest {
                 );
             }
             #[inline]
+            pub fn add_occluders(
+                &mut self,
+                occluders: flatbuffers::WIPOffset<flatbuffers::Vector<'b, OccluderData>>,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    GeometryDatabase::VT_OCCLUDERS,
+                    occluders,
+                );
+            }
+            #[inline]
+            pub fn add_occluder_vertices(
+                &mut self,
+                occluder_vertices: flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'b, super::super::common::tempest::Vec3>,
+                >,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    GeometryDatabase::VT_OCCLUDER_VERTICES,
+                    occluder_vertices,
+                );
+            }
+            #[inline]
+            pub fn add_occluder_indices(
+                &mut self,
+                occluder_indices: flatbuffers::WIPOffset<flatbuffers::Vector<'b, u32>>,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    GeometryDatabase::VT_OCCLUDER_INDICES,
+                    occluder_indices,
+                );
+            }
+            #[inline]
+            pub fn add_primitive_lods(
+                &mut self,
+                primitive_lods: flatbuffers::WIPOffset<flatbuffers::Vector<'b, PrimitiveMeshLods>>,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    GeometryDatabase::VT_PRIMITIVE_LODS,
+                    primitive_lods,
+                );
+            }
+            #[inline]
+            pub fn add_lods(
+                &mut self,
+                lods: flatbuffers::WIPOffset<flatbuffers::Vector<'b, MeshLod>>,
+            ) {
+                self.fbb_
+                    .push_slot_always::<flatbuffers::WIPOffset<_>>(GeometryDatabase::VT_LODS, lods);
+            }
+            #[inline]
+            pub fn add_primitive_uv_densities(
+                &mut self,
+                primitive_uv_densities: flatbuffers::WIPOffset<flatbuffers::Vector<'b, f32>>,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    GeometryDatabase::VT_PRIMITIVE_UV_DENSITIES,
+                    primitive_uv_densities,
+                );
+            }
+            #[inline]
             pub fn new(
                 _fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>,
             ) -> GeometryDatabaseBuilder<'a, 'b> {
@@ -118,6 +118,124 @@ pub mod tempest {
             }
         }
 
+        pub enum LevelSectorOffset {}
+        #[derive(Copy, Clone, Debug, PartialEq)]
+
+        pub struct LevelSector<'a> {
+            pub _tab: flatbuffers::Table<'a>,
+        }
+
+        impl<'a> flatbuffers::Follow<'a> for LevelSector<'a> {
+            type Inner = LevelSector<'a>;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                Self {
+                    _tab: flatbuffers::Table { buf: buf, loc: loc },
+                }
+            }
+        }
+
+        impl<'a> LevelSector<'a> {
+            #[inline]
+            pub fn init_from_table(table: flatbuffers::Table<'a>) -> Self {
+                LevelSector { _tab: table }
+            }
+            #[allow(unused_mut)]
+            pub fn create<'bldr: 'args, 'args: 'mut_bldr, 'mut_bldr>(
+                _fbb: &'mut_bldr mut flatbuffers::FlatBufferBuilder<'bldr>,
+                args: &'args LevelSectorArgs<'args>,
+            ) -> flatbuffers::WIPOffset<LevelSector<'bldr>> {
+                let mut builder = LevelSectorBuilder::new(_fbb);
+                if let Some(x) = args.file {
+                    builder.add_file(x);
+                }
+                if let Some(x) = args.bounds_max {
+                    builder.add_bounds_max(x);
+                }
+                if let Some(x) = args.bounds_min {
+                    builder.add_bounds_min(x);
+                }
+                builder.finish()
+            }
+
+            pub const VT_BOUNDS_MIN: flatbuffers::VOffsetT = 4;
+            pub const VT_BOUNDS_MAX: flatbuffers::VOffsetT = 6;
+            pub const VT_FILE: flatbuffers::VOffsetT = 8;
+
+            #[inline]
+            pub fn bounds_min(&self) -> Option<&'a super::super::common::tempest::Vec3> {
+                self._tab
+                    .get::<super::super::common::tempest::Vec3>(LevelSector::VT_BOUNDS_MIN, None)
+            }
+            #[inline]
+            pub fn bounds_max(&self) -> Option<&'a super::super::common::tempest::Vec3> {
+                self._tab
+                    .get::<super::super::common::tempest::Vec3>(LevelSector::VT_BOUNDS_MAX, None)
+            }
+            #[inline]
+            pub fn file(&self) -> Option<&'a str> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<&str>>(LevelSector::VT_FILE, None)
+            }
+        }
+
+        pub struct LevelSectorArgs<'a> {
+            pub bounds_min: Option<&'a super::super::common::tempest::Vec3>,
+            pub bounds_max: Option<&'a super::super::common::tempest::Vec3>,
+            pub file: Option<flatbuffers::WIPOffset<&'a str>>,
+        }
+        impl<'a> Default for LevelSectorArgs<'a> {
+            #[inline]
+            fn default() -> Self {
+                LevelSectorArgs {
+                    bounds_min: None,
+                    bounds_max: None,
+                    file: None,
+                }
+            }
+        }
+        pub struct LevelSectorBuilder<'a: 'b, 'b> {
+            fbb_: &'b mut flatbuffers::FlatBufferBuilder<'a>,
+            start_: flatbuffers::WIPOffset<flatbuffers::TableUnfinishedWIPOffset>,
+        }
+        impl<'a: 'b, 'b> LevelSectorBuilder<'a, 'b> {
+            #[inline]
+            pub fn add_bounds_min(&mut self, bounds_min: &'b super::super::common::tempest::Vec3) {
+                self.fbb_
+                    .push_slot_always::<&super::super::common::tempest::Vec3>(
+                        LevelSector::VT_BOUNDS_MIN,
+                        bounds_min,
+                    );
+            }
+            #[inline]
+            pub fn add_bounds_max(&mut self, bounds_max: &'b super::super::common::tempest::Vec3) {
+                self.fbb_
+                    .push_slot_always::<&super::super::common::tempest::Vec3>(
+                        LevelSector::VT_BOUNDS_MAX,
+                        bounds_max,
+                    );
+            }
+            #[inline]
+            pub fn add_file(&mut self, file: flatbuffers::WIPOffset<&'b str>) {
+                self.fbb_
+                    .push_slot_always::<flatbuffers::WIPOffset<_>>(LevelSector::VT_FILE, file);
+            }
+            #[inline]
+            pub fn new(
+                _fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>,
+            ) -> LevelSectorBuilder<'a, 'b> {
+                let start = _fbb.start_table();
+                LevelSectorBuilder {
+                    fbb_: _fbb,
+                    start_: start,
+                }
+            }
+            #[inline]
+            pub fn finish(self) -> flatbuffers::WIPOffset<LevelSector<'a>> {
+                let o = self.fbb_.end_table(self.start_);
+                flatbuffers::WIPOffset::new(o.value())
+            }
+        }
         pub enum LevelOffset {}
         #[derive(Copy, Clone, Debug, PartialEq)]
 
@@ -146,6 +264,9 @@ pub mod tempest {
                 args: &'args LevelArgs<'args>,
             ) -> flatbuffers::WIPOffset<Level<'bldr>> {
                 let mut builder = LevelBuilder::new(_fbb);
+                if let Some(x) = args.sectors {
+                    builder.add_sectors(x);
+                }
                 if let Some(x) = args.camera {
                     builder.add_camera(x);
                 }
@@ -177,6 +298,7 @@ pub mod tempest {
             pub const VT_TEXTURE_DATABASE_FILE: flatbuffers::VOffsetT = 12;
             pub const VT_AUDIO_DATABASE_FILE: flatbuffers::VOffsetT = 14;
             pub const VT_CAMERA: flatbuffers::VOffsetT = 16;
+            pub const VT_SECTORS: flatbuffers::VOffsetT = 18;
 
             #[inline]
             pub fn name(&self) -> Option<&'a str> {
@@ -224,6 +346,15 @@ pub mod tempest {
             pub fn camera(&self) -> Option<&'a Camera> {
                 self._tab.get::<Camera>(Level::VT_CAMERA, None)
             }
+            #[inline]
+            pub fn sectors(
+                &self,
+            ) -> Option<flatbuffers::Vector<'a, flatbuffers::ForwardsUOffset<LevelSector<'a>>>>
+            {
+                self._tab.get::<flatbuffers::ForwardsUOffset<
+                    flatbuffers::Vector<flatbuffers::ForwardsUOffset<LevelSector<'a>>>,
+                >>(Level::VT_SECTORS, None)
+            }
         }
 
         pub struct LevelArgs<'a> {
@@ -234,6 +365,11 @@ pub mod tempest {
             pub texture_database_file: Option<flatbuffers::WIPOffset<&'a str>>,
             pub audio_database_file: Option<flatbuffers::WIPOffset<&'a str>>,
             pub camera: Option<&'a Camera>,
+            pub sectors: Option<
+                flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'a, flatbuffers::ForwardsUOffset<LevelSector<'a>>>,
+                >,
+            >,
         }
         impl<'a> Default for LevelArgs<'a> {
             #[inline]
@@ -246,6 +382,7 @@ pub mod tempest {
                     texture_database_file: None,
                     audio_database_file: None,
                     camera: None,
+                    sectors: None,
                 }
             }
         }
@@ -313,6 +450,16 @@ pub mod tempest {
                     .push_slot_always::<&Camera>(Level::VT_CAMERA, camera);
             }
             #[inline]
+            pub fn add_sectors(
+                &mut self,
+                sectors: flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'b, flatbuffers::ForwardsUOffset<LevelSector<'b>>>,
+                >,
+            ) {
+                self.fbb_
+                    .push_slot_always::<flatbuffers::WIPOffset<_>>(Level::VT_SECTORS, sectors);
+            }
+            #[inline]
             pub fn new(_fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>) -> LevelBuilder<'a, 'b> {
                 let start = _fbb.start_table();
                 LevelBuilder {
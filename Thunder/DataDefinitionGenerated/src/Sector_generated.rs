@@ -0,0 +1,183 @@
+// automatically generated by the FlatBuffers compiler, do not modify
+
+use std::cmp::Ordering;
+use std::mem;
+
+extern crate flatbuffers;
+use self::flatbuffers::EndianScalar;
+
+#[allow(unused_imports, dead_code)]
+pub mod tempest {
+
+    use std::cmp::Ordering;
+    use std::mem;
+
+    extern crate flatbuffers;
+    use self::flatbuffers::EndianScalar;
+    #[allow(unused_imports, dead_code)]
+    pub mod definition {
+
+        use std::cmp::Ordering;
+        use std::mem;
+
+        extern crate flatbuffers;
+        use self::flatbuffers::EndianScalar;
+
+        pub enum SectorOffset {}
+        #[derive(Copy, Clone, Debug, PartialEq)]
+
+        pub struct Sector<'a> {
+            pub _tab: flatbuffers::Table<'a>,
+        }
+
+        impl<'a> flatbuffers::Follow<'a> for Sector<'a> {
+            type Inner = Sector<'a>;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                Self {
+                    _tab: flatbuffers::Table { buf: buf, loc: loc },
+                }
+            }
+        }
+
+        impl<'a> Sector<'a> {
+            #[inline]
+            pub fn init_from_table(table: flatbuffers::Table<'a>) -> Self {
+                Sector { _tab: table }
+            }
+            #[allow(unused_mut)]
+            pub fn create<'bldr: 'args, 'args: 'mut_bldr, 'mut_bldr>(
+                _fbb: &'mut_bldr mut flatbuffers::FlatBufferBuilder<'bldr>,
+                args: &'args SectorArgs<'args>,
+            ) -> flatbuffers::WIPOffset<Sector<'bldr>> {
+                let mut builder = SectorBuilder::new(_fbb);
+                if let Some(x) = args.entity_names {
+                    builder.add_entity_names(x);
+                }
+                if let Some(x) = args.entities {
+                    builder.add_entities(x);
+                }
+                builder.finish()
+            }
+
+            pub const VT_ENTITIES: flatbuffers::VOffsetT = 4;
+            pub const VT_ENTITY_NAMES: flatbuffers::VOffsetT = 6;
+
+            #[inline]
+            pub fn entities(&self) -> Option<&'a [u8]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<'a, u8>>>(
+                        Sector::VT_ENTITIES,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn entity_names(
+                &self,
+            ) -> Option<flatbuffers::Vector<'a, flatbuffers::ForwardsUOffset<&'a str>>>
+            {
+                self._tab.get::<flatbuffers::ForwardsUOffset<
+                    flatbuffers::Vector<flatbuffers::ForwardsUOffset<&'a str>>,
+                >>(Sector::VT_ENTITY_NAMES, None)
+            }
+        }
+
+        pub struct SectorArgs<'a> {
+            pub entities: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, u8>>>,
+            pub entity_names: Option<
+                flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'a, flatbuffers::ForwardsUOffset<&'a str>>,
+                >,
+            >,
+        }
+        impl<'a> Default for SectorArgs<'a> {
+            #[inline]
+            fn default() -> Self {
+                SectorArgs {
+                    entities: None,
+                    entity_names: None,
+                }
+            }
+        }
+        pub struct SectorBuilder<'a: 'b, 'b> {
+            fbb_: &'b mut flatbuffers::FlatBufferBuilder<'a>,
+            start_: flatbuffers::WIPOffset<flatbuffers::TableUnfinishedWIPOffset>,
+        }
+        impl<'a: 'b, 'b> SectorBuilder<'a, 'b> {
+            #[inline]
+            pub fn add_entities(
+                &mut self,
+                entities: flatbuffers::WIPOffset<flatbuffers::Vector<'b, u8>>,
+            ) {
+                self.fbb_
+                    .push_slot_always::<flatbuffers::WIPOffset<_>>(Sector::VT_ENTITIES, entities);
+            }
+            #[inline]
+            pub fn add_entity_names(
+                &mut self,
+                entity_names: flatbuffers::WIPOffset<
+                    flatbuffers::Vector<'b, flatbuffers::ForwardsUOffset<&'b str>>,
+                >,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    Sector::VT_ENTITY_NAMES,
+                    entity_names,
+                );
+            }
+            #[inline]
+            pub fn new(_fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>) -> SectorBuilder<'a, 'b> {
+                let start = _fbb.start_table();
+                SectorBuilder {
+                    fbb_: _fbb,
+                    start_: start,
+                }
+            }
+            #[inline]
+            pub fn finish(self) -> flatbuffers::WIPOffset<Sector<'a>> {
+                let o = self.fbb_.end_table(self.start_);
+                flatbuffers::WIPOffset::new(o.value())
+            }
+        }
+
+        #[inline]
+        pub fn get_root_as_sector<'a>(buf: &'a [u8]) -> Sector<'a> {
+            flatbuffers::get_root::<Sector<'a>>(buf)
+        }
+
+        #[inline]
+        pub fn get_size_prefixed_root_as_sector<'a>(buf: &'a [u8]) -> Sector<'a> {
+            flatbuffers::get_size_prefixed_root::<Sector<'a>>(buf)
+        }
+
+        pub const SECTOR_IDENTIFIER: &'static str = "TSEC";
+
+        #[inline]
+        pub fn sector_buffer_has_identifier(buf: &[u8]) -> bool {
+            return flatbuffers::buffer_has_identifier(buf, SECTOR_IDENTIFIER, false);
+        }
+
+        #[inline]
+        pub fn sector_size_prefixed_buffer_has_identifier(buf: &[u8]) -> bool {
+            return flatbuffers::buffer_has_identifier(buf, SECTOR_IDENTIFIER, true);
+        }
+
+        pub const SECTOR_EXTENSION: &'static str = "tsc";
+
+        #[inline]
+        pub fn finish_sector_buffer<'a, 'b>(
+            fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>,
+            root: flatbuffers::WIPOffset<Sector<'a>>,
+        ) {
+            fbb.finish(root, Some(SECTOR_IDENTIFIER));
+        }
+
+        #[inline]
+        pub fn finish_size_prefixed_sector_buffer<'a, 'b>(
+            fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>,
+            root: flatbuffers::WIPOffset<Sector<'a>>,
+        ) {
+            fbb.finish_size_prefixed(root, Some(SECTOR_IDENTIFIER));
+        }
+    } // pub mod Definition
+} // pub mod Tempest
@@ -217,6 +217,136 @@ pub mod tempest {
             }
         }
 
+        // struct TextureMip, aligned to 4
+        #[repr(C, align(4))]
+        #[derive(Clone, Copy, Debug, PartialEq)]
+        pub struct TextureMip {
+            offset_: u32,
+            byte_count_: u32,
+        } // pub struct TextureMip
+        impl flatbuffers::SafeSliceAccess for TextureMip {}
+        impl<'a> flatbuffers::Follow<'a> for TextureMip {
+            type Inner = &'a TextureMip;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                <&'a TextureMip>::follow(buf, loc)
+            }
+        }
+        impl<'a> flatbuffers::Follow<'a> for &'a TextureMip {
+            type Inner = &'a TextureMip;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                flatbuffers::follow_cast_ref::<TextureMip>(buf, loc)
+            }
+        }
+        impl<'b> flatbuffers::Push for TextureMip {
+            type Output = TextureMip;
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        self as *const TextureMip as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+        impl<'b> flatbuffers::Push for &'b TextureMip {
+            type Output = TextureMip;
+
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        *self as *const TextureMip as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+
+        impl TextureMip {
+            pub fn new<'a>(_offset: u32, _byte_count: u32) -> Self {
+                TextureMip {
+                    offset_: _offset.to_little_endian(),
+                    byte_count_: _byte_count.to_little_endian(),
+                }
+            }
+            pub fn offset<'a>(&'a self) -> u32 {
+                self.offset_.from_little_endian()
+            }
+            pub fn byte_count<'a>(&'a self) -> u32 {
+                self.byte_count_.from_little_endian()
+            }
+        }
+
+        // struct TextureMipRange, aligned to 4
+        #[repr(C, align(4))]
+        #[derive(Clone, Copy, Debug, PartialEq)]
+        pub struct TextureMipRange {
+            mip_offset_: u32,
+            mip_count_: u32,
+        } // pub struct TextureMipRange
+        impl flatbuffers::SafeSliceAccess for TextureMipRange {}
+        impl<'a> flatbuffers::Follow<'a> for TextureMipRange {
+            type Inner = &'a TextureMipRange;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                <&'a TextureMipRange>::follow(buf, loc)
+            }
+        }
+        impl<'a> flatbuffers::Follow<'a> for &'a TextureMipRange {
+            type Inner = &'a TextureMipRange;
+            #[inline]
+            fn follow(buf: &'a [u8], loc: usize) -> Self::Inner {
+                flatbuffers::follow_cast_ref::<TextureMipRange>(buf, loc)
+            }
+        }
+        impl<'b> flatbuffers::Push for TextureMipRange {
+            type Output = TextureMipRange;
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        self as *const TextureMipRange as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+        impl<'b> flatbuffers::Push for &'b TextureMipRange {
+            type Output = TextureMipRange;
+
+            #[inline]
+            fn push(&self, dst: &mut [u8], _rest: &[u8]) {
+                let src = unsafe {
+                    ::std::slice::from_raw_parts(
+                        *self as *const TextureMipRange as *const u8,
+                        Self::size(),
+                    )
+                };
+                dst.copy_from_slice(src);
+            }
+        }
+
+        impl TextureMipRange {
+            pub fn new<'a>(_mip_offset: u32, _mip_count: u32) -> Self {
+                TextureMipRange {
+                    mip_offset_: _mip_offset.to_little_endian(),
+                    mip_count_: _mip_count.to_little_endian(),
+                }
+            }
+            pub fn mip_offset<'a>(&'a self) -> u32 {
+                self.mip_offset_.from_little_endian()
+            }
+            pub fn mip_count<'a>(&'a self) -> u32 {
+                self.mip_count_.from_little_endian()
+            }
+        }
+
         // struct TextureMapping, aligned to 4
         #[repr(C, align(4))]
         #[derive(Clone, Copy, Debug, PartialEq)]
@@ -335,6 +465,12 @@ pub mod tempest {
                 args: &'args TextureDatabaseArgs<'args>,
             ) -> flatbuffers::WIPOffset<TextureDatabase<'bldr>> {
                 let mut builder = TextureDatabaseBuilder::new(_fbb);
+                if let Some(x) = args.mips {
+                    builder.add_mips(x);
+                }
+                if let Some(x) = args.mip_ranges {
+                    builder.add_mip_ranges(x);
+                }
                 if let Some(x) = args.mappings {
                     builder.add_mappings(x);
                 }
@@ -346,6 +482,8 @@ pub mod tempest {
 
             pub const VT_TEXTURE_DATA_BUFFER: flatbuffers::VOffsetT = 4;
             pub const VT_MAPPINGS: flatbuffers::VOffsetT = 6;
+            pub const VT_MIP_RANGES: flatbuffers::VOffsetT = 8;
+            pub const VT_MIPS: flatbuffers::VOffsetT = 10;
 
             #[inline]
             pub fn texture_data_buffer(&self) -> Option<&'a [u8]> {
@@ -365,11 +503,32 @@ pub mod tempest {
                     )
                     .map(|v| v.safe_slice())
             }
+            #[inline]
+            pub fn mip_ranges(&self) -> Option<&'a [TextureMipRange]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<TextureMipRange>>>(
+                        TextureDatabase::VT_MIP_RANGES,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
+            #[inline]
+            pub fn mips(&self) -> Option<&'a [TextureMip]> {
+                self._tab
+                    .get::<flatbuffers::ForwardsUOffset<flatbuffers::Vector<TextureMip>>>(
+                        TextureDatabase::VT_MIPS,
+                        None,
+                    )
+                    .map(|v| v.safe_slice())
+            }
         }
 
         pub struct TextureDatabaseArgs<'a> {
             pub texture_data_buffer: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, u8>>>,
             pub mappings: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, TextureMapping>>>,
+            pub mip_ranges:
+                Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, TextureMipRange>>>,
+            pub mips: Option<flatbuffers::WIPOffset<flatbuffers::Vector<'a, TextureMip>>>,
         }
         impl<'a> Default for TextureDatabaseArgs<'a> {
             #[inline]
@@ -377,6 +536,8 @@ pub mod tempest {
                 TextureDatabaseArgs {
                     texture_data_buffer: None,
                     mappings: None,
+                    mip_ranges: None,
+                    mips: None,
                 }
             }
         }
@@ -406,6 +567,24 @@ pub mod tempest {
                 );
             }
             #[inline]
+            pub fn add_mip_ranges(
+                &mut self,
+                mip_ranges: flatbuffers::WIPOffset<flatbuffers::Vector<'b, TextureMipRange>>,
+            ) {
+                self.fbb_.push_slot_always::<flatbuffers::WIPOffset<_>>(
+                    TextureDatabase::VT_MIP_RANGES,
+                    mip_ranges,
+                );
+            }
+            #[inline]
+            pub fn add_mips(
+                &mut self,
+                mips: flatbuffers::WIPOffset<flatbuffers::Vector<'b, TextureMip>>,
+            ) {
+                self.fbb_
+                    .push_slot_always::<flatbuffers::WIPOffset<_>>(TextureDatabase::VT_MIPS, mips);
+            }
+            #[inline]
             pub fn new(
                 _fbb: &'b mut flatbuffers::FlatBufferBuilder<'a>,
             ) -> TextureDatabaseBuilder<'a, 'b> {
@@ -5,6 +5,7 @@ pub mod AudioDatabase_generated;
 pub mod CommonTypes_generated;
 pub mod GeometryDatabase_generated;
 pub mod Level_generated;
+pub mod Sector_generated;
 pub mod ShaderLibrary_generated;
 pub mod TextureDatabase_generated;
 
@@ -17,6 +18,7 @@ pub use AudioDatabase_generated::tempest::definition::*;
 pub use CommonTypes_generated::common::tempest::*;
 pub use GeometryDatabase_generated::tempest::definition::*;
 pub use Level_generated::tempest::definition::*;
+pub use Sector_generated::tempest::definition::*;
 pub use ShaderLibrary_generated::tempest::definition::*;
 pub use TextureDatabase_generated::tempest::definition::*;
 
@@ -213,6 +213,8 @@ fn derive_serialize_impl(
                     builder,
                     &data_definition_generated::#flatbuffer_struct_args_name {
                         #(#members_assign,)*
+                        // Fields added to the schema later are optional and stay empty
+                        ..Default::default()
                     }
                 )
             }
@@ -1,7 +1,7 @@
 use std::sync::Weak;
 
 use basis_universal::{Compressor, CompressorParams, TranscodeParameters, Transcoder};
-use data_definition_generated::{ColorSpace, TextureData, TextureFormat};
+use data_definition_generated::{ColorSpace, TextureData, TextureFormat, TextureMip};
 
 use crate::{compiler::AsyncCompiler, scene::Scene};
 
@@ -28,7 +28,10 @@ impl TextureResource {
 
 #[derive(Debug)]
 pub struct CompiledTextureData {
+    // All mips one after another, starting with the most detailed
     pub data: Vec<u8>,
+    // Offsets are from the start of data
+    pub mips: Vec<TextureMip>,
     pub texture_info: TextureData,
 }
 
@@ -53,7 +56,8 @@ impl Resource for TextureResource {
         };
 
         let mut compressor_params = CompressorParams::new();
-        compressor_params.set_generate_mipmaps(false);
+        // The engine streams the mips, so the whole chain down to 1x1 is cooked
+        compressor_params.set_generate_mipmaps(true);
         compressor_params.set_basis_format(basis_universal::BasisTextureFormat::UASTC4x4);
         compressor_params.set_uastc_quality_level(basis_universal::UASTC_QUALITY_DEFAULT);
         compressor_params.set_print_status_to_stdout(false);
@@ -81,21 +85,30 @@ impl Resource for TextureResource {
 
         let mut transcoder = Transcoder::new();
         transcoder.prepare_transcoding(basis_file).unwrap();
-        let result = transcoder
-            .transcode_image_level(
-                basis_file,
-                match self.request.format {
-                    TextureFormat::RGBA8 => basis_universal::TranscoderTextureFormat::RGBA32,
-                    TextureFormat::BC1_RGB => basis_universal::TranscoderTextureFormat::BC1_RGB,
-                    TextureFormat::BC7_RGBA => basis_universal::TranscoderTextureFormat::BC7_RGBA,
-                } ,
-                TranscodeParameters {
-                    image_index: 0,
-                    level_index: 0,
-                    ..Default::default()
-                },
-            )
-            .unwrap();
+        let transcode_format = match self.request.format {
+            TextureFormat::RGBA8 => basis_universal::TranscoderTextureFormat::RGBA32,
+            TextureFormat::BC1_RGB => basis_universal::TranscoderTextureFormat::BC1_RGB,
+            TextureFormat::BC7_RGBA => basis_universal::TranscoderTextureFormat::BC7_RGBA,
+        };
+
+        // Blocks and pixels come out tightly packed row after row, which is what the engine expects for every mip
+        let mut result = Vec::new();
+        let mut mips = Vec::new();
+        for level_index in 0..transcoder.image_level_count(basis_file, 0) {
+            let level = transcoder
+                .transcode_image_level(
+                    basis_file,
+                    transcode_format,
+                    TranscodeParameters {
+                        image_index: 0,
+                        level_index,
+                        ..Default::default()
+                    },
+                )
+                .unwrap();
+            mips.push(TextureMip::new(result.len() as u32, level.len() as u32));
+            result.extend(level);
+        }
 
         let image_description = transcoder
             .image_level_description(basis_file, 0, 0)
@@ -103,6 +116,7 @@ impl Resource for TextureResource {
 
         CompiledTextureData {
             data: result,
+            mips,
             texture_info: TextureData::new(
                 image_description.original_width,
                 image_description.original_height,
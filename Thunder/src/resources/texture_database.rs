@@ -1,7 +1,9 @@
 use std::sync::{Arc, Weak};
 
 use crate::scene::Scene;
-use data_definition_generated::{flatbuffer_derive::FlatbufferSerializeRoot, TextureMapping};
+use data_definition_generated::{
+    flatbuffer_derive::FlatbufferSerializeRoot, TextureMapping, TextureMip, TextureMipRange,
+};
 
 use crate::compiler::AsyncCompiler;
 
@@ -30,6 +32,10 @@ struct TextureDatabase {
     texture_data_buffer: Vec<u8>,
     #[store_vector_direct]
     mappings: Vec<data_definition_generated::TextureMapping>,
+    #[store_vector_direct]
+    mip_ranges: Vec<TextureMipRange>,
+    #[store_vector_direct]
+    mips: Vec<TextureMip>,
 }
 
 #[async_trait]
@@ -59,8 +65,17 @@ impl Resource for TextureDatabaseResource {
 
         let mut texture_data_buffer = Vec::<u8>::new();
         let mut mappings = Vec::new();
+        let mut mip_ranges = Vec::new();
+        let mut mips = Vec::new();
 
         for (index, texture) in gathered_textures.into_iter().enumerate() {
+            mip_ranges.push(TextureMipRange::new(mips.len() as u32, texture.mips.len() as u32));
+            for mip in &texture.mips {
+                mips.push(TextureMip::new(
+                    texture_data_buffer.len() as u32 + mip.offset(),
+                    mip.byte_count(),
+                ));
+            }
             mappings.push(TextureMapping::new(
                 index as u32,
                 texture_data_buffer.len() as u32,
@@ -73,6 +88,8 @@ impl Resource for TextureDatabaseResource {
         let database = TextureDatabase {
             texture_data_buffer,
             mappings,
+            mip_ranges,
+            mips,
         };
 
         database.serialize_root()
@@ -0,0 +1,22 @@
+using Sharpmake;
+
+namespace TempoEngine
+{
+    [Sharpmake.Generate]
+    public class Benchmarks : CommonProject
+    {
+        public Benchmarks()
+        {
+            Name = "Benchmarks";
+            SourceRootPath = @"[project.SharpmakeCsPath]\..\Benchmarks";
+        }
+
+        public override void ConfigureAll(Project.Configuration conf, Target target)
+        {
+            base.ConfigureAll(conf, target);
+            conf.Output = Configuration.OutputType.Exe;
+
+            conf.AddPrivateDependency<Tempest>(target);
+        }
+    }
+}
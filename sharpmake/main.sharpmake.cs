@@ -5,6 +5,8 @@ using Sharpmake;
 [module: Sharpmake.Include("tempest.sharpmake.cs")]
 [module: Sharpmake.Include("maelstrom.sharpmake.cs")]
 [module: Sharpmake.Include("spark.sharpmake.cs")]
+[module: Sharpmake.Include("tests.sharpmake.cs")]
+[module: Sharpmake.Include("benchmarks.sharpmake.cs")]
 
 namespace TempoEngine
 {
@@ -25,6 +27,8 @@ namespace TempoEngine
 
             conf.AddProject<Spark>(target);
             conf.AddProject<Maelstrom>(target);
+            conf.AddProject<Tests>(target);
+            conf.AddProject<Benchmarks>(target);
         }
     }
 
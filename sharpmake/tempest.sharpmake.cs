@@ -25,6 +25,8 @@ namespace TempoEngine
             conf.AddPublicDependency<GAInput>(target);
             conf.AddPublicDependency<ImGUI>(target);
             conf.AddPublicDependency<Stb>(target);
+            conf.AddPublicDependency<Lz4>(target);
+            conf.AddPublicDependency<Zstd>(target);
 
             conf.IncludePaths.Add("[project.RootPath]");
 
@@ -0,0 +1,22 @@
+using Sharpmake;
+
+namespace TempoEngine
+{
+    [Sharpmake.Generate]
+    public class Tests : CommonProject
+    {
+        public Tests()
+        {
+            Name = "Tests";
+            SourceRootPath = @"[project.SharpmakeCsPath]\..\Tests";
+        }
+
+        public override void ConfigureAll(Project.Configuration conf, Target target)
+        {
+            base.ConfigureAll(conf, target);
+            conf.Output = Configuration.OutputType.Exe;
+
+            conf.AddPrivateDependency<Tempest>(target);
+        }
+    }
+}
@@ -153,6 +153,46 @@ namespace TempoEngine
         }
     }
 
+    [Sharpmake.Export]
+    public class Lz4 : ThirdPartyVcpkgProject
+    {
+        public override void ConfigureAll(Project.Configuration conf, Target target)
+        {
+            base.ConfigureAll(conf, target);
+
+            if (target.Optimization == Optimization.Debug)
+            {
+                conf.LibraryFiles.Add("lz4d");
+                conf.TargetCopyFiles.Add(@"[project.SharpmakeCsPath]\..\vcpkg_installed\x64-windows\debug\bin\lz4d.dll");
+            }
+            else
+            {
+                conf.LibraryFiles.Add("lz4");
+                conf.TargetCopyFiles.Add(@"[project.SharpmakeCsPath]\..\vcpkg_installed\x64-windows\bin\lz4.dll");
+            }
+        }
+    }
+
+    [Sharpmake.Export]
+    public class Zstd : ThirdPartyVcpkgProject
+    {
+        public override void ConfigureAll(Project.Configuration conf, Target target)
+        {
+            base.ConfigureAll(conf, target);
+
+            if (target.Optimization == Optimization.Debug)
+            {
+                conf.LibraryFiles.Add("zstdd");
+                conf.TargetCopyFiles.Add(@"[project.SharpmakeCsPath]\..\vcpkg_installed\x64-windows\debug\bin\zstdd.dll");
+            }
+            else
+            {
+                conf.LibraryFiles.Add("zstd");
+                conf.TargetCopyFiles.Add(@"[project.SharpmakeCsPath]\..\vcpkg_installed\x64-windows\bin\zstd.dll");
+            }
+        }
+    }
+
     [Sharpmake.Export]
     public class Nvtt : ThirdPartyVcpkgProject
     {